@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef MANIFOLD_ENUPROJECTION_HH_
+#define MANIFOLD_ENUPROJECTION_HH_
+
+#include <memory>
+#include <vector>
+#include <ignition/math/SphericalCoordinates.hh>
+#include <ignition/math/Vector3.hh>
+
+#include "manifold/Helpers.hh"
+
+namespace manifold
+{
+  namespace rndf
+  {
+    class RNDF;
+    class UniqueId;
+    class Waypoint;
+  }
+
+  // Forward declarations.
+  class EnuProjectionPrivate;
+
+  /// \brief Projection of locations to a local east-north-up (ENU) frame
+  /// with a chosen origin (WGS84 ellipsoid), for whole lanes or maps at a
+  /// time.
+  ///
+  /// The batch functions convert arrays of latitudes and longitudes with
+  /// a SIMD kernel (SSE2) where available, or a scalar one otherwise. Both
+  /// kernels return the same bits, and so does the projection of a single
+  /// location, so the result doesn't depend on how the locations are
+  /// batched. The error is below a micrometer within hundreds of
+  /// kilometers of the origin. The up coordinate is ignored: all the
+  /// points returned are on the horizontal plane (z = 0).
+  class MANIFOLD_VISIBLE EnuProjection
+  {
+    /// \brief Constructor.
+    /// \param[in] _origin Origin of the ENU frame.
+    public: explicit EnuProjection(
+      const ignition::math::SphericalCoordinates &_origin);
+
+    /// \brief Destructor.
+    public: virtual ~EnuProjection();
+
+    /// \brief Get the origin of the ENU frame.
+    /// \return The origin.
+    public: const ignition::math::SphericalCoordinates &Origin() const;
+
+    /// \brief Whether the batch functions use SIMD instructions.
+    /// \return True if they do.
+    public: static bool Vectorized();
+
+    /// \brief Project a location.
+    /// \param[in] _location The location.
+    /// \return The position in the ENU frame (meters).
+    public: ignition::math::Vector3d Project(
+      const ignition::math::SphericalCoordinates &_location) const;
+
+    /// \brief Project arrays of latitudes and longitudes.
+    /// \param[in] _latitudes The latitudes (degrees).
+    /// \param[in] _longitudes The longitudes (degrees).
+    /// \param[out] _east East coordinate of each location (meters).
+    /// \param[out] _north North coordinate of each location (meters).
+    /// \return False if the arrays have different sizes.
+    public: bool Project(const std::vector<double> &_latitudes,
+                         const std::vector<double> &_longitudes,
+                         std::vector<double> &_east,
+                         std::vector<double> &_north) const;
+
+    /// \brief Project the locations of some waypoints, e.g. of a lane.
+    /// \param[in] _waypoints The waypoints.
+    /// \param[out] _points The position of each waypoint (meters).
+    public: void Project(const std::vector<rndf::Waypoint> &_waypoints,
+      std::vector<ignition::math::Vector3d> &_points) const;
+
+    /// \brief Project all the waypoints of an RNDF: the ones of the lanes,
+    /// the perimeters of the zones and the parking spots.
+    /// \param[in] _rndf The RNDF.
+    /// \param[out] _ids Unique Id of each waypoint. Perimeter points have
+    /// 0 as the second number.
+    /// \param[out] _points The position of each waypoint (meters).
+    public: void Project(const rndf::RNDF &_rndf,
+      std::vector<rndf::UniqueId> &_ids,
+      std::vector<ignition::math::Vector3d> &_points) const;
+
+    /// \internal
+    /// \brief Smart pointer to private data.
+    private: std::unique_ptr<EnuProjectionPrivate> dataPtr;
+  };
+}
+#endif
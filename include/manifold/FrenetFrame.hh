@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef MANIFOLD_FRENETFRAME_HH_
+#define MANIFOLD_FRENETFRAME_HH_
+
+#include <memory>
+#include <vector>
+#include <ignition/math/Vector3.hh>
+
+#include "manifold/Helpers.hh"
+
+namespace manifold
+{
+  namespace rndf
+  {
+    class UniqueId;
+  }
+
+  // Forward declarations.
+  class FrenetFramePrivate;
+  class LaneGeometry;
+  class LaneGeometryCache;
+
+  /// \brief Conversion between the Cartesian coordinates of a local
+  /// east-north-up (ENU) frame and the Frenet coordinates (s, d) along a
+  /// reference path, a lane or a route across several lanes, e.g. for a
+  /// trajectory optimizer: s is the arc length along the path and d the
+  /// signed distance to it, positive to the left.
+  ///
+  /// The path is the polyline of the waypoints, taken from the cached
+  /// geometry of the lanes (see LaneGeometryCache). A point is projected on
+  /// its closest piece of the path; the pieces at both ends are extended,
+  /// so the points before the start have a negative s and the points after
+  /// the end have an s greater than the length.
+  ///
+  /// A query without a hint searches the whole path in O(log n). A query
+  /// with a hint, the piece of the previous query, walks from that piece to
+  /// the closest one nearby, so sequential queries (e.g. the samples of a
+  /// trajectory) take amortized O(1). The walk stops at the first local
+  /// minimum of the distance: give no hint after a jump. The batched
+  /// conversions chain the hints and fall back to a full search when the
+  /// walk can't be right. All the functions can be called concurrently.
+  class MANIFOLD_VISIBLE FrenetFrame
+  {
+    /// \brief Constructor along a lane.
+    /// \param[in] _lane Geometry of the lane.
+    public: explicit FrenetFrame(const LaneGeometry &_lane);
+
+    /// \brief Constructor along a route, e.g. from
+    /// RoadNetwork::ShortestPath(). Consecutive waypoints of the same lane
+    /// are joined along the lane, so the route can also be given as the
+    /// first and last waypoints driven on each lane. The waypoints outside
+    /// the lanes (i.e. in zones) are skipped.
+    /// \param[in] _cache Geometry of the lanes.
+    /// \param[in] _route Unique Ids of the waypoints along the route.
+    public: FrenetFrame(const LaneGeometryCache &_cache,
+                        const std::vector<rndf::UniqueId> &_route);
+
+    /// \brief Destructor.
+    public: virtual ~FrenetFrame();
+
+    /// \brief Get the reference path, e.g. for its heading or curvature at
+    /// some s. Repeated points are removed.
+    /// \return The geometry of the path.
+    public: const LaneGeometry &Path() const;
+
+    /// \brief Get the length of the reference path.
+    /// \return The length (meters).
+    public: double Length() const;
+
+    /// \brief Convert a point to Frenet coordinates, searching the whole
+    /// path.
+    /// \param[in] _point The point in the ENU frame (meters).
+    /// \param[out] _s Arc length along the path (meters).
+    /// \param[out] _d Signed distance to the path (meters), positive to
+    /// the left.
+    /// \return True if the conversion succeeded or false if the path has
+    /// fewer than two points.
+    public: bool ToFrenet(const ignition::math::Vector3d &_point,
+                          double &_s, double &_d) const;
+
+    /// \brief Convert a point to Frenet coordinates, starting from a piece
+    /// of the path.
+    /// \param[in] _point The point in the ENU frame (meters).
+    /// \param[in,out] _hint Index of the piece to start from, e.g. 0 or the
+    /// value left by the previous query. Set to the piece of the point.
+    /// \param[out] _s Arc length along the path (meters).
+    /// \param[out] _d Signed distance to the path (meters), positive to
+    /// the left.
+    /// \return True if the conversion succeeded or false if the path has
+    /// fewer than two points.
+    public: bool ToFrenet(const ignition::math::Vector3d &_point,
+                          size_t &_hint, double &_s, double &_d) const;
+
+    /// \brief Convert a batch of points to Frenet coordinates. The points
+    /// are converted in order, each one starting from the piece of the
+    /// previous one.
+    /// \param[in] _points The points in the ENU frame (meters).
+    /// \param[out] _s Arc length of each point (meters).
+    /// \param[out] _d Signed distance of each point (meters).
+    /// \return True if the conversion succeeded or false if the path has
+    /// fewer than two points.
+    public: bool ToFrenet(const std::vector<ignition::math::Vector3d> &_points,
+                          std::vector<double> &_s,
+                          std::vector<double> &_d) const;
+
+    /// \brief Convert Frenet coordinates to a point, searching the whole
+    /// path.
+    /// \param[in] _s Arc length along the path (meters).
+    /// \param[in] _d Signed distance to the path (meters), positive to the
+    /// left.
+    /// \param[out] _point The point in the ENU frame (meters), with z = 0.
+    /// \return True if the conversion succeeded or false if the path has
+    /// fewer than two points.
+    public: bool ToCartesian(const double _s, const double _d,
+                             ignition::math::Vector3d &_point) const;
+
+    /// \brief Convert Frenet coordinates to a point, starting from a piece
+    /// of the path.
+    /// \param[in] _s Arc length along the path (meters).
+    /// \param[in] _d Signed distance to the path (meters), positive to the
+    /// left.
+    /// \param[in,out] _hint Index of the piece to start from, e.g. 0 or the
+    /// value left by the previous query. Set to the piece at _s.
+    /// \param[out] _point The point in the ENU frame (meters), with z = 0.
+    /// \return True if the conversion succeeded or false if the path has
+    /// fewer than two points.
+    public: bool ToCartesian(const double _s, const double _d,
+                             size_t &_hint,
+                             ignition::math::Vector3d &_point) const;
+
+    /// \brief Convert a batch of Frenet coordinates to points. The
+    /// coordinates are converted in order, each one starting from the piece
+    /// of the previous one.
+    /// \param[in] _s Arc length of each point (meters).
+    /// \param[in] _d Signed distance of each point (meters).
+    /// \param[out] _points The points in the ENU frame (meters).
+    /// \return True if the conversion succeeded or false if the path has
+    /// fewer than two points or the sizes of _s and _d differ.
+    public: bool ToCartesian(const std::vector<double> &_s,
+                             const std::vector<double> &_d,
+                             std::vector<ignition::math::Vector3d> &_points)
+                             const;
+
+    /// \internal
+    /// \brief Smart pointer to private data.
+    private: std::unique_ptr<FrenetFramePrivate> dataPtr;
+  };
+}
+#endif
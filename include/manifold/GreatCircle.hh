@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef MANIFOLD_GREATCIRCLE_HH_
+#define MANIFOLD_GREATCIRCLE_HH_
+
+#include <vector>
+
+#include "manifold/Helpers.hh"
+
+namespace manifold
+{
+  namespace rndf
+  {
+    class Waypoint;
+  }
+
+  /// \brief Bulk great-circle distances over arrays of latitudes and
+  /// longitudes, e.g. the lengths of the pieces of a lane or the distances
+  /// from a vehicle to many waypoints.
+  ///
+  /// The distances use the haversine formula on the same sphere as
+  /// SphericalCoordinates::Distance(), and agree with it within a few
+  /// ulps. The sines, cosines and arcsines are computed with a SIMD kernel
+  /// (SSE2) where available, or a scalar one otherwise. Both kernels
+  /// return the same bits, and so does the distance between two single
+  /// locations, so the result doesn't depend on how the pairs are
+  /// batched. All the angles are in degrees and all the distances in
+  /// meters.
+  class MANIFOLD_VISIBLE GreatCircle
+  {
+    /// \brief Whether the batch functions use SIMD instructions.
+    /// \return True if they do.
+    public: static bool Vectorized();
+
+    /// \brief Get the latitudes and longitudes of some waypoints, e.g. of
+    /// a lane, as contiguous arrays.
+    /// \param[in] _waypoints The waypoints.
+    /// \param[out] _latitudes Latitude of each waypoint.
+    /// \param[out] _longitudes Longitude of each waypoint.
+    public: static void Coordinates(
+      const std::vector<rndf::Waypoint> &_waypoints,
+      std::vector<double> &_latitudes, std::vector<double> &_longitudes);
+
+    /// \brief Distance between two locations.
+    /// \param[in] _latA Latitude of the first location.
+    /// \param[in] _lonA Longitude of the first location.
+    /// \param[in] _latB Latitude of the second location.
+    /// \param[in] _lonB Longitude of the second location.
+    /// \return The distance.
+    public: static double Distance(const double _latA, const double _lonA,
+                                   const double _latB, const double _lonB);
+
+    /// \brief Distances between consecutive locations, e.g. the length of
+    /// each piece of a lane.
+    /// \param[in] _latitudes The latitudes.
+    /// \param[in] _longitudes The longitudes.
+    /// \param[out] _distances Distance from each location to the next one
+    /// (one less than the number of locations, or none).
+    /// \return False if the arrays have different sizes.
+    public: static bool Consecutive(const std::vector<double> &_latitudes,
+                                    const std::vector<double> &_longitudes,
+                                    std::vector<double> &_distances);
+
+    /// \brief Distances from a location to many others.
+    /// \param[in] _latitude Latitude of the location.
+    /// \param[in] _longitude Longitude of the location.
+    /// \param[in] _latitudes Latitudes of the others.
+    /// \param[in] _longitudes Longitudes of the others.
+    /// \param[out] _distances Distance to each of the others.
+    /// \return False if the arrays have different sizes.
+    public: static bool OneToMany(const double _latitude,
+                                  const double _longitude,
+                                  const std::vector<double> &_latitudes,
+                                  const std::vector<double> &_longitudes,
+                                  std::vector<double> &_distances);
+
+    /// \brief Distances between all the pairs of two sets of locations.
+    /// \param[in] _latitudesA Latitudes of the first set.
+    /// \param[in] _longitudesA Longitudes of the first set.
+    /// \param[in] _latitudesB Latitudes of the second set.
+    /// \param[in] _longitudesB Longitudes of the second set.
+    /// \param[out] _distances Row-major matrix with the distance from each
+    /// location of the first set (row) to each of the second one (column).
+    /// \return False if the arrays of a set have different sizes.
+    public: static bool ManyToMany(const std::vector<double> &_latitudesA,
+                                   const std::vector<double> &_longitudesA,
+                                   const std::vector<double> &_latitudesB,
+                                   const std::vector<double> &_longitudesB,
+                                   std::vector<double> &_distances);
+  };
+}
+#endif
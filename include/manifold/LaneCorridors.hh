@@ -0,0 +1,148 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef MANIFOLD_LANECORRIDORS_HH_
+#define MANIFOLD_LANECORRIDORS_HH_
+
+#include <memory>
+#include <vector>
+#include <ignition/math/SphericalCoordinates.hh>
+#include <ignition/math/Vector3.hh>
+
+#include "manifold/Helpers.hh"
+
+namespace manifold
+{
+  namespace rndf
+  {
+    class RNDF;
+    class UniqueId;
+  }
+
+  // Forward declarations.
+  class LaneCorridorsPrivate;
+
+  /// \brief The drivable corridor of each lane of an RNDF, in a common
+  /// local east-north-up (ENU) frame, e.g. for the collision checks of a
+  /// planner.
+  ///
+  /// The corridor of a lane extends half its width to each side of the
+  /// centerline (12 feet wide if the lane has no width). The left and
+  /// right boundaries are offset from the waypoints along the bisector of
+  /// the pieces that meet there (mitered joins, limited to twice the half
+  /// width at sharp turns). Each piece of the corridor is split in two
+  /// triangles, and the bounding boxes of the triangles are hashed in a
+  /// uniform grid, so a query only tests the few triangles around it.
+  ///
+  /// Points are given in the ENU frame (see EnuProjection) and their up
+  /// coordinate is ignored. The corridors are a snapshot of the RNDF:
+  /// build new ones after modifying it. All the functions can be called
+  /// concurrently.
+  class MANIFOLD_VISIBLE LaneCorridors
+  {
+    /// \brief Constructor. The origin of the frame is the first waypoint of
+    /// the RNDF.
+    /// \param[in] _rndf The RNDF.
+    public: explicit LaneCorridors(const rndf::RNDF &_rndf);
+
+    /// \brief Constructor.
+    /// \param[in] _rndf The RNDF.
+    /// \param[in] _origin Origin of the ENU frame.
+    public: LaneCorridors(const rndf::RNDF &_rndf,
+      const ignition::math::SphericalCoordinates &_origin);
+
+    /// \brief Destructor.
+    public: virtual ~LaneCorridors();
+
+    /// \brief Get the origin of the ENU frame.
+    /// \return The origin.
+    public: const ignition::math::SphericalCoordinates &Origin() const;
+
+    /// \brief Get the number of lanes.
+    /// \return The number of lanes.
+    public: size_t NumLanes() const;
+
+    /// \brief Get the number of triangles of all the corridors.
+    /// \return The number of triangles.
+    public: size_t NumTriangles() const;
+
+    /// \brief Get the boundaries of the corridor of a lane.
+    /// \param[in] _id Unique Id of the lane or of any of its waypoints (the
+    /// waypoint Id is ignored).
+    /// \param[out] _left Left boundary, one point per waypoint (meters).
+    /// \param[out] _right Right boundary, one point per waypoint (meters).
+    /// \return False if the lane doesn't exist.
+    public: bool Boundaries(const rndf::UniqueId &_id,
+                            std::vector<ignition::math::Vector3d> &_left,
+                            std::vector<ignition::math::Vector3d> &_right)
+                            const;
+
+    /// \brief Get the triangles of the corridor of a lane.
+    /// \param[in] _id Unique Id of the lane or of any of its waypoints (the
+    /// waypoint Id is ignored).
+    /// \param[out] _vertices Three vertices per triangle (meters).
+    /// \return False if the lane doesn't exist.
+    public: bool Triangles(const rndf::UniqueId &_id,
+                           std::vector<ignition::math::Vector3d> &_vertices)
+                           const;
+
+    /// \brief Find the lanes whose corridor contains a point.
+    /// \param[in] _point The point (meters).
+    /// \param[out] _lanes One Unique Id per lane: the one of the first
+    /// waypoint of the piece of the lane that contains the point, in the
+    /// order of the lanes in the RNDF.
+    /// \return The number of lanes.
+    public: size_t LanesAt(const ignition::math::Vector3d &_point,
+                           std::vector<rndf::UniqueId> &_lanes) const;
+
+    /// \brief Whether the corridor of a lane contains a point.
+    /// \param[in] _id Unique Id of the lane or of any of its waypoints (the
+    /// waypoint Id is ignored).
+    /// \param[in] _point The point (meters).
+    /// \return True if it does, false otherwise or if the lane doesn't
+    /// exist.
+    public: bool InLane(const rndf::UniqueId &_id,
+                        const ignition::math::Vector3d &_point) const;
+
+    /// \brief Find the lanes whose corridor intersects a segment.
+    /// \param[in] _start Start of the segment (meters).
+    /// \param[in] _end End of the segment (meters).
+    /// \param[out] _lanes One Unique Id per lane: the one of the first
+    /// waypoint of the first piece of the lane intersected, in the order
+    /// of the lanes in the RNDF.
+    /// \return The number of lanes.
+    public: size_t LanesCrossed(const ignition::math::Vector3d &_start,
+                                const ignition::math::Vector3d &_end,
+                                std::vector<rndf::UniqueId> &_lanes) const;
+
+    /// \brief Whether a segment intersects the corridor of a lane.
+    /// \param[in] _id Unique Id of the lane or of any of its waypoints (the
+    /// waypoint Id is ignored).
+    /// \param[in] _start Start of the segment (meters).
+    /// \param[in] _end End of the segment (meters).
+    /// \return True if it does, false otherwise or if the lane doesn't
+    /// exist.
+    public: bool Crosses(const rndf::UniqueId &_id,
+                         const ignition::math::Vector3d &_start,
+                         const ignition::math::Vector3d &_end) const;
+
+    /// \internal
+    /// \brief Smart pointer to private data.
+    private: std::unique_ptr<LaneCorridorsPrivate> dataPtr;
+  };
+}
+#endif
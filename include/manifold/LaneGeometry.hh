@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef MANIFOLD_LANEGEOMETRY_HH_
+#define MANIFOLD_LANEGEOMETRY_HH_
+
+#include <memory>
+#include <vector>
+#include <ignition/math/SphericalCoordinates.hh>
+#include <ignition/math/Vector3.hh>
+
+#include "manifold/Helpers.hh"
+
+namespace manifold
+{
+  namespace rndf
+  {
+    class Lane;
+    class RNDF;
+    class UniqueId;
+  }
+
+  // Forward declarations.
+  class LaneGeometryPrivate;
+  class LaneGeometryCachePrivate;
+
+  /// \brief The centerline of a lane in a local east-north-up (ENU) frame,
+  /// parameterized by arc length (the station), e.g. for the controllers
+  /// that need the point some distance ahead along the lane.
+  ///
+  /// The waypoints are converted once to the frame (WGS84 ellipsoid). The
+  /// station of each waypoint, the heading of each piece between
+  /// waypoints and a smoothed curvature are stored, so the queries run in
+  /// O(log n) and don't allocate memory. The up coordinate is ignored:
+  /// all the points returned are on the horizontal plane (z = 0).
+  class MANIFOLD_VISIBLE LaneGeometry
+  {
+    /// \brief Constructor.
+    /// \param[in] _lane The lane.
+    /// \param[in] _origin Origin of the ENU frame.
+    public: LaneGeometry(const rndf::Lane &_lane,
+                         const ignition::math::SphericalCoordinates &_origin);
+
+    /// \brief Constructor from points already in an ENU frame, e.g. the
+    /// waypoints of a route across several lanes.
+    /// \param[in] _points The points (meters). The up coordinate is
+    /// ignored.
+    public: explicit LaneGeometry(
+      const std::vector<ignition::math::Vector3d> &_points);
+
+    /// \brief Destructor.
+    public: virtual ~LaneGeometry();
+
+    /// \brief Get the number of waypoints.
+    /// \return The number of waypoints.
+    public: size_t NumPoints() const;
+
+    /// \brief Get the position of a waypoint.
+    /// \param[in] _index Index of the waypoint in Lane::Waypoints().
+    /// \return The position in the ENU frame (meters).
+    public: const ignition::math::Vector3d &Point(const size_t _index) const;
+
+    /// \brief Get the station of a waypoint.
+    /// \param[in] _index Index of the waypoint in Lane::Waypoints().
+    /// \return The arc length from the first waypoint (meters).
+    public: double Station(const size_t _index) const;
+
+    /// \brief Get the index of a waypoint.
+    /// \param[in] _waypointId Id of the waypoint in the lane.
+    /// \param[out] _index Index of the waypoint in Lane::Waypoints().
+    /// \return True if the waypoint was found or false otherwise, always
+    /// if the geometry was built from points.
+    public: bool Index(const int _waypointId, size_t &_index) const;
+
+    /// \brief Get the length of the centerline.
+    /// \return The length (meters).
+    public: double Length() const;
+
+    /// \brief Get the index of the piece of centerline at a station, from
+    /// the waypoint with that index to the next one.
+    /// \param[in] _s The station (meters), clamped to [0, Length()].
+    /// \return The index of the piece, or 0 if there are fewer than two
+    /// waypoints.
+    public: size_t PieceAt(const double _s) const;
+
+    /// \brief Get the point of the centerline at a station.
+    /// \param[in] _s The station (meters), clamped to [0, Length()].
+    /// \return The point in the ENU frame (meters).
+    public: ignition::math::Vector3d PointAt(const double _s) const;
+
+    /// \brief Get the heading of the centerline at a station.
+    /// \param[in] _s The station (meters), clamped to [0, Length()].
+    /// \return The heading (radians), counterclockwise from east.
+    public: double HeadingAt(const double _s) const;
+
+    /// \brief Get the curvature of the centerline at a station, estimated
+    /// from the turn at each waypoint, smoothed over its neighbors and
+    /// interpolated between them.
+    /// \param[in] _s The station (meters), clamped to [0, Length()].
+    /// \return The curvature (1/meters), positive when turning left.
+    public: double CurvatureAt(const double _s) const;
+
+    /// \brief Project a point on the centerline.
+    /// \param[in] _point The point in the ENU frame (meters).
+    /// \param[out] _offset Signed distance from the centerline to the
+    /// point (meters), positive to the left.
+    /// \return The station of the closest point of the centerline.
+    public: double Project(const ignition::math::Vector3d &_point,
+                           double &_offset) const;
+
+    /// \internal
+    /// \brief Smart pointer to private data.
+    private: std::unique_ptr<LaneGeometryPrivate> dataPtr;
+  };
+
+  /// \brief The geometry of all the lanes of an RNDF in a common ENU frame.
+  /// The geometry of a lane is built on its first access and then shared
+  /// by all the threads.
+  ///
+  /// The RNDF must outlive the cache and must not be modified while it's
+  /// in use. All the functions can be called concurrently.
+  class MANIFOLD_VISIBLE LaneGeometryCache
+  {
+    /// \brief Constructor. The origin of the frame is the first waypoint of
+    /// the RNDF.
+    /// \param[in] _rndf The RNDF.
+    public: explicit LaneGeometryCache(const rndf::RNDF &_rndf);
+
+    /// \brief Constructor.
+    /// \param[in] _rndf The RNDF.
+    /// \param[in] _origin Origin of the ENU frame.
+    public: LaneGeometryCache(const rndf::RNDF &_rndf,
+      const ignition::math::SphericalCoordinates &_origin);
+
+    /// \brief Destructor.
+    public: virtual ~LaneGeometryCache();
+
+    /// \brief Get the origin of the ENU frame.
+    /// \return The origin.
+    public: const ignition::math::SphericalCoordinates &Origin() const;
+
+    /// \brief Get the geometry of a lane, building it if needed.
+    /// \param[in] _id Unique Id of the lane or of any of its waypoints (the
+    /// waypoint Id is ignored).
+    /// \return The geometry, valid while the cache exists, or nullptr if
+    /// the lane doesn't exist.
+    public: const LaneGeometry *Lane(const rndf::UniqueId &_id) const;
+
+    /// \brief Get the number of lanes whose geometry has been built.
+    /// \return The number of lanes.
+    public: size_t NumBuilt() const;
+
+    /// \internal
+    /// \brief Smart pointer to private data.
+    private: std::unique_ptr<LaneGeometryCachePrivate> dataPtr;
+  };
+}
+#endif
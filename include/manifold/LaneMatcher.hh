@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef MANIFOLD_LANEMATCHER_HH_
+#define MANIFOLD_LANEMATCHER_HH_
+
+#include <memory>
+#include <vector>
+#include <ignition/math/SphericalCoordinates.hh>
+
+#include "manifold/Helpers.hh"
+#include "manifold/rndf/UniqueId.hh"
+
+namespace manifold
+{
+  namespace rndf
+  {
+    class RNDF;
+  }
+
+  // Forward declarations.
+  class LaneMatcherPrivate;
+
+  /// \brief The projection of a location on the centerline of a lane.
+  class MANIFOLD_VISIBLE LaneMatch
+  {
+    /// \brief Unique Id of the first waypoint of the piece of centerline
+    /// where the location projects. Its segment and lane Ids are the ones of
+    /// the lane matched.
+    public: rndf::UniqueId waypoint;
+
+    /// \brief Index of that waypoint in Lane::Waypoints().
+    public: size_t index = 0;
+
+    /// \brief Signed distance from the line of the piece to the location
+    /// (meters), positive to the left of the direction of travel.
+    public: double offset = 0;
+
+    /// \brief Distance from the centerline to the location (meters). It's
+    /// larger than the offset if the location is beyond an end of the lane.
+    public: double distance = 0;
+
+    /// \brief Arc length along the lane from its first waypoint to the
+    /// projection of the location (meters).
+    public: double progress = 0;
+  };
+
+  /// \brief Map-matching of locations to the centerlines of the lanes of an
+  /// RNDF, the polylines through the consecutive waypoints of each lane.
+  /// Waypoints can be hundreds of meters apart, so snapping to the closest
+  /// waypoint is too coarse to know where a vehicle is along a lane.
+  ///
+  /// The pieces of the centerlines are hashed in a uniform grid by their
+  /// bounding boxes, so a query only tests the pieces near the location.
+  /// Each candidate is projected on a plane tangent to the Earth at the
+  /// location, and the arc length uses the great-circle distances between
+  /// waypoints, as the edge costs of RoadNetwork.
+  ///
+  /// The matcher is a snapshot of the RNDF: build a new one after modifying
+  /// it. All the functions can be called concurrently.
+  class MANIFOLD_VISIBLE LaneMatcher
+  {
+    /// \brief Constructor.
+    /// \param[in] _rndf The RNDF.
+    public: explicit LaneMatcher(const rndf::RNDF &_rndf);
+
+    /// \brief Destructor.
+    public: virtual ~LaneMatcher();
+
+    /// \brief Get the number of pieces of centerline indexed.
+    /// \return The number of pieces.
+    public: size_t Size() const;
+
+    /// \brief Match a location to the closest lane centerline.
+    /// \param[in] _location The location.
+    /// \param[out] _match The projection on the closest centerline.
+    /// \param[in] _maxDistance Maximum distance to the centerline (meters).
+    /// \return True if a lane was found within _maxDistance or false
+    /// otherwise.
+    public: bool Match(const ignition::math::SphericalCoordinates &_location,
+                       LaneMatch &_match,
+                       const double _maxDistance = 50.0) const;
+
+    /// \brief Match a batch of locations to the closest lane centerlines.
+    /// \param[in] _locations The locations.
+    /// \param[out] _matches The projection of each location. The waypoint
+    /// Id is invalid for the locations without a lane within _maxDistance.
+    /// \param[in] _maxDistance Maximum distance to the centerline (meters).
+    /// \param[in] _threads Number of worker threads. A value of 0 uses one
+    /// thread per hardware thread available.
+    /// \return The number of locations matched.
+    /// \sa Match
+    public: size_t Match(
+      const std::vector<ignition::math::SphericalCoordinates> &_locations,
+      std::vector<LaneMatch> &_matches,
+      const double _maxDistance = 50.0,
+      const unsigned int _threads = 0) const;
+
+    /// \brief Get the projections of a location on all the lanes within a
+    /// distance, e.g. the candidate states of a map-matcher.
+    /// \param[in] _location The location.
+    /// \param[in] _radius Maximum distance to the centerline (meters).
+    /// \param[out] _candidates The projection on the closest piece of each
+    /// lane found, in increasing order of distance.
+    public: void Candidates(
+      const ignition::math::SphericalCoordinates &_location,
+      const double _radius, std::vector<LaneMatch> &_candidates) const;
+
+    /// \internal
+    /// \brief Smart pointer to private data.
+    private: std::unique_ptr<LaneMatcherPrivate> dataPtr;
+  };
+}
+#endif
@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef MANIFOLD_MISSION_HH_
+#define MANIFOLD_MISSION_HH_
+
+#include <memory>
+#include <vector>
+
+#include "manifold/Helpers.hh"
+
+namespace manifold
+{
+  namespace rndf
+  {
+    class RNDF;
+    class UniqueId;
+  }
+
+  // Forward declarations.
+  class MissionPrivate;
+  class RoadNetwork;
+
+  /// \brief A compiled mission: a sequence of checkpoints to visit and the
+  /// precomputed route that visits them. Compile() resolves every checkpoint
+  /// Id to its waypoint using the checkpoint tables of the lanes and parking
+  /// spots, computes the route between consecutive checkpoints and caches
+  /// the concatenated route and the cost of each leg, so the planner doesn't
+  /// need to route again at runtime.
+  class MANIFOLD_VISIBLE Mission
+  {
+    /// \brief Default constructor. The mission is empty until Compile() is
+    /// called.
+    public: Mission();
+
+    /// \brief Destructor.
+    public: virtual ~Mission();
+
+    /// \brief Compile a mission.
+    /// \param[in] _rndf The RNDF containing the checkpoints.
+    /// \param[in] _network The road network built from _rndf.
+    /// \param[in] _checkpoints Sequence of checkpoint Ids to visit.
+    /// \param[in] _reorder When false, the checkpoints are visited in the
+    /// order given. When true, _checkpoints is treated as an unordered set
+    /// (except its first element, which is always the start) and the visit
+    /// order is chosen with a nearest neighbor tour improved with 2-opt and
+    /// or-opt moves.
+    /// \return True if the mission was compiled or false otherwise (e.g.: if
+    /// a checkpoint Id is unknown or a checkpoint can't be reached from the
+    /// previous one). On failure the mission is left empty.
+    public: bool Compile(const rndf::RNDF &_rndf,
+                         const RoadNetwork &_network,
+                         const std::vector<int> &_checkpoints,
+                         const bool _reorder = false);
+
+    /// \brief Whether the mission has been successfully compiled.
+    /// \return True if the mission is compiled.
+    public: bool Valid() const;
+
+    /// \brief Get the checkpoint Ids in visit order.
+    /// \return The checkpoint Ids. If the mission was compiled with
+    /// reordering enabled, this is the order selected.
+    public: const std::vector<int> &Checkpoints() const;
+
+    /// \brief Get the waypoint associated to each checkpoint, in visit order.
+    /// \return The unique Ids of the checkpoint waypoints.
+    public: const std::vector<rndf::UniqueId> &Waypoints() const;
+
+    /// \brief Get the full route of the mission: the concatenation of all
+    /// the legs, without repeating the waypoints shared by consecutive legs.
+    /// \return The unique Ids of the waypoints along the route.
+    public: const std::vector<rndf::UniqueId> &Route() const;
+
+    /// \brief Get the number of legs (one less than the number of
+    /// checkpoints).
+    /// \return The number of legs.
+    public: size_t NumLegs() const;
+
+    /// \brief Get the cost of each leg.
+    /// \return The cost of each leg, where the leg i goes from the checkpoint
+    /// i to the checkpoint i + 1.
+    public: const std::vector<double> &LegCosts() const;
+
+    /// \brief Get the route of a leg.
+    /// \param[in] _leg Leg index.
+    /// \param[out] _route Unique Ids of the waypoints along the leg, both
+    /// checkpoints included.
+    /// \return True if the leg exists or false otherwise.
+    public: bool Leg(const size_t _leg,
+                     std::vector<rndf::UniqueId> &_route) const;
+
+    /// \brief Get the total cost of the mission.
+    /// \return The sum of the costs of all the legs.
+    public: double Cost() const;
+
+    /// \brief Find the waypoint associated to a checkpoint Id.
+    /// \param[in] _rndf The RNDF containing the checkpoints.
+    /// \param[in] _checkpointId The checkpoint Id.
+    /// \param[out] _waypoint The unique Id of the checkpoint waypoint.
+    /// \return True if the checkpoint was found or false otherwise.
+    public: static bool CheckpointWaypoint(const rndf::RNDF &_rndf,
+                                           const int _checkpointId,
+                                           rndf::UniqueId &_waypoint);
+
+    /// \internal
+    /// \brief Smart pointer to private data.
+    private: std::unique_ptr<MissionPrivate> dataPtr;
+  };
+}
+#endif
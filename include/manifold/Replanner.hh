@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef MANIFOLD_REPLANNER_HH_
+#define MANIFOLD_REPLANNER_HH_
+
+#include <memory>
+#include <vector>
+
+#include "manifold/Helpers.hh"
+
+namespace manifold
+{
+  namespace rndf
+  {
+    class UniqueId;
+  }
+
+  // Forward declarations.
+  class ReplannerPrivate;
+  class RoadNetwork;
+
+  /// \brief Incremental route planner for a vehicle driving towards a goal
+  /// while closures and penalties are discovered at runtime (see
+  /// RoadNetwork::CloseEdge()). It implements D* Lite: the search runs
+  /// backwards from the goal and keeps its state between calls, so after a
+  /// few edge cost changes Replan() only revisits the vertexes whose cost
+  /// to the goal is affected, and the vehicle can move along the route
+  /// without restarting the search.
+  ///
+  /// The network must outlive the replanner. If segments, zones or exits
+  /// are added or removed from the network, the next call to Replan()
+  /// searches from scratch.
+  class MANIFOLD_VISIBLE Replanner
+  {
+    /// \brief Constructor.
+    /// \param[in] _network The road network.
+    public: explicit Replanner(const RoadNetwork &_network);
+
+    /// \brief Destructor.
+    public: virtual ~Replanner();
+
+    /// \brief Plan a route from scratch.
+    /// \param[in] _start Unique Id of the current waypoint of the vehicle.
+    /// \param[in] _goal Unique Id of the destination waypoint.
+    /// \return True if a route was found or false otherwise (e.g.: if any
+    /// of the waypoints is not part of the network or _goal isn't
+    /// reachable).
+    public: bool Plan(const rndf::UniqueId &_start,
+                      const rndf::UniqueId &_goal);
+
+    /// \brief Update the position of the vehicle. The route is updated in the
+    /// next call to Replan().
+    /// \param[in] _waypoint Unique Id of the current waypoint of the vehicle.
+    /// \return True if the waypoint is part of the network and a plan has
+    /// been requested with Plan().
+    public: bool MoveTo(const rndf::UniqueId &_waypoint);
+
+    /// \brief Repair the route after the closures and penalties changed in
+    /// the network since the last call to Plan() or Replan().
+    /// \return True if a route was found or false otherwise.
+    public: bool Replan();
+
+    /// \brief Get the current route.
+    /// \return Unique Ids of the waypoints along the route, from the
+    /// current position of the vehicle to the goal (both included). Empty
+    /// if there's no route.
+    public: const std::vector<rndf::UniqueId> &Route() const;
+
+    /// \brief Get the cost of the current route.
+    /// \return The cost or infinity if there's no route.
+    public: double Cost() const;
+
+    /// \brief Get the number of vertexes expanded by the last call to Plan()
+    /// or Replan(). Useful to measure the size of the region repaired.
+    /// \return The number of vertex expansions.
+    public: size_t Expansions() const;
+
+    /// \internal
+    /// \brief Smart pointer to private data.
+    private: std::unique_ptr<ReplannerPrivate> dataPtr;
+  };
+}
+#endif
@@ -20,36 +20,88 @@
 
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 #include <ignition/math/Graph.hh>
 
 #include "manifold/Helpers.hh"
+#include "manifold/RoadNetworkOptions.hh"
 
 namespace manifold
 {
   namespace rndf
   {
+    class Exit;
     class RNDF;
+    class Segment;
+    class UniqueId;
+    class Zone;
   }
 
   // Forward declarations.
+  class Replanner;
   class RoadNetworkPrivate;
+  class RouteCache;
+  class TiledMap;
 
   /// \brief A class that stores an RNDF object preserving its topological
-  /// information. You can use the Graph() method to get access to a graph
-  /// where all nodes are the waypoints of the RNDF object.
+  /// information. You can use the Graph() method to get a read-only view of
+  /// a graph where all nodes are the waypoints of the RNDF object.
+  /// The network can be updated incrementally when the RNDF is edited (see
+  /// AddSegment(), RemoveZone(), etc.), without rebuilding it.
   class MANIFOLD_VISIBLE RoadNetwork
   {
     /// \brief Constructor.
-    public: explicit RoadNetwork(const rndf::RNDF &_rndf);
+    /// \param[in] _rndf The RNDF used to populate the graph.
+    /// \param[in] _options Options to customize the graph.
+    public: explicit RoadNetwork(const rndf::RNDF &_rndf,
+                const RoadNetworkOptions &_options = RoadNetworkOptions());
+
+    /// \brief Constructor that reuses a network saved in a file. If the
+    /// file was saved from the same RNDF content with the same options, the
+    /// network is loaded from it, which is much faster than building it.
+    /// Otherwise (e.g.: the file doesn't exist or the RNDF has been edited)
+    /// the network is built from _rndf and saved to the file for the next
+    /// time.
+    /// \param[in] _rndf The RNDF used to populate the graph.
+    /// \param[in] _cachePath Path of the binary file.
+    /// \param[in] _options Options to customize the graph.
+    /// \sa Save
+    public: RoadNetwork(const rndf::RNDF &_rndf,
+                        const std::string &_cachePath,
+                        const RoadNetworkOptions &_options =
+                          RoadNetworkOptions());
 
     /// \brief Destructor.
     public: virtual ~RoadNetwork();
 
-    /// \brief Get a mutable reference to the graph of road segments.
-    /// \return A mutable reference to the graph of road segments.
-    public: ignition::math::DirectedGraph<std::string, int> &Graph();
+    /// \brief Save the network to a compact binary file, including its
+    /// strongly connected components. The file is keyed by a hash of the
+    /// content of the RNDF and the options, so it's only loaded back with
+    /// the same RNDF. Closures and penalties aren't saved.
+    /// \param[in] _path Path of the file.
+    /// \param[in] _rndf The RNDF that the network reflects (including the
+    /// edits applied incrementally, if any).
+    /// \return True if the file was written.
+    public: bool Save(const std::string &_path,
+                      const rndf::RNDF &_rndf) const;
+
+    /// \brief Check whether a file saved with Save() can be loaded for a
+    /// given RNDF and options.
+    /// \param[in] _path Path of the file.
+    /// \param[in] _rndf The RNDF.
+    /// \param[in] _options Options to customize the graph.
+    /// \return True if the file exists and matches the content of _rndf,
+    /// the options and the current file format.
+    public: static bool UpToDate(const std::string &_path,
+                                 const rndf::RNDF &_rndf,
+                                 const RoadNetworkOptions &_options =
+                                   RoadNetworkOptions());
 
-    /// \brief Get a reference to the graph of road segments.
+    /// \brief Get a read-only view of the graph of road segments. It
+    /// mirrors the routing graph and it's rebuilt when the network changes,
+    /// so it can't be edited: use AddSegment(), AddExit(), CloseEdge(),
+    /// etc. instead.
     /// \return The reference to the graph of road segments.
     public: const ignition::math::DirectedGraph<std::string, int> &Graph()
       const;
@@ -59,6 +111,308 @@ namespace manifold
     /// \return The type of road file loaded (e.g.: rndf, opendrive).
     public: std::string RoadType() const;
 
+    /// \brief Get the options used to build the graph.
+    /// \return The options.
+    public: const RoadNetworkOptions &Options() const;
+
+    /// \brief Compute the shortest route between two waypoints. The cost of
+    /// an edge is the great-circle distance (meters) between its waypoints
+    /// plus its penalty, if any. Closed edges are not used.
+    /// \param[in] _src Unique Id of the origin waypoint.
+    /// \param[in] _dst Unique Id of the destination waypoint.
+    /// \param[out] _path Unique Ids of the waypoints along the route, from
+    /// _src to _dst (both included).
+    /// \param[out] _cost Cost of the route.
+    /// \return True if a route was found or false otherwise (e.g.: if any of
+    /// the waypoints is not part of the network or _dst is not reachable from
+    /// _src).
+    public: bool ShortestPath(const rndf::UniqueId &_src,
+                              const rndf::UniqueId &_dst,
+                              std::vector<rndf::UniqueId> &_path,
+                              double &_cost) const;
+
+    /// \brief Compute the shortest routes of a batch of independent queries
+    /// (e.g.: replaying the trips of a simulation). The queries are spread
+    /// across worker threads with work stealing and each worker reuses its
+    /// own search workspace over the shared graph.
+    /// \param[in] _queries Unique Ids of the origin and destination
+    /// waypoints of each query.
+    /// \param[out] _costs Cost of the route of each query or infinity if
+    /// the destination is not reachable from the origin.
+    /// \param[out] _paths Unique Ids of the waypoints along the route of
+    /// each query (empty if there's no route).
+    /// \param[in] _threads Number of worker threads. A value of 0 uses one
+    /// thread per hardware thread available.
+    /// \return True if the routes were computed or false otherwise (e.g.: if
+    /// any of the waypoints is not part of the network).
+    public: bool ShortestPaths(
+      const std::vector<std::pair<rndf::UniqueId, rndf::UniqueId>> &_queries,
+      std::vector<double> &_costs,
+      std::vector<std::vector<rndf::UniqueId>> &_paths,
+      const unsigned int _threads = 0) const;
+
+    /// \brief Compute the cost of the shortest route of a batch of
+    /// independent queries, without reconstructing the routes.
+    /// \param[in] _queries Unique Ids of the origin and destination
+    /// waypoints of each query.
+    /// \param[out] _costs Cost of the route of each query or infinity if
+    /// the destination is not reachable from the origin.
+    /// \param[in] _threads Number of worker threads. A value of 0 uses one
+    /// thread per hardware thread available.
+    /// \return True if the costs were computed or false otherwise.
+    /// \sa ShortestPaths
+    public: bool ShortestPaths(
+      const std::vector<std::pair<rndf::UniqueId, rndf::UniqueId>> &_queries,
+      std::vector<double> &_costs,
+      const unsigned int _threads = 0) const;
+
+    /// \brief Compute up to _k loopless alternative routes between two
+    /// waypoints, in increasing order of cost. The first one is the
+    /// shortest route. The search state is shared by all the routes, so
+    /// asking for a few alternatives costs a small multiple of a single
+    /// ShortestPath() query.
+    /// \param[in] _src Unique Id of the origin waypoint.
+    /// \param[in] _dst Unique Id of the destination waypoint.
+    /// \param[in] _k Maximum number of routes.
+    /// \param[out] _paths Unique Ids of the waypoints along each route, from
+    /// _src to _dst (both included).
+    /// \param[out] _costs Cost of each route.
+    /// \param[in] _maxOverlap Maximum fraction of the cost of a route that
+    /// can be shared with a cheaper route returned, in [0, 1]. Routes that
+    /// overlap more are skipped, so fewer than _k routes might be returned
+    /// even if more exist. A value of 1 returns the _k shortest routes.
+    /// \return True if at least one route was found or false otherwise.
+    /// \sa ShortestPath
+    public: bool AlternativePaths(const rndf::UniqueId &_src,
+      const rndf::UniqueId &_dst, const unsigned int _k,
+      std::vector<std::vector<rndf::UniqueId>> &_paths,
+      std::vector<double> &_costs, const double _maxOverlap = 1.0) const;
+
+    /// \brief Get all the waypoints that can be reached from a waypoint
+    /// within a cost budget, e.g. to find the parking spots near a vehicle.
+    /// Queries on the same thread reuse the search state, so they don't
+    /// allocate memory once it has grown to the size of the network.
+    /// \param[in] _src Unique Id of the origin waypoint.
+    /// \param[in] _budget Maximum cost of the routes (meters plus
+    /// penalties, see ShortestPath()).
+    /// \param[out] _reached Unique Id of each waypoint reached, including
+    /// _src, and the cost of its shortest route, in increasing order of
+    /// cost.
+    /// \return True if the search was run or false if _src is not part of
+    /// the network or the budget is negative.
+    public: bool WithinCost(const rndf::UniqueId &_src, const double _budget,
+      std::vector<std::pair<rndf::UniqueId, double>> &_reached) const;
+
+    /// \brief Compute the cost of the shortest route from every source to
+    /// every target. One one-to-many search is run per source and the
+    /// searches are spread across worker threads with work stealing.
+    /// Only the costs are stored; use ShortestPath() to reconstruct the route
+    /// of any pair on demand.
+    /// \param[in] _sources Unique Ids of the origin waypoints.
+    /// \param[in] _targets Unique Ids of the destination waypoints.
+    /// \param[out] _costs Dense row-major matrix with _sources.size() rows
+    /// and _targets.size() columns. The element
+    /// [i * _targets.size() + j] is the cost from _sources[i] to _targets[j]
+    /// or infinity if _targets[j] is not reachable from _sources[i].
+    /// \param[in] _threads Number of worker threads. A value of 0 uses one
+    /// thread per hardware thread available.
+    /// \return True if the matrix was computed or false otherwise (e.g.: if
+    /// any of the waypoints is not part of the network).
+    public: bool CostMatrix(const std::vector<rndf::UniqueId> &_sources,
+                            const std::vector<rndf::UniqueId> &_targets,
+                            std::vector<double> &_costs,
+                            const unsigned int _threads = 0) const;
+
+    /// \brief Get the waypoints with an edge leading to a waypoint (e.g.:
+    /// the lanes feeding a stop line). An index of the incoming edges is kept
+    /// up to date with every change in the network, so the cost is
+    /// proportional to the number of predecessors instead of the number of
+    /// edges. Zone points are reported as predecessors of each other,
+    /// regardless of the ZoneModel used. Closures and penalties are ignored.
+    /// \param[in] _id Unique Id of the waypoint.
+    /// \param[out] _predecessors Unique Ids of the predecessors, sorted and
+    /// without duplicates.
+    /// \return True if the waypoint is part of the network.
+    public: bool Predecessors(const rndf::UniqueId &_id,
+                              std::vector<rndf::UniqueId> &_predecessors)
+      const;
+
+    /// \brief Check whether a waypoint can be reached from another one. The
+    /// strongly connected components of the graph and the reachability
+    /// between them are precomputed, so the query takes constant time.
+    /// Closures and penalties are ignored: if this function returns false
+    /// there's no route, but a route might not exist when it returns true if
+    /// some edges are closed.
+    /// \param[in] _src Unique Id of the origin waypoint.
+    /// \param[in] _dst Unique Id of the destination waypoint.
+    /// \return True if _dst can be reached from _src or false otherwise
+    /// (or if any of the waypoints is not part of the network).
+    public: bool Reachable(const rndf::UniqueId &_src,
+                           const rndf::UniqueId &_dst) const;
+
+    /// \brief Get the number of strongly connected components of the graph.
+    /// A network where every waypoint can be reached from any other has a
+    /// single component.
+    /// \return The number of components.
+    public: unsigned int NumComponents() const;
+
+    /// \brief Get the strongly connected component of a waypoint. Components
+    /// are numbered in reverse topological order of the condensed graph: a
+    /// component can only reach components with a lower number.
+    /// \param[in] _id Unique Id of the waypoint.
+    /// \param[out] _component The component.
+    /// \return True if the waypoint is part of the network.
+    public: bool Component(const rndf::UniqueId &_id,
+                           unsigned int &_component) const;
+
+    /// \brief Find the waypoints that aren't properly connected to the rest
+    /// of the network, defined as the strongly connected component with
+    /// more waypoints.
+    /// \param[out] _deadEnds Waypoints from which the rest of the network
+    /// can't be reached (e.g.: an exit into a lane that has no way back).
+    /// \param[out] _unreachable Waypoints that can't be reached from the
+    /// rest of the network.
+    public: void ConnectivityReport(std::vector<rndf::UniqueId> &_deadEnds,
+                                   std::vector<rndf::UniqueId> &_unreachable)
+      const;
+
+    /// \brief Get the number of intersections. An intersection is a group
+    /// of exits that leave from the same waypoint (e.g.: a stop) or enter
+    /// the same waypoint, directly or through other exits of the group.
+    /// \return The number of intersections.
+    public: unsigned int NumIntersections() const;
+
+    /// \brief Get the turn made by an exit. The turns are precomputed, and
+    /// with RoadNetworkOptions::TurnCosts() enabled their stop and turn
+    /// penalties are part of the cost of the exit.
+    /// \param[in] _exit Unique Id of the exit waypoint.
+    /// \param[in] _entry Unique Id of the entry waypoint.
+    /// \param[out] _angle Heading change from the lane left to the lane
+    /// entered (radians, in [-pi, pi]). Positive to the left.
+    /// \param[out] _stop Whether the exit waypoint is a stop.
+    /// \param[out] _intersection Intersection of the exit, in
+    /// [0, NumIntersections()).
+    /// \return True if the exit is part of the network.
+    public: bool Turn(const rndf::UniqueId &_exit,
+                      const rndf::UniqueId &_entry,
+                      double &_angle, bool &_stop,
+                      unsigned int &_intersection) const;
+
+    /// \brief Add the waypoints of a new segment, the edges along its lanes
+    /// and the exits of its lanes. Exits from other segments or zones that
+    /// were waiting for the waypoints of this segment are connected too.
+    /// Only the new segment is processed, the rest of the graph is untouched.
+    /// \param[in] _segment The segment.
+    /// \return True if the segment was added or false if a segment with the
+    /// same Id is already part of the network.
+    public: bool AddSegment(const rndf::Segment &_segment);
+
+    /// \brief Remove all the waypoints of a segment and their edges. The
+    /// exits from other segments or zones into the removed segment are kept
+    /// pending and are reconnected if the segment is added again.
+    /// \param[in] _segmentId The segment Id.
+    /// \return True if the segment was removed or false if it isn't part of
+    /// the network.
+    public: bool RemoveSegment(const int _segmentId);
+
+    /// \brief Replace a segment with a new version of it (e.g.: after
+    /// editing its lanes or exits).
+    /// \param[in] _segment The new version of the segment.
+    /// \return True if the segment was updated or false if it isn't part of
+    /// the network.
+    public: bool UpdateSegment(const rndf::Segment &_segment);
+
+    /// \brief Add a new zone: its perimeter points, its parking spots, the
+    /// edges that allow the traversal of the zone and its perimeter exits.
+    /// \param[in] _zone The zone.
+    /// \return True if the zone was added or false if a zone with the same
+    /// Id is already part of the network.
+    /// \sa AddSegment
+    public: bool AddZone(const rndf::Zone &_zone);
+
+    /// \brief Remove all the vertexes of a zone and their edges.
+    /// \param[in] _zoneId The zone Id.
+    /// \return True if the zone was removed or false if it isn't part of
+    /// the network.
+    /// \sa RemoveSegment
+    public: bool RemoveZone(const int _zoneId);
+
+    /// \brief Replace a zone with a new version of it.
+    /// \param[in] _zone The new version of the zone.
+    /// \return True if the zone was updated or false if it isn't part of
+    /// the network.
+    public: bool UpdateZone(const rndf::Zone &_zone);
+
+    /// \brief Add an exit. If any of its waypoints isn't part of the
+    /// network yet, the exit is connected once the waypoint is added.
+    /// \param[in] _exit The exit.
+    /// \return True if the exit was added or false if it isn't valid.
+    public: bool AddExit(const rndf::Exit &_exit);
+
+    /// \brief Remove an exit.
+    /// \param[in] _exit The exit.
+    /// \return True if the exit was removed or false if it wasn't found.
+    public: bool RemoveExit(const rndf::Exit &_exit);
+
+    /// \brief Close an edge (e.g.: a lane blocked at runtime). Closures and
+    /// penalties are an overlay: the base cost of the edge is kept and the
+    /// edge can be opened again with OpenEdge(). Routing queries and
+    /// replanners skip closed edges.
+    /// \param[in] _tail Unique Id of the tail waypoint.
+    /// \param[in] _head Unique Id of the head waypoint.
+    /// \return True if the edge was closed or false if it doesn't exist.
+    /// \sa Replanner
+    public: bool CloseEdge(const rndf::UniqueId &_tail,
+                           const rndf::UniqueId &_head);
+
+    /// \brief Add a penalty to the base cost of an edge (e.g.: a congested
+    /// lane). It replaces any previous penalty or closure of the edge.
+    /// \param[in] _tail Unique Id of the tail waypoint.
+    /// \param[in] _head Unique Id of the head waypoint.
+    /// \param[in] _penalty Extra cost (meters). It must be non-negative.
+    /// \return True if the penalty was set or false if the edge doesn't
+    /// exist or the penalty is negative.
+    public: bool SetEdgePenalty(const rndf::UniqueId &_tail,
+                                const rndf::UniqueId &_head,
+                                const double _penalty);
+
+    /// \brief Remove the closure or penalty of an edge.
+    /// \param[in] _tail Unique Id of the tail waypoint.
+    /// \param[in] _head Unique Id of the head waypoint.
+    /// \return True if the edge exists.
+    public: bool OpenEdge(const rndf::UniqueId &_tail,
+                          const rndf::UniqueId &_head);
+
+    /// \brief Remove all the closures and penalties.
+    public: void ClearOverlay();
+
+    /// \brief Get the current cost of an edge, penalty included.
+    /// \param[in] _tail Unique Id of the tail waypoint.
+    /// \param[in] _head Unique Id of the head waypoint.
+    /// \param[out] _cost The cost or infinity if the edge is closed.
+    /// \return True if the edge exists.
+    public: bool EdgeCost(const rndf::UniqueId &_tail,
+                          const rndf::UniqueId &_head,
+                          double &_cost) const;
+
+    /// \brief Check that the network matches the one that would be built
+    /// from scratch from an RNDF with the same options. Use it to validate
+    /// a sequence of incremental updates. The first difference found is
+    /// printed on the standard error.
+    /// \param[in] _rndf The RNDF reflecting all the edits applied.
+    /// \return True if both networks have the same vertexes and the same
+    /// edges with the same base costs (closures and penalties are ignored).
+    public: bool Consistent(const rndf::RNDF &_rndf) const;
+
+    /// \brief The replanner searches directly on the routing graph.
+    friend class Replanner;
+
+    /// \brief The route cache follows the changes of the routing graph.
+    friend class RouteCache;
+
+    /// \brief The tiled map adds the segments and zones of a tile at once.
+    friend class TiledMap;
+
     /// \internal
     /// \brief Smart pointer to private data.
     private: std::unique_ptr<RoadNetworkPrivate> dataPtr;
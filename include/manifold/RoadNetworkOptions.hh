@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef MANIFOLD_ROADNETWORKOPTIONS_HH_
+#define MANIFOLD_ROADNETWORKOPTIONS_HH_
+
+#include "manifold/Helpers.hh"
+
+namespace manifold
+{
+  /// \brief How the free traversal inside a zone is encoded in the graph.
+  enum class ZoneModel
+  {
+    /// \brief An edge between every pair of perimeter points and parking
+    /// spot entries. The number of edges is quadratic in the zone size. This
+    /// is the default.
+    CLIQUE,
+
+    /// \brief A virtual hub vertex per zone, placed at the centroid of the
+    /// perimeter. Every perimeter point and parking spot entry is linked to
+    /// and from the hub, so the number of edges is linear in the zone size.
+    /// The reachability is the same as with CLIQUE. The cost of crossing the
+    /// zone is the distance through the hub, which is an upper bound of the
+    /// direct distance. The hubs are vertexes of the graph named
+    /// "<zone>.0.0".
+    HUB
+  };
+
+  /// \brief A class to customize how a RoadNetwork is built.
+  class MANIFOLD_VISIBLE RoadNetworkOptions
+  {
+    /// \brief Default constructor.
+    public: RoadNetworkOptions() = default;
+
+    /// \brief Destructor.
+    public: virtual ~RoadNetworkOptions() = default;
+
+    /// \brief Get the zone model.
+    /// \return The zone model.
+    public: manifold::ZoneModel ZoneModel() const;
+
+    /// \brief Set the zone model.
+    /// \param[in] _model The new zone model.
+    public: void SetZoneModel(const manifold::ZoneModel _model);
+
+    /// \brief Whether the graph contains lane change edges.
+    /// \return True if lane changes are enabled.
+    public: bool LaneChanges() const;
+
+    /// \brief Enable or disable the lane change edges. When enabled, the
+    /// adjacent lanes of each segment are detected from the geometry of
+    /// their waypoints, their width and their boundary markings, and each
+    /// waypoint is connected to the next waypoint of the adjacent lanes that
+    /// can be reached crossing a broken white line.
+    /// \param[in] _enabled True to enable lane changes.
+    public: void SetLaneChanges(const bool _enabled);
+
+    /// \brief Get the cost added to the length of a lane change.
+    /// \return The penalty (meters).
+    public: double LaneChangePenalty() const;
+
+    /// \brief Set the cost added to the length of a lane change, so routes
+    /// prefer staying in their lane.
+    /// \param[in] _penalty The new penalty (meters).
+    /// \return True if the penalty was set or false if it's negative.
+    public: bool SetLaneChangePenalty(const double _penalty);
+
+    /// \brief Whether the exits cost extra for turning and for stopping.
+    /// \return True if turn costs are enabled.
+    public: bool TurnCosts() const;
+
+    /// \brief Enable or disable the turn costs. When enabled, each exit
+    /// costs StopPenalty() more if it leaves from a stop waypoint, plus
+    /// TurnPenalty() for each 90 degrees of heading change between the lane
+    /// that it leaves and the lane that it enters.
+    /// \param[in] _enabled True to enable turn costs.
+    public: void SetTurnCosts(const bool _enabled);
+
+    /// \brief Get the cost added to the exits that leave from a stop.
+    /// \return The penalty (meters).
+    public: double StopPenalty() const;
+
+    /// \brief Set the cost added to the exits that leave from a stop.
+    /// \param[in] _penalty The new penalty (meters).
+    /// \return True if the penalty was set or false if it's negative.
+    public: bool SetStopPenalty(const double _penalty);
+
+    /// \brief Get the cost added to an exit for each 90 degrees of turn.
+    /// \return The penalty (meters).
+    public: double TurnPenalty() const;
+
+    /// \brief Set the cost added to an exit for each 90 degrees of turn.
+    /// \param[in] _penalty The new penalty (meters).
+    /// \return True if the penalty was set or false if it's negative.
+    public: bool SetTurnPenalty(const double _penalty);
+
+    /// \brief Get the number of landmarks used to speed up the route
+    /// queries.
+    /// \return The number of landmarks. 0 if they are disabled.
+    public: unsigned int Landmarks() const;
+
+    /// \brief Set the number of landmarks used to speed up the route
+    /// queries. The landmarks are waypoints spread around the border of the
+    /// network. The cost from and to each one of them is precomputed (in
+    /// parallel), which gives lower bounds of the cost between any two
+    /// waypoints, so the searches explore much less of the network. Each
+    /// landmark takes 16 bytes per waypoint. Between 8 and 16 landmarks
+    /// work well. The default is 0 (disabled).
+    /// \param[in] _landmarks The new number of landmarks.
+    /// \return True if the number was set or false if it's above 64.
+    public: bool SetLandmarks(const unsigned int _landmarks);
+
+    /// \brief Equality operator, result = this == _other
+    /// \param[in] _other Options to check for equality.
+    /// \return true if this == _other
+    public: bool operator==(const RoadNetworkOptions &_other) const;
+
+    /// \brief Inequality.
+    /// \param[in] _other Options to check for inequality.
+    /// \return true if this != _other
+    public: bool operator!=(const RoadNetworkOptions &_other) const;
+
+    /// \brief How zones are encoded.
+    private: manifold::ZoneModel zoneModel = manifold::ZoneModel::CLIQUE;
+
+    /// \brief Whether to add lane change edges.
+    private: bool laneChanges = false;
+
+    /// \brief Cost added to the length of a lane change (meters).
+    private: double laneChangePenalty = 10.0;
+
+    /// \brief Number of landmarks.
+    private: unsigned int landmarks = 0;
+
+    /// \brief Whether the exits have turn costs.
+    private: bool turnCosts = false;
+
+    /// \brief Cost added to the exits that leave from a stop (meters).
+    private: double stopPenalty = 30.0;
+
+    /// \brief Cost added to an exit for each 90 degrees of turn (meters).
+    private: double turnPenalty = 20.0;
+  };
+}
+#endif
@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef MANIFOLD_ROUTECACHE_HH_
+#define MANIFOLD_ROUTECACHE_HH_
+
+#include <memory>
+#include <vector>
+
+#include "manifold/Helpers.hh"
+
+namespace manifold
+{
+  namespace rndf
+  {
+    class UniqueId;
+  }
+
+  // Forward declarations.
+  class RoadNetwork;
+  class RouteCachePrivate;
+
+  /// \brief A bounded cache of the routes computed on a road network, for
+  /// services that ask for the same origin and destination over and over.
+  /// When the cache is full, the least recently used route is evicted.
+  ///
+  /// The cache follows the changes in the network. When an edge is closed,
+  /// removed or gets more expensive, only the routes that traverse it are
+  /// discarded. When an edge is added or gets cheaper, only the routes that
+  /// could get shorter through it are discarded: a route is kept if the
+  /// great-circle distance to the tail of the edge, plus the cost of the
+  /// edge, plus the great-circle distance from its head is already longer.
+  ///
+  /// The cost profile of the routes is the one of the network (its options
+  /// and its closures and penalties), so each network needs its own cache.
+  /// The network must outlive the cache. All the functions can be called
+  /// concurrently, but not while the network is being modified.
+  class MANIFOLD_VISIBLE RouteCache
+  {
+    /// \brief Constructor.
+    /// \param[in] _network The road network.
+    /// \param[in] _capacity Maximum number of routes stored. A value of 0
+    /// disables the cache.
+    public: explicit RouteCache(const RoadNetwork &_network,
+                                const size_t _capacity = 1024);
+
+    /// \brief Destructor.
+    public: virtual ~RouteCache();
+
+    /// \brief Get the shortest route between two waypoints, from the cache
+    /// if possible.
+    /// \param[in] _src Unique Id of the origin waypoint.
+    /// \param[in] _dst Unique Id of the destination waypoint.
+    /// \param[out] _path Unique Ids of the waypoints along the route, from
+    /// _src to _dst (both included).
+    /// \param[out] _cost Cost of the route.
+    /// \return True if a route was found or false otherwise.
+    /// \sa RoadNetwork::ShortestPath
+    public: bool ShortestPath(const rndf::UniqueId &_src,
+                              const rndf::UniqueId &_dst,
+                              std::vector<rndf::UniqueId> &_path,
+                              double &_cost);
+
+    /// \brief Get the maximum number of routes stored.
+    /// \return The capacity.
+    public: size_t Capacity() const;
+
+    /// \brief Get the number of routes stored.
+    /// \return The number of routes.
+    public: size_t Size() const;
+
+    /// \brief Remove all the routes. The counters aren't reset.
+    public: void Clear();
+
+    /// \brief Get the number of queries answered from the cache.
+    /// \return The number of hits.
+    public: size_t Hits() const;
+
+    /// \brief Get the number of queries that required a search.
+    /// \return The number of misses.
+    public: size_t Misses() const;
+
+    /// \brief Get the number of routes evicted to make room for new ones.
+    /// \return The number of evictions.
+    public: size_t Evictions() const;
+
+    /// \brief Get the number of routes discarded because of changes in the
+    /// network.
+    /// \return The number of invalidations.
+    public: size_t Invalidations() const;
+
+    /// \brief Set all the counters to zero.
+    public: void ResetCounters();
+
+    /// \internal
+    /// \brief Smart pointer to private data.
+    private: std::unique_ptr<RouteCachePrivate> dataPtr;
+  };
+}
+#endif
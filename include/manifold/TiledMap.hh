@@ -0,0 +1,171 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef MANIFOLD_TILEDMAP_HH_
+#define MANIFOLD_TILEDMAP_HH_
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <ignition/math/SphericalCoordinates.hh>
+
+#include "manifold/Helpers.hh"
+#include "manifold/RoadNetworkOptions.hh"
+
+namespace manifold
+{
+  namespace rndf
+  {
+    class Exit;
+    class RNDF;
+    class UniqueId;
+  }
+
+  // Forward declarations.
+  class RoadNetwork;
+  class TiledMapPrivate;
+
+  /// \brief A large RNDF split in tiles that are loaded on demand, e.g. a
+  /// state-wide map on a vehicle with a small memory budget.
+  ///
+  /// Build() partitions the segments (with their lanes) and the zones of an
+  /// RNDF in a grid of square tiles, by the center of their bounding box,
+  /// and saves each tile to its own binary file, next to a manifest with
+  /// the extent of each tile. A TiledMap reads the manifest and keeps an
+  /// RNDF and a road network with the tiles around the vehicle: Update()
+  /// loads the tiles that overlap a radius around a position and unloads
+  /// the ones farther than twice the radius, so a vehicle moving along a
+  /// tile boundary doesn't load and unload the same tiles over and over.
+  ///
+  /// The exits to segments or zones of tiles that aren't loaded are kept
+  /// pending by the road network, and they are connected when their tile
+  /// is loaded (see PendingExits() and Require()).
+  ///
+  /// The functions aren't thread-safe.
+  class MANIFOLD_VISIBLE TiledMap
+  {
+    /// \brief Partition an RNDF in tiles and save them.
+    /// \param[in] _rndf The RNDF.
+    /// \param[in] _path Path of the manifest. Each tile is saved to the same
+    /// path followed by a dot and the index of the tile.
+    /// \param[in] _tileSize Length of the side of a tile (meters).
+    /// \return True if all the files were written or false otherwise.
+    public: static bool Build(const rndf::RNDF &_rndf,
+                              const std::string &_path,
+                              const double _tileSize = 1000.0);
+
+    /// \brief Constructor. No tile is loaded.
+    /// \param[in] _path Path of the manifest saved by Build().
+    /// \param[in] _options Options of the road network.
+    public: explicit TiledMap(const std::string &_path,
+                              const RoadNetworkOptions &_options =
+                                RoadNetworkOptions());
+
+    /// \brief Destructor.
+    public: virtual ~TiledMap();
+
+    /// \brief Whether the manifest was read.
+    /// \return True if the manifest was read or false otherwise.
+    public: bool Valid() const;
+
+    /// \brief Get the length of the side of a tile.
+    /// \return The length (meters).
+    public: double TileSize() const;
+
+    /// \brief Get the number of tiles.
+    /// \return The number of tiles with any segment or zone.
+    public: size_t NumTiles() const;
+
+    /// \brief Get the number of tiles loaded.
+    /// \return The number of tiles.
+    public: size_t NumResident() const;
+
+    /// \brief Whether a tile is loaded.
+    /// \param[in] _tile Index of the tile.
+    /// \return True if the tile is loaded.
+    public: bool Resident(const size_t _tile) const;
+
+    /// \brief Get the size of the files of the tiles loaded, a measure of
+    /// the memory used by them.
+    /// \return The size (bytes).
+    public: size_t ResidentBytes() const;
+
+    /// \brief Get the approximate memory used by the graph of the road
+    /// network, which should stay flat while the same tiles are loaded and
+    /// unloaded over and over.
+    /// \return The size (bytes).
+    public: size_t NetworkBytes() const;
+
+    /// \brief Get the number of times that a tile was loaded.
+    /// \return The number of loads.
+    public: size_t NumLoads() const;
+
+    /// \brief Get the number of times that a tile was unloaded.
+    /// \return The number of unloads.
+    public: size_t NumUnloads() const;
+
+    /// \brief Get the tile of a segment or zone.
+    /// \param[in] _id Unique Id of any waypoint (or perimeter point or
+    /// parking spot) of the segment or zone.
+    /// \param[out] _tile Index of the tile.
+    /// \return True if the tile was found or false otherwise.
+    public: bool Tile(const rndf::UniqueId &_id, size_t &_tile) const;
+
+    /// \brief Load the tiles around a position and unload the far ones.
+    /// \param[in] _position The position.
+    /// \param[in] _radius Radius around the position (meters).
+    /// \return True if all the tiles needed were loaded or false otherwise.
+    public: bool Update(const ignition::math::SphericalCoordinates &_position,
+                        const double _radius);
+
+    /// \brief Load the tile of a segment or zone, if needed, e.g. to follow
+    /// a pending exit. It's unloaded by the next Update() if it's far.
+    /// \param[in] _id Unique Id of any waypoint of the segment or zone.
+    /// \return True if the tile is loaded or false otherwise (e.g. some of
+    /// its segments were already in the network).
+    public: bool Require(const rndf::UniqueId &_id);
+
+    /// \brief Get the exits of the tiles loaded whose entry isn't loaded.
+    /// \param[out] _exits The exits.
+    public: void PendingExits(std::vector<rndf::Exit> &_exits) const;
+
+    /// \brief Get the segments and zones of the tiles loaded.
+    /// \return The RNDF.
+    public: const rndf::RNDF &Map() const;
+
+    /// \brief Get the road network of the tiles loaded. It's updated
+    /// incrementally when tiles are loaded or unloaded.
+    /// \return The road network.
+    public: RoadNetwork &Network();
+
+    /// \brief Get the road network of the tiles loaded.
+    /// \return The road network.
+    public: const RoadNetwork &Network() const;
+
+    /// \brief Rebuild the road network from the tiles loaded. The slots of
+    /// the waypoints unloaded are reused by the next waypoints loaded, so
+    /// it's only needed to give the memory back after unloading many tiles
+    /// for good. The references to the previous network (and the objects
+    /// using it, such as a RouteCache) are no longer valid.
+    public: void Compact();
+
+    /// \internal
+    /// \brief Smart pointer to private data.
+    private: std::unique_ptr<TiledMapPrivate> dataPtr;
+  };
+}
+#endif
@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef MANIFOLD_TRACEMATCHER_HH_
+#define MANIFOLD_TRACEMATCHER_HH_
+
+#include <iosfwd>
+#include <memory>
+#include <string>
+#include <vector>
+#include <ignition/math/SphericalCoordinates.hh>
+
+#include "manifold/Helpers.hh"
+#include "manifold/LaneMatcher.hh"
+
+namespace manifold
+{
+  namespace rndf
+  {
+    class RNDF;
+  }
+
+  // Forward declarations.
+  class RoadNetwork;
+  class TraceMatcherPrivate;
+
+  /// \brief Offline map-matching of GPS traces to the lanes of an RNDF with
+  /// a hidden Markov model, e.g. for the analysis of fleet logs.
+  ///
+  /// The states of each fix are its projections on the lanes within the
+  /// search radius (see LaneMatcher::Candidates()). The emission
+  /// probability decays with the distance to the centerline as a Gaussian
+  /// of deviation GpsNoise(). The transition probability decays
+  /// exponentially, with scale TransitionScale(), with the difference
+  /// between the cost of the route between two states on the road network
+  /// and the great-circle distance between the fixes. The most likely
+  /// sequence of lanes is found with the Viterbi algorithm.
+  ///
+  /// The traces are processed as streams: the matches of the oldest fixes
+  /// are output as soon as all the candidate sequences agree on them, or
+  /// when they're MaxLag() fixes old, so the memory used doesn't depend on
+  /// the length of the trace. A fix without lanes within the search radius
+  /// or that can't be reached from the previous one breaks the trace and
+  /// the matching restarts after it.
+  ///
+  /// The road network and the RNDF must outlive the matcher. The matching
+  /// functions can be called concurrently.
+  class MANIFOLD_VISIBLE TraceMatcher
+  {
+    /// \brief Constructor.
+    /// \param[in] _rndf The RNDF.
+    /// \param[in] _network The road network built from _rndf, whose route
+    /// costs are used for the transitions.
+    public: TraceMatcher(const rndf::RNDF &_rndf,
+                         const RoadNetwork &_network);
+
+    /// \brief Destructor.
+    public: virtual ~TraceMatcher();
+
+    /// \brief Get the standard deviation of the GPS error.
+    /// \return The deviation (meters).
+    public: double GpsNoise() const;
+
+    /// \brief Set the standard deviation of the GPS error.
+    /// \param[in] _sigma The deviation (meters), positive.
+    /// \return True if the value was set or false if it's invalid.
+    public: bool SetGpsNoise(const double _sigma);
+
+    /// \brief Get the scale of the transition probability.
+    /// \return The scale (meters).
+    public: double TransitionScale() const;
+
+    /// \brief Set the scale of the transition probability. Larger values
+    /// tolerate routes that differ more from the straight line.
+    /// \param[in] _beta The scale (meters), positive.
+    /// \return True if the value was set or false if it's invalid.
+    public: bool SetTransitionScale(const double _beta);
+
+    /// \brief Get the maximum distance from a fix to its candidate lanes.
+    /// \return The radius (meters).
+    public: double SearchRadius() const;
+
+    /// \brief Set the maximum distance from a fix to its candidate lanes.
+    /// \param[in] _radius The radius (meters), positive.
+    /// \return True if the value was set or false if it's invalid.
+    public: bool SetSearchRadius(const double _radius);
+
+    /// \brief Get the maximum number of fixes kept before forcing the
+    /// output of the oldest one.
+    /// \return The number of fixes.
+    public: size_t MaxLag() const;
+
+    /// \brief Set the maximum number of fixes kept before forcing the
+    /// output of the oldest one. Larger values use more memory but let
+    /// later fixes correct more of the earlier ones.
+    /// \param[in] _lag The number of fixes, positive.
+    /// \return True if the value was set or false if it's invalid.
+    public: bool SetMaxLag(const size_t _lag);
+
+    /// \brief Match a trace.
+    /// \param[in] _trace The fixes of the trace, in chronological order.
+    /// \param[out] _matches The match of each fix. The waypoint Id is
+    /// invalid for the fixes that weren't matched.
+    /// \return The number of fixes matched.
+    public: size_t Match(
+      const std::vector<ignition::math::SphericalCoordinates> &_trace,
+      std::vector<LaneMatch> &_matches) const;
+
+    /// \brief Match a trace read from a stream. Each line of the input has
+    /// the latitude and longitude of a fix in decimal degrees, separated
+    /// by spaces; empty lines and lines starting with '#' are skipped. Each
+    /// line of the output has the match of a fix: the Unique Id of the
+    /// waypoint, the index, the offset, the distance and the progress (see
+    /// LaneMatch), or a single '-' if the fix wasn't matched.
+    /// \param[in] _in The input stream.
+    /// \param[out] _out The output stream.
+    /// \return True if the whole input was matched or false if a line
+    /// couldn't be parsed.
+    public: bool Match(std::istream &_in, std::ostream &_out) const;
+
+    /// \brief Match a batch of trace files in parallel, one file per task.
+    /// \param[in] _inputs Paths of the input files (see the stream
+    /// version of Match()).
+    /// \param[in] _outputs Paths of the output files, one per input.
+    /// \param[in] _threads Number of worker threads. A value of 0 uses one
+    /// thread per hardware thread available.
+    /// \return The number of traces matched without errors.
+    public: size_t Match(const std::vector<std::string> &_inputs,
+                         const std::vector<std::string> &_outputs,
+                         const unsigned int _threads = 0) const;
+
+    /// \internal
+    /// \brief Smart pointer to private data.
+    private: std::unique_ptr<TraceMatcherPrivate> dataPtr;
+  };
+}
+#endif
@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef MANIFOLD_ZONEINDEX_HH_
+#define MANIFOLD_ZONEINDEX_HH_
+
+#include <memory>
+#include <vector>
+#include <ignition/math/SphericalCoordinates.hh>
+
+#include "manifold/Helpers.hh"
+
+namespace manifold
+{
+  namespace rndf
+  {
+    class RNDF;
+  }
+
+  // Forward declarations.
+  class ZoneIndexPrivate;
+
+  /// \brief A spatial index of the zones of an RNDF, to find the zone where
+  /// a vehicle is.
+  ///
+  /// The perimeter of each zone is converted once to a polygon of
+  /// longitudes and latitudes (radians). A local projection is an affine
+  /// map of these coordinates, so it doesn't change which points are
+  /// inside. The bounding boxes of the polygons are hashed in a uniform
+  /// grid, so a query only tests the few zones around the location. The
+  /// edges of each polygon are stored as arrays, and the batch query tests
+  /// all the locations near a zone against each edge in a loop that the
+  /// compiler can vectorize.
+  ///
+  /// If zones overlap, the one with the lowest Id is returned. The index is
+  /// a snapshot of the RNDF: build a new one after modifying it. All the
+  /// functions can be called concurrently.
+  class MANIFOLD_VISIBLE ZoneIndex
+  {
+    /// \brief Constructor.
+    /// \param[in] _rndf The RNDF.
+    public: explicit ZoneIndex(const rndf::RNDF &_rndf);
+
+    /// \brief Destructor.
+    public: virtual ~ZoneIndex();
+
+    /// \brief Get the number of zones indexed (the ones whose perimeter
+    /// has at least 3 points).
+    /// \return The number of zones.
+    public: size_t Size() const;
+
+    /// \brief Find the zone that contains a location.
+    /// \param[in] _latitude Latitude (degrees).
+    /// \param[in] _longitude Longitude (degrees).
+    /// \return Id of the zone or 0 if the location isn't in any zone.
+    public: int ZoneAt(const double _latitude, const double _longitude) const;
+
+    /// \brief Find the zone that contains a location.
+    /// \param[in] _location The location.
+    /// \return Id of the zone or 0 if the location isn't in any zone.
+    public: int ZoneAt(
+      const ignition::math::SphericalCoordinates &_location) const;
+
+    /// \brief Find the zone that contains each location of a batch.
+    /// \param[in] _locations The locations.
+    /// \param[out] _zones Id of the zone of each location, or 0 if it isn't
+    /// in any zone.
+    /// \return The number of locations in a zone.
+    public: size_t ZoneAt(
+      const std::vector<ignition::math::SphericalCoordinates> &_locations,
+      std::vector<int> &_zones) const;
+
+    /// \internal
+    /// \brief Smart pointer to private data.
+    private: std::unique_ptr<ZoneIndexPrivate> dataPtr;
+  };
+}
+#endif
@@ -99,6 +99,10 @@ namespace manifold
       /// \return A mutable reference to the waypoint location.
       public: ignition::math::SphericalCoordinates &Location();
 
+      /// \brief Get the waypoint location.
+      /// \return The waypoint location.
+      public: const ignition::math::SphericalCoordinates &Location() const;
+
       //////////////
       /// Validation
       //////////////
@@ -0,0 +1,95 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef MANIFOLD_RNDF_WAYPOINTINDEX_HH_
+#define MANIFOLD_RNDF_WAYPOINTINDEX_HH_
+
+#include <memory>
+#include <utility>
+#include <vector>
+#include <ignition/math/SphericalCoordinates.hh>
+
+#include "manifold/Helpers.hh"
+
+namespace manifold
+{
+  namespace rndf
+  {
+    // Forward declarations.
+    class RNDF;
+    class UniqueId;
+    class WaypointIndexPrivate;
+
+    /// \brief A spatial index of all the waypoints of an RNDF: the waypoints
+    /// of the lanes, the perimeter points and the waypoints of the parking
+    /// spots. It answers nearest neighbor and radius queries in logarithmic
+    /// time, e.g. to find the waypoint closest to a GPS fix.
+    ///
+    /// The waypoints are stored in a k-d tree over their position on the
+    /// sphere, so the index works anywhere on Earth without a local
+    /// projection. Distances are great-circle distances (meters). The index
+    /// is a snapshot: build a new one after modifying the RNDF.
+    class MANIFOLD_VISIBLE WaypointIndex
+    {
+      /// \brief Constructor. Builds the index in O(n log n).
+      /// \param[in] _rndf The RNDF.
+      public: explicit WaypointIndex(const RNDF &_rndf);
+
+      /// \brief Destructor.
+      public: virtual ~WaypointIndex();
+
+      /// \brief Get the number of waypoints indexed.
+      /// \return The number of waypoints.
+      public: size_t Size() const;
+
+      /// \brief Find the waypoint closest to a location.
+      /// \param[in] _location The location.
+      /// \param[out] _id Unique Id of the closest waypoint.
+      /// \param[out] _distance Distance to the closest waypoint (meters).
+      /// \return True if a waypoint was found or false if the index is
+      /// empty.
+      public: bool Nearest(
+        const ignition::math::SphericalCoordinates &_location,
+        rndf::UniqueId &_id, double &_distance) const;
+
+      /// \brief Find the k waypoints closest to a location.
+      /// \param[in] _location The location.
+      /// \param[in] _k Number of waypoints.
+      /// \param[out] _nearest Unique Id and distance (meters) of the closest
+      /// waypoints (up to _k), in increasing order of distance.
+      public: void Nearest(
+        const ignition::math::SphericalCoordinates &_location,
+        const size_t _k,
+        std::vector<std::pair<rndf::UniqueId, double>> &_nearest) const;
+
+      /// \brief Find all the waypoints within a distance of a location.
+      /// \param[in] _location The location.
+      /// \param[in] _radius Maximum distance (meters).
+      /// \param[out] _within Unique Id and distance (meters) of each
+      /// waypoint found, in increasing order of distance.
+      public: void Within(
+        const ignition::math::SphericalCoordinates &_location,
+        const double _radius,
+        std::vector<std::pair<rndf::UniqueId, double>> &_within) const;
+
+      /// \internal
+      /// \brief Smart pointer to private data.
+      private: std::unique_ptr<WaypointIndexPrivate> dataPtr;
+    };
+  }
+}
+#endif
@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef MANIFOLD_BINARYIO_HH_
+#define MANIFOLD_BINARYIO_HH_
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "manifold/rndf/UniqueId.hh"
+
+namespace manifold
+{
+  /// \internal
+  /// \brief Upper bound of any count stored in a binary file, to reject
+  /// corrupted files before allocating memory.
+  const uint64_t kMaxCount = uint64_t(1) << 32;
+
+  /// \internal
+  /// \brief Write a value with a fixed size representation.
+  /// \param[in] _out Output stream.
+  /// \param[in] _value The value.
+  template<typename T> void write(std::ostream &_out, const T &_value)
+  {
+    _out.write(reinterpret_cast<const char *>(&_value), sizeof(T));
+  }
+
+  /// \internal
+  /// \brief Write a vector of values with a fixed size representation,
+  /// preceded by its size.
+  /// \param[in] _out Output stream.
+  /// \param[in] _values The values.
+  template<typename T> void write(std::ostream &_out,
+                                  const std::vector<T> &_values)
+  {
+    write<uint64_t>(_out, _values.size());
+    if (!_values.empty())
+    {
+      _out.write(reinterpret_cast<const char *>(_values.data()),
+                 _values.size() * sizeof(T));
+    }
+  }
+
+  /// \internal
+  /// \brief Write a string preceded by its size.
+  /// \param[in] _out Output stream.
+  /// \param[in] _value The string.
+  inline void write(std::ostream &_out, const std::string &_value)
+  {
+    write<uint64_t>(_out, _value.size());
+    _out.write(_value.data(), _value.size());
+  }
+
+  /// \internal
+  /// \brief Write a unique Id.
+  /// \param[in] _out Output stream.
+  /// \param[in] _id The unique Id.
+  inline void write(std::ostream &_out, const rndf::UniqueId &_id)
+  {
+    write<int32_t>(_out, _id.X());
+    write<int32_t>(_out, _id.Y());
+    write<int32_t>(_out, _id.Z());
+  }
+
+  /// \internal
+  /// \brief Read a value with a fixed size representation.
+  /// \param[in] _in Input stream.
+  /// \param[out] _value The value.
+  /// \return True if the value was read.
+  template<typename T> bool read(std::istream &_in, T &_value)
+  {
+    return static_cast<bool>(
+      _in.read(reinterpret_cast<char *>(&_value), sizeof(T)));
+  }
+
+  /// \internal
+  /// \brief Read a size.
+  /// \param[in] _in Input stream.
+  /// \param[out] _count The size.
+  /// \return True if the size was read and it's not too large.
+  inline bool readCount(std::istream &_in, size_t &_count)
+  {
+    uint64_t count;
+    if (!read(_in, count) || count > kMaxCount)
+      return false;
+    _count = static_cast<size_t>(count);
+    return true;
+  }
+
+  /// \internal
+  /// \brief Read a vector of values with a fixed size representation.
+  /// \param[in] _in Input stream.
+  /// \param[out] _values The values.
+  /// \return True if the values were read.
+  template<typename T> bool read(std::istream &_in, std::vector<T> &_values)
+  {
+    size_t count;
+    if (!readCount(_in, count))
+      return false;
+    _values.resize(count);
+    if (count == 0)
+      return true;
+    return static_cast<bool>(_in.read(reinterpret_cast<char *>(
+      _values.data()), count * sizeof(T)));
+  }
+
+  /// \internal
+  /// \brief Read a string.
+  /// \param[in] _in Input stream.
+  /// \param[out] _value The string.
+  /// \return True if the string was read.
+  inline bool read(std::istream &_in, std::string &_value)
+  {
+    size_t count;
+    if (!readCount(_in, count))
+      return false;
+    _value.resize(count);
+    if (count == 0)
+      return true;
+    return static_cast<bool>(_in.read(&_value[0], count));
+  }
+
+  /// \internal
+  /// \brief Read a unique Id.
+  /// \param[in] _in Input stream.
+  /// \param[out] _id The unique Id.
+  /// \return True if the unique Id was read.
+  inline bool read(std::istream &_in, rndf::UniqueId &_id)
+  {
+    int32_t x;
+    int32_t y;
+    int32_t z;
+    if (!read(_in, x) || !read(_in, y) || !read(_in, z))
+      return false;
+
+    // Invalid Ids (hubs and removed vertexes) are restored as invalid.
+    _id = rndf::UniqueId(x, y, z);
+    return true;
+  }
+}
+#endif
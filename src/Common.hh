@@ -0,0 +1,46 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef MANIFOLD_COMMON_HH_
+#define MANIFOLD_COMMON_HH_
+
+#include <cstdint>
+
+#include "manifold/rndf/UniqueId.hh"
+
+namespace manifold
+{
+  /// \internal
+  /// \brief Radius of the sphere used by SphericalCoordinates::Distance()
+  /// and so by the edge costs (meters).
+  const double kEarthRadius = 6371000.0;
+
+  /// \internal
+  /// \brief Width used for lanes without width (12 feet).
+  const double kDefaultLaneWidth = 3.6576;
+
+  /// \internal
+  /// \brief Key of a lane.
+  /// \param[in] _id Unique Id of the lane or one of its waypoints.
+  /// \return The key.
+  inline uint64_t laneKey(const rndf::UniqueId &_id)
+  {
+    return (static_cast<uint64_t>(_id.X()) << 32) |
+      static_cast<uint32_t>(_id.Y());
+  }
+}
+#endif
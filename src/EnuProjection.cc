@@ -0,0 +1,315 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include <ignition/math/Helpers.hh>
+#include <ignition/math/SphericalCoordinates.hh>
+#include <ignition/math/Vector3.hh>
+
+#include "manifold/rndf/Lane.hh"
+#include "manifold/rndf/ParkingSpot.hh"
+#include "manifold/rndf/Perimeter.hh"
+#include "manifold/rndf/RNDF.hh"
+#include "manifold/rndf/Segment.hh"
+#include "manifold/rndf/UniqueId.hh"
+#include "manifold/rndf/Waypoint.hh"
+#include "manifold/rndf/Zone.hh"
+#include "manifold/EnuProjection.hh"
+#include "VectorMath.hh"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using namespace manifold;
+
+namespace
+{
+  /// \internal
+  /// \brief Semi-major axis of the WGS84 ellipsoid (meters).
+  const double kWgs84A = 6378137.0;
+
+  /// \internal
+  /// \brief First eccentricity squared of the WGS84 ellipsoid.
+  const double kWgs84E2 = 6.69437999014e-3;
+
+  /// \internal
+  /// \brief Number of locations converted at a time, so the intermediate
+  /// arrays stay in the L1 cache.
+  const size_t kBlock = 256;
+}
+
+namespace manifold
+{
+  /// \internal
+  /// \brief Private data for EnuProjection class.
+  class EnuProjectionPrivate
+  {
+    /// \brief Constructor.
+    /// \param[in] _origin Origin of the ENU frame.
+    public: explicit EnuProjectionPrivate(
+      const ignition::math::SphericalCoordinates &_origin)
+      : origin(_origin)
+    {
+      double lat0 = _origin.LatitudeReference().Radian();
+      this->lon0 = _origin.LongitudeReference().Radian();
+      VectorMath::SinCos(lat0, this->sinLat0, this->cosLat0);
+      double n0 = kWgs84A / std::sqrt(1 - kWgs84E2 *
+        (this->sinLat0 * this->sinLat0));
+      this->x0 = n0 * this->cosLat0;
+      this->z0 = (n0 * (1 - kWgs84E2)) * this->sinLat0;
+    }
+
+    /// \brief Destructor.
+    public: virtual ~EnuProjectionPrivate() = default;
+
+    /// \brief Project arrays of locations.
+    ///
+    /// The earth-centered coordinates are rotated about the polar axis by
+    /// the longitude of the origin, so the east coordinate doesn't cancel
+    /// large numbers: with dlon the longitude from the origin, the
+    /// location is (n cos(lat) cos(dlon), n cos(lat) sin(dlon),
+    /// n (1 - e2) sin(lat)) and the origin is (x0, 0, z0).
+    /// \param[in] _lat The latitudes (degrees).
+    /// \param[in] _lon The longitudes (degrees).
+    /// \param[in] _count Number of locations.
+    /// \param[out] _east East coordinate of each location (meters).
+    /// \param[out] _north North coordinate of each location (meters).
+    public: void Project(const double *_lat, const double *_lon,
+                         const size_t _count, double *_east,
+                         double *_north) const
+    {
+      double lat[kBlock];
+      double dlon[kBlock];
+      double sinLat[kBlock];
+      double cosLat[kBlock];
+      double sinLon[kBlock];
+      double cosLon[kBlock];
+
+      for (size_t start = 0; start < _count; start += kBlock)
+      {
+        const size_t count = std::min(kBlock, _count - start);
+        for (size_t i = 0; i < count; ++i)
+        {
+          lat[i] = _lat[start + i] * IGN_DTOR(1.0);
+          dlon[i] = _lon[start + i] * IGN_DTOR(1.0) - this->lon0;
+        }
+        VectorMath::SinCos(lat, count, sinLat, cosLat);
+        VectorMath::SinCos(dlon, count, sinLon, cosLon);
+        this->Combine(sinLat, cosLat, sinLon, cosLon, count,
+                      _east + start, _north + start);
+      }
+    }
+
+    /// \brief Compute the ENU coordinates from the sines and cosines of
+    /// the latitudes and of the longitudes from the origin. The SIMD and
+    /// the scalar loops run the same operations in the same order.
+    /// \param[in] _sinLat Sine of each latitude.
+    /// \param[in] _cosLat Cosine of each latitude.
+    /// \param[in] _sinLon Sine of each longitude from the origin.
+    /// \param[in] _cosLon Cosine of each longitude from the origin.
+    /// \param[in] _count Number of locations.
+    /// \param[out] _east East coordinate of each location (meters).
+    /// \param[out] _north North coordinate of each location (meters).
+    private: void Combine(const double *_sinLat, const double *_cosLat,
+                          const double *_sinLon, const double *_cosLon,
+                          const size_t _count, double *_east,
+                          double *_north) const
+    {
+      size_t i = 0;
+#if defined(__SSE2__)
+      const __m128d a = _mm_set1_pd(kWgs84A);
+      const __m128d e2 = _mm_set1_pd(kWgs84E2);
+      const __m128d oneMinusE2 = _mm_set1_pd(1 - kWgs84E2);
+      const __m128d one = _mm_set1_pd(1.0);
+      const __m128d vx0 = _mm_set1_pd(this->x0);
+      const __m128d vz0 = _mm_set1_pd(this->z0);
+      const __m128d vSinLat0 = _mm_set1_pd(this->sinLat0);
+      const __m128d vCosLat0 = _mm_set1_pd(this->cosLat0);
+      for (; i + 2 <= _count; i += 2)
+      {
+        __m128d sinLat = _mm_loadu_pd(_sinLat + i);
+        __m128d n = _mm_div_pd(a, _mm_sqrt_pd(_mm_sub_pd(one,
+          _mm_mul_pd(e2, _mm_mul_pd(sinLat, sinLat)))));
+        __m128d nc = _mm_mul_pd(n, _mm_loadu_pd(_cosLat + i));
+        __m128d dx = _mm_sub_pd(_mm_mul_pd(nc, _mm_loadu_pd(_cosLon + i)),
+                                vx0);
+        __m128d dz = _mm_sub_pd(_mm_mul_pd(_mm_mul_pd(n, oneMinusE2),
+                                           sinLat), vz0);
+        _mm_storeu_pd(_east + i, _mm_mul_pd(nc, _mm_loadu_pd(_sinLon + i)));
+        _mm_storeu_pd(_north + i, _mm_sub_pd(_mm_mul_pd(vCosLat0, dz),
+                                             _mm_mul_pd(vSinLat0, dx)));
+      }
+#endif
+      for (; i < _count; ++i)
+      {
+        double n = kWgs84A / std::sqrt(1 - kWgs84E2 *
+          (_sinLat[i] * _sinLat[i]));
+        double nc = n * _cosLat[i];
+        double dx = nc * _cosLon[i] - this->x0;
+        double dz = (n * (1 - kWgs84E2)) * _sinLat[i] - this->z0;
+        _east[i] = nc * _sinLon[i];
+        _north[i] = this->cosLat0 * dz - this->sinLat0 * dx;
+      }
+    }
+
+    /// \brief Origin of the ENU frame.
+    public: ignition::math::SphericalCoordinates origin;
+
+    /// \brief Longitude of the origin (radians).
+    private: double lon0 = 0;
+
+    /// \brief Sine of the latitude of the origin.
+    private: double sinLat0 = 0;
+
+    /// \brief Cosine of the latitude of the origin.
+    private: double cosLat0 = 1;
+
+    /// \brief First earth-centered coordinate of the origin, after the
+    /// rotation (meters).
+    private: double x0 = 0;
+
+    /// \brief Third earth-centered coordinate of the origin (meters).
+    private: double z0 = 0;
+  };
+}
+
+//////////////////////////////////////////////////
+EnuProjection::EnuProjection(
+  const ignition::math::SphericalCoordinates &_origin)
+  : dataPtr(new EnuProjectionPrivate(_origin))
+{
+}
+
+//////////////////////////////////////////////////
+EnuProjection::~EnuProjection()
+{
+}
+
+//////////////////////////////////////////////////
+const ignition::math::SphericalCoordinates &EnuProjection::Origin() const
+{
+  return this->dataPtr->origin;
+}
+
+//////////////////////////////////////////////////
+bool EnuProjection::Vectorized()
+{
+  return VectorMath::Vectorized();
+}
+
+//////////////////////////////////////////////////
+ignition::math::Vector3d EnuProjection::Project(
+  const ignition::math::SphericalCoordinates &_location) const
+{
+  double lat = _location.LatitudeReference().Degree();
+  double lon = _location.LongitudeReference().Degree();
+  double east;
+  double north;
+  this->dataPtr->Project(&lat, &lon, 1, &east, &north);
+  return ignition::math::Vector3d(east, north, 0);
+}
+
+//////////////////////////////////////////////////
+bool EnuProjection::Project(const std::vector<double> &_latitudes,
+  const std::vector<double> &_longitudes, std::vector<double> &_east,
+  std::vector<double> &_north) const
+{
+  if (_latitudes.size() != _longitudes.size())
+  {
+    std::cerr << "EnuProjection::Project() Invalid number of longitudes ["
+              << _longitudes.size() << "]" << std::endl;
+    return false;
+  }
+
+  _east.resize(_latitudes.size());
+  _north.resize(_latitudes.size());
+  this->dataPtr->Project(_latitudes.data(), _longitudes.data(),
+                         _latitudes.size(), _east.data(), _north.data());
+  return true;
+}
+
+//////////////////////////////////////////////////
+void EnuProjection::Project(const std::vector<rndf::Waypoint> &_waypoints,
+  std::vector<ignition::math::Vector3d> &_points) const
+{
+  std::vector<double> lat;
+  std::vector<double> lon;
+  lat.reserve(_waypoints.size());
+  lon.reserve(_waypoints.size());
+  for (auto const &waypoint : _waypoints)
+  {
+    lat.push_back(waypoint.Location().LatitudeReference().Degree());
+    lon.push_back(waypoint.Location().LongitudeReference().Degree());
+  }
+
+  std::vector<double> east;
+  std::vector<double> north;
+  this->Project(lat, lon, east, north);
+  _points.clear();
+  _points.reserve(east.size());
+  for (size_t i = 0; i < east.size(); ++i)
+    _points.push_back(ignition::math::Vector3d(east[i], north[i], 0));
+}
+
+//////////////////////////////////////////////////
+void EnuProjection::Project(const rndf::RNDF &_rndf,
+  std::vector<rndf::UniqueId> &_ids,
+  std::vector<ignition::math::Vector3d> &_points) const
+{
+  std::vector<double> lat;
+  std::vector<double> lon;
+  _ids.clear();
+  auto add = [&](const rndf::UniqueId &_id, const rndf::Waypoint &_wp)
+  {
+    _ids.push_back(_id);
+    lat.push_back(_wp.Location().LatitudeReference().Degree());
+    lon.push_back(_wp.Location().LongitudeReference().Degree());
+  };
+
+  for (auto const &segment : _rndf.Segments())
+  {
+    for (auto const &lane : segment.Lanes())
+    {
+      for (auto const &wp : lane.Waypoints())
+        add(rndf::UniqueId(segment.Id(), lane.Id(), wp.Id()), wp);
+    }
+  }
+
+  for (auto const &zone : _rndf.Zones())
+  {
+    for (auto const &wp : zone.Perimeter().Points())
+      add(rndf::UniqueId(zone.Id(), 0, wp.Id()), wp);
+
+    for (auto const &spot : zone.Spots())
+    {
+      for (auto const &wp : spot.Waypoints())
+        add(rndf::UniqueId(zone.Id(), spot.Id(), wp.Id()), wp);
+    }
+  }
+
+  std::vector<double> east;
+  std::vector<double> north;
+  this->Project(lat, lon, east, north);
+  _points.clear();
+  _points.reserve(east.size());
+  for (size_t i = 0; i < east.size(); ++i)
+    _points.push_back(ignition::math::Vector3d(east[i], north[i], 0));
+}
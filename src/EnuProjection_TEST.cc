@@ -0,0 +1,193 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+#include <ignition/math/Angle.hh>
+#include <ignition/math/Helpers.hh>
+#include <ignition/math/SphericalCoordinates.hh>
+#include <ignition/math/Vector3.hh>
+
+#include "manifold/rndf/Lane.hh"
+#include "manifold/rndf/RNDF.hh"
+#include "manifold/rndf/RNDFNode.hh"
+#include "manifold/rndf/Segment.hh"
+#include "manifold/rndf/UniqueId.hh"
+#include "manifold/rndf/Waypoint.hh"
+#include "manifold/EnuProjection.hh"
+#include "manifold/test_config.h"
+#include "performance/fixtures.hh"
+#include "gtest/gtest.h"
+
+using namespace manifold;
+using test::location;
+
+/// \brief Reference ENU coordinates, through the earth-centered frame
+/// with the standard library.
+/// \param[in] _lat Latitude (degrees).
+/// \param[in] _lon Longitude (degrees).
+/// \param[in] _lat0 Latitude of the origin (degrees).
+/// \param[in] _lon0 Longitude of the origin (degrees).
+/// \return The east and north coordinates (meters).
+ignition::math::Vector3d reference(const double _lat, const double _lon,
+  const double _lat0, const double _lon0)
+{
+  const double kA = 6378137.0;
+  const double kE2 = 6.69437999014e-3;
+  auto ecef = [&](const double _phi, const double _lambda)
+  {
+    double n = kA / std::sqrt(1 - kE2 * std::sin(_phi) * std::sin(_phi));
+    return ignition::math::Vector3d(n * std::cos(_phi) * std::cos(_lambda),
+      n * std::cos(_phi) * std::sin(_lambda),
+      n * (1 - kE2) * std::sin(_phi));
+  };
+
+  double phi0 = IGN_DTOR(_lat0);
+  double lambda0 = IGN_DTOR(_lon0);
+  auto d = ecef(IGN_DTOR(_lat), IGN_DTOR(_lon)) - ecef(phi0, lambda0);
+  double east = -std::sin(lambda0) * d.X() + std::cos(lambda0) * d.Y();
+  double north = -std::sin(phi0) * std::cos(lambda0) * d.X() -
+    std::sin(phi0) * std::sin(lambda0) * d.Y() + std::cos(phi0) * d.Z();
+  return ignition::math::Vector3d(east, north, 0);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the projection of single locations.
+TEST(EnuProjection, Point)
+{
+  auto origin = location(37.0, -122.0);
+  EnuProjection projection(origin);
+  EXPECT_NEAR(projection.Origin().LatitudeReference().Degree(), 37.0, 1e-9);
+
+  auto p = projection.Project(origin);
+  EXPECT_NEAR(p.X(), 0.0, 1e-9);
+  EXPECT_NEAR(p.Y(), 0.0, 1e-9);
+  EXPECT_NEAR(p.Z(), 0.0, 1e-9);
+
+  // About 111 m north and 89 m east. The parallel curves to the north.
+  p = projection.Project(location(37.001, -122.0));
+  EXPECT_NEAR(p.X(), 0.0, 1e-9);
+  EXPECT_NEAR(p.Y(), 111.0, 0.1);
+  p = projection.Project(location(37.0, -121.999));
+  EXPECT_NEAR(p.X(), 89.0, 0.1);
+  EXPECT_GT(p.Y(), 0.0);
+  EXPECT_LT(p.Y(), 0.001);
+
+  // Across the antimeridian.
+  EnuProjection wrapped(location(0.0, 179.9995));
+  p = wrapped.Project(location(0.0, -179.9995));
+  EXPECT_NEAR(p.X(), 111.3, 0.1);
+}
+
+//////////////////////////////////////////////////
+/// \brief Compare the batch projection with the reference and with the
+/// projection of single locations, around several origins.
+TEST(EnuProjection, Batch)
+{
+  std::mt19937 generator(5);
+  std::uniform_real_distribution<double> offset(-1.0, 1.0);
+  const std::vector<std::pair<double, double>> origins =
+    {{37.0, -122.0}, {0.0, 0.0}, {-33.9, 151.2}, {64.1, -21.9}};
+
+  for (auto const &origin : origins)
+  {
+    EnuProjection projection(location(origin.first, origin.second));
+
+    // An odd number, so both the SIMD and the scalar loops run.
+    std::vector<double> lat;
+    std::vector<double> lon;
+    for (int i = 0; i < 1001; ++i)
+    {
+      lat.push_back(origin.first + offset(generator));
+      lon.push_back(origin.second + offset(generator));
+    }
+
+    std::vector<double> east;
+    std::vector<double> north;
+    ASSERT_TRUE(projection.Project(lat, lon, east, north));
+    ASSERT_EQ(east.size(), lat.size());
+    ASSERT_EQ(north.size(), lat.size());
+    for (size_t i = 0; i < lat.size(); ++i)
+    {
+      auto expected = reference(lat[i], lon[i], origin.first, origin.second);
+      EXPECT_NEAR(east[i], expected.X(), 1e-6);
+      EXPECT_NEAR(north[i], expected.Y(), 1e-6);
+
+      // The angles of the location are stored in radians, which can round
+      // the degrees differently.
+      auto p = projection.Project(location(lat[i], lon[i]));
+      EXPECT_NEAR(p.X(), east[i], 1e-6);
+      EXPECT_NEAR(p.Y(), north[i], 1e-6);
+    }
+  }
+
+  // The arrays must have the same size.
+  EnuProjection projection(location(37.0, -122.0));
+  std::vector<double> east;
+  std::vector<double> north;
+  EXPECT_FALSE(projection.Project({37.0, 37.1}, {-122.0}, east, north));
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the projection of a lane and of a whole RNDF.
+TEST(EnuProjection, Waypoints)
+{
+  std::string dirPath(std::string(PROJECT_SOURCE_PATH));
+  rndf::RNDF rndf(dirPath + "/test/rndf/sample1.rndf");
+  ASSERT_TRUE(rndf.Valid());
+
+  auto const &lane = rndf.Segments().front().Lanes().front();
+  EnuProjection projection(lane.Waypoints().front().Location());
+
+  std::vector<ignition::math::Vector3d> points;
+  projection.Project(lane.Waypoints(), points);
+  ASSERT_EQ(points.size(), lane.Waypoints().size());
+  EXPECT_NEAR(points[0].Length(), 0.0, 1e-9);
+  for (size_t i = 0; i < points.size(); ++i)
+  {
+    auto p = projection.Project(lane.Waypoints()[i].Location());
+    EXPECT_DOUBLE_EQ(points[i].X(), p.X());
+    EXPECT_DOUBLE_EQ(points[i].Y(), p.Y());
+    EXPECT_NEAR(points[i].Z(), 0.0, 1e-9);
+  }
+
+  std::vector<rndf::UniqueId> ids;
+  projection.Project(rndf, ids, points);
+  ASSERT_EQ(ids.size(), points.size());
+  EXPECT_FALSE(ids.empty());
+  size_t perimeter = 0;
+  for (size_t i = 0; i < ids.size(); ++i)
+  {
+    auto const *info = rndf.Info(ids[i]);
+    ASSERT_TRUE(info != nullptr);
+    auto p = projection.Project(info->Waypoint()->Location());
+    EXPECT_DOUBLE_EQ(points[i].X(), p.X());
+    EXPECT_DOUBLE_EQ(points[i].Y(), p.Y());
+    if (ids[i].Y() == 0)
+      ++perimeter;
+  }
+  EXPECT_GT(perimeter, 0u);
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
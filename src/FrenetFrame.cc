@@ -0,0 +1,398 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <vector>
+#include <ignition/math/Helpers.hh>
+#include <ignition/math/Vector3.hh>
+
+#include "manifold/rndf/UniqueId.hh"
+#include "manifold/FrenetFrame.hh"
+#include "manifold/LaneGeometry.hh"
+
+using namespace manifold;
+
+namespace
+{
+  /// \internal
+  /// \brief Points closer than this to the previous one are dropped
+  /// (meters).
+  const double kMinLength = 1e-6;
+}
+
+namespace manifold
+{
+  /// \internal
+  /// \brief Private data for FrenetFrame class.
+  class FrenetFramePrivate
+  {
+    /// \brief Build the path.
+    /// \param[in] _points The points of the path (meters).
+    public: void Build(const std::vector<ignition::math::Vector3d> &_points)
+    {
+      std::vector<ignition::math::Vector3d> points;
+      for (auto const &point : _points)
+      {
+        ignition::math::Vector3d p(point.X(), point.Y(), 0);
+        if (points.empty() || p.Distance(points.back()) > kMinLength)
+          points.push_back(p);
+      }
+      this->path.reset(new LaneGeometry(points));
+
+      this->pieces = points.empty() ? 0 : points.size() - 1;
+      for (size_t i = 0; i < points.size(); ++i)
+      {
+        this->x.push_back(points[i].X());
+        this->y.push_back(points[i].Y());
+        this->stations.push_back(this->path->Station(i));
+      }
+      for (size_t i = 0; i < this->pieces; ++i)
+      {
+        double length = this->stations[i + 1] - this->stations[i];
+        this->lengths.push_back(length);
+        this->ux.push_back((this->x[i + 1] - this->x[i]) / length);
+        this->uy.push_back((this->y[i + 1] - this->y[i]) / length);
+      }
+    }
+
+    /// \brief Squared distance from a point to a piece.
+    /// \param[in] _i Index of the piece.
+    /// \param[in] _x X of the point.
+    /// \param[in] _y Y of the point.
+    /// \return The squared distance.
+    public: double Distance2(const size_t _i, const double _x,
+                             const double _y) const
+    {
+      double wx = _x - this->x[_i];
+      double wy = _y - this->y[_i];
+      double t = ignition::math::clamp(
+        wx * this->ux[_i] + wy * this->uy[_i], 0.0, this->lengths[_i]);
+      double dx = wx - t * this->ux[_i];
+      double dy = wy - t * this->uy[_i];
+      return dx * dx + dy * dy;
+    }
+
+    /// \brief Walk from a piece to the closest one nearby: forward while
+    /// the distance decreases, then backward if it didn't move.
+    /// \param[in] _hint Index of the first piece.
+    /// \param[in] _x X of the point.
+    /// \param[in] _y Y of the point.
+    /// \param[out] _best Squared distance to the piece found.
+    /// \return Index of the piece found.
+    public: size_t Walk(const size_t _hint, const double _x, const double _y,
+                        double &_best) const
+    {
+      size_t i = std::min(_hint, this->pieces - 1);
+      _best = this->Distance2(i, _x, _y);
+      const size_t start = i;
+      while (i + 1 < this->pieces)
+      {
+        double next = this->Distance2(i + 1, _x, _y);
+        if (next >= _best)
+          break;
+        _best = next;
+        ++i;
+      }
+      if (i != start)
+        return i;
+
+      while (i > 0)
+      {
+        double prev = this->Distance2(i - 1, _x, _y);
+        if (prev >= _best)
+          break;
+        _best = prev;
+        --i;
+      }
+      return i;
+    }
+
+    /// \brief Find the closest piece of the whole path.
+    /// \param[in] _x X of the point.
+    /// \param[in] _y Y of the point.
+    /// \param[out] _best Squared distance to the piece found.
+    /// \return Index of the piece found.
+    public: size_t Search(const double _x, const double _y,
+                          double &_best) const
+    {
+      double offset;
+      double s = this->path->Project(ignition::math::Vector3d(_x, _y, 0),
+                                     offset);
+
+      // Settle the ties at the waypoints as a walk would.
+      return this->Walk(this->path->PieceAt(s), _x, _y, _best);
+    }
+
+    /// \brief Frenet coordinates of a point projected on a piece.
+    /// \param[in] _i Index of the piece.
+    /// \param[in] _x X of the point.
+    /// \param[in] _y Y of the point.
+    /// \param[out] _s Arc length (meters).
+    /// \param[out] _d Signed distance (meters).
+    public: void Frenet(const size_t _i, const double _x, const double _y,
+                        double &_s, double &_d) const
+    {
+      double wx = _x - this->x[_i];
+      double wy = _y - this->y[_i];
+      double along = wx * this->ux[_i] + wy * this->uy[_i];
+      double across = this->ux[_i] * wy - this->uy[_i] * wx;
+      bool extended = (along < 0 && _i == 0) ||
+        (along > this->lengths[_i] && _i + 1 == this->pieces);
+      if (extended || (along >= 0 && along <= this->lengths[_i]))
+      {
+        _s = this->stations[_i] + along;
+        _d = across;
+        return;
+      }
+
+      // Closest to a waypoint, on the outside of a turn.
+      double t = ignition::math::clamp(along, 0.0, this->lengths[_i]);
+      double dx = wx - t * this->ux[_i];
+      double dy = wy - t * this->uy[_i];
+      double distance = std::sqrt(dx * dx + dy * dy);
+      _s = this->stations[_i] + t;
+      _d = across < 0 ? -distance : distance;
+    }
+
+    /// \brief Walk from a piece to the piece at an arc length.
+    /// \param[in] _hint Index of the first piece.
+    /// \param[in] _s The arc length (meters).
+    /// \return Index of the piece, the first or the last one if _s is out
+    /// of the path.
+    public: size_t PieceAt(const size_t _hint, const double _s) const
+    {
+      size_t i = std::min(_hint, this->pieces - 1);
+      while (i + 1 < this->pieces && _s >= this->stations[i + 1])
+        ++i;
+      while (i > 0 && _s < this->stations[i])
+        --i;
+      return i;
+    }
+
+    /// \brief Point at Frenet coordinates along a piece.
+    /// \param[in] _i Index of the piece.
+    /// \param[in] _s Arc length (meters).
+    /// \param[in] _d Signed distance (meters).
+    /// \param[out] _point The point (meters).
+    public: void Cartesian(const size_t _i, const double _s, const double _d,
+                           ignition::math::Vector3d &_point) const
+    {
+      double t = _s - this->stations[_i];
+      _point = ignition::math::Vector3d(
+        this->x[_i] + t * this->ux[_i] - _d * this->uy[_i],
+        this->y[_i] + t * this->uy[_i] + _d * this->ux[_i], 0);
+    }
+
+    /// \brief Geometry of the path.
+    public: std::unique_ptr<LaneGeometry> path;
+
+    /// \brief Number of pieces of the path.
+    public: size_t pieces = 0;
+
+    /// \brief X of each point (meters).
+    public: std::vector<double> x;
+
+    /// \brief Y of each point (meters).
+    public: std::vector<double> y;
+
+    /// \brief Arc length of each point (meters).
+    public: std::vector<double> stations;
+
+    /// \brief Length of each piece (meters).
+    public: std::vector<double> lengths;
+
+    /// \brief X of the unit direction of each piece.
+    public: std::vector<double> ux;
+
+    /// \brief Y of the unit direction of each piece.
+    public: std::vector<double> uy;
+  };
+}
+
+//////////////////////////////////////////////////
+FrenetFrame::FrenetFrame(const LaneGeometry &_lane)
+  : dataPtr(new FrenetFramePrivate())
+{
+  std::vector<ignition::math::Vector3d> points;
+  for (size_t i = 0; i < _lane.NumPoints(); ++i)
+    points.push_back(_lane.Point(i));
+  this->dataPtr->Build(points);
+}
+
+//////////////////////////////////////////////////
+FrenetFrame::FrenetFrame(const LaneGeometryCache &_cache,
+  const std::vector<rndf::UniqueId> &_route)
+  : dataPtr(new FrenetFramePrivate())
+{
+  std::vector<ignition::math::Vector3d> points;
+  const LaneGeometry *prevLane = nullptr;
+  size_t prevIndex = 0;
+  for (auto const &id : _route)
+  {
+    auto lane = _cache.Lane(id);
+    size_t index;
+    if (!lane || !lane->Index(id.Z(), index))
+    {
+      prevLane = nullptr;
+      continue;
+    }
+
+    // Join the waypoints skipped along the same lane.
+    size_t from = lane == prevLane && index > prevIndex ?
+      prevIndex + 1 : index;
+    for (size_t i = from; i <= index; ++i)
+      points.push_back(lane->Point(i));
+    prevLane = lane;
+    prevIndex = index;
+  }
+  this->dataPtr->Build(points);
+}
+
+//////////////////////////////////////////////////
+FrenetFrame::~FrenetFrame()
+{
+}
+
+//////////////////////////////////////////////////
+const LaneGeometry &FrenetFrame::Path() const
+{
+  return *this->dataPtr->path;
+}
+
+//////////////////////////////////////////////////
+double FrenetFrame::Length() const
+{
+  return this->dataPtr->path->Length();
+}
+
+//////////////////////////////////////////////////
+bool FrenetFrame::ToFrenet(const ignition::math::Vector3d &_point,
+  double &_s, double &_d) const
+{
+  auto const &d = *this->dataPtr;
+  if (d.pieces == 0)
+    return false;
+
+  double best;
+  size_t i = d.Search(_point.X(), _point.Y(), best);
+  d.Frenet(i, _point.X(), _point.Y(), _s, _d);
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool FrenetFrame::ToFrenet(const ignition::math::Vector3d &_point,
+  size_t &_hint, double &_s, double &_d) const
+{
+  auto const &d = *this->dataPtr;
+  if (d.pieces == 0)
+    return false;
+
+  double best;
+  _hint = d.Walk(_hint, _point.X(), _point.Y(), best);
+  d.Frenet(_hint, _point.X(), _point.Y(), _s, _d);
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool FrenetFrame::ToFrenet(
+  const std::vector<ignition::math::Vector3d> &_points,
+  std::vector<double> &_s, std::vector<double> &_d) const
+{
+  auto const &d = *this->dataPtr;
+  if (d.pieces == 0)
+    return false;
+
+  _s.resize(_points.size());
+  _d.resize(_points.size());
+  size_t hint = 0;
+  double distance = 0;
+  for (size_t k = 0; k < _points.size(); ++k)
+  {
+    const double px = _points[k].X();
+    const double py = _points[k].Y();
+    double best;
+    if (k == 0)
+      hint = d.Search(px, py, best);
+    else
+    {
+      // The path is at most as far as from the previous point plus its
+      // distance to the path: otherwise the walk stopped too early.
+      hint = d.Walk(hint, px, py, best);
+      double dx = px - _points[k - 1].X();
+      double dy = py - _points[k - 1].Y();
+      double bound = distance + std::sqrt(dx * dx + dy * dy);
+      if (best > bound * bound * (1 + 1e-9) + 1e-9)
+        hint = d.Search(px, py, best);
+    }
+    distance = std::sqrt(best);
+    d.Frenet(hint, px, py, _s[k], _d[k]);
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool FrenetFrame::ToCartesian(const double _s, const double _d,
+  ignition::math::Vector3d &_point) const
+{
+  auto const &d = *this->dataPtr;
+  if (d.pieces == 0)
+    return false;
+
+  d.Cartesian(d.path->PieceAt(_s), _s, _d, _point);
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool FrenetFrame::ToCartesian(const double _s, const double _d,
+  size_t &_hint, ignition::math::Vector3d &_point) const
+{
+  auto const &d = *this->dataPtr;
+  if (d.pieces == 0)
+    return false;
+
+  _hint = d.PieceAt(_hint, _s);
+  d.Cartesian(_hint, _s, _d, _point);
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool FrenetFrame::ToCartesian(const std::vector<double> &_s,
+  const std::vector<double> &_d,
+  std::vector<ignition::math::Vector3d> &_points) const
+{
+  auto const &d = *this->dataPtr;
+  if (_s.size() != _d.size())
+  {
+    std::cerr << "FrenetFrame::ToCartesian() Invalid number of distances ["
+              << _d.size() << "]" << std::endl;
+    return false;
+  }
+  if (d.pieces == 0)
+    return false;
+
+  _points.resize(_s.size());
+  size_t hint = _s.empty() ? 0 : d.path->PieceAt(_s[0]);
+  for (size_t k = 0; k < _s.size(); ++k)
+  {
+    hint = d.PieceAt(hint, _s[k]);
+    d.Cartesian(hint, _s[k], _d[k], _points[k]);
+  }
+  return true;
+}
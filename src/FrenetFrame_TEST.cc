@@ -0,0 +1,299 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+#include <ignition/math/Helpers.hh>
+#include <ignition/math/Vector3.hh>
+
+#include "manifold/rndf/RNDF.hh"
+#include "manifold/rndf/UniqueId.hh"
+#include "manifold/FrenetFrame.hh"
+#include "manifold/LaneGeometry.hh"
+#include "manifold/RoadNetwork.hh"
+#include "manifold/test_config.h"
+#include "gtest/gtest.h"
+
+using namespace manifold;
+
+/// \brief Distance from a point to the closest piece of a path.
+/// \param[in] _path The path.
+/// \param[in] _p The point.
+/// \return The distance (meters).
+double scan(const LaneGeometry &_path, const ignition::math::Vector3d &_p)
+{
+  double best = 1e9;
+  for (size_t j = 0; j + 1 < _path.NumPoints(); ++j)
+  {
+    auto a = _path.Point(j);
+    auto e = _path.Point(j + 1) - a;
+    double t = ignition::math::clamp((_p - a).Dot(e) / e.Dot(e), 0.0, 1.0);
+    best = std::min(best, (a + e * t - _p).Length());
+  }
+  return best;
+}
+
+/// \brief A path turning left along a circle of 100 m of radius centered
+/// at the origin, from south to north.
+/// \return The points of the path.
+std::vector<ignition::math::Vector3d> arcPath()
+{
+  std::vector<ignition::math::Vector3d> points;
+  for (int i = 0; i <= 36; ++i)
+  {
+    double angle = -IGN_PI / 2 + i * IGN_PI / 36;
+    points.push_back(ignition::math::Vector3d(100 * std::cos(angle),
+                                              100 * std::sin(angle), 0));
+  }
+  return points;
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the conversions along a path with a left turn.
+TEST(FrenetFrame, Corner)
+{
+  std::vector<ignition::math::Vector3d> points =
+  {
+    ignition::math::Vector3d(0, 0, 0),
+    ignition::math::Vector3d(10, 0, 0),
+    ignition::math::Vector3d(10, 0, 0),
+    ignition::math::Vector3d(20, 0, 0),
+    ignition::math::Vector3d(20, 10, 0)
+  };
+  FrenetFrame frame{LaneGeometry(points)};
+  EXPECT_EQ(frame.Path().NumPoints(), 4u);
+  EXPECT_DOUBLE_EQ(frame.Length(), 30.0);
+
+  double s;
+  double d;
+  ASSERT_TRUE(frame.ToFrenet(ignition::math::Vector3d(5, 2, 0), s, d));
+  EXPECT_NEAR(s, 5.0, 1e-9);
+  EXPECT_NEAR(d, 2.0, 1e-9);
+  ASSERT_TRUE(frame.ToFrenet(ignition::math::Vector3d(15, -3, 0), s, d));
+  EXPECT_NEAR(s, 15.0, 1e-9);
+  EXPECT_NEAR(d, -3.0, 1e-9);
+
+  // The ends are extended.
+  ASSERT_TRUE(frame.ToFrenet(ignition::math::Vector3d(-4, 1, 0), s, d));
+  EXPECT_NEAR(s, -4.0, 1e-9);
+  EXPECT_NEAR(d, 1.0, 1e-9);
+  ASSERT_TRUE(frame.ToFrenet(ignition::math::Vector3d(20, 15, 0), s, d));
+  EXPECT_NEAR(s, 35.0, 1e-9);
+  EXPECT_NEAR(d, 0.0, 1e-9);
+
+  // Outside of the turn, the closest point is the corner.
+  ASSERT_TRUE(frame.ToFrenet(ignition::math::Vector3d(25, -5, 0), s, d));
+  EXPECT_NEAR(s, 20.0, 1e-9);
+  EXPECT_NEAR(d, -std::sqrt(50.0), 1e-9);
+
+  ignition::math::Vector3d point;
+  ASSERT_TRUE(frame.ToCartesian(5, 2, point));
+  EXPECT_NEAR(point.X(), 5.0, 1e-9);
+  EXPECT_NEAR(point.Y(), 2.0, 1e-9);
+  ASSERT_TRUE(frame.ToCartesian(25, -1, point));
+  EXPECT_NEAR(point.X(), 21.0, 1e-9);
+  EXPECT_NEAR(point.Y(), 5.0, 1e-9);
+  ASSERT_TRUE(frame.ToCartesian(-2, 0, point));
+  EXPECT_NEAR(point.X(), -2.0, 1e-9);
+
+  // Hints.
+  size_t hint = 0;
+  ASSERT_TRUE(frame.ToFrenet(ignition::math::Vector3d(19, 8, 0), hint, s, d));
+  EXPECT_EQ(hint, 2u);
+  EXPECT_NEAR(s, 28.0, 1e-9);
+  EXPECT_NEAR(d, 1.0, 1e-9);
+  ASSERT_TRUE(frame.ToFrenet(ignition::math::Vector3d(3, 1, 0), hint, s, d));
+  EXPECT_EQ(hint, 0u);
+  EXPECT_NEAR(s, 3.0, 1e-9);
+  hint = 99;
+  ASSERT_TRUE(frame.ToCartesian(12, 0, hint, point));
+  EXPECT_EQ(hint, 1u);
+  EXPECT_NEAR(point.X(), 12.0, 1e-9);
+
+  std::vector<double> ss = {1, 2};
+  std::vector<double> ds = {0};
+  std::vector<ignition::math::Vector3d> out;
+  EXPECT_FALSE(frame.ToCartesian(ss, ds, out));
+}
+
+//////////////////////////////////////////////////
+/// \brief Check paths with fewer than two points.
+TEST(FrenetFrame, Degenerate)
+{
+  std::vector<ignition::math::Vector3d> points =
+  {
+    ignition::math::Vector3d(1, 1, 0),
+    ignition::math::Vector3d(1, 1, 0)
+  };
+  FrenetFrame frame{LaneGeometry(points)};
+  EXPECT_EQ(frame.Path().NumPoints(), 1u);
+  EXPECT_DOUBLE_EQ(frame.Length(), 0.0);
+
+  double s;
+  double d;
+  size_t hint = 0;
+  ignition::math::Vector3d point;
+  std::vector<double> ss;
+  std::vector<double> ds;
+  std::vector<ignition::math::Vector3d> out;
+  EXPECT_FALSE(frame.ToFrenet(point, s, d));
+  EXPECT_FALSE(frame.ToFrenet(point, hint, s, d));
+  EXPECT_FALSE(frame.ToFrenet(out, ss, ds));
+  EXPECT_FALSE(frame.ToCartesian(0, 0, point));
+  EXPECT_FALSE(frame.ToCartesian(0, 0, hint, point));
+  EXPECT_FALSE(frame.ToCartesian(ss, ds, out));
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the conversions along a curved path against a scan of all
+/// the pieces, with and without hints.
+TEST(FrenetFrame, Curved)
+{
+  FrenetFrame frame{LaneGeometry(arcPath())};
+  auto const &path = frame.Path();
+  std::mt19937 generator(3);
+  std::uniform_real_distribution<double> coordinate(-150.0, 150.0);
+  for (int i = 0; i < 500; ++i)
+  {
+    ignition::math::Vector3d p(coordinate(generator), coordinate(generator),
+                               0);
+    double s;
+    double d;
+    ASSERT_TRUE(frame.ToFrenet(p, s, d));
+    if (s >= 0 && s <= frame.Length())
+    {
+      EXPECT_NEAR(std::abs(d), scan(path, p), 1e-6);
+    }
+
+    // Inside the turn, the conversion is reversible.
+    if (d > 0)
+    {
+      ignition::math::Vector3d q;
+      ASSERT_TRUE(frame.ToCartesian(s, d, q));
+      EXPECT_NEAR(q.Distance(p), 0.0, 1e-6);
+    }
+  }
+
+  // A trajectory along the path, converted in order.
+  std::vector<ignition::math::Vector3d> samples;
+  std::uniform_real_distribution<double> lateral(-20.0, 20.0);
+  for (int i = -50; i < 1700; ++i)
+  {
+    double s = 0.1 * i;
+    ignition::math::Vector3d point;
+    ASSERT_TRUE(frame.ToCartesian(s, lateral(generator), point));
+    samples.push_back(point);
+  }
+
+  std::vector<double> ss;
+  std::vector<double> ds;
+  ASSERT_TRUE(frame.ToFrenet(samples, ss, ds));
+  ASSERT_EQ(ss.size(), samples.size());
+  size_t hint = 0;
+  for (size_t i = 0; i < samples.size(); ++i)
+  {
+    double s;
+    double d;
+    ASSERT_TRUE(frame.ToFrenet(samples[i], s, d));
+    EXPECT_NEAR(ss[i], s, 1e-9);
+    EXPECT_NEAR(ds[i], d, 1e-9);
+    ASSERT_TRUE(frame.ToFrenet(samples[i], hint, s, d));
+    EXPECT_NEAR(ss[i], s, 1e-9);
+    EXPECT_NEAR(ds[i], d, 1e-9);
+  }
+
+  std::vector<ignition::math::Vector3d> back;
+  ASSERT_TRUE(frame.ToCartesian(ss, ds, back));
+  ASSERT_EQ(back.size(), ss.size());
+  for (size_t i = 0; i < back.size(); ++i)
+  {
+    ignition::math::Vector3d point;
+    ASSERT_TRUE(frame.ToCartesian(ss[i], ds[i], point));
+    EXPECT_NEAR(back[i].Distance(point), 0.0, 1e-9);
+  }
+
+  // In random order, the walks that stop too early are detected.
+  std::shuffle(samples.begin(), samples.end(), generator);
+  ASSERT_TRUE(frame.ToFrenet(samples, ss, ds));
+  for (size_t i = 0; i < samples.size(); ++i)
+  {
+    double s;
+    double d;
+    ASSERT_TRUE(frame.ToFrenet(samples[i], s, d));
+    EXPECT_NEAR(ss[i], s, 1e-9);
+    EXPECT_NEAR(ds[i], d, 1e-9);
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Check a route across lanes of the sample RNDF.
+TEST(FrenetFrame, Route)
+{
+  std::string dirPath(PROJECT_SOURCE_PATH);
+  rndf::RNDF rndf(dirPath + "/test/rndf/sample1.rndf");
+  ASSERT_TRUE(rndf.Valid());
+  RoadNetwork roadNetwork(rndf);
+  LaneGeometryCache cache(rndf);
+
+  std::vector<rndf::UniqueId> route;
+  double cost;
+  ASSERT_TRUE(roadNetwork.ShortestPath(rndf::UniqueId(1, 2, 1),
+    rndf::UniqueId(3, 1, 3), route, cost));
+  ASSERT_EQ(route.size(), 7u);
+
+  FrenetFrame frame(cache, route);
+  EXPECT_EQ(frame.Path().NumPoints(), route.size());
+  auto lane = cache.Lane(route.front());
+  auto next = cache.Lane(route.back());
+  ASSERT_NE(lane, nullptr);
+  ASSERT_NE(next, nullptr);
+  double expected = lane->Station(3) + lane->Point(3).Distance(
+    next->Point(0)) + next->Station(2);
+  EXPECT_NEAR(frame.Length(), expected, 1e-6);
+
+  // The waypoints are on the path, in order.
+  double last = -1;
+  for (auto const &id : route)
+  {
+    size_t index;
+    ASSERT_TRUE(cache.Lane(id)->Index(id.Z(), index));
+    double s;
+    double d;
+    ASSERT_TRUE(frame.ToFrenet(cache.Lane(id)->Point(index), s, d));
+    EXPECT_NEAR(d, 0.0, 1e-6);
+    EXPECT_GT(s, last);
+    last = s;
+  }
+
+  // Only the first and last waypoints of each lane, and a perimeter point
+  // that is skipped.
+  std::vector<rndf::UniqueId> compact =
+  {
+    rndf::UniqueId(1, 2, 1), rndf::UniqueId(1, 2, 4),
+    rndf::UniqueId(14, 0, 1),
+    rndf::UniqueId(3, 1, 1), rndf::UniqueId(3, 1, 3)
+  };
+  FrenetFrame same(cache, compact);
+  EXPECT_EQ(same.Path().NumPoints(), route.size());
+  EXPECT_NEAR(same.Length(), frame.Length(), 1e-9);
+
+  FrenetFrame empty(cache, {rndf::UniqueId(99, 1, 1)});
+  EXPECT_EQ(empty.Path().NumPoints(), 0u);
+}
@@ -0,0 +1,275 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <ignition/math/Helpers.hh>
+#include <ignition/math/SphericalCoordinates.hh>
+
+#include "manifold/rndf/Waypoint.hh"
+#include "manifold/GreatCircle.hh"
+#include "Common.hh"
+#include "VectorMath.hh"
+
+using namespace manifold;
+
+namespace
+{
+  /// \internal
+  /// \brief Number of pairs computed at a time, so the intermediate
+  /// arrays stay in the L1 cache.
+  const size_t kBlock = 256;
+
+  /// \internal
+  /// \brief Haversine distances of a block of pairs.
+  /// \param[in] _halfDLat Half the difference of latitudes (radians).
+  /// \param[in] _halfDLon Half the difference of longitudes (radians).
+  /// \param[in] _cosProduct Product of the cosines of the latitudes.
+  /// \param[in] _count Number of pairs, up to kBlock.
+  /// \param[out] _distances Distance of each pair (meters).
+  void haversine(const double *_halfDLat, const double *_halfDLon,
+                 const double *_cosProduct, const size_t _count,
+                 double *_distances)
+  {
+    double sinLat[kBlock];
+    double cosLat[kBlock];
+    double sinLon[kBlock];
+    double cosLon[kBlock];
+    VectorMath::SinCos(_halfDLat, _count, sinLat, cosLat);
+    VectorMath::SinCos(_halfDLon, _count, sinLon, cosLon);
+
+    // Rounding can push the haversine slightly above 1 for antipodes.
+    for (size_t i = 0; i < _count; ++i)
+    {
+      double a = sinLat[i] * sinLat[i] +
+        (sinLon[i] * sinLon[i]) * _cosProduct[i];
+      _distances[i] = std::sqrt(std::min(a, 1.0));
+    }
+
+    VectorMath::Asin(_distances, _count, _distances);
+    for (size_t i = 0; i < _count; ++i)
+      _distances[i] *= 2 * kEarthRadius;
+  }
+
+  /// \internal
+  /// \brief Convert a block of latitudes to radians and get their
+  /// cosines.
+  /// \param[in] _degrees The latitudes (degrees).
+  /// \param[in] _count Number of latitudes, up to kBlock + 1.
+  /// \param[out] _radians The latitudes (radians).
+  /// \param[out] _cos Cosine of each latitude.
+  void latitudes(const double *_degrees, const size_t _count,
+                 double *_radians, double *_cos)
+  {
+    double sines[kBlock + 1];
+    for (size_t i = 0; i < _count; ++i)
+      _radians[i] = IGN_DTOR(_degrees[i]);
+    VectorMath::SinCos(_radians, _count, sines, _cos);
+  }
+
+  /// \internal
+  /// \brief Distances from a location to many others.
+  /// \param[in] _lat0 Latitude of the location (radians).
+  /// \param[in] _lon0 Longitude of the location (radians).
+  /// \param[in] _cos0 Cosine of the latitude of the location.
+  /// \param[in] _lat Latitudes of the others (radians).
+  /// \param[in] _lon Longitudes of the others (degrees).
+  /// \param[in] _cos Cosines of the latitudes of the others.
+  /// \param[in] _count Number of other locations, up to kBlock.
+  /// \param[out] _distances Distance to each of the others (meters).
+  void fromLocation(const double _lat0, const double _lon0,
+                    const double _cos0, const double *_lat,
+                    const double *_lon, const double *_cos,
+                    const size_t _count, double *_distances)
+  {
+    double halfDLat[kBlock];
+    double halfDLon[kBlock];
+    double cosProduct[kBlock];
+    for (size_t i = 0; i < _count; ++i)
+    {
+      halfDLat[i] = (_lat[i] - _lat0) * 0.5;
+      halfDLon[i] = (IGN_DTOR(_lon[i]) - _lon0) * 0.5;
+      cosProduct[i] = _cos0 * _cos[i];
+    }
+    haversine(halfDLat, halfDLon, cosProduct, _count, _distances);
+  }
+
+  /// \internal
+  /// \brief Check that the arrays of latitudes and longitudes match.
+  /// \param[in] _function Name of the function called.
+  /// \param[in] _latitudes The latitudes.
+  /// \param[in] _longitudes The longitudes.
+  /// \return True if they have the same size.
+  bool sameSize(const std::string &_function,
+                const std::vector<double> &_latitudes,
+                const std::vector<double> &_longitudes)
+  {
+    if (_latitudes.size() == _longitudes.size())
+      return true;
+
+    std::cerr << "GreatCircle::" << _function << "() Invalid number of "
+              << "longitudes [" << _longitudes.size() << "]" << std::endl;
+    return false;
+  }
+}
+
+//////////////////////////////////////////////////
+bool GreatCircle::Vectorized()
+{
+  return VectorMath::Vectorized();
+}
+
+//////////////////////////////////////////////////
+void GreatCircle::Coordinates(const std::vector<rndf::Waypoint> &_waypoints,
+  std::vector<double> &_latitudes, std::vector<double> &_longitudes)
+{
+  _latitudes.clear();
+  _longitudes.clear();
+  _latitudes.reserve(_waypoints.size());
+  _longitudes.reserve(_waypoints.size());
+  for (auto const &waypoint : _waypoints)
+  {
+    _latitudes.push_back(waypoint.Location().LatitudeReference().Degree());
+    _longitudes.push_back(waypoint.Location().LongitudeReference().Degree());
+  }
+}
+
+//////////////////////////////////////////////////
+double GreatCircle::Distance(const double _latA, const double _lonA,
+  const double _latB, const double _lonB)
+{
+  double latA = IGN_DTOR(_latA);
+  double latB = IGN_DTOR(_latB);
+  double sinA;
+  double cosA;
+  double sinB;
+  double cosB;
+  VectorMath::SinCos(latA, sinA, cosA);
+  VectorMath::SinCos(latB, sinB, cosB);
+
+  double halfDLat = (latB - latA) * 0.5;
+  double halfDLon = (IGN_DTOR(_lonB) - IGN_DTOR(_lonA)) * 0.5;
+  double cosProduct = cosA * cosB;
+  double distance;
+  haversine(&halfDLat, &halfDLon, &cosProduct, 1, &distance);
+  return distance;
+}
+
+//////////////////////////////////////////////////
+bool GreatCircle::Consecutive(const std::vector<double> &_latitudes,
+  const std::vector<double> &_longitudes, std::vector<double> &_distances)
+{
+  if (!sameSize("Consecutive", _latitudes, _longitudes))
+    return false;
+
+  _distances.clear();
+  if (_latitudes.size() < 2)
+    return true;
+
+  const size_t n = _latitudes.size() - 1;
+  _distances.resize(n);
+  double lat[kBlock + 1];
+  double cosLat[kBlock + 1];
+  double halfDLat[kBlock];
+  double halfDLon[kBlock];
+  double cosProduct[kBlock];
+  for (size_t start = 0; start < n; start += kBlock)
+  {
+    // The pairs of the block share their ends.
+    const size_t count = std::min(kBlock, n - start);
+    latitudes(&_latitudes[start], count + 1, lat, cosLat);
+    for (size_t i = 0; i < count; ++i)
+    {
+      halfDLat[i] = (lat[i + 1] - lat[i]) * 0.5;
+      halfDLon[i] = (IGN_DTOR(_longitudes[start + i + 1]) -
+        IGN_DTOR(_longitudes[start + i])) * 0.5;
+      cosProduct[i] = cosLat[i] * cosLat[i + 1];
+    }
+    haversine(halfDLat, halfDLon, cosProduct, count, &_distances[start]);
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool GreatCircle::OneToMany(const double _latitude, const double _longitude,
+  const std::vector<double> &_latitudes,
+  const std::vector<double> &_longitudes, std::vector<double> &_distances)
+{
+  if (!sameSize("OneToMany", _latitudes, _longitudes))
+    return false;
+
+  double lat0 = IGN_DTOR(_latitude);
+  double sin0;
+  double cos0;
+  VectorMath::SinCos(lat0, sin0, cos0);
+
+  const size_t n = _latitudes.size();
+  _distances.resize(n);
+  double lat[kBlock];
+  double cosLat[kBlock];
+  for (size_t start = 0; start < n; start += kBlock)
+  {
+    const size_t count = std::min(kBlock, n - start);
+    latitudes(&_latitudes[start], count, lat, cosLat);
+    fromLocation(lat0, IGN_DTOR(_longitude), cos0, lat, &_longitudes[start],
+                 cosLat, count, &_distances[start]);
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool GreatCircle::ManyToMany(const std::vector<double> &_latitudesA,
+  const std::vector<double> &_longitudesA,
+  const std::vector<double> &_latitudesB,
+  const std::vector<double> &_longitudesB, std::vector<double> &_distances)
+{
+  if (!sameSize("ManyToMany", _latitudesA, _longitudesA) ||
+      !sameSize("ManyToMany", _latitudesB, _longitudesB))
+  {
+    return false;
+  }
+
+  // Convert the columns once, block by block.
+  const size_t columns = _latitudesB.size();
+  std::vector<double> latB(columns);
+  std::vector<double> cosB(columns);
+  for (size_t start = 0; start < columns; start += kBlock)
+  {
+    latitudes(&_latitudesB[start], std::min(kBlock, columns - start),
+              &latB[start], &cosB[start]);
+  }
+
+  _distances.resize(_latitudesA.size() * columns);
+  for (size_t row = 0; row < _latitudesA.size(); ++row)
+  {
+    double lat0 = IGN_DTOR(_latitudesA[row]);
+    double lon0 = IGN_DTOR(_longitudesA[row]);
+    double sin0;
+    double cos0;
+    VectorMath::SinCos(lat0, sin0, cos0);
+    for (size_t start = 0; start < columns; start += kBlock)
+    {
+      fromLocation(lat0, lon0, cos0, &latB[start], &_longitudesB[start],
+                   &cosB[start], std::min(kBlock, columns - start),
+                   &_distances[row * columns + start]);
+    }
+  }
+  return true;
+}
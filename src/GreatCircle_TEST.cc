@@ -0,0 +1,211 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <cmath>
+#include <random>
+#include <vector>
+#include <ignition/math/Angle.hh>
+#include <ignition/math/Helpers.hh>
+#include <ignition/math/SphericalCoordinates.hh>
+
+#include "manifold/rndf/Lane.hh"
+#include "manifold/rndf/Waypoint.hh"
+#include "manifold/GreatCircle.hh"
+#include "gtest/gtest.h"
+
+using namespace manifold;
+
+/// \brief Reference distance between two locations.
+/// \param[in] _latA Latitude of the first location (degrees).
+/// \param[in] _lonA Longitude of the first location (degrees).
+/// \param[in] _latB Latitude of the second location (degrees).
+/// \param[in] _lonB Longitude of the second location (degrees).
+/// \return The distance (meters).
+double reference(const double _latA, const double _lonA, const double _latB,
+                 const double _lonB)
+{
+  return ignition::math::SphericalCoordinates::Distance(
+    ignition::math::Angle(IGN_DTOR(_latA)),
+    ignition::math::Angle(IGN_DTOR(_lonA)),
+    ignition::math::Angle(IGN_DTOR(_latB)),
+    ignition::math::Angle(IGN_DTOR(_lonB)));
+}
+
+/// \brief Whether a distance matches the reference: within a micrometer,
+/// or a few ulps of the distance.
+/// \param[in] _distance The distance.
+/// \param[in] _expected The reference.
+/// \return True if they match.
+bool matches(const double _distance, const double _expected)
+{
+  return std::abs(_distance - _expected) <=
+    std::max(1e-6, 1e-14 * _expected);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the distance between single locations.
+TEST(GreatCircle, Distance)
+{
+  EXPECT_NEAR(GreatCircle::Distance(37.0, -122.0, 37.0, -122.0), 0.0, 1e-9);
+
+  // One degree along a meridian.
+  EXPECT_NEAR(GreatCircle::Distance(0.0, 0.0, 1.0, 0.0),
+              6371000.0 * IGN_PI / 180, 1e-6);
+
+  // Across the antimeridian.
+  EXPECT_NEAR(GreatCircle::Distance(0.0, 179.9995, 0.0, -179.9995),
+              reference(0.0, 179.9995, 0.0, -179.9995), 1e-6);
+
+  // Antipodes.
+  double half = GreatCircle::Distance(10.0, 20.0, -10.0, -160.0);
+  EXPECT_FALSE(std::isnan(half));
+  EXPECT_NEAR(half, 6371000.0 * IGN_PI, 1e-3);
+
+  std::mt19937 generator(7);
+  std::uniform_real_distribution<double> lat(-89.0, 89.0);
+  std::uniform_real_distribution<double> lon(-180.0, 180.0);
+  std::uniform_real_distribution<double> offset(-0.01, 0.01);
+  for (int i = 0; i < 10000; ++i)
+  {
+    double latA = lat(generator);
+    double lonA = lon(generator);
+
+    // Far away and nearby.
+    double latB = lat(generator);
+    double lonB = lon(generator);
+    EXPECT_TRUE(matches(GreatCircle::Distance(latA, lonA, latB, lonB),
+                        reference(latA, lonA, latB, lonB)));
+    latB = latA + offset(generator);
+    lonB = lonA + offset(generator);
+    EXPECT_TRUE(matches(GreatCircle::Distance(latA, lonA, latB, lonB),
+                        reference(latA, lonA, latB, lonB)));
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the batch functions against the single distances.
+TEST(GreatCircle, Batch)
+{
+  std::mt19937 generator(8);
+  std::uniform_real_distribution<double> offset(-0.5, 0.5);
+
+  // An odd number, so both the SIMD and the scalar loops run.
+  std::vector<double> lat;
+  std::vector<double> lon;
+  for (int i = 0; i < 601; ++i)
+  {
+    lat.push_back(37.0 + offset(generator));
+    lon.push_back(-122.0 + offset(generator));
+  }
+
+  std::vector<double> distances;
+  ASSERT_TRUE(GreatCircle::Consecutive(lat, lon, distances));
+  ASSERT_EQ(distances.size(), lat.size() - 1);
+  for (size_t i = 0; i + 1 < lat.size(); ++i)
+  {
+    EXPECT_DOUBLE_EQ(distances[i],
+      GreatCircle::Distance(lat[i], lon[i], lat[i + 1], lon[i + 1]));
+    EXPECT_TRUE(matches(distances[i],
+      reference(lat[i], lon[i], lat[i + 1], lon[i + 1])));
+  }
+
+  ASSERT_TRUE(GreatCircle::OneToMany(37.1, -122.1, lat, lon, distances));
+  ASSERT_EQ(distances.size(), lat.size());
+  for (size_t i = 0; i < lat.size(); ++i)
+  {
+    EXPECT_DOUBLE_EQ(distances[i],
+      GreatCircle::Distance(37.1, -122.1, lat[i], lon[i]));
+    EXPECT_TRUE(matches(distances[i], reference(37.1, -122.1, lat[i],
+                                                lon[i])));
+  }
+
+  std::vector<double> latA(lat.begin(), lat.begin() + 7);
+  std::vector<double> lonA(lon.begin(), lon.begin() + 7);
+  ASSERT_TRUE(GreatCircle::ManyToMany(latA, lonA, lat, lon, distances));
+  ASSERT_EQ(distances.size(), latA.size() * lat.size());
+  for (size_t i = 0; i < latA.size(); ++i)
+  {
+    for (size_t j = 0; j < lat.size(); ++j)
+    {
+      EXPECT_DOUBLE_EQ(distances[i * lat.size() + j],
+        GreatCircle::Distance(latA[i], lonA[i], lat[j], lon[j]));
+    }
+    EXPECT_NEAR(distances[i * lat.size() + i], 0.0, 1e-9);
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the edge cases of the batch functions.
+TEST(GreatCircle, Edges)
+{
+  std::vector<double> distances = {1.0};
+  EXPECT_TRUE(GreatCircle::Consecutive({}, {}, distances));
+  EXPECT_TRUE(distances.empty());
+  EXPECT_TRUE(GreatCircle::Consecutive({37.0}, {-122.0}, distances));
+  EXPECT_TRUE(distances.empty());
+  EXPECT_TRUE(GreatCircle::OneToMany(37.0, -122.0, {}, {}, distances));
+  EXPECT_TRUE(distances.empty());
+  EXPECT_TRUE(GreatCircle::ManyToMany({37.0}, {-122.0}, {}, {}, distances));
+  EXPECT_TRUE(distances.empty());
+
+  // The arrays must have the same size.
+  EXPECT_FALSE(GreatCircle::Consecutive({37.0, 37.1}, {-122.0}, distances));
+  EXPECT_FALSE(GreatCircle::OneToMany(37.0, -122.0, {37.0}, {}, distances));
+  EXPECT_FALSE(GreatCircle::ManyToMany({37.0}, {}, {37.0}, {-122.0},
+                                       distances));
+  EXPECT_FALSE(GreatCircle::ManyToMany({37.0}, {-122.0}, {37.0}, {},
+                                       distances));
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the length of a lane.
+TEST(GreatCircle, Lane)
+{
+  rndf::Lane lane(1);
+  for (int w = 0; w < 5; ++w)
+  {
+    lane.AddWaypoint(rndf::Waypoint(w + 1,
+      ignition::math::SphericalCoordinates(
+        ignition::math::SphericalCoordinates::EARTH_WGS84,
+        ignition::math::Angle(IGN_DTOR(37.0 + w * 1e-3)),
+        ignition::math::Angle(IGN_DTOR(-122.0)),
+        0.0, ignition::math::Angle::Zero)));
+  }
+
+  std::vector<double> lat;
+  std::vector<double> lon;
+  GreatCircle::Coordinates(lane.Waypoints(), lat, lon);
+  ASSERT_EQ(lat.size(), 5u);
+  ASSERT_EQ(lon.size(), 5u);
+  EXPECT_NEAR(lat[2], 37.002, 1e-12);
+  EXPECT_NEAR(lon[2], -122.0, 1e-12);
+
+  std::vector<double> distances;
+  ASSERT_TRUE(GreatCircle::Consecutive(lat, lon, distances));
+  ASSERT_EQ(distances.size(), 4u);
+  double length = 0;
+  for (auto const &distance : distances)
+    length += distance;
+  EXPECT_NEAR(length, 6371000.0 * IGN_DTOR(4e-3), 1e-6);
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,233 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+#include <ignition/math/SphericalCoordinates.hh>
+
+#include "manifold/rndf/Lane.hh"
+#include "manifold/rndf/Segment.hh"
+#include "manifold/rndf/UniqueId.hh"
+#include "manifold/rndf/Waypoint.hh"
+#include "Common.hh"
+#include "LaneChanges.hh"
+#include "SpatialGrid.hh"
+
+using namespace manifold;
+
+namespace
+{
+  /// \internal
+  /// \brief A straight piece of a lane between two consecutive waypoints,
+  /// in a local tangent plane (meters).
+  class Piece
+  {
+    /// \brief Index of the lane in the segment.
+    public: size_t lane;
+
+    /// \brief Index of the first waypoint of the piece in the lane.
+    public: size_t first;
+
+    /// \brief Start of the piece.
+    public: double x0;
+
+    /// \brief Start of the piece.
+    public: double y0;
+
+    /// \brief End of the piece.
+    public: double x1;
+
+    /// \brief End of the piece.
+    public: double y1;
+  };
+
+  /// \internal
+  /// \brief The closest candidate lane on one side of a waypoint.
+  class Candidate
+  {
+    /// \brief Index of the piece of the adjacent lane, or -1 if none.
+    public: int piece = -1;
+
+    /// \brief Lateral distance (meters).
+    public: double distance = 0;
+  };
+
+  /// \internal
+  /// \brief Minimum cosine of the angle between parallel lanes (30 deg).
+  const double kMinParallel = 0.866;
+
+  /// \internal
+  /// \brief Whether a lane marking allows crossing it.
+  /// \param[in] _marking The marking.
+  /// \return 1 if it's allowed, -1 if it's forbidden or 0 if unknown.
+  int crossing(const rndf::Marking _marking)
+  {
+    switch (_marking)
+    {
+      case rndf::Marking::BROKEN_WHITE:
+        return 1;
+      case rndf::Marking::UNDEFINED:
+        return 0;
+      default:
+        return -1;
+    }
+  }
+
+  /// \internal
+  /// \brief Width of a lane.
+  /// \param[in] _lane The lane.
+  /// \return The width (meters).
+  double width(const rndf::Lane &_lane)
+  {
+    return _lane.Width() > 0 ? _lane.Width() : kDefaultLaneWidth;
+  }
+}
+
+//////////////////////////////////////////////////
+void manifold::laneChanges(const rndf::Segment &_segment,
+  std::vector<LaneChange> &_changes)
+{
+  _changes.clear();
+  auto const &lanes = _segment.Lanes();
+  if (lanes.size() < 2)
+    return;
+
+  // Project all the waypoints on a plane tangent to the first one.
+  std::vector<std::vector<std::pair<double, double>>> points(lanes.size());
+  bool hasOrigin = false;
+  double lat0 = 0;
+  double lon0 = 0;
+  double maxWidth = 0;
+  for (size_t l = 0; l < lanes.size(); ++l)
+  {
+    maxWidth = std::max(maxWidth, width(lanes[l]));
+    for (auto const &waypoint : lanes[l].Waypoints())
+    {
+      double lat = waypoint.Location().LatitudeReference().Radian();
+      double lon = waypoint.Location().LongitudeReference().Radian();
+      if (!hasOrigin)
+      {
+        lat0 = lat;
+        lon0 = lon;
+        hasOrigin = true;
+      }
+      points[l].push_back(std::make_pair(
+        kEarthRadius * (lon - lon0) * std::cos(lat0),
+        kEarthRadius * (lat - lat0)));
+    }
+  }
+
+  // Index the pieces of all the lanes.
+  const double radius = 2 * maxWidth;
+  SpatialGrid grid(radius);
+  std::vector<Piece> pieces;
+  for (size_t l = 0; l < lanes.size(); ++l)
+  {
+    for (size_t i = 0; i + 1 < points[l].size(); ++i)
+    {
+      Piece piece = {l, i, points[l][i].first, points[l][i].second,
+        points[l][i + 1].first, points[l][i + 1].second};
+      grid.Insert(pieces.size(),
+        std::min(piece.x0, piece.x1), std::min(piece.y0, piece.y1),
+        std::max(piece.x0, piece.x1), std::max(piece.y0, piece.y1));
+      pieces.push_back(piece);
+    }
+  }
+
+  std::vector<size_t> nearby;
+  for (size_t l = 0; l < lanes.size(); ++l)
+  {
+    auto const &lane = lanes[l];
+    auto const &lanePoints = points[l];
+    for (size_t i = 0; i < lanePoints.size() && lanePoints.size() > 1; ++i)
+    {
+      // Direction of the lane at the waypoint.
+      size_t from = std::min(i, lanePoints.size() - 2);
+      double dx = lanePoints[from + 1].first - lanePoints[from].first;
+      double dy = lanePoints[from + 1].second - lanePoints[from].second;
+      double length = std::hypot(dx, dy);
+      if (length <= 0)
+        continue;
+      dx /= length;
+      dy /= length;
+
+      double px = lanePoints[i].first;
+      double py = lanePoints[i].second;
+      grid.Query(px - radius, py - radius, px + radius, py + radius, nearby);
+
+      // Closest lane on the left [0] and on the right [1].
+      Candidate sides[2];
+      for (auto const &p : nearby)
+      {
+        auto const &piece = pieces[p];
+        if (piece.lane == l)
+          continue;
+
+        double ex = piece.x1 - piece.x0;
+        double ey = piece.y1 - piece.y0;
+        double squared = ex * ex + ey * ey;
+        if (squared <= 0 ||
+            (dx * ex + dy * ey) < kMinParallel * std::sqrt(squared))
+        {
+          continue;
+        }
+
+        // Projection of the waypoint on the piece.
+        double t = ((px - piece.x0) * ex + (py - piece.y0) * ey) / squared;
+        if (t < 0 || t > 1)
+          continue;
+
+        double qx = piece.x0 + t * ex - px;
+        double qy = piece.y0 + t * ey - py;
+        double lateral = dx * qy - dy * qx;
+        double distance = std::abs(lateral);
+        if (distance > width(lane) + width(lanes[piece.lane]))
+          continue;
+
+        auto &side = sides[lateral > 0 ? 0 : 1];
+        if (side.piece < 0 || distance < side.distance)
+        {
+          side.piece = static_cast<int>(p);
+          side.distance = distance;
+        }
+      }
+
+      for (int s = 0; s < 2; ++s)
+      {
+        if (sides[s].piece < 0)
+          continue;
+
+        auto const &piece = pieces[sides[s].piece];
+        auto const &other = lanes[piece.lane];
+        int own = crossing(s == 0 ? lane.LeftBoundary() : lane.RightBoundary());
+        int theirs =
+          crossing(s == 0 ? other.RightBoundary() : other.LeftBoundary());
+        if (own < 0 || theirs < 0 || own + theirs == 0)
+          continue;
+
+        LaneChange change;
+        change.tail = rndf::UniqueId(_segment.Id(), lane.Id(),
+          lane.Waypoints()[i].Id());
+        change.head = rndf::UniqueId(_segment.Id(), other.Id(),
+          other.Waypoints()[piece.first + 1].Id());
+        _changes.push_back(change);
+      }
+    }
+  }
+}
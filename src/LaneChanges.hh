@@ -0,0 +1,59 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef MANIFOLD_LANECHANGES_HH_
+#define MANIFOLD_LANECHANGES_HH_
+
+#include <vector>
+
+#include "manifold/rndf/UniqueId.hh"
+
+namespace manifold
+{
+  namespace rndf
+  {
+    class Segment;
+  }
+
+  /// \internal
+  /// \brief A lateral move from a waypoint to a waypoint of a parallel lane.
+  class LaneChange
+  {
+    /// \brief Waypoint where the lane change starts.
+    public: rndf::UniqueId tail;
+
+    /// \brief Waypoint of the adjacent lane where the lane change ends.
+    public: rndf::UniqueId head;
+  };
+
+  /// \internal
+  /// \brief Detect the lane changes allowed within a segment.
+  /// Two lanes are adjacent at a waypoint if the other lane runs in the
+  /// same direction (within 30 degrees) and is the closest one on that side,
+  /// at a lateral distance below the sum of both lane widths. The change is
+  /// allowed if no lane has a solid or double marking on the shared
+  /// boundary and at least one of them marks it as broken white. The lane
+  /// change ends at the first waypoint of the adjacent lane ahead of the
+  /// projection of the starting waypoint. The pieces of the lanes are
+  /// hashed in a uniform grid, so the cost is linear in the number of
+  /// waypoints for typical segments.
+  /// \param[in] _segment The segment.
+  /// \param[out] _changes The lane changes found.
+  void laneChanges(const rndf::Segment &_segment,
+                   std::vector<LaneChange> &_changes);
+}
+#endif
@@ -0,0 +1,536 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include <ignition/math/SphericalCoordinates.hh>
+#include <ignition/math/Vector3.hh>
+
+#include "manifold/rndf/Lane.hh"
+#include "manifold/rndf/RNDF.hh"
+#include "manifold/rndf/Segment.hh"
+#include "manifold/rndf/UniqueId.hh"
+#include "manifold/rndf/Waypoint.hh"
+#include "manifold/EnuProjection.hh"
+#include "manifold/LaneCorridors.hh"
+#include "Common.hh"
+#include "SpatialGrid.hh"
+
+using namespace manifold;
+
+namespace
+{
+  /// \internal
+  /// \brief Length of the side of a cell of the grid (meters).
+  const double kCellSize = 25.0;
+
+  /// \internal
+  /// \brief Minimum cosine between the bisector of a join and the normal
+  /// of its pieces, which limits the miter to twice the half width.
+  const double kMinMiterCos = 0.5;
+
+  /// \internal
+  /// \brief Default origin of the frame of an RNDF: its first waypoint.
+  /// \param[in] _rndf The RNDF.
+  /// \return The origin.
+  ignition::math::SphericalCoordinates firstLocation(const rndf::RNDF &_rndf)
+  {
+    for (auto const &segment : _rndf.Segments())
+    {
+      for (auto const &lane : segment.Lanes())
+      {
+        if (!lane.Waypoints().empty())
+          return lane.Waypoints().front().Location();
+      }
+    }
+    return ignition::math::SphericalCoordinates();
+  }
+
+  /// \internal
+  /// \brief Sign of the area of a triangle.
+  /// \param[in] _ax X of the first vertex.
+  /// \param[in] _ay Y of the first vertex.
+  /// \param[in] _bx X of the second vertex.
+  /// \param[in] _by Y of the second vertex.
+  /// \param[in] _cx X of the third vertex.
+  /// \param[in] _cy Y of the third vertex.
+  /// \return 1 if counterclockwise, -1 if clockwise or 0 if collinear.
+  int orientation(const double _ax, const double _ay, const double _bx,
+                  const double _by, const double _cx, const double _cy)
+  {
+    double cross = (_bx - _ax) * (_cy - _ay) - (_by - _ay) * (_cx - _ax);
+    return (cross > 0) - (cross < 0);
+  }
+
+  /// \internal
+  /// \brief Whether two segments intersect, touching included.
+  /// \param[in] _p Coordinates of the ends of the first segment (x0, y0,
+  /// x1, y1).
+  /// \param[in] _q Coordinates of the ends of the second segment.
+  /// \return True if they intersect.
+  bool segmentsIntersect(const double _p[4], const double _q[4])
+  {
+    int o1 = orientation(_p[0], _p[1], _p[2], _p[3], _q[0], _q[1]);
+    int o2 = orientation(_p[0], _p[1], _p[2], _p[3], _q[2], _q[3]);
+    int o3 = orientation(_q[0], _q[1], _q[2], _q[3], _p[0], _p[1]);
+    int o4 = orientation(_q[0], _q[1], _q[2], _q[3], _p[2], _p[3]);
+    if (o1 * o2 < 0 && o3 * o4 < 0)
+      return true;
+
+    // Collinear: the boxes must overlap.
+    auto within = [](const double _a, const double _b, const double _v)
+    {
+      return std::min(_a, _b) <= _v && _v <= std::max(_a, _b);
+    };
+    auto onSegment = [&](const double _s[4], const double _x,
+                         const double _y)
+    {
+      return within(_s[0], _s[2], _x) && within(_s[1], _s[3], _y);
+    };
+    return (o1 == 0 && onSegment(_p, _q[0], _q[1])) ||
+           (o2 == 0 && onSegment(_p, _q[2], _q[3])) ||
+           (o3 == 0 && onSegment(_q, _p[0], _p[1])) ||
+           (o4 == 0 && onSegment(_q, _p[2], _p[3]));
+  }
+}
+
+namespace manifold
+{
+  /// \internal
+  /// \brief The corridor of a lane.
+  class Corridor
+  {
+    /// \brief Id of the segment.
+    public: int segment = 0;
+
+    /// \brief Id of the lane.
+    public: int lane = 0;
+
+    /// \brief Id of each waypoint.
+    public: std::vector<int> waypoints;
+
+    /// \brief Left boundary, one point per waypoint.
+    public: std::vector<ignition::math::Vector3d> left;
+
+    /// \brief Right boundary, one point per waypoint.
+    public: std::vector<ignition::math::Vector3d> right;
+
+    /// \brief Index of the first triangle of the lane.
+    public: size_t first = 0;
+
+    /// \brief One past the index of the last triangle of the lane.
+    public: size_t last = 0;
+  };
+
+  /// \internal
+  /// \brief A triangle of a corridor.
+  class Triangle
+  {
+    /// \brief X of the vertexes.
+    public: double x[3];
+
+    /// \brief Y of the vertexes.
+    public: double y[3];
+
+    /// \brief Index of the lane in LaneCorridorsPrivate::lanes.
+    public: size_t lane;
+
+    /// \brief Index of the waypoint where the piece starts.
+    public: size_t piece;
+  };
+
+  /// \internal
+  /// \brief Private data for LaneCorridors class.
+  class LaneCorridorsPrivate
+  {
+    /// \brief Constructor.
+    /// \param[in] _rndf The RNDF.
+    /// \param[in] _origin Origin of the ENU frame.
+    public: LaneCorridorsPrivate(const rndf::RNDF &_rndf,
+                                 const ignition::math::SphericalCoordinates
+                                 &_origin)
+      : origin(_origin)
+    {
+      EnuProjection projection(_origin);
+      std::vector<ignition::math::Vector3d> points;
+      for (auto const &segment : _rndf.Segments())
+      {
+        for (auto const &lane : segment.Lanes())
+        {
+          Corridor corridor;
+          corridor.segment = segment.Id();
+          corridor.lane = lane.Id();
+          for (auto const &waypoint : lane.Waypoints())
+            corridor.waypoints.push_back(waypoint.Id());
+
+          projection.Project(lane.Waypoints(), points);
+          double width = lane.Width() > 0 ? lane.Width() : kDefaultLaneWidth;
+          this->Offset(points, width / 2, corridor);
+
+          this->index[laneKey(rndf::UniqueId(segment.Id(), lane.Id(), 1))] =
+            this->lanes.size();
+          this->lanes.push_back(corridor);
+          this->Triangulate(this->lanes.size() - 1);
+        }
+      }
+    }
+
+    /// \brief Destructor.
+    public: virtual ~LaneCorridorsPrivate() = default;
+
+    /// \brief Compute the boundaries of a corridor.
+    /// \param[in] _points The centerline.
+    /// \param[in] _halfWidth Half the width of the lane.
+    /// \param[in,out] _corridor The corridor.
+    public: void Offset(const std::vector<ignition::math::Vector3d> &_points,
+                        const double _halfWidth, Corridor &_corridor) const
+    {
+      // Left normal of each piece. Pieces without length take the one of
+      // the previous piece, or of the first piece with length at the start.
+      const size_t n = _points.size();
+      std::vector<ignition::math::Vector3d> normals(n > 1 ? n - 1 : 0);
+      size_t firstValid = normals.size();
+      for (size_t i = 0; i < normals.size(); ++i)
+      {
+        auto delta = _points[i + 1] - _points[i];
+        double length = delta.Length();
+        if (length > 0)
+        {
+          normals[i] = ignition::math::Vector3d(-delta.Y(), delta.X(), 0) *
+            (1.0 / length);
+          firstValid = std::min(firstValid, i);
+        }
+        else if (i > 0)
+          normals[i] = normals[i - 1];
+      }
+      if (firstValid < normals.size())
+      {
+        for (size_t i = 0; i < firstValid; ++i)
+          normals[i] = normals[firstValid];
+      }
+
+      for (size_t i = 0; i < n; ++i)
+      {
+        ignition::math::Vector3d offset;
+        if (!normals.empty())
+        {
+          auto const &before = normals[i == 0 ? 0 : i - 1];
+          auto const &after = normals[std::min(i, normals.size() - 1)];
+          auto bisector = before + after;
+          double length = bisector.Length();
+
+          // A reversal keeps the normal of the next piece.
+          if (length < 1e-9)
+            offset = after * _halfWidth;
+          else
+          {
+            bisector = bisector * (1.0 / length);
+            offset = bisector * (_halfWidth /
+              std::max(bisector.Dot(after), kMinMiterCos));
+          }
+        }
+        _corridor.left.push_back(_points[i] + offset);
+        _corridor.right.push_back(_points[i] - offset);
+      }
+    }
+
+    /// \brief Split the pieces of a corridor with length in triangles and
+    /// add them to the grid.
+    /// \param[in] _lane Index of the lane.
+    public: void Triangulate(const size_t _lane)
+    {
+      auto &corridor = this->lanes[_lane];
+      corridor.first = this->triangles.size();
+      auto const &l = corridor.left;
+      auto const &r = corridor.right;
+      for (size_t i = 0; i + 1 < l.size(); ++i)
+      {
+        if (!((l[i + 1] - l[i]).Length() > 0) &&
+            !((r[i + 1] - r[i]).Length() > 0))
+        {
+          continue;
+        }
+
+        const ignition::math::Vector3d *vertexes[2][3] =
+          {{&r[i], &r[i + 1], &l[i + 1]}, {&r[i], &l[i + 1], &l[i]}};
+        for (auto const &v : vertexes)
+        {
+          Triangle triangle;
+          for (int k = 0; k < 3; ++k)
+          {
+            triangle.x[k] = v[k]->X();
+            triangle.y[k] = v[k]->Y();
+          }
+          triangle.lane = _lane;
+          triangle.piece = i;
+          this->grid.Insert(this->triangles.size(),
+            *std::min_element(triangle.x, triangle.x + 3),
+            *std::min_element(triangle.y, triangle.y + 3),
+            *std::max_element(triangle.x, triangle.x + 3),
+            *std::max_element(triangle.y, triangle.y + 3));
+          this->triangles.push_back(triangle);
+        }
+      }
+      corridor.last = this->triangles.size();
+    }
+
+    /// \brief Whether a triangle contains a point, boundary included.
+    /// \param[in] _t Index of the triangle.
+    /// \param[in] _x X of the point.
+    /// \param[in] _y Y of the point.
+    /// \return True if it does.
+    public: bool Contains(const size_t _t, const double _x,
+                          const double _y) const
+    {
+      auto const &t = this->triangles[_t];
+      int o0 = orientation(t.x[0], t.y[0], t.x[1], t.y[1], _x, _y);
+      int o1 = orientation(t.x[1], t.y[1], t.x[2], t.y[2], _x, _y);
+      int o2 = orientation(t.x[2], t.y[2], t.x[0], t.y[0], _x, _y);
+      bool negative = o0 < 0 || o1 < 0 || o2 < 0;
+      bool positive = o0 > 0 || o1 > 0 || o2 > 0;
+      return !(negative && positive);
+    }
+
+    /// \brief Whether a segment intersects a triangle.
+    /// \param[in] _t Index of the triangle.
+    /// \param[in] _segment Coordinates of the ends (x0, y0, x1, y1).
+    /// \return True if it does.
+    public: bool Intersects(const size_t _t, const double _segment[4]) const
+    {
+      if (this->Contains(_t, _segment[0], _segment[1]) ||
+          this->Contains(_t, _segment[2], _segment[3]))
+      {
+        return true;
+      }
+
+      auto const &t = this->triangles[_t];
+      for (int k = 0; k < 3; ++k)
+      {
+        double edge[4] = {t.x[k], t.y[k], t.x[(k + 1) % 3], t.y[(k + 1) % 3]};
+        if (segmentsIntersect(_segment, edge))
+          return true;
+      }
+      return false;
+    }
+
+    /// \brief Unique Id of the piece of a triangle.
+    /// \param[in] _t Index of the triangle.
+    /// \return Unique Id of the first waypoint of the piece.
+    public: rndf::UniqueId Id(const size_t _t) const
+    {
+      auto const &t = this->triangles[_t];
+      auto const &corridor = this->lanes[t.lane];
+      return rndf::UniqueId(corridor.segment, corridor.lane,
+                            corridor.waypoints[t.piece]);
+    }
+
+    /// \brief Find a lane.
+    /// \param[in] _id Unique Id of the lane or one of its waypoints.
+    /// \return The corridor or nullptr if the lane doesn't exist.
+    public: const Corridor *Find(const rndf::UniqueId &_id) const
+    {
+      auto it = this->index.find(laneKey(_id));
+      return it == this->index.end() ? nullptr : &this->lanes[it->second];
+    }
+
+    /// \brief Origin of the frame.
+    public: ignition::math::SphericalCoordinates origin;
+
+    /// \brief Corridor of each lane.
+    public: std::vector<Corridor> lanes;
+
+    /// \brief Index in lanes of each lane, keyed by segment and lane Id.
+    public: std::unordered_map<uint64_t, size_t> index;
+
+    /// \brief Triangles of all the corridors, grouped by lane.
+    public: std::vector<Triangle> triangles;
+
+    /// \brief Grid of the triangles.
+    public: SpatialGrid grid{kCellSize};
+  };
+}
+
+//////////////////////////////////////////////////
+LaneCorridors::LaneCorridors(const rndf::RNDF &_rndf)
+  : dataPtr(new LaneCorridorsPrivate(_rndf, firstLocation(_rndf)))
+{
+}
+
+//////////////////////////////////////////////////
+LaneCorridors::LaneCorridors(const rndf::RNDF &_rndf,
+  const ignition::math::SphericalCoordinates &_origin)
+  : dataPtr(new LaneCorridorsPrivate(_rndf, _origin))
+{
+}
+
+//////////////////////////////////////////////////
+LaneCorridors::~LaneCorridors()
+{
+}
+
+//////////////////////////////////////////////////
+const ignition::math::SphericalCoordinates &LaneCorridors::Origin() const
+{
+  return this->dataPtr->origin;
+}
+
+//////////////////////////////////////////////////
+size_t LaneCorridors::NumLanes() const
+{
+  return this->dataPtr->lanes.size();
+}
+
+//////////////////////////////////////////////////
+size_t LaneCorridors::NumTriangles() const
+{
+  return this->dataPtr->triangles.size();
+}
+
+//////////////////////////////////////////////////
+bool LaneCorridors::Boundaries(const rndf::UniqueId &_id,
+  std::vector<ignition::math::Vector3d> &_left,
+  std::vector<ignition::math::Vector3d> &_right) const
+{
+  auto corridor = this->dataPtr->Find(_id);
+  if (!corridor)
+    return false;
+
+  _left = corridor->left;
+  _right = corridor->right;
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool LaneCorridors::Triangles(const rndf::UniqueId &_id,
+  std::vector<ignition::math::Vector3d> &_vertices) const
+{
+  auto corridor = this->dataPtr->Find(_id);
+  if (!corridor)
+    return false;
+
+  _vertices.clear();
+  for (size_t t = corridor->first; t < corridor->last; ++t)
+  {
+    auto const &triangle = this->dataPtr->triangles[t];
+    for (int k = 0; k < 3; ++k)
+    {
+      _vertices.push_back(
+        ignition::math::Vector3d(triangle.x[k], triangle.y[k], 0));
+    }
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+size_t LaneCorridors::LanesAt(const ignition::math::Vector3d &_point,
+  std::vector<rndf::UniqueId> &_lanes) const
+{
+  auto &d = *this->dataPtr;
+  _lanes.clear();
+  std::vector<size_t> nearby;
+  d.grid.Query(_point.X(), _point.Y(), _point.X(), _point.Y(), nearby);
+
+  // The triangles are sorted and grouped by lane.
+  size_t lastLane = d.lanes.size();
+  for (auto const &t : nearby)
+  {
+    if (d.triangles[t].lane != lastLane && d.Contains(t, _point.X(),
+                                                      _point.Y()))
+    {
+      lastLane = d.triangles[t].lane;
+      _lanes.push_back(d.Id(t));
+    }
+  }
+  return _lanes.size();
+}
+
+//////////////////////////////////////////////////
+bool LaneCorridors::InLane(const rndf::UniqueId &_id,
+  const ignition::math::Vector3d &_point) const
+{
+  auto &d = *this->dataPtr;
+  auto corridor = d.Find(_id);
+  if (!corridor)
+    return false;
+
+  std::vector<size_t> nearby;
+  d.grid.Query(_point.X(), _point.Y(), _point.X(), _point.Y(), nearby);
+  for (auto const &t : nearby)
+  {
+    if (t >= corridor->first && t < corridor->last &&
+        d.Contains(t, _point.X(), _point.Y()))
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+//////////////////////////////////////////////////
+size_t LaneCorridors::LanesCrossed(const ignition::math::Vector3d &_start,
+  const ignition::math::Vector3d &_end,
+  std::vector<rndf::UniqueId> &_lanes) const
+{
+  auto &d = *this->dataPtr;
+  _lanes.clear();
+  std::vector<size_t> nearby;
+  d.grid.Query(std::min(_start.X(), _end.X()), std::min(_start.Y(), _end.Y()),
+               std::max(_start.X(), _end.X()), std::max(_start.Y(), _end.Y()),
+               nearby);
+
+  const double segment[4] = {_start.X(), _start.Y(), _end.X(), _end.Y()};
+  size_t lastLane = d.lanes.size();
+  for (auto const &t : nearby)
+  {
+    if (d.triangles[t].lane != lastLane && d.Intersects(t, segment))
+    {
+      lastLane = d.triangles[t].lane;
+      _lanes.push_back(d.Id(t));
+    }
+  }
+  return _lanes.size();
+}
+
+//////////////////////////////////////////////////
+bool LaneCorridors::Crosses(const rndf::UniqueId &_id,
+  const ignition::math::Vector3d &_start,
+  const ignition::math::Vector3d &_end) const
+{
+  auto &d = *this->dataPtr;
+  auto corridor = d.Find(_id);
+  if (!corridor)
+    return false;
+
+  std::vector<size_t> nearby;
+  d.grid.Query(std::min(_start.X(), _end.X()), std::min(_start.Y(), _end.Y()),
+               std::max(_start.X(), _end.X()), std::max(_start.Y(), _end.Y()),
+               nearby);
+
+  const double segment[4] = {_start.X(), _start.Y(), _end.X(), _end.Y()};
+  for (auto const &t : nearby)
+  {
+    if (t >= corridor->first && t < corridor->last &&
+        d.Intersects(t, segment))
+    {
+      return true;
+    }
+  }
+  return false;
+}
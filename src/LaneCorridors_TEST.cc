@@ -0,0 +1,279 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <string>
+#include <vector>
+#include <ignition/math/Angle.hh>
+#include <ignition/math/Helpers.hh>
+#include <ignition/math/SphericalCoordinates.hh>
+#include <ignition/math/Vector3.hh>
+
+#include "manifold/rndf/Lane.hh"
+#include "manifold/rndf/RNDF.hh"
+#include "manifold/rndf/Segment.hh"
+#include "manifold/rndf/UniqueId.hh"
+#include "manifold/rndf/Waypoint.hh"
+#include "manifold/EnuProjection.hh"
+#include "manifold/LaneCorridors.hh"
+#include "manifold/test_config.h"
+#include "performance/fixtures.hh"
+#include "gtest/gtest.h"
+
+using namespace manifold;
+using test::location;
+
+/// \brief A point of the ENU frame.
+/// \param[in] _x East (meters).
+/// \param[in] _y North (meters).
+/// \return The point.
+ignition::math::Vector3d point(const double _x, const double _y)
+{
+  return ignition::math::Vector3d(_x, _y, 0);
+}
+
+/// \brief A road with two lanes in the same direction, 3 m apart: lane 1
+/// runs east along latitude 37 and lane 2 north of it. Each lane has 4
+/// waypoints, 1e-3 degrees of longitude (89 m) apart.
+/// \param[in] _width Width of the lanes (meters), or 0 for none.
+/// \param[out] _rndf The RNDF.
+void roadRNDF(const double _width, rndf::RNDF &_rndf)
+{
+  rndf::Segment segment(1);
+  rndf::Lane right(1);
+  rndf::Lane left(2);
+  for (int w = 0; w < 4; ++w)
+  {
+    right.AddWaypoint(
+      rndf::Waypoint(w + 1, location(37.0, -122.0 + w * 1e-3)));
+    left.AddWaypoint(
+      rndf::Waypoint(w + 1, location(37.000027, -122.0 + w * 1e-3)));
+  }
+  if (_width > 0)
+  {
+    EXPECT_TRUE(right.SetWidth(_width));
+    EXPECT_TRUE(left.SetWidth(_width));
+  }
+  segment.AddLane(right);
+  segment.AddLane(left);
+  _rndf.AddSegment(segment);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the corridors of an empty RNDF.
+TEST(LaneCorridors, Empty)
+{
+  rndf::RNDF rndf;
+  LaneCorridors corridors(rndf);
+  EXPECT_EQ(corridors.NumLanes(), 0u);
+  EXPECT_EQ(corridors.NumTriangles(), 0u);
+
+  std::vector<rndf::UniqueId> lanes;
+  EXPECT_EQ(corridors.LanesAt(point(0, 0), lanes), 0u);
+  EXPECT_EQ(corridors.LanesCrossed(point(0, 0), point(10, 10), lanes), 0u);
+  EXPECT_FALSE(corridors.InLane(rndf::UniqueId(1, 1, 1), point(0, 0)));
+  std::vector<ignition::math::Vector3d> left;
+  std::vector<ignition::math::Vector3d> right;
+  EXPECT_FALSE(corridors.Boundaries(rndf::UniqueId(1, 1, 1), left, right));
+  EXPECT_FALSE(corridors.Triangles(rndf::UniqueId(1, 1, 1), left));
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the points in a straight lane.
+TEST(LaneCorridors, Straight)
+{
+  rndf::RNDF rndf;
+  roadRNDF(1.0, rndf);
+  LaneCorridors corridors(rndf);
+  EXPECT_EQ(corridors.NumLanes(), 2u);
+  EXPECT_EQ(corridors.NumTriangles(), 12u);
+  EXPECT_NEAR(corridors.Origin().LatitudeReference().Degree(), 37.0, 1e-9);
+
+  std::vector<ignition::math::Vector3d> left;
+  std::vector<ignition::math::Vector3d> right;
+  ASSERT_TRUE(corridors.Boundaries(rndf::UniqueId(1, 1, 1), left, right));
+  ASSERT_EQ(left.size(), 4u);
+  ASSERT_EQ(right.size(), 4u);
+  EXPECT_NEAR(left[0].X(), 0.0, 1e-3);
+  EXPECT_NEAR(left[0].Y(), 0.5, 1e-3);
+  EXPECT_NEAR(right[0].Y(), -0.5, 1e-3);
+  EXPECT_NEAR(left[3].X(), 267.0, 0.1);
+
+  std::vector<ignition::math::Vector3d> vertexes;
+  ASSERT_TRUE(corridors.Triangles(rndf::UniqueId(1, 1, 7), vertexes));
+  EXPECT_EQ(vertexes.size(), 18u);
+
+  std::vector<rndf::UniqueId> lanes;
+  ASSERT_EQ(corridors.LanesAt(point(50, 0.4), lanes), 1u);
+  EXPECT_EQ(lanes[0], rndf::UniqueId(1, 1, 1));
+  ASSERT_EQ(corridors.LanesAt(point(150, -0.4), lanes), 1u);
+  EXPECT_EQ(lanes[0], rndf::UniqueId(1, 1, 2));
+  ASSERT_EQ(corridors.LanesAt(point(150, 3.0), lanes), 1u);
+  EXPECT_EQ(lanes[0], rndf::UniqueId(1, 2, 2));
+  EXPECT_EQ(corridors.LanesAt(point(50, 0.6), lanes), 0u);
+  EXPECT_EQ(corridors.LanesAt(point(50, 1.5), lanes), 0u);
+  EXPECT_EQ(corridors.LanesAt(point(-1, 0), lanes), 0u);
+  EXPECT_EQ(corridors.LanesAt(point(270, 0), lanes), 0u);
+
+  EXPECT_TRUE(corridors.InLane(rndf::UniqueId(1, 1, 3), point(50, 0.4)));
+  EXPECT_FALSE(corridors.InLane(rndf::UniqueId(1, 2, 1), point(50, 0.4)));
+  EXPECT_FALSE(corridors.InLane(rndf::UniqueId(2, 1, 1), point(50, 0.4)));
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the segments that cross the lanes.
+TEST(LaneCorridors, Segments)
+{
+  rndf::RNDF rndf;
+  roadRNDF(1.0, rndf);
+  LaneCorridors corridors(rndf);
+
+  // Across both lanes.
+  std::vector<rndf::UniqueId> lanes;
+  ASSERT_EQ(corridors.LanesCrossed(point(150, -5), point(150, 5), lanes),
+            2u);
+  EXPECT_EQ(lanes[0], rndf::UniqueId(1, 1, 2));
+  EXPECT_EQ(lanes[1], rndf::UniqueId(1, 2, 2));
+
+  // Inside a lane, along it.
+  ASSERT_EQ(corridors.LanesCrossed(point(10, 0), point(200, 0), lanes), 1u);
+  EXPECT_EQ(lanes[0], rndf::UniqueId(1, 1, 1));
+
+  // Between the lanes, and ending on a boundary.
+  EXPECT_EQ(corridors.LanesCrossed(point(10, 1.5), point(200, 1.5), lanes),
+            0u);
+  EXPECT_EQ(corridors.LanesCrossed(point(20, 1.5), point(20, 2.0), lanes),
+            0u);
+  EXPECT_TRUE(corridors.Crosses(rndf::UniqueId(1, 2, 1), point(20, 1.5),
+                                point(20, 3.0)));
+  EXPECT_FALSE(corridors.Crosses(rndf::UniqueId(1, 1, 1), point(20, 1.5),
+                                 point(20, 3.0)));
+
+  // Diagonal, through a single lane.
+  EXPECT_TRUE(corridors.Crosses(rndf::UniqueId(1, 1, 1), point(80, 1.2),
+                                point(100, -1.2)));
+  EXPECT_FALSE(corridors.Crosses(rndf::UniqueId(1, 1, 1), point(80, 5),
+                                 point(100, 1.2)));
+  EXPECT_FALSE(corridors.Crosses(rndf::UniqueId(3, 1, 1), point(80, 1.2),
+                                 point(100, -1.2)));
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the default width and the overlap of the corridors.
+TEST(LaneCorridors, DefaultWidth)
+{
+  rndf::RNDF rndf;
+  roadRNDF(0.0, rndf);
+  LaneCorridors corridors(rndf, location(37.0, -122.0));
+
+  // 12 feet wide: the lanes overlap between 1.17 and 1.83 m.
+  std::vector<rndf::UniqueId> lanes;
+  EXPECT_EQ(corridors.LanesAt(point(50, 1.0), lanes), 1u);
+  EXPECT_EQ(corridors.LanesAt(point(50, -1.8), lanes), 1u);
+  EXPECT_EQ(corridors.LanesAt(point(50, 4.8), lanes), 1u);
+  EXPECT_EQ(corridors.LanesAt(point(50, -1.9), lanes), 0u);
+  ASSERT_EQ(corridors.LanesAt(point(50, 1.5), lanes), 2u);
+  EXPECT_EQ(lanes[0], rndf::UniqueId(1, 1, 1));
+  EXPECT_EQ(lanes[1], rndf::UniqueId(1, 2, 1));
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the mitered join of a lane turning left.
+TEST(LaneCorridors, Turn)
+{
+  // East for 100 m and then north for 100 m, 4 m wide.
+  const double kLon = 100.0 / 88.9;
+  rndf::Lane lane(1);
+  lane.AddWaypoint(rndf::Waypoint(1, location(37.0, -122.0)));
+  lane.AddWaypoint(rndf::Waypoint(2, location(37.0, -122.0 + kLon * 1e-3)));
+  lane.AddWaypoint(rndf::Waypoint(3, location(37.0009, -122.0 + kLon * 1e-3)));
+  EXPECT_TRUE(lane.SetWidth(4.0));
+  rndf::Segment segment(1);
+  segment.AddLane(lane);
+  rndf::RNDF rndf;
+  rndf.AddSegment(segment);
+
+  LaneCorridors corridors(rndf);
+  EXPECT_EQ(corridors.NumTriangles(), 4u);
+  EnuProjection projection(corridors.Origin());
+  auto corner = projection.Project(lane.Waypoints()[1].Location());
+
+  std::vector<ignition::math::Vector3d> left;
+  std::vector<ignition::math::Vector3d> right;
+  ASSERT_TRUE(corridors.Boundaries(rndf::UniqueId(1, 1, 1), left, right));
+  ASSERT_EQ(left.size(), 3u);
+  EXPECT_NEAR(left[1].X(), corner.X() - 2, 0.05);
+  EXPECT_NEAR(left[1].Y(), corner.Y() + 2, 0.05);
+  EXPECT_NEAR(right[1].X(), corner.X() + 2, 0.05);
+  EXPECT_NEAR(right[1].Y(), corner.Y() - 2, 0.05);
+
+  // The outer corner is covered, up to the miter.
+  auto id = rndf::UniqueId(1, 1, 1);
+  EXPECT_TRUE(corridors.InLane(id, corner + point(1.8, -1.8)));
+  EXPECT_FALSE(corridors.InLane(id, corner + point(2.2, -2.2)));
+  EXPECT_TRUE(corridors.InLane(id, corner + point(-1.8, 1.8)));
+  EXPECT_FALSE(corridors.InLane(id, corner + point(-2.2, 2.2)));
+  EXPECT_TRUE(corridors.InLane(id, corner + point(0, 50)));
+  EXPECT_FALSE(corridors.InLane(id, corner + point(3, 50)));
+
+  std::vector<rndf::UniqueId> lanes;
+  ASSERT_EQ(corridors.LanesAt(corner + point(0, 50), lanes), 1u);
+  EXPECT_EQ(lanes[0], rndf::UniqueId(1, 1, 2));
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that the centerlines of a sample RNDF are in their lanes.
+TEST(LaneCorridors, Sample)
+{
+  std::string dirPath(std::string(PROJECT_SOURCE_PATH));
+  rndf::RNDF rndf(dirPath + "/test/rndf/sample1.rndf");
+  ASSERT_TRUE(rndf.Valid());
+
+  LaneCorridors corridors(rndf);
+  EnuProjection projection(corridors.Origin());
+  size_t numLanes = 0;
+  std::vector<ignition::math::Vector3d> points;
+  std::vector<rndf::UniqueId> lanes;
+  for (auto const &segment : rndf.Segments())
+  {
+    for (auto const &lane : segment.Lanes())
+    {
+      ++numLanes;
+      projection.Project(lane.Waypoints(), points);
+      for (size_t i = 0; i + 1 < points.size(); ++i)
+      {
+        // The middle of each piece.
+        rndf::UniqueId id(segment.Id(), lane.Id(), lane.Waypoints()[i].Id());
+        auto p = (points[i] + points[i + 1]) * 0.5;
+        EXPECT_TRUE(corridors.InLane(id, p)) << id;
+
+        bool found = false;
+        corridors.LanesAt(p, lanes);
+        for (auto const &l : lanes)
+          found = found || (l.X() == id.X() && l.Y() == id.Y());
+        EXPECT_TRUE(found) << id;
+      }
+    }
+  }
+  EXPECT_EQ(corridors.NumLanes(), numLanes);
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,485 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#include <ignition/math/Helpers.hh>
+#include <ignition/math/SphericalCoordinates.hh>
+#include <ignition/math/Vector3.hh>
+
+#include "manifold/rndf/Lane.hh"
+#include "manifold/rndf/RNDF.hh"
+#include "manifold/rndf/Segment.hh"
+#include "manifold/rndf/UniqueId.hh"
+#include "manifold/rndf/Waypoint.hh"
+#include "manifold/EnuProjection.hh"
+#include "manifold/LaneGeometry.hh"
+#include "Common.hh"
+
+using namespace manifold;
+
+namespace
+{
+  /// \internal
+  /// \brief Maximum depth of the tree of bounding boxes.
+  const size_t kMaxDepth = 64;
+
+  /// \internal
+  /// \brief Wrap an angle to [-pi, pi].
+  /// \param[in] _angle The angle (radians).
+  /// \return The wrapped angle.
+  double wrap(const double _angle)
+  {
+    return std::atan2(std::sin(_angle), std::cos(_angle));
+  }
+}
+
+namespace manifold
+{
+  /// \internal
+  /// \brief An axis-aligned bounding box on the horizontal plane.
+  class Box
+  {
+    /// \brief Minimum x.
+    public: double minX = std::numeric_limits<double>::infinity();
+
+    /// \brief Minimum y.
+    public: double minY = std::numeric_limits<double>::infinity();
+
+    /// \brief Maximum x.
+    public: double maxX = -std::numeric_limits<double>::infinity();
+
+    /// \brief Maximum y.
+    public: double maxY = -std::numeric_limits<double>::infinity();
+
+    /// \brief Grow the box to include another one.
+    /// \param[in] _other The other box.
+    public: void Merge(const Box &_other)
+    {
+      this->minX = std::min(this->minX, _other.minX);
+      this->minY = std::min(this->minY, _other.minY);
+      this->maxX = std::max(this->maxX, _other.maxX);
+      this->maxY = std::max(this->maxY, _other.maxY);
+    }
+
+    /// \brief Squared distance from a point to the box.
+    /// \param[in] _x X of the point.
+    /// \param[in] _y Y of the point.
+    /// \return The squared distance, 0 if it's inside or infinity if the
+    /// box is empty.
+    public: double Distance2(const double _x, const double _y) const
+    {
+      if (this->minX > this->maxX)
+        return std::numeric_limits<double>::infinity();
+      double dx = std::max(std::max(this->minX - _x, _x - this->maxX), 0.0);
+      double dy = std::max(std::max(this->minY - _y, _y - this->maxY), 0.0);
+      return dx * dx + dy * dy;
+    }
+  };
+
+  /// \internal
+  /// \brief Private data for LaneGeometry class.
+  class LaneGeometryPrivate
+  {
+    /// \brief Compute the stations, headings, curvatures and bounding boxes
+    /// from the points.
+    public: void Build();
+
+    /// \brief Positions of the waypoints (meters).
+    public: std::vector<ignition::math::Vector3d> points;
+
+    /// \brief Id of each waypoint, empty if the points were given.
+    public: std::vector<int> ids;
+
+    /// \brief Station of each waypoint (meters).
+    public: std::vector<double> stations;
+
+    /// \brief Heading of each piece (radians).
+    public: std::vector<double> headings;
+
+    /// \brief Smoothed curvature at each waypoint (1/meters).
+    public: std::vector<double> curvatures;
+
+    /// \brief Number of leaves of the tree of bounding boxes, a power of 2
+    /// not lower than the number of pieces.
+    public: size_t leaves = 1;
+
+    /// \brief Implicit binary tree of the bounding boxes of the pieces:
+    /// node 1 is the root, the children of node i are 2i and 2i + 1 and the
+    /// leaf of piece j is leaves + j.
+    public: std::vector<Box> boxes;
+  };
+
+  /// \internal
+  /// \brief Private data for LaneGeometryCache class.
+  class LaneGeometryCachePrivate
+  {
+    /// \brief Origin of the frame.
+    public: ignition::math::SphericalCoordinates origin;
+
+    /// \brief The lanes of the RNDF.
+    public: std::vector<const rndf::Lane *> lanes;
+
+    /// \brief Index in lanes of each lane, keyed by segment and lane Id.
+    public: std::unordered_map<uint64_t, size_t> index;
+
+    /// \brief Geometry of each lane, once built.
+    public: std::unique_ptr<std::atomic<const LaneGeometry *>[]> ready;
+
+    /// \brief Owner of the geometries built. Requires the lock.
+    public: std::vector<std::unique_ptr<LaneGeometry>> geometries;
+
+    /// \brief Number of geometries built.
+    public: std::atomic<size_t> built{0};
+
+    /// \brief Serializes the construction of the geometries.
+    public: std::mutex mutex;
+  };
+}
+
+//////////////////////////////////////////////////
+void LaneGeometryPrivate::Build()
+{
+  auto &d = *this;
+  for (size_t i = 0; i < d.points.size(); ++i)
+  {
+    d.stations.push_back(i == 0 ? 0.0 :
+      d.stations.back() + d.points[i].Distance(d.points[i - 1]));
+  }
+
+  const size_t n = d.points.size();
+  d.curvatures.assign(n, 0.0);
+  if (n < 2)
+    return;
+
+  // Pieces without length keep the heading of the previous one.
+  for (size_t i = 0; i + 1 < n; ++i)
+  {
+    auto delta = d.points[i + 1] - d.points[i];
+    if (d.stations[i + 1] > d.stations[i] || d.headings.empty())
+      d.headings.push_back(std::atan2(delta.Y(), delta.X()));
+    else
+      d.headings.push_back(d.headings.back());
+  }
+
+  // Turn at each inner waypoint over the mean length of its pieces, then
+  // a [1 2 1] filter.
+  std::vector<double> raw(n, 0.0);
+  for (size_t i = 1; i + 1 < n; ++i)
+  {
+    double ds = 0.5 * (d.stations[i + 1] - d.stations[i - 1]);
+    if (ds > 0)
+      raw[i] = wrap(d.headings[i] - d.headings[i - 1]) / ds;
+  }
+  for (size_t i = 0; i < n; ++i)
+  {
+    double prev = raw[i > 0 ? i - 1 : i];
+    double next = raw[i + 1 < n ? i + 1 : i];
+    d.curvatures[i] = 0.25 * (prev + 2 * raw[i] + next);
+  }
+
+  // Bounding boxes, bottom-up.
+  const size_t pieces = n - 1;
+  while (d.leaves < pieces)
+    d.leaves *= 2;
+  d.boxes.assign(2 * d.leaves, Box());
+  for (size_t i = 0; i < pieces; ++i)
+  {
+    auto &box = d.boxes[d.leaves + i];
+    box.minX = std::min(d.points[i].X(), d.points[i + 1].X());
+    box.minY = std::min(d.points[i].Y(), d.points[i + 1].Y());
+    box.maxX = std::max(d.points[i].X(), d.points[i + 1].X());
+    box.maxY = std::max(d.points[i].Y(), d.points[i + 1].Y());
+  }
+  for (size_t node = d.leaves - 1; node > 0; --node)
+  {
+    d.boxes[node] = d.boxes[2 * node];
+    d.boxes[node].Merge(d.boxes[2 * node + 1]);
+  }
+}
+
+//////////////////////////////////////////////////
+LaneGeometry::LaneGeometry(const rndf::Lane &_lane,
+  const ignition::math::SphericalCoordinates &_origin)
+  : dataPtr(new LaneGeometryPrivate())
+{
+  auto &d = *this->dataPtr;
+  EnuProjection(_origin).Project(_lane.Waypoints(), d.points);
+  for (auto const &waypoint : _lane.Waypoints())
+    d.ids.push_back(waypoint.Id());
+  d.Build();
+}
+
+//////////////////////////////////////////////////
+LaneGeometry::LaneGeometry(
+  const std::vector<ignition::math::Vector3d> &_points)
+  : dataPtr(new LaneGeometryPrivate())
+{
+  auto &d = *this->dataPtr;
+  for (auto const &point : _points)
+    d.points.push_back(ignition::math::Vector3d(point.X(), point.Y(), 0));
+  d.Build();
+}
+
+//////////////////////////////////////////////////
+LaneGeometry::~LaneGeometry()
+{
+}
+
+//////////////////////////////////////////////////
+size_t LaneGeometry::NumPoints() const
+{
+  return this->dataPtr->points.size();
+}
+
+//////////////////////////////////////////////////
+const ignition::math::Vector3d &LaneGeometry::Point(
+  const size_t _index) const
+{
+  return this->dataPtr->points.at(_index);
+}
+
+//////////////////////////////////////////////////
+double LaneGeometry::Station(const size_t _index) const
+{
+  return this->dataPtr->stations.at(_index);
+}
+
+//////////////////////////////////////////////////
+bool LaneGeometry::Index(const int _waypointId, size_t &_index) const
+{
+  auto const &ids = this->dataPtr->ids;
+
+  // The waypoints are usually numbered from 1.
+  size_t guess = static_cast<size_t>(_waypointId - 1);
+  if (_waypointId > 0 && guess < ids.size() && ids[guess] == _waypointId)
+  {
+    _index = guess;
+    return true;
+  }
+
+  auto it = std::find(ids.begin(), ids.end(), _waypointId);
+  if (it == ids.end())
+    return false;
+  _index = it - ids.begin();
+  return true;
+}
+
+//////////////////////////////////////////////////
+double LaneGeometry::Length() const
+{
+  auto const &stations = this->dataPtr->stations;
+  return stations.empty() ? 0.0 : stations.back();
+}
+
+//////////////////////////////////////////////////
+size_t LaneGeometry::PieceAt(const double _s) const
+{
+  auto const &stations = this->dataPtr->stations;
+  if (stations.size() < 2)
+    return 0;
+
+  auto it = std::upper_bound(stations.begin(), stations.end(), _s);
+  size_t piece = it == stations.begin() ? 0 : it - stations.begin() - 1;
+  return std::min(piece, stations.size() - 2);
+}
+
+//////////////////////////////////////////////////
+ignition::math::Vector3d LaneGeometry::PointAt(const double _s) const
+{
+  auto const &d = *this->dataPtr;
+  if (d.points.size() < 2)
+    return d.points.empty() ? ignition::math::Vector3d() : d.points[0];
+
+  size_t i = this->PieceAt(_s);
+  double length = d.stations[i + 1] - d.stations[i];
+  double t = length > 0 ?
+    ignition::math::clamp((_s - d.stations[i]) / length, 0.0, 1.0) : 0.0;
+  return d.points[i] + (d.points[i + 1] - d.points[i]) * t;
+}
+
+//////////////////////////////////////////////////
+double LaneGeometry::HeadingAt(const double _s) const
+{
+  auto const &d = *this->dataPtr;
+  if (d.headings.empty())
+    return 0.0;
+  return d.headings[this->PieceAt(_s)];
+}
+
+//////////////////////////////////////////////////
+double LaneGeometry::CurvatureAt(const double _s) const
+{
+  auto const &d = *this->dataPtr;
+  if (d.points.size() < 2)
+    return 0.0;
+
+  size_t i = this->PieceAt(_s);
+  double length = d.stations[i + 1] - d.stations[i];
+  double t = length > 0 ?
+    ignition::math::clamp((_s - d.stations[i]) / length, 0.0, 1.0) : 0.0;
+  return (1 - t) * d.curvatures[i] + t * d.curvatures[i + 1];
+}
+
+//////////////////////////////////////////////////
+double LaneGeometry::Project(const ignition::math::Vector3d &_point,
+  double &_offset) const
+{
+  auto const &d = *this->dataPtr;
+  _offset = 0;
+  if (d.points.size() < 2)
+  {
+    if (!d.points.empty())
+      _offset = (_point - d.points[0]).Length();
+    return 0.0;
+  }
+
+  // Branch and bound over the tree, the closest child first. The stack
+  // holds at most one sibling per level.
+  const double px = _point.X();
+  const double py = _point.Y();
+  size_t stack[2 * kMaxDepth];
+  size_t top = 0;
+  stack[top++] = 1;
+  double best = std::numeric_limits<double>::infinity();
+  double station = 0;
+  while (top > 0)
+  {
+    size_t node = stack[--top];
+    if (d.boxes[node].Distance2(px, py) >= best)
+      continue;
+
+    if (node < d.leaves)
+    {
+      size_t near = 2 * node;
+      size_t far = 2 * node + 1;
+      if (d.boxes[far].Distance2(px, py) < d.boxes[near].Distance2(px, py))
+        std::swap(near, far);
+      stack[top++] = far;
+      stack[top++] = near;
+      continue;
+    }
+
+    size_t i = node - d.leaves;
+    auto const &a = d.points[i];
+    double ex = d.points[i + 1].X() - a.X();
+    double ey = d.points[i + 1].Y() - a.Y();
+    double wx = px - a.X();
+    double wy = py - a.Y();
+    double squared = ex * ex + ey * ey;
+    double t = squared > 0 ?
+      ignition::math::clamp((wx * ex + wy * ey) / squared, 0.0, 1.0) : 0.0;
+    double dx = wx - t * ex;
+    double dy = wy - t * ey;
+    double distance2 = dx * dx + dy * dy;
+    if (distance2 < best)
+    {
+      best = distance2;
+      station = d.stations[i] + t * (d.stations[i + 1] - d.stations[i]);
+      _offset = (ex * wy - ey * wx) < 0 ? -std::sqrt(distance2) :
+        std::sqrt(distance2);
+    }
+  }
+  return station;
+}
+
+//////////////////////////////////////////////////
+LaneGeometryCache::LaneGeometryCache(const rndf::RNDF &_rndf)
+  : LaneGeometryCache(_rndf, ignition::math::SphericalCoordinates())
+{
+  auto &d = *this->dataPtr;
+  for (auto const &lane : d.lanes)
+  {
+    if (!lane->Waypoints().empty())
+    {
+      d.origin = lane->Waypoints().front().Location();
+      break;
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+LaneGeometryCache::LaneGeometryCache(const rndf::RNDF &_rndf,
+  const ignition::math::SphericalCoordinates &_origin)
+  : dataPtr(new LaneGeometryCachePrivate())
+{
+  auto &d = *this->dataPtr;
+  d.origin = _origin;
+  for (auto const &segment : _rndf.Segments())
+  {
+    for (auto const &lane : segment.Lanes())
+    {
+      d.index[laneKey(rndf::UniqueId(segment.Id(), lane.Id(), 1))] =
+        d.lanes.size();
+      d.lanes.push_back(&lane);
+    }
+  }
+
+  d.ready.reset(new std::atomic<const LaneGeometry *>[d.lanes.size()]);
+  for (size_t i = 0; i < d.lanes.size(); ++i)
+    d.ready[i].store(nullptr);
+  d.geometries.resize(d.lanes.size());
+}
+
+//////////////////////////////////////////////////
+LaneGeometryCache::~LaneGeometryCache()
+{
+}
+
+//////////////////////////////////////////////////
+const ignition::math::SphericalCoordinates &LaneGeometryCache::Origin() const
+{
+  return this->dataPtr->origin;
+}
+
+//////////////////////////////////////////////////
+const LaneGeometry *LaneGeometryCache::Lane(const rndf::UniqueId &_id) const
+{
+  auto &d = *this->dataPtr;
+  auto it = d.index.find(laneKey(_id));
+  if (it == d.index.end())
+    return nullptr;
+
+  auto &ready = d.ready[it->second];
+  const LaneGeometry *geometry = ready.load(std::memory_order_acquire);
+  if (geometry)
+    return geometry;
+
+  std::lock_guard<std::mutex> lock(d.mutex);
+  geometry = ready.load(std::memory_order_relaxed);
+  if (!geometry)
+  {
+    d.geometries[it->second].reset(
+      new LaneGeometry(*d.lanes[it->second], d.origin));
+    geometry = d.geometries[it->second].get();
+    ready.store(geometry, std::memory_order_release);
+    ++d.built;
+  }
+  return geometry;
+}
+
+//////////////////////////////////////////////////
+size_t LaneGeometryCache::NumBuilt() const
+{
+  return this->dataPtr->built.load();
+}
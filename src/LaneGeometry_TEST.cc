@@ -0,0 +1,252 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <cmath>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <ignition/math/Angle.hh>
+#include <ignition/math/Helpers.hh>
+#include <ignition/math/SphericalCoordinates.hh>
+#include <ignition/math/Vector3.hh>
+
+#include "manifold/rndf/Lane.hh"
+#include "manifold/rndf/RNDF.hh"
+#include "manifold/rndf/Segment.hh"
+#include "manifold/rndf/UniqueId.hh"
+#include "manifold/rndf/Waypoint.hh"
+#include "manifold/LaneGeometry.hh"
+#include "manifold/test_config.h"
+#include "performance/fixtures.hh"
+#include "gtest/gtest.h"
+
+using namespace manifold;
+using test::location;
+
+/// \brief A lane turning left along a circle of about 100 m of radius,
+/// centered at (37, -122), from south to east.
+/// \param[out] _lane The lane. It should be empty.
+void arcLane(rndf::Lane &_lane)
+{
+  const double kRadiusLat = 100.0 / 111000.0;
+  const double kRadiusLon = kRadiusLat / std::cos(IGN_DTOR(37.0));
+  for (int w = 0; w <= 18; ++w)
+  {
+    double angle = -IGN_PI / 2 + w * IGN_PI / 36;
+    _lane.AddWaypoint(rndf::Waypoint(w + 1,
+      location(37.0 + kRadiusLat * std::sin(angle),
+               -122.0 + kRadiusLon * std::cos(angle))));
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Check a straight lane.
+TEST(LaneGeometry, Straight)
+{
+  rndf::Lane lane(1);
+  for (int w = 0; w < 4; ++w)
+    lane.AddWaypoint(rndf::Waypoint(w + 1, location(37.0, -122.0 + w * 1e-3)));
+
+  auto origin = location(37.0, -122.0);
+  LaneGeometry geometry(lane, origin);
+  ASSERT_EQ(geometry.NumPoints(), 4u);
+  EXPECT_NEAR(geometry.Point(0).X(), 0.0, 1e-6);
+  EXPECT_NEAR(geometry.Station(0), 0.0, 1e-9);
+
+  // Close to the great-circle length.
+  double arc = ignition::math::SphericalCoordinates::Distance(
+    origin.LatitudeReference(), origin.LongitudeReference(),
+    lane.Waypoints().back().Location().LatitudeReference(),
+    lane.Waypoints().back().Location().LongitudeReference());
+  EXPECT_NEAR(geometry.Length(), arc, 0.005 * arc);
+  EXPECT_NEAR(geometry.Station(3), geometry.Length(), 1e-9);
+
+  auto point = geometry.PointAt(100.0);
+  EXPECT_NEAR(point.X(), 100.0, 0.01);
+  EXPECT_NEAR(point.Y(), 0.0, 0.01);
+  EXPECT_NEAR(point.Z(), 0.0, 1e-9);
+  EXPECT_NEAR(geometry.HeadingAt(100.0), 0.0, 1e-3);
+  EXPECT_NEAR(geometry.CurvatureAt(100.0), 0.0, 1e-6);
+  EXPECT_EQ(geometry.PieceAt(100.0), 1u);
+  EXPECT_EQ(geometry.PieceAt(-5.0), 0u);
+  EXPECT_EQ(geometry.PieceAt(1e6), 2u);
+
+  // Stations are clamped.
+  EXPECT_NEAR(geometry.PointAt(-10.0).X(), 0.0, 1e-6);
+  EXPECT_NEAR(geometry.PointAt(1e6).X(), geometry.Point(3).X(), 1e-6);
+
+  double offset;
+  EXPECT_NEAR(geometry.Project(ignition::math::Vector3d(150, 2, 0), offset),
+              150.0, 0.01);
+  EXPECT_NEAR(offset, 2.0, 0.01);
+  EXPECT_NEAR(geometry.Project(ignition::math::Vector3d(150, -3, 0), offset),
+              150.0, 0.01);
+  EXPECT_NEAR(offset, -3.0, 0.01);
+  EXPECT_NEAR(geometry.Project(ignition::math::Vector3d(-10, 0, 0), offset),
+              0.0, 1e-9);
+  EXPECT_NEAR(std::abs(offset), 10.0, 0.01);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check a curved lane.
+TEST(LaneGeometry, Curved)
+{
+  rndf::Lane lane(1);
+  arcLane(lane);
+  LaneGeometry geometry(lane, location(37.0, -122.0));
+  ASSERT_EQ(geometry.NumPoints(), 19u);
+
+  // A quarter of a circle of 100 m, heading east then north.
+  EXPECT_NEAR(geometry.Length(), 50 * IGN_PI, 1.0);
+  EXPECT_NEAR(geometry.HeadingAt(0.0), IGN_PI / 72, 0.01);
+  EXPECT_NEAR(geometry.HeadingAt(geometry.Length()), IGN_PI / 2 - IGN_PI / 72,
+              0.01);
+  EXPECT_NEAR(geometry.CurvatureAt(geometry.Length() / 2), 0.01, 0.001);
+
+  // The projection matches a scan of all the pieces.
+  std::mt19937 generator(1);
+  std::uniform_real_distribution<double> coordinate(-150.0, 150.0);
+  for (int i = 0; i < 500; ++i)
+  {
+    ignition::math::Vector3d p(coordinate(generator), coordinate(generator),
+                               0);
+    double best = 1e9;
+    for (size_t j = 0; j + 1 < geometry.NumPoints(); ++j)
+    {
+      auto a = geometry.Point(j);
+      auto e = geometry.Point(j + 1) - a;
+      double t = ignition::math::clamp((p - a).Dot(e) / e.Dot(e), 0.0, 1.0);
+      best = std::min(best, (a + e * t - p).Length());
+    }
+
+    double offset;
+    double s = geometry.Project(p, offset);
+    EXPECT_NEAR(std::abs(offset), best, 1e-6);
+    EXPECT_NEAR((geometry.PointAt(s) - p).Length(), best, 1e-6);
+  }
+
+  // Inside the turn is on the left.
+  double offset;
+  geometry.Project(ignition::math::Vector3d(0, 0, 0), offset);
+  EXPECT_NEAR(offset, 100.0, 1.0);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check lanes with fewer than two waypoints.
+TEST(LaneGeometry, Degenerate)
+{
+  rndf::Lane lane(1);
+  LaneGeometry empty(lane, location(37.0, -122.0));
+  EXPECT_EQ(empty.NumPoints(), 0u);
+  EXPECT_DOUBLE_EQ(empty.Length(), 0.0);
+  EXPECT_DOUBLE_EQ(empty.HeadingAt(1.0), 0.0);
+  double offset;
+  EXPECT_DOUBLE_EQ(empty.Project(ignition::math::Vector3d(1, 2, 0), offset),
+                   0.0);
+
+  lane.AddWaypoint(rndf::Waypoint(1, location(37.0, -122.0)));
+  LaneGeometry single(lane, location(37.0, -122.0));
+  EXPECT_EQ(single.NumPoints(), 1u);
+  EXPECT_NEAR(single.PointAt(5.0).X(), 0.0, 1e-6);
+  single.Project(ignition::math::Vector3d(3, 4, 0), offset);
+  EXPECT_NEAR(offset, 5.0, 1e-6);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check a geometry built from points and the index of the
+/// waypoints.
+TEST(LaneGeometry, Points)
+{
+  rndf::Lane lane(1);
+  arcLane(lane);
+  LaneGeometry geometry(lane, location(37.0, -122.0));
+
+  std::vector<ignition::math::Vector3d> points;
+  for (size_t i = 0; i < geometry.NumPoints(); ++i)
+    points.push_back(geometry.Point(i) + ignition::math::Vector3d(0, 0, 5));
+  LaneGeometry copy(points);
+  ASSERT_EQ(copy.NumPoints(), geometry.NumPoints());
+  EXPECT_DOUBLE_EQ(copy.Length(), geometry.Length());
+  EXPECT_DOUBLE_EQ(copy.Point(3).Z(), 0.0);
+  EXPECT_DOUBLE_EQ(copy.CurvatureAt(50.0), geometry.CurvatureAt(50.0));
+
+  size_t index = 0;
+  EXPECT_TRUE(geometry.Index(1, index));
+  EXPECT_EQ(index, 0u);
+  EXPECT_TRUE(geometry.Index(19, index));
+  EXPECT_EQ(index, 18u);
+  EXPECT_FALSE(geometry.Index(20, index));
+  EXPECT_FALSE(geometry.Index(0, index));
+  EXPECT_FALSE(copy.Index(1, index));
+
+  // Waypoints not numbered from 1.
+  rndf::Lane sparse(1);
+  sparse.AddWaypoint(rndf::Waypoint(3, location(37.0, -122.0)));
+  sparse.AddWaypoint(rndf::Waypoint(7, location(37.0, -122.001)));
+  LaneGeometry other(sparse, location(37.0, -122.0));
+  EXPECT_TRUE(other.Index(7, index));
+  EXPECT_EQ(index, 1u);
+  EXPECT_FALSE(other.Index(2, index));
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the lazy construction of the cache.
+TEST(LaneGeometry, Cache)
+{
+  std::string dirPath(std::string(PROJECT_SOURCE_PATH));
+  rndf::RNDF rndf(dirPath + "/test/rndf/sample1.rndf");
+  ASSERT_TRUE(rndf.Valid());
+
+  LaneGeometryCache cache(rndf);
+  EXPECT_EQ(cache.Origin(),
+    rndf.Segments()[0].Lanes()[0].Waypoints()[0].Location());
+  EXPECT_EQ(cache.NumBuilt(), 0u);
+  EXPECT_TRUE(cache.Lane(rndf::UniqueId(99, 1, 1)) == nullptr);
+
+  auto geometry = cache.Lane(rndf::UniqueId(1, 1, 3));
+  ASSERT_TRUE(geometry != nullptr);
+  EXPECT_EQ(cache.NumBuilt(), 1u);
+  EXPECT_EQ(cache.Lane(rndf::UniqueId(1, 1, 1)), geometry);
+  EXPECT_EQ(cache.NumBuilt(), 1u);
+  EXPECT_NEAR(geometry->Point(0).X(), 0.0, 1e-6);
+  EXPECT_NEAR(geometry->Point(0).Y(), 0.0, 1e-6);
+
+  // All the threads get the same geometries.
+  std::vector<rndf::UniqueId> ids;
+  for (auto const &segment : rndf.Segments())
+  {
+    for (auto const &lane : segment.Lanes())
+      ids.push_back(rndf::UniqueId(segment.Id(), lane.Id(), 1));
+  }
+  std::vector<std::vector<const LaneGeometry *>> found(4);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < found.size(); ++t)
+  {
+    threads.push_back(std::thread([&, t]()
+      {
+        for (auto const &id : ids)
+          found[t].push_back(cache.Lane(id));
+      }));
+  }
+  for (auto &thread : threads)
+    thread.join();
+
+  EXPECT_EQ(cache.NumBuilt(), ids.size());
+  for (size_t t = 1; t < found.size(); ++t)
+    EXPECT_EQ(found[t], found[0]);
+}
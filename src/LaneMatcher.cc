@@ -0,0 +1,312 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <ignition/math/Angle.hh>
+#include <ignition/math/SphericalCoordinates.hh>
+
+#include "manifold/rndf/Lane.hh"
+#include "manifold/rndf/RNDF.hh"
+#include "manifold/rndf/Segment.hh"
+#include "manifold/rndf/UniqueId.hh"
+#include "manifold/rndf/Waypoint.hh"
+#include "manifold/GreatCircle.hh"
+#include "manifold/LaneMatcher.hh"
+#include "Common.hh"
+#include "ParallelFor.hh"
+#include "SpatialGrid.hh"
+
+using namespace manifold;
+
+namespace
+{
+  /// \internal
+  /// \brief Side of a cell of the grid (meters along a meridian).
+  const double kCellSize = 100.0;
+}
+
+namespace manifold
+{
+  /// \internal
+  /// \brief A straight piece of a lane centerline between two consecutive
+  /// waypoints.
+  class CenterlinePiece
+  {
+    /// \brief Unique Id of the first waypoint of the piece.
+    public: rndf::UniqueId waypoint;
+
+    /// \brief Index of the first waypoint of the piece in the lane.
+    public: size_t index;
+
+    /// \brief Latitude of the start (radians).
+    public: double lat0;
+
+    /// \brief Longitude of the start (radians).
+    public: double lon0;
+
+    /// \brief Latitude of the end (radians).
+    public: double lat1;
+
+    /// \brief Longitude of the end (radians).
+    public: double lon1;
+
+    /// \brief Arc length of the lane up to the start (meters).
+    public: double start;
+
+    /// \brief Great-circle length of the piece (meters).
+    public: double length;
+  };
+
+  /// \internal
+  /// \brief Private data for LaneMatcher class.
+  class LaneMatcherPrivate
+  {
+    /// \brief Constructor.
+    /// \param[in] _rndf The RNDF.
+    public: explicit LaneMatcherPrivate(const rndf::RNDF &_rndf)
+      : grid(kCellSize / kEarthRadius)
+    {
+      for (auto const &segment : _rndf.Segments())
+      {
+        for (auto const &lane : segment.Lanes())
+        {
+          auto const &waypoints = lane.Waypoints();
+          std::vector<double> lat;
+          std::vector<double> lon;
+          std::vector<double> lengths;
+          GreatCircle::Coordinates(waypoints, lat, lon);
+          GreatCircle::Consecutive(lat, lon, lengths);
+          double start = 0;
+          for (size_t i = 0; i + 1 < waypoints.size(); ++i)
+          {
+            auto const &from = waypoints[i].Location();
+            auto const &to = waypoints[i + 1].Location();
+            CenterlinePiece piece;
+            piece.waypoint =
+              rndf::UniqueId(segment.Id(), lane.Id(), waypoints[i].Id());
+            piece.index = i;
+            piece.lat0 = from.LatitudeReference().Radian();
+            piece.lon0 = from.LongitudeReference().Radian();
+            piece.lat1 = to.LatitudeReference().Radian();
+            piece.lon1 = to.LongitudeReference().Radian();
+            piece.start = start;
+            piece.length = lengths[i];
+            start += piece.length;
+
+            // The grid is indexed by longitude and latitude (radians).
+            this->grid.Insert(this->pieces.size(),
+              std::min(piece.lon0, piece.lon1),
+              std::min(piece.lat0, piece.lat1),
+              std::max(piece.lon0, piece.lon1),
+              std::max(piece.lat0, piece.lat1));
+            this->pieces.push_back(piece);
+          }
+        }
+      }
+    }
+
+    /// \brief Destructor.
+    public: virtual ~LaneMatcherPrivate() = default;
+
+    /// \brief Find the pieces that might be within a distance of a
+    /// location.
+    /// \param[in] _location The location.
+    /// \param[in] _maxDistance Maximum distance (meters).
+    /// \param[out] _nearby Indexes of the candidate pieces.
+    public: void Nearby(const ignition::math::SphericalCoordinates &_location,
+      const double _maxDistance, std::vector<size_t> &_nearby) const
+    {
+      double lat = _location.LatitudeReference().Radian();
+      double lon = _location.LongitudeReference().Radian();
+      double dLat = _maxDistance / kEarthRadius;
+      double dLon = dLat / std::max(std::cos(lat), 1e-6);
+      this->grid.Query(lon - dLon, lat - dLat, lon + dLon, lat + dLat,
+                       _nearby);
+    }
+
+    /// \brief Project a location on a piece of centerline.
+    /// \param[in] _location The location.
+    /// \param[in] _piece Index of the piece.
+    /// \param[out] _match The projection.
+    public: void Project(const ignition::math::SphericalCoordinates &_location,
+      const size_t _piece, LaneMatch &_match) const
+    {
+      auto const &piece = this->pieces[_piece];
+      double lat = _location.LatitudeReference().Radian();
+      double lon = _location.LongitudeReference().Radian();
+      double cosLat = std::cos(lat);
+
+      // Ends of the piece on a plane tangent at the location.
+      double ax = kEarthRadius * (piece.lon0 - lon) * cosLat;
+      double ay = kEarthRadius * (piece.lat0 - lat);
+      double ex = kEarthRadius * (piece.lon1 - lon) * cosLat - ax;
+      double ey = kEarthRadius * (piece.lat1 - lat) - ay;
+      double squared = ex * ex + ey * ey;
+      double t = 0;
+      if (squared > 0)
+        t = std::min(std::max(-(ax * ex + ay * ey) / squared, 0.0), 1.0);
+
+      _match.waypoint = piece.waypoint;
+      _match.index = piece.index;
+      _match.distance = std::hypot(ax + t * ex, ay + t * ey);
+      _match.offset = squared > 0 ?
+        (ey * ax - ex * ay) / std::sqrt(squared) : _match.distance;
+      _match.progress = piece.start + t * piece.length;
+    }
+
+    /// \brief Match a location to the closest lane centerline.
+    /// \param[in] _location The location.
+    /// \param[in] _maxDistance Maximum distance (meters).
+    /// \param[out] _match The projection on the closest centerline.
+    /// \param[in,out] _nearby Buffer for the candidate pieces.
+    /// \return True if a lane was found or false otherwise.
+    public: bool Match(const ignition::math::SphericalCoordinates &_location,
+      const double _maxDistance, LaneMatch &_match,
+      std::vector<size_t> &_nearby) const
+    {
+      if (this->pieces.empty() || !(_maxDistance >= 0))
+        return false;
+
+      this->Nearby(_location, _maxDistance, _nearby);
+      bool found = false;
+      LaneMatch match;
+      for (auto const &p : _nearby)
+      {
+        this->Project(_location, p, match);
+        if (match.distance <= _maxDistance &&
+            (!found || match.distance < _match.distance))
+        {
+          _match = match;
+          found = true;
+        }
+      }
+      return found;
+    }
+
+    /// \brief The pieces of the centerlines.
+    public: std::vector<CenterlinePiece> pieces;
+
+    /// \brief Index of the pieces by longitude and latitude.
+    public: SpatialGrid grid;
+  };
+}
+
+//////////////////////////////////////////////////
+LaneMatcher::LaneMatcher(const rndf::RNDF &_rndf)
+  : dataPtr(new LaneMatcherPrivate(_rndf))
+{
+}
+
+//////////////////////////////////////////////////
+LaneMatcher::~LaneMatcher()
+{
+}
+
+//////////////////////////////////////////////////
+size_t LaneMatcher::Size() const
+{
+  return this->dataPtr->pieces.size();
+}
+
+//////////////////////////////////////////////////
+bool LaneMatcher::Match(
+  const ignition::math::SphericalCoordinates &_location, LaneMatch &_match,
+  const double _maxDistance) const
+{
+  std::vector<size_t> nearby;
+  return this->dataPtr->Match(_location, _maxDistance, _match, nearby);
+}
+
+//////////////////////////////////////////////////
+void LaneMatcher::Candidates(
+  const ignition::math::SphericalCoordinates &_location,
+  const double _radius, std::vector<LaneMatch> &_candidates) const
+{
+  _candidates.clear();
+  auto const &d = *this->dataPtr;
+  if (d.pieces.empty() || !(_radius >= 0))
+    return;
+
+  std::vector<size_t> nearby;
+  d.Nearby(_location, _radius, nearby);
+  LaneMatch match;
+  for (auto const &p : nearby)
+  {
+    d.Project(_location, p, match);
+    if (match.distance <= _radius)
+      _candidates.push_back(match);
+  }
+
+  // Keep the closest piece of each lane.
+  auto lane = [](const LaneMatch &_a, const LaneMatch &_b)
+  {
+    return _a.waypoint.X() == _b.waypoint.X() &&
+      _a.waypoint.Y() == _b.waypoint.Y();
+  };
+  std::sort(_candidates.begin(), _candidates.end(),
+    [](const LaneMatch &_a, const LaneMatch &_b)
+    {
+      if (_a.waypoint.X() != _b.waypoint.X())
+        return _a.waypoint.X() < _b.waypoint.X();
+      if (_a.waypoint.Y() != _b.waypoint.Y())
+        return _a.waypoint.Y() < _b.waypoint.Y();
+      return _a.distance < _b.distance;
+    });
+  _candidates.erase(std::unique(_candidates.begin(), _candidates.end(), lane),
+                    _candidates.end());
+  std::stable_sort(_candidates.begin(), _candidates.end(),
+    [](const LaneMatch &_a, const LaneMatch &_b)
+    {
+      return _a.distance < _b.distance;
+    });
+}
+
+//////////////////////////////////////////////////
+size_t LaneMatcher::Match(
+  const std::vector<ignition::math::SphericalCoordinates> &_locations,
+  std::vector<LaneMatch> &_matches, const double _maxDistance,
+  const unsigned int _threads) const
+{
+  _matches.assign(_locations.size(), LaneMatch());
+
+  // Locations are matched in blocks so the tasks aren't too small.
+  const size_t kBlock = 256;
+  size_t blocks = (_locations.size() + kBlock - 1) / kBlock;
+  auto workers = workerCount(_threads, blocks);
+  std::vector<std::vector<size_t>> buffers(workers);
+  std::vector<size_t> counts(workers, 0);
+  parallelFor(blocks, workers,
+    [&](const size_t _block, const unsigned int _worker)
+    {
+      size_t end = std::min(_locations.size(), (_block + 1) * kBlock);
+      for (size_t i = _block * kBlock; i < end; ++i)
+      {
+        if (this->dataPtr->Match(_locations[i], _maxDistance, _matches[i],
+                                 buffers[_worker]))
+        {
+          ++counts[_worker];
+        }
+      }
+    });
+
+  size_t matched = 0;
+  for (auto const &count : counts)
+    matched += count;
+  return matched;
+}
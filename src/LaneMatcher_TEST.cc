@@ -0,0 +1,196 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <random>
+#include <string>
+#include <vector>
+#include <ignition/math/Angle.hh>
+#include <ignition/math/Helpers.hh>
+#include <ignition/math/SphericalCoordinates.hh>
+
+#include "manifold/rndf/Lane.hh"
+#include "manifold/rndf/RNDF.hh"
+#include "manifold/rndf/Segment.hh"
+#include "manifold/rndf/UniqueId.hh"
+#include "manifold/rndf/Waypoint.hh"
+#include "manifold/LaneMatcher.hh"
+#include "manifold/test_config.h"
+#include "performance/fixtures.hh"
+#include "gtest/gtest.h"
+
+using namespace manifold;
+using test::location;
+using test::roadRNDF;
+
+/// \brief Great-circle distance between two locations.
+/// \param[in] _a First location.
+/// \param[in] _b Second location.
+/// \return The distance (meters).
+double distance(const ignition::math::SphericalCoordinates &_a,
+                const ignition::math::SphericalCoordinates &_b)
+{
+  return ignition::math::SphericalCoordinates::Distance(
+    _a.LatitudeReference(), _a.LongitudeReference(),
+    _b.LatitudeReference(), _b.LongitudeReference());
+}
+
+//////////////////////////////////////////////////
+/// \brief Check a matcher of an empty RNDF.
+TEST(LaneMatcher, Empty)
+{
+  rndf::RNDF rndf;
+  LaneMatcher matcher(rndf);
+  EXPECT_EQ(matcher.Size(), 0u);
+
+  LaneMatch match;
+  EXPECT_FALSE(matcher.Match(location(37.0, -122.0), match));
+
+  std::vector<LaneMatch> matches;
+  EXPECT_EQ(matcher.Match({location(37.0, -122.0)}, matches), 0u);
+  ASSERT_EQ(matches.size(), 1u);
+  EXPECT_FALSE(matches[0].waypoint.Valid());
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the projection on the lanes.
+TEST(LaneMatcher, Match)
+{
+  rndf::RNDF rndf;
+  roadRNDF(rndf);
+  LaneMatcher matcher(rndf);
+  EXPECT_EQ(matcher.Size(), 6u);
+
+  auto const &east = rndf.Segments()[0].Lanes()[0].Waypoints();
+  auto const &west = rndf.Segments()[0].Lanes()[1].Waypoints();
+  double piece = distance(east[0].Location(), east[1].Location());
+
+  // Halfway along the second piece of lane 1, 1.1 m to its left.
+  auto query = location(37.00001, -121.9985);
+  double lateral = distance(query, location(37.0, -121.9985));
+  LaneMatch match;
+  ASSERT_TRUE(matcher.Match(query, match));
+  EXPECT_EQ(match.waypoint, rndf::UniqueId(1, 1, 2));
+  EXPECT_EQ(match.index, 1u);
+  EXPECT_NEAR(match.offset, lateral, 1e-3);
+  EXPECT_NEAR(match.distance, lateral, 1e-3);
+  EXPECT_NEAR(match.progress, 1.5 * piece, 1e-2);
+
+  // Closer to lane 2, which runs west: the location is on its left (south)
+  // as well.
+  query = location(37.00003, -121.9985);
+  ASSERT_TRUE(matcher.Match(query, match));
+  EXPECT_EQ(match.waypoint, rndf::UniqueId(1, 2, 2));
+  EXPECT_EQ(match.index, 1u);
+  EXPECT_GT(match.offset, 0);
+  EXPECT_NEAR(match.distance, match.offset, 1e-6);
+  EXPECT_NEAR(match.progress,
+    distance(west[0].Location(), west[1].Location()) + 0.5 * piece, 1e-2);
+
+  // Beyond the end of lane 1.
+  query = location(36.99999, -121.9969);
+  ASSERT_TRUE(matcher.Match(query, match));
+  EXPECT_EQ(match.waypoint, rndf::UniqueId(1, 1, 3));
+  EXPECT_EQ(match.index, 2u);
+  EXPECT_GT(match.distance, std::abs(match.offset) + 1.0);
+  EXPECT_NEAR(match.progress, 3 * piece, 1e-2);
+
+  // Too far from the lanes.
+  query = location(37.001, -121.9985);
+  EXPECT_FALSE(matcher.Match(query, match));
+  ASSERT_TRUE(matcher.Match(query, match, 200.0));
+  EXPECT_EQ(match.waypoint.Y(), 2);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the candidate lanes of a location.
+TEST(LaneMatcher, Candidates)
+{
+  rndf::RNDF rndf;
+  roadRNDF(rndf);
+  LaneMatcher matcher(rndf);
+
+  // Both lanes, the closest first, with a single piece each.
+  std::vector<LaneMatch> candidates;
+  matcher.Candidates(location(37.00003, -121.999), 10.0, candidates);
+  ASSERT_EQ(candidates.size(), 2u);
+  EXPECT_EQ(candidates[0].waypoint.Y(), 2);
+  EXPECT_EQ(candidates[1].waypoint.Y(), 1);
+  EXPECT_LT(candidates[0].distance, candidates[1].distance);
+
+  matcher.Candidates(location(37.00003, -121.999), 2.0, candidates);
+  ASSERT_EQ(candidates.size(), 1u);
+  EXPECT_EQ(candidates[0].waypoint.Y(), 2);
+
+  matcher.Candidates(location(37.001, -121.999), 10.0, candidates);
+  EXPECT_TRUE(candidates.empty());
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that the batch queries give the same results as the single
+/// ones.
+TEST(LaneMatcher, Batch)
+{
+  std::string dirPath(std::string(PROJECT_SOURCE_PATH));
+  rndf::RNDF rndf(dirPath + "/test/rndf/sample2.rndf");
+  ASSERT_TRUE(rndf.Valid());
+  LaneMatcher matcher(rndf);
+  ASSERT_GT(matcher.Size(), 0u);
+
+  // Locations around the waypoints of the RNDF.
+  std::mt19937 generator(3);
+  std::uniform_real_distribution<double> offset(-5e-4, 5e-4);
+  std::vector<ignition::math::SphericalCoordinates> locations;
+  for (auto const &segment : rndf.Segments())
+  {
+    for (auto const &lane : segment.Lanes())
+    {
+      for (auto const &wp : lane.Waypoints())
+      {
+        locations.push_back(location(
+          wp.Location().LatitudeReference().Degree() + offset(generator),
+          wp.Location().LongitudeReference().Degree() + offset(generator)));
+      }
+    }
+  }
+
+  for (unsigned int threads : {1u, 4u})
+  {
+    std::vector<LaneMatch> matches;
+    size_t matched = matcher.Match(locations, matches, 30.0, threads);
+    ASSERT_EQ(matches.size(), locations.size());
+    EXPECT_GT(matched, 0u);
+    EXPECT_LT(matched, locations.size());
+
+    size_t expected = 0;
+    for (size_t i = 0; i < locations.size(); ++i)
+    {
+      LaneMatch match;
+      bool found = matcher.Match(locations[i], match, 30.0);
+      expected += found ? 1 : 0;
+      EXPECT_EQ(matches[i].waypoint.Valid(), found);
+      if (found)
+      {
+        EXPECT_EQ(matches[i].waypoint, match.waypoint);
+        EXPECT_EQ(matches[i].index, match.index);
+        EXPECT_DOUBLE_EQ(matches[i].distance, match.distance);
+        EXPECT_DOUBLE_EQ(matches[i].progress, match.progress);
+        EXPECT_LE(match.distance, 30.0);
+      }
+    }
+    EXPECT_EQ(matched, expected);
+  }
+}
@@ -0,0 +1,370 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <vector>
+
+#include "manifold/rndf/Checkpoint.hh"
+#include "manifold/rndf/Lane.hh"
+#include "manifold/rndf/ParkingSpot.hh"
+#include "manifold/rndf/RNDF.hh"
+#include "manifold/rndf/Segment.hh"
+#include "manifold/rndf/UniqueId.hh"
+#include "manifold/rndf/Zone.hh"
+#include "manifold/Mission.hh"
+#include "manifold/RoadNetwork.hh"
+
+using namespace manifold;
+
+namespace manifold
+{
+  /// \internal
+  /// \brief Private data for Mission class.
+  class MissionPrivate
+  {
+    /// \brief Constructor.
+    public: MissionPrivate() = default;
+
+    /// \brief Destructor.
+    public: virtual ~MissionPrivate() = default;
+
+    /// \brief Empty the mission.
+    public: void Clear()
+    {
+      this->checkpoints.clear();
+      this->waypoints.clear();
+      this->route.clear();
+      this->legCosts.clear();
+      this->legOffsets.clear();
+    }
+
+    /// \brief Checkpoint Ids in visit order.
+    public: std::vector<int> checkpoints;
+
+    /// \brief Waypoint of each checkpoint in visit order.
+    public: std::vector<rndf::UniqueId> waypoints;
+
+    /// \brief Concatenated route.
+    public: std::vector<rndf::UniqueId> route;
+
+    /// \brief Cost of each leg.
+    public: std::vector<double> legCosts;
+
+    /// \brief Position in the route of the first waypoint of each leg.
+    public: std::vector<size_t> legOffsets;
+  };
+}
+
+/////////////////////////////////////////////////
+/// \brief Build the table that maps each checkpoint Id to its waypoint.
+/// \param[in] _rndf The RNDF.
+/// \return The checkpoint table.
+static std::map<int, rndf::UniqueId> checkpointTable(const rndf::RNDF &_rndf)
+{
+  std::map<int, rndf::UniqueId> table;
+  for (auto const &segment : _rndf.Segments())
+    for (auto const &lane : segment.Lanes())
+      for (auto const &cp : lane.Checkpoints())
+      {
+        table[cp.CheckpointId()] =
+          rndf::UniqueId(segment.Id(), lane.Id(), cp.WaypointId());
+      }
+
+  for (auto const &zone : _rndf.Zones())
+    for (auto const &spot : zone.Spots())
+    {
+      auto const &cp = spot.Checkpoint();
+      if (cp.Valid())
+      {
+        table[cp.CheckpointId()] =
+          rndf::UniqueId(zone.Id(), spot.Id(), cp.WaypointId());
+      }
+    }
+
+  return table;
+}
+
+/////////////////////////////////////////////////
+/// \brief Heuristic for the asymmetric open traveling salesman problem with
+/// a fixed start: nearest neighbor construction followed by 2-opt and or-opt
+/// local search until no move improves the tour.
+/// \param[in] _costs Row-major n x n cost matrix.
+/// \param[in] _n Number of locations. Location 0 is the start.
+/// \return The visit order.
+static std::vector<size_t> solveTour(const std::vector<double> &_costs,
+  const size_t _n)
+{
+  std::vector<size_t> order = {0};
+  std::vector<bool> visited(_n, false);
+  visited[0] = true;
+  for (size_t step = 1; step < _n; ++step)
+  {
+    size_t last = order.back();
+    size_t best = _n;
+    for (size_t j = 0; j < _n; ++j)
+    {
+      if (!visited[j] &&
+          (best == _n || _costs[last * _n + j] < _costs[last * _n + best]))
+      {
+        best = j;
+      }
+    }
+    visited[best] = true;
+    order.push_back(best);
+  }
+
+  // Costs are asymmetric, so a reversed subsequence changes the cost of
+  // its inner edges too. The prefix sums of the costs along the order and
+  // against it give the cost of any subsequence in both directions, so
+  // every move is evaluated in constant time.
+  auto cost = [&](const size_t _from, const size_t _to)
+  {
+    return _costs[order[_from] * _n + order[_to]];
+  };
+  std::vector<double> forward(_n, 0);
+  std::vector<double> backward(_n, 0);
+  auto accumulate = [&]()
+  {
+    for (size_t k = 1; k < _n; ++k)
+    {
+      forward[k] = forward[k - 1] + cost(k - 1, k);
+      backward[k] = backward[k - 1] + cost(k, k - 1);
+    }
+  };
+  accumulate();
+
+  const double kEpsilon = 1e-9;
+  const int kMaxPasses = 50;
+  bool improved = true;
+  for (int pass = 0; improved && pass < kMaxPasses; ++pass)
+  {
+    improved = false;
+
+    // 2-opt: reverse the subsequence [i, j].
+    for (size_t i = 1; i + 1 < _n; ++i)
+    {
+      for (size_t j = i + 1; j < _n; ++j)
+      {
+        double before = cost(i - 1, i) + forward[j] - forward[i];
+        double after = cost(i - 1, j) + backward[j] - backward[i];
+        if (j + 1 < _n)
+        {
+          before += cost(j, j + 1);
+          after += cost(i, j + 1);
+        }
+        if (after + kEpsilon < before)
+        {
+          std::reverse(order.begin() + i, order.begin() + j + 1);
+          accumulate();
+          improved = true;
+        }
+      }
+    }
+
+    // Or-opt: move the location at i between the locations at k and k + 1
+    // (or after the last one).
+    for (size_t i = 1; i < _n; ++i)
+    {
+      double removal = cost(i - 1, i);
+      if (i + 1 < _n)
+        removal += cost(i, i + 1) - cost(i - 1, i + 1);
+
+      for (size_t k = 0; k < _n; ++k)
+      {
+        if (k + 1 == i || k == i)
+          continue;
+
+        double insertion = cost(k, i);
+        if (k + 1 < _n)
+          insertion += cost(i, k + 1) - cost(k, k + 1);
+        if (insertion + kEpsilon < removal)
+        {
+          size_t location = order[i];
+          order.erase(order.begin() + i);
+          order.insert(order.begin() + (k < i ? k + 1 : k), location);
+          accumulate();
+          improved = true;
+          break;
+        }
+      }
+    }
+  }
+
+  return order;
+}
+
+//////////////////////////////////////////////////
+Mission::Mission()
+  : dataPtr(new MissionPrivate())
+{
+}
+
+//////////////////////////////////////////////////
+Mission::~Mission()
+{
+}
+
+//////////////////////////////////////////////////
+bool Mission::Compile(const rndf::RNDF &_rndf, const RoadNetwork &_network,
+  const std::vector<int> &_checkpoints, const bool _reorder)
+{
+  this->dataPtr->Clear();
+
+  // Resolve the checkpoints.
+  auto table = checkpointTable(_rndf);
+  std::vector<rndf::UniqueId> waypoints;
+  for (auto const &cpId : _checkpoints)
+  {
+    auto it = table.find(cpId);
+    if (it == table.end())
+    {
+      std::cerr << "Mission::Compile(): Unknown checkpoint [" << cpId << "]"
+                << std::endl;
+      return false;
+    }
+    waypoints.push_back(it->second);
+  }
+
+  std::vector<size_t> order(_checkpoints.size());
+  for (size_t i = 0; i < order.size(); ++i)
+    order[i] = i;
+
+  if (_reorder && order.size() > 2)
+  {
+    std::vector<double> costs;
+    if (!_network.CostMatrix(waypoints, waypoints, costs))
+      return false;
+    order = solveTour(costs, order.size());
+  }
+
+  std::vector<int> checkpoints;
+  std::vector<rndf::UniqueId> visits;
+  for (auto const &i : order)
+  {
+    checkpoints.push_back(_checkpoints[i]);
+    visits.push_back(waypoints[i]);
+  }
+
+  // Route every leg. All the queries run on this thread reuse the same
+  // search workspace.
+  std::vector<rndf::UniqueId> route;
+  std::vector<double> legCosts;
+  std::vector<size_t> legOffsets;
+  if (!visits.empty())
+    route.push_back(visits.front());
+
+  for (size_t i = 1; i < visits.size(); ++i)
+  {
+    std::vector<rndf::UniqueId> leg;
+    double cost;
+    if (!_network.ShortestPath(visits[i - 1], visits[i], leg, cost))
+    {
+      std::cerr << "Mission::Compile(): Checkpoint [" << checkpoints[i]
+                << "] is not reachable from checkpoint [" << checkpoints[i - 1]
+                << "]" << std::endl;
+      return false;
+    }
+
+    legOffsets.push_back(route.size() - 1);
+    legCosts.push_back(cost);
+    route.insert(route.end(), leg.begin() + 1, leg.end());
+  }
+
+  this->dataPtr->checkpoints = checkpoints;
+  this->dataPtr->waypoints = visits;
+  this->dataPtr->route = route;
+  this->dataPtr->legCosts = legCosts;
+  this->dataPtr->legOffsets = legOffsets;
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool Mission::Valid() const
+{
+  return !this->dataPtr->checkpoints.empty();
+}
+
+//////////////////////////////////////////////////
+const std::vector<int> &Mission::Checkpoints() const
+{
+  return this->dataPtr->checkpoints;
+}
+
+//////////////////////////////////////////////////
+const std::vector<rndf::UniqueId> &Mission::Waypoints() const
+{
+  return this->dataPtr->waypoints;
+}
+
+//////////////////////////////////////////////////
+const std::vector<rndf::UniqueId> &Mission::Route() const
+{
+  return this->dataPtr->route;
+}
+
+//////////////////////////////////////////////////
+size_t Mission::NumLegs() const
+{
+  return this->dataPtr->legCosts.size();
+}
+
+//////////////////////////////////////////////////
+const std::vector<double> &Mission::LegCosts() const
+{
+  return this->dataPtr->legCosts;
+}
+
+//////////////////////////////////////////////////
+bool Mission::Leg(const size_t _leg, std::vector<rndf::UniqueId> &_route) const
+{
+  if (_leg >= this->NumLegs())
+    return false;
+
+  auto const &offsets = this->dataPtr->legOffsets;
+  size_t first = offsets[_leg];
+  size_t last = _leg + 1 < offsets.size() ?
+    offsets[_leg + 1] : this->dataPtr->route.size() - 1;
+
+  _route.assign(this->dataPtr->route.begin() + first,
+                this->dataPtr->route.begin() + last + 1);
+  return true;
+}
+
+//////////////////////////////////////////////////
+double Mission::Cost() const
+{
+  double cost = 0;
+  for (auto const &legCost : this->dataPtr->legCosts)
+    cost += legCost;
+  return cost;
+}
+
+//////////////////////////////////////////////////
+bool Mission::CheckpointWaypoint(const rndf::RNDF &_rndf,
+  const int _checkpointId, rndf::UniqueId &_waypoint)
+{
+  auto table = checkpointTable(_rndf);
+  auto it = table.find(_checkpointId);
+  if (it == table.end())
+    return false;
+
+  _waypoint = it->second;
+  return true;
+}
@@ -0,0 +1,141 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "manifold/rndf/RNDF.hh"
+#include "manifold/rndf/UniqueId.hh"
+#include "manifold/Mission.hh"
+#include "manifold/RoadNetwork.hh"
+#include "manifold/test_config.h"
+#include "gtest/gtest.h"
+
+using namespace manifold;
+
+//////////////////////////////////////////////////
+/// \brief Check the resolution of checkpoints.
+TEST(Mission, CheckpointWaypoint)
+{
+  std::string dirPath(std::string(PROJECT_SOURCE_PATH));
+  rndf::RNDF rndf(dirPath + "/test/rndf/sample1.rndf");
+  EXPECT_TRUE(rndf.Valid());
+
+  rndf::UniqueId id;
+  // Lane checkpoint.
+  ASSERT_TRUE(Mission::CheckpointWaypoint(rndf, 7, id));
+  EXPECT_EQ(id, rndf::UniqueId(2, 1, 2));
+  // Parking spot checkpoint.
+  ASSERT_TRUE(Mission::CheckpointWaypoint(rndf, 14, id));
+  EXPECT_EQ(id, rndf::UniqueId(14, 3, 2));
+  // Unknown checkpoint.
+  EXPECT_FALSE(Mission::CheckpointWaypoint(rndf, 99, id));
+}
+
+//////////////////////////////////////////////////
+/// \brief Check a mission visited in the given order.
+TEST(Mission, Ordered)
+{
+  std::string dirPath(std::string(PROJECT_SOURCE_PATH));
+  rndf::RNDF rndf(dirPath + "/test/rndf/sample1.rndf");
+  EXPECT_TRUE(rndf.Valid());
+  RoadNetwork roadNetwork(rndf);
+
+  Mission mission;
+  EXPECT_FALSE(mission.Valid());
+  EXPECT_EQ(mission.NumLegs(), 0u);
+
+  // Unknown checkpoint.
+  EXPECT_FALSE(mission.Compile(rndf, roadNetwork, {1, 99}));
+  EXPECT_FALSE(mission.Valid());
+
+  std::vector<int> checkpoints = {1, 14, 7, 4};
+  ASSERT_TRUE(mission.Compile(rndf, roadNetwork, checkpoints));
+  EXPECT_TRUE(mission.Valid());
+  EXPECT_EQ(mission.Checkpoints(), checkpoints);
+  ASSERT_EQ(mission.Waypoints().size(), checkpoints.size());
+  ASSERT_EQ(mission.NumLegs(), checkpoints.size() - 1);
+  ASSERT_EQ(mission.LegCosts().size(), mission.NumLegs());
+
+  // The route starts and ends at the first and last checkpoint.
+  auto const &route = mission.Route();
+  ASSERT_FALSE(route.empty());
+  EXPECT_EQ(route.front(), mission.Waypoints().front());
+  EXPECT_EQ(route.back(), mission.Waypoints().back());
+
+  // Each leg matches a point to point query and the legs are chained.
+  double total = 0;
+  size_t waypoints = 1;
+  for (size_t i = 0; i < mission.NumLegs(); ++i)
+  {
+    std::vector<rndf::UniqueId> leg;
+    ASSERT_TRUE(mission.Leg(i, leg));
+    EXPECT_EQ(leg.front(), mission.Waypoints().at(i));
+    EXPECT_EQ(leg.back(), mission.Waypoints().at(i + 1));
+
+    std::vector<rndf::UniqueId> path;
+    double cost;
+    ASSERT_TRUE(roadNetwork.ShortestPath(mission.Waypoints().at(i),
+      mission.Waypoints().at(i + 1), path, cost));
+    EXPECT_EQ(leg, path);
+    EXPECT_DOUBLE_EQ(mission.LegCosts().at(i), cost);
+    total += cost;
+    waypoints += leg.size() - 1;
+  }
+  EXPECT_DOUBLE_EQ(mission.Cost(), total);
+  EXPECT_EQ(route.size(), waypoints);
+
+  std::vector<rndf::UniqueId> leg;
+  EXPECT_FALSE(mission.Leg(mission.NumLegs(), leg));
+}
+
+//////////////////////////////////////////////////
+/// \brief Check a mission where the visit order is optimized.
+TEST(Mission, Reorder)
+{
+  std::string dirPath(std::string(PROJECT_SOURCE_PATH));
+  rndf::RNDF rndf(dirPath + "/test/rndf/sample1.rndf");
+  EXPECT_TRUE(rndf.Valid());
+  RoadNetwork roadNetwork(rndf);
+
+  std::vector<int> checkpoints = {1, 14, 7, 4, 11, 2, 9, 17, 5};
+  Mission ordered;
+  ASSERT_TRUE(ordered.Compile(rndf, roadNetwork, checkpoints));
+
+  Mission reordered;
+  ASSERT_TRUE(reordered.Compile(rndf, roadNetwork, checkpoints, true));
+
+  // The start is preserved and all the checkpoints are visited once.
+  ASSERT_EQ(reordered.Checkpoints().size(), checkpoints.size());
+  EXPECT_EQ(reordered.Checkpoints().front(), checkpoints.front());
+  auto sorted = reordered.Checkpoints();
+  std::sort(sorted.begin(), sorted.end());
+  auto expected = checkpoints;
+  std::sort(expected.begin(), expected.end());
+  EXPECT_EQ(sorted, expected);
+
+  // The optimized order is never worse than the original one.
+  EXPECT_LE(reordered.Cost(), ordered.Cost() + 1e-6);
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ParallelFor.hh"
+
+using namespace manifold;
+
+namespace
+{
+  /// \internal
+  /// \brief The queue of pending tasks of a worker.
+  class WorkerQueue
+  {
+    /// \brief Take the most recently queued task of this worker.
+    /// \param[out] _task The task.
+    /// \return True if a task was available.
+    public: bool Pop(size_t &_task)
+    {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      if (this->tasks.empty())
+        return false;
+
+      _task = this->tasks.back();
+      this->tasks.pop_back();
+      return true;
+    }
+
+    /// \brief Take the oldest task queued in this worker. Used by other
+    /// workers once they run out of work.
+    /// \param[out] _task The task.
+    /// \return True if a task was available.
+    public: bool Steal(size_t &_task)
+    {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      if (this->tasks.empty())
+        return false;
+
+      _task = this->tasks.front();
+      this->tasks.pop_front();
+      return true;
+    }
+
+    /// \brief Protects the queue.
+    public: std::mutex mutex;
+
+    /// \brief Pending tasks.
+    public: std::deque<size_t> tasks;
+  };
+}
+
+//////////////////////////////////////////////////
+unsigned int manifold::workerCount(const unsigned int _requested,
+  const size_t _tasks)
+{
+  size_t workers = _requested;
+  if (workers == 0)
+    workers = std::max(1u, std::thread::hardware_concurrency());
+
+  return static_cast<unsigned int>(
+    std::max<size_t>(1u, std::min(workers, _tasks)));
+}
+
+//////////////////////////////////////////////////
+void manifold::parallelFor(const size_t _count, const unsigned int _workers,
+  const std::function<void(const size_t, const unsigned int)> &_task)
+{
+  if (_count == 0)
+    return;
+
+  const unsigned int workers = std::max(1u, _workers);
+  if (workers == 1)
+  {
+    for (size_t i = 0; i < _count; ++i)
+      _task(i, 0);
+    return;
+  }
+
+  // Deal the tasks in contiguous blocks. The back of each queue holds the
+  // lowest indexes, so each worker walks its block in increasing order.
+  std::vector<std::unique_ptr<WorkerQueue>> queues;
+  for (unsigned int w = 0; w < workers; ++w)
+  {
+    queues.emplace_back(new WorkerQueue());
+    size_t first = _count * w / workers;
+    size_t last = _count * (w + 1) / workers;
+    for (size_t i = last; i > first; --i)
+      queues.back()->tasks.push_back(i - 1);
+  }
+
+  auto work = [&](const unsigned int _worker)
+  {
+    size_t task;
+    while (true)
+    {
+      if (queues[_worker]->Pop(task))
+      {
+        _task(task, _worker);
+        continue;
+      }
+
+      // Our queue is empty: try to steal from the other workers.
+      bool stolen = false;
+      for (unsigned int i = 1; i < workers && !stolen; ++i)
+        stolen = queues[(_worker + i) % workers]->Steal(task);
+
+      if (!stolen)
+        return;
+
+      _task(task, _worker);
+    }
+  };
+
+  std::vector<std::thread> threads;
+  for (unsigned int w = 1; w < workers; ++w)
+    threads.emplace_back(work, w);
+
+  work(0);
+
+  for (auto &thread : threads)
+    thread.join();
+}
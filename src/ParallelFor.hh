@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef MANIFOLD_PARALLELFOR_HH_
+#define MANIFOLD_PARALLELFOR_HH_
+
+#include <cstddef>
+#include <functional>
+
+namespace manifold
+{
+  /// \internal
+  /// \brief Get the number of workers to use for a parallel job.
+  /// \param[in] _requested Number of threads requested by the caller. A value
+  /// of 0 selects the number of hardware threads available.
+  /// \param[in] _tasks Number of tasks to run. There's no point in having
+  /// more workers than tasks.
+  /// \return The number of workers (at least 1).
+  unsigned int workerCount(const unsigned int _requested,
+                           const size_t _tasks);
+
+  /// \internal
+  /// \brief Run _task(i, w) for every i in [0, _count) using _workers
+  /// threads. The tasks are initially split in contiguous blocks, one per
+  /// worker. A worker pops tasks from the back of its own queue and, when the
+  /// queue is empty, steals from the front of the queue of another worker,
+  /// so uneven task costs are balanced without a central queue.
+  /// The calling thread is used as worker 0.
+  /// \param[in] _count Number of tasks.
+  /// \param[in] _workers Number of workers (see workerCount()).
+  /// \param[in] _task Function executed for each task. The second argument is
+  /// the index of the worker running the task, in [0, _workers). It can be
+  /// used to index per-worker state without locking.
+  void parallelFor(const size_t _count,
+                   const unsigned int _workers,
+                   const std::function<void(const size_t,
+                                            const unsigned int)> &_task);
+}
+#endif
@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef MANIFOLD_RADIXHEAP_HH_
+#define MANIFOLD_RADIXHEAP_HH_
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <vector>
+
+namespace manifold
+{
+  /// \internal
+  /// \brief A monotone priority queue of (cost, vertex) pairs for
+  /// Dijkstra's algorithm: the extracted costs never decrease, so the
+  /// costs pushed can't be lower than the last one extracted.
+  ///
+  /// Items are kept in buckets by the highest bit in which their key
+  /// differs from the last key extracted. The key of a non-negative
+  /// double is its bit pattern, which has the same order, so the costs are
+  /// exact. Each item is moved to a lower bucket at most 64 times and the
+  /// buckets keep their memory, so a reused heap doesn't allocate.
+  class RadixHeap
+  {
+    /// \brief Remove all the items.
+    public: void Clear()
+    {
+      for (auto &bucket : this->buckets)
+        bucket.clear();
+      this->size = 0;
+      this->last = 0;
+    }
+
+    /// \brief Whether the heap is empty.
+    /// \return True if there are no items.
+    public: bool Empty() const
+    {
+      return this->size == 0;
+    }
+
+    /// \brief Add an item.
+    /// \param[in] _cost Cost, not lower than the last one extracted.
+    /// \param[in] _v Vertex index.
+    public: void Push(const double _cost, const unsigned int _v)
+    {
+      auto key = Key(_cost);
+      assert(key >= this->last);
+      this->buckets[this->Bucket(key)].push_back(std::make_pair(key, _v));
+      ++this->size;
+    }
+
+    /// \brief Extract an item with the lowest cost.
+    /// \param[out] _cost Cost of the item.
+    /// \param[out] _v Vertex index.
+    /// \return True if an item was extracted or false if the heap is empty.
+    public: bool Pop(double &_cost, unsigned int &_v)
+    {
+      if (this->size == 0)
+        return false;
+
+      if (this->buckets[0].empty())
+      {
+        // Move the items of the first non-empty bucket to lower buckets,
+        // relative to its minimum key. The minimum goes to bucket 0.
+        size_t i = 1;
+        while (this->buckets[i].empty())
+          ++i;
+
+        auto &bucket = this->buckets[i];
+        this->last = bucket.front().first;
+        for (auto const &item : bucket)
+          this->last = std::min(this->last, item.first);
+        for (auto const &item : bucket)
+          this->buckets[this->Bucket(item.first)].push_back(item);
+        bucket.clear();
+      }
+
+      auto const &item = this->buckets[0].back();
+      std::memcpy(&_cost, &item.first, sizeof(_cost));
+      _v = item.second;
+      this->buckets[0].pop_back();
+      --this->size;
+      return true;
+    }
+
+    /// \brief Key of a non-negative cost.
+    /// \param[in] _cost The cost.
+    /// \return Its bit pattern.
+    private: static uint64_t Key(const double _cost)
+    {
+      // Map -0.0 to 0.0.
+      double cost = _cost + 0.0;
+      uint64_t key;
+      std::memcpy(&key, &cost, sizeof(key));
+      return key;
+    }
+
+    /// \brief Bucket of a key.
+    /// \param[in] _key The key.
+    /// \return 0 if it's equal to the last key extracted, or one plus the
+    /// index of the highest bit in which they differ.
+    private: size_t Bucket(const uint64_t _key) const
+    {
+      uint64_t diff = _key ^ this->last;
+      if (diff == 0)
+        return 0;
+#if defined(__GNUC__)
+      return 64 - static_cast<size_t>(__builtin_clzll(diff));
+#else
+      size_t bucket = 0;
+      for (; diff != 0; diff >>= 1)
+        ++bucket;
+      return bucket;
+#endif
+    }
+
+    /// \brief Items of each bucket as (key, vertex) pairs.
+    private: std::vector<std::pair<uint64_t, unsigned int>> buckets[65];
+
+    /// \brief Number of items.
+    private: size_t size = 0;
+
+    /// \brief Last key extracted.
+    private: uint64_t last = 0;
+  };
+}
+#endif
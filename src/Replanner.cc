@@ -0,0 +1,395 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <utility>
+#include <vector>
+#include <ignition/math/SphericalCoordinates.hh>
+
+#include "manifold/rndf/UniqueId.hh"
+#include "manifold/Replanner.hh"
+#include "manifold/RoadNetwork.hh"
+#include "RoadNetworkPrivate.hh"
+
+using namespace manifold;
+
+namespace manifold
+{
+  /// \internal
+  /// \brief Priority of a vertex in the D* Lite queue. Keys are compared
+  /// lexicographically.
+  using Key = std::pair<double, double>;
+
+  /// \internal
+  /// \brief Private data for Replanner class.
+  class ReplannerPrivate
+  {
+    /// \brief The queue type: a min-heap of (key, vertex) pairs.
+    public: using Queue = std::priority_queue<std::pair<Key, unsigned int>,
+      std::vector<std::pair<Key, unsigned int>>,
+      std::greater<std::pair<Key, unsigned int>>>;
+
+    /// \brief Constructor.
+    /// \param[in] _graph The routing graph.
+    public: explicit ReplannerPrivate(RoadNetworkPrivate &_graph)
+      : graph(_graph),
+        changeLog(_graph.edgeChanges),
+        cursor(_graph.edgeChanges.Open())
+    {
+    }
+
+    /// \brief Destructor.
+    public: virtual ~ReplannerPrivate()
+    {
+      this->changeLog.Close(this->cursor);
+    }
+
+    /// \brief Lower bound of the cost between the vehicle and a vertex.
+    /// \param[in] _v Vertex index.
+    /// \return The great-circle distance from the current start to _v.
+    public: double Heuristic(const unsigned int _v)
+    {
+      // The distances are cached until the vehicle moves.
+      if (this->heuristicStamps[_v] != this->heuristicGeneration)
+      {
+        this->heuristicStamps[_v] = this->heuristicGeneration;
+        this->heuristics[_v] = ignition::math::SphericalCoordinates::Distance(
+          this->graph.latitudes[this->start],
+          this->graph.longitudes[this->start],
+          this->graph.latitudes[_v], this->graph.longitudes[_v]);
+      }
+      return this->heuristics[_v];
+    }
+
+    /// \brief Invalidate the cached heuristic values.
+    public: void ResetHeuristic()
+    {
+      const size_t n = this->graph.ids.size();
+      if (this->heuristicStamps.size() != n ||
+          this->heuristicGeneration == std::numeric_limits<unsigned int>::max())
+      {
+        this->heuristicStamps.assign(n, 0);
+        this->heuristics.resize(n);
+        this->heuristicGeneration = 0;
+      }
+      ++this->heuristicGeneration;
+    }
+
+    /// \brief Compute the priority of a vertex.
+    /// \param[in] _v Vertex index.
+    /// \return The key.
+    public: Key CalculateKey(const unsigned int _v)
+    {
+      double m = std::min(this->g[_v], this->rhs[_v]);
+      return Key(m + this->Heuristic(_v) + this->km, m);
+    }
+
+    /// \brief Whether the cost of a vertex matches its lookahead cost.
+    /// \param[in] _v Vertex index.
+    /// \return True if the vertex is locally consistent.
+    public: bool Consistent(const unsigned int _v) const
+    {
+      return !(this->g[_v] < this->rhs[_v]) && !(this->g[_v] > this->rhs[_v]);
+    }
+
+    /// \brief Reset the search state and queue the goal.
+    public: void Initialize()
+    {
+      const size_t n = this->graph.ids.size();
+      const double kInf = std::numeric_limits<double>::infinity();
+      this->g.assign(n, kInf);
+      this->rhs.assign(n, kInf);
+      this->queue = Queue();
+      this->km = 0;
+      this->last = this->start;
+      this->ResetHeuristic();
+
+      this->rhs[this->goal] = 0;
+      this->queue.push(std::make_pair(this->CalculateKey(this->goal),
+                                      this->goal));
+      this->revision = this->graph.revision;
+      this->changeLog.Skip(this->cursor);
+    }
+
+    /// \brief Recompute the one-step lookahead cost of a vertex and queue it
+    /// if it's inconsistent. Outdated queue entries are discarded when
+    /// popped.
+    /// \param[in] _u Vertex index.
+    public: void UpdateVertex(const unsigned int _u)
+    {
+      if (_u != this->goal)
+      {
+        double best = std::numeric_limits<double>::infinity();
+        for (auto const &link : this->graph.links[_u])
+          best = std::min(best, link.Cost() + this->g[link.head]);
+        this->rhs[_u] = best;
+      }
+
+      if (!this->Consistent(_u))
+        this->queue.push(std::make_pair(this->CalculateKey(_u), _u));
+    }
+
+    /// \brief Expand vertexes until the cost of the start is final.
+    public: void ComputeShortestPath()
+    {
+      while (!this->queue.empty() &&
+             (this->queue.top().first < this->CalculateKey(this->start) ||
+              !this->Consistent(this->start)))
+      {
+        auto top = this->queue.top();
+        this->queue.pop();
+        unsigned int u = top.second;
+
+        // Outdated entry.
+        if (this->Consistent(u))
+          continue;
+
+        Key newKey = this->CalculateKey(u);
+        if (top.first < newKey)
+        {
+          this->queue.push(std::make_pair(newKey, u));
+          continue;
+        }
+
+        ++this->expansions;
+        if (this->g[u] > this->rhs[u])
+        {
+          this->g[u] = this->rhs[u];
+        }
+        else
+        {
+          this->g[u] = std::numeric_limits<double>::infinity();
+          this->UpdateVertex(u);
+        }
+
+        for (auto const &in : this->graph.inbound[u])
+          this->UpdateVertex(in.tail);
+      }
+    }
+
+    /// \brief Follow the cheapest edges from the start to the goal.
+    /// \return True if the goal is reachable.
+    public: bool ExtractRoute()
+    {
+      this->route.clear();
+      this->cost = std::numeric_limits<double>::infinity();
+      if (std::isinf(this->g[this->start]))
+        return false;
+
+      double total = 0;
+      unsigned int v = this->start;
+      for (size_t steps = 0; steps < this->g.size(); ++steps)
+      {
+        if (this->graph.ids[v].Valid())
+          this->route.push_back(this->graph.ids[v]);
+
+        if (v == this->goal)
+        {
+          this->cost = total;
+          return true;
+        }
+
+        const Link *next = nullptr;
+        double best = std::numeric_limits<double>::infinity();
+        for (auto const &link : this->graph.links[v])
+        {
+          double c = link.Cost() + this->g[link.head];
+          if (c < best)
+          {
+            best = c;
+            next = &link;
+          }
+        }
+
+        if (!next)
+          break;
+
+        total += next->Cost();
+        v = next->head;
+      }
+
+      this->route.clear();
+      return false;
+    }
+
+    /// \brief The routing graph.
+    public: const RoadNetworkPrivate &graph;
+
+    /// \brief Changes of the routing graph.
+    public: EdgeChangeLog &changeLog;
+
+    /// \brief Cursor in the log of changes.
+    public: size_t cursor;
+
+    /// \brief Whether Plan() has been called.
+    public: bool planned = false;
+
+    /// \brief Unique Id of the start waypoint.
+    public: rndf::UniqueId startId;
+
+    /// \brief Unique Id of the goal waypoint.
+    public: rndf::UniqueId goalId;
+
+    /// \brief Index of the current position of the vehicle.
+    public: unsigned int start = 0;
+
+    /// \brief Index of the goal.
+    public: unsigned int goal = 0;
+
+    /// \brief Position of the vehicle when the keys were last corrected.
+    public: unsigned int last = 0;
+
+    /// \brief Key modifier accumulated while the vehicle moves.
+    public: double km = 0;
+
+    /// \brief Cost to the goal of each vertex.
+    public: std::vector<double> g;
+
+    /// \brief One-step lookahead cost to the goal of each vertex.
+    public: std::vector<double> rhs;
+
+    /// \brief Cached heuristic value of each vertex.
+    public: std::vector<double> heuristics;
+
+    /// \brief Generation in which each heuristic value was computed.
+    public: std::vector<unsigned int> heuristicStamps;
+
+    /// \brief Current generation of the heuristic values. It changes each
+    /// time that the vehicle moves.
+    public: unsigned int heuristicGeneration = 0;
+
+    /// \brief Vertexes to expand.
+    public: Queue queue;
+
+    /// \brief Revision of the graph used by the search.
+    public: unsigned int revision = 0;
+
+
+    /// \brief Expansions of the last search.
+    public: size_t expansions = 0;
+
+    /// \brief Current route.
+    public: std::vector<rndf::UniqueId> route;
+
+    /// \brief Cost of the current route.
+    public: double cost = std::numeric_limits<double>::infinity();
+  };
+}
+
+//////////////////////////////////////////////////
+Replanner::Replanner(const RoadNetwork &_network)
+  : dataPtr(new ReplannerPrivate(*_network.dataPtr))
+{
+}
+
+//////////////////////////////////////////////////
+Replanner::~Replanner()
+{
+}
+
+//////////////////////////////////////////////////
+bool Replanner::Plan(const rndf::UniqueId &_start, const rndf::UniqueId &_goal)
+{
+  auto &d = *this->dataPtr;
+  d.planned = false;
+  d.route.clear();
+  d.cost = std::numeric_limits<double>::infinity();
+  d.expansions = 0;
+  std::vector<unsigned int> indexes;
+  if (!d.graph.Indexes({_start, _goal}, indexes))
+    return false;
+
+  d.startId = _start;
+  d.goalId = _goal;
+  d.start = indexes[0];
+  d.goal = indexes[1];
+  d.planned = true;
+  d.Initialize();
+  d.ComputeShortestPath();
+  return d.ExtractRoute();
+}
+
+//////////////////////////////////////////////////
+bool Replanner::MoveTo(const rndf::UniqueId &_waypoint)
+{
+  auto &d = *this->dataPtr;
+  unsigned int v;
+  if (!d.planned || !d.graph.Index(_waypoint, v))
+    return false;
+
+  d.startId = _waypoint;
+  d.start = v;
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool Replanner::Replan()
+{
+  auto &d = *this->dataPtr;
+  if (!d.planned)
+    return false;
+
+  // The vertexes or edges changed: start from scratch.
+  if (d.revision != d.graph.revision)
+    return this->Plan(d.startId, d.goalId);
+
+  d.expansions = 0;
+  if (d.start != d.last)
+  {
+    // Keep the keys already queued comparable with the new ones.
+    d.km += ignition::math::SphericalCoordinates::Distance(
+      d.graph.latitudes[d.last], d.graph.longitudes[d.last],
+      d.graph.latitudes[d.start], d.graph.longitudes[d.start]);
+    d.last = d.start;
+    d.ResetHeuristic();
+  }
+
+  // Start from scratch if some changes were missed.
+  if (!d.changeLog.Read(d.cursor,
+        [&d](const unsigned int _tail, const unsigned int)
+        {
+          d.UpdateVertex(_tail);
+        }))
+  {
+    return this->Plan(d.startId, d.goalId);
+  }
+
+  d.ComputeShortestPath();
+  return d.ExtractRoute();
+}
+
+//////////////////////////////////////////////////
+const std::vector<rndf::UniqueId> &Replanner::Route() const
+{
+  return this->dataPtr->route;
+}
+
+//////////////////////////////////////////////////
+double Replanner::Cost() const
+{
+  return this->dataPtr->cost;
+}
+
+//////////////////////////////////////////////////
+size_t Replanner::Expansions() const
+{
+  return this->dataPtr->expansions;
+}
@@ -0,0 +1,203 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "manifold/rndf/RNDF.hh"
+#include "manifold/rndf/UniqueId.hh"
+#include "manifold/Replanner.hh"
+#include "manifold/RoadNetwork.hh"
+#include "manifold/test_config.h"
+#include "gtest/gtest.h"
+
+using namespace manifold;
+
+//////////////////////////////////////////////////
+/// \brief Check planning, closures and reopening.
+TEST(Replanner, Closures)
+{
+  std::string dirPath(std::string(PROJECT_SOURCE_PATH));
+
+  rndf::RNDF rndf(dirPath + "/test/rndf/sample1.rndf");
+  EXPECT_TRUE(rndf.Valid());
+
+  RoadNetwork roadNetwork(rndf);
+  Replanner replanner(roadNetwork);
+
+  // Nothing planned yet.
+  EXPECT_FALSE(replanner.Replan());
+  EXPECT_FALSE(replanner.MoveTo(rndf::UniqueId(1, 2, 1)));
+  EXPECT_TRUE(replanner.Route().empty());
+  EXPECT_TRUE(std::isinf(replanner.Cost()));
+
+  // Unknown waypoints.
+  EXPECT_FALSE(replanner.Plan(rndf::UniqueId(99, 1, 1),
+    rndf::UniqueId(3, 1, 1)));
+
+  rndf::UniqueId start(1, 2, 1);
+  rndf::UniqueId goal(3, 1, 1);
+  ASSERT_TRUE(replanner.Plan(start, goal));
+  std::vector<rndf::UniqueId> path;
+  double cost;
+  ASSERT_TRUE(roadNetwork.ShortestPath(start, goal, path, cost));
+  EXPECT_EQ(replanner.Route(), path);
+  EXPECT_NEAR(replanner.Cost(), cost, 1e-6);
+  EXPECT_GT(replanner.Expansions(), 0u);
+
+  // Close the exit used by the route.
+  EXPECT_FALSE(roadNetwork.CloseEdge(rndf::UniqueId(1, 2, 1), goal));
+  EXPECT_TRUE(roadNetwork.CloseEdge(rndf::UniqueId(1, 2, 4), goal));
+  EXPECT_FALSE(roadNetwork.ShortestPath(start, goal, path, cost));
+  EXPECT_FALSE(replanner.Replan());
+  EXPECT_TRUE(replanner.Route().empty());
+
+  // Reopen it with a penalty.
+  EXPECT_TRUE(roadNetwork.SetEdgePenalty(rndf::UniqueId(1, 2, 4), goal, 10));
+  ASSERT_TRUE(replanner.Replan());
+  ASSERT_TRUE(roadNetwork.ShortestPath(start, goal, path, cost));
+  EXPECT_EQ(replanner.Route(), path);
+  EXPECT_NEAR(replanner.Cost(), cost, 1e-6);
+
+  // Move along the route.
+  EXPECT_TRUE(replanner.MoveTo(rndf::UniqueId(1, 2, 2)));
+  ASSERT_TRUE(replanner.Replan());
+  ASSERT_FALSE(replanner.Route().empty());
+  EXPECT_EQ(replanner.Route().front(), rndf::UniqueId(1, 2, 2));
+  ASSERT_TRUE(roadNetwork.ShortestPath(rndf::UniqueId(1, 2, 2), goal, path,
+    cost));
+  EXPECT_NEAR(replanner.Cost(), cost, 1e-6);
+
+  // Removing a segment forces a search from scratch.
+  roadNetwork.ClearOverlay();
+  EXPECT_TRUE(roadNetwork.RemoveSegment(3));
+  EXPECT_FALSE(replanner.Replan());
+}
+
+//////////////////////////////////////////////////
+/// \brief Check a burst of penalty updates between replans that is longer
+/// than the changes kept for the replanner.
+TEST(Replanner, LongBurst)
+{
+  std::string dirPath(std::string(PROJECT_SOURCE_PATH));
+
+  rndf::RNDF rndf(dirPath + "/test/rndf/sample1.rndf");
+  EXPECT_TRUE(rndf.Valid());
+
+  RoadNetwork roadNetwork(rndf);
+  Replanner replanner(roadNetwork);
+
+  rndf::UniqueId start(1, 2, 1);
+  rndf::UniqueId goal(3, 1, 1);
+  ASSERT_TRUE(replanner.Plan(start, goal));
+
+  rndf::UniqueId tail(1, 2, 4);
+  for (int i = 0; i < 100000; ++i)
+    EXPECT_TRUE(roadNetwork.SetEdgePenalty(tail, goal, i % 100));
+
+  std::vector<rndf::UniqueId> path;
+  double cost;
+  ASSERT_TRUE(replanner.Replan());
+  ASSERT_TRUE(roadNetwork.ShortestPath(start, goal, path, cost));
+  EXPECT_EQ(replanner.Route(), path);
+  EXPECT_NEAR(replanner.Cost(), cost, 1e-6);
+
+  // A short burst is applied incrementally.
+  EXPECT_TRUE(roadNetwork.OpenEdge(tail, goal));
+  ASSERT_TRUE(replanner.Replan());
+  ASSERT_TRUE(roadNetwork.ShortestPath(start, goal, path, cost));
+  EXPECT_EQ(replanner.Route(), path);
+  EXPECT_NEAR(replanner.Cost(), cost, 1e-6);
+}
+
+//////////////////////////////////////////////////
+/// \brief The repaired routes match a search from scratch after each
+/// change.
+TEST(Replanner, RandomChanges)
+{
+  std::string dirPath(std::string(PROJECT_SOURCE_PATH));
+
+  rndf::RNDF rndf(dirPath + "/test/rndf/sample1.rndf");
+  EXPECT_TRUE(rndf.Valid());
+
+  RoadNetwork roadNetwork(rndf);
+  Replanner replanner(roadNetwork);
+
+  rndf::UniqueId start(1, 2, 1);
+  rndf::UniqueId goal(14, 0, 5);
+  ASSERT_TRUE(replanner.Plan(start, goal));
+
+  std::mt19937 generator(42);
+  for (int i = 0; i < 100; ++i)
+  {
+    // Pick an edge of the current route or, if there's no route, an edge
+    // that leaves the vehicle's position.
+    auto const route = replanner.Route();
+    rndf::UniqueId tail = start;
+    rndf::UniqueId head;
+    if (route.size() > 1)
+    {
+      std::uniform_int_distribution<size_t> d(0, route.size() - 2);
+      size_t k = d(generator);
+      tail = route[k];
+      head = route[k + 1];
+    }
+
+    std::uniform_int_distribution<int> action(0, 3);
+    switch (action(generator))
+    {
+      case 0:
+        roadNetwork.CloseEdge(tail, head);
+        break;
+      case 1:
+        roadNetwork.SetEdgePenalty(tail, head, 25.0);
+        break;
+      case 2:
+        roadNetwork.ClearOverlay();
+        break;
+      default:
+        // Advance one waypoint.
+        if (route.size() > 2)
+        {
+          start = route[1];
+          EXPECT_TRUE(replanner.MoveTo(start));
+        }
+        break;
+    }
+
+    std::vector<rndf::UniqueId> path;
+    double cost;
+    bool expected = roadNetwork.ShortestPath(start, goal, path, cost);
+    ASSERT_EQ(replanner.Replan(), expected);
+    if (expected)
+    {
+      EXPECT_NEAR(replanner.Cost(), cost, 1e-6);
+      ASSERT_FALSE(replanner.Route().empty());
+      EXPECT_EQ(replanner.Route().front(), start);
+      EXPECT_EQ(replanner.Route().back(), goal);
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
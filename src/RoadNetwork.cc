@@ -15,185 +15,690 @@
  *
 */
 
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <map>
 #include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
 #include <ignition/math/Graph.hh>
 
 #include "manifold/rndf/Exit.hh"
-#include "manifold/rndf/Perimeter.hh"
 #include "manifold/rndf/RNDF.hh"
-#include "manifold/rndf/ParkingSpot.hh"
 #include "manifold/rndf/Segment.hh"
-#include "manifold/rndf/Waypoint.hh"
+#include "manifold/rndf/UniqueId.hh"
 #include "manifold/rndf/Zone.hh"
 #include "manifold/RoadNetwork.hh"
+#include "ParallelFor.hh"
+#include "RoadNetworkPrivate.hh"
 
 using namespace manifold;
 
-namespace manifold
+//////////////////////////////////////////////////
+RoadNetwork::RoadNetwork(const rndf::RNDF &_rndf,
+  const RoadNetworkOptions &_options)
+  : dataPtr(new RoadNetworkPrivate())
+{
+  this->dataPtr->options = _options;
+  this->dataPtr->Build(_rndf);
+}
+
+//////////////////////////////////////////////////
+RoadNetwork::RoadNetwork(const rndf::RNDF &_rndf,
+  const std::string &_cachePath, const RoadNetworkOptions &_options)
+  : dataPtr(new RoadNetworkPrivate())
+{
+  this->dataPtr->options = _options;
+  auto hash = contentHash(_rndf, _options);
+  std::ifstream in(_cachePath, std::ios::binary);
+  if (in && this->dataPtr->Read(in, hash))
+    return;
+
+  // Missing, stale or corrupted file.
+  this->dataPtr.reset(new RoadNetworkPrivate());
+  this->dataPtr->options = _options;
+  this->dataPtr->Build(_rndf);
+  this->Save(_cachePath, _rndf);
+}
+
+//////////////////////////////////////////////////
+RoadNetwork::~RoadNetwork()
+{
+}
+
+//////////////////////////////////////////////////
+bool RoadNetwork::Save(const std::string &_path,
+  const rndf::RNDF &_rndf) const
 {
-  /// \internal
-  /// \brief Private data for RoadNetwork class.
-  class RoadNetworkPrivate
+  // Write to a temporary file first, so a reader never sees a partial file.
+  std::string tmpPath = _path + ".tmp";
+  bool written = false;
   {
-    /// \brief Constructor.
-    public: RoadNetworkPrivate() = default;
+    std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+    if (out)
+    {
+      this->dataPtr->Write(out,
+        contentHash(_rndf, this->dataPtr->options));
+      out.close();
+      written = !out.fail();
+    }
+  }
 
-    /// \brief Destructor.
-    public: virtual ~RoadNetworkPrivate() = default;
+  if (!written || std::rename(tmpPath.c_str(), _path.c_str()) != 0)
+  {
+    std::cerr << "RoadNetwork::Save(): Unable to write [" << _path << "]"
+              << std::endl;
+    std::remove(tmpPath.c_str());
+    return false;
+  }
+  return true;
+}
 
-    /// \brief Graph of segments.
-    /// The vertex contains a string (waypoint Id) and the edge an
-    /// integer (unused).
-    public: ignition::math::DirectedGraph<std::string, int> network;
+//////////////////////////////////////////////////
+bool RoadNetwork::UpToDate(const std::string &_path,
+  const rndf::RNDF &_rndf, const RoadNetworkOptions &_options)
+{
+  std::ifstream in(_path, std::ios::binary);
+  RoadNetworkPrivate loaded;
+  return in && loaded.Read(in, contentHash(_rndf, _options));
+}
 
-    /// \brief Type of road file loaded into the graph.
-    public: std::string type = "";
-  };
+//////////////////////////////////////////////////
+const ignition::math::DirectedGraph<std::string, int> &RoadNetwork::Graph()
+  const
+{
+  this->dataPtr->SyncGraph();
+  return this->dataPtr->network;
 }
 
 //////////////////////////////////////////////////
-RoadNetwork::RoadNetwork(const rndf::RNDF &_rndf)
-  : dataPtr(new RoadNetworkPrivate())
+std::string RoadNetwork::RoadType() const
+{
+  return this->dataPtr->type;
+}
+
+//////////////////////////////////////////////////
+const RoadNetworkOptions &RoadNetwork::Options() const
 {
-  // Populate the graph.
-  // Vertexes (all waypoints):
-  //   * All waypoints in each segment.
-  //   * All perimeter points in each zone.
-  //   * All waypoints in each parking spot.
-  // Edges:
-  //   * Waypoint_i to waypoint_i_+_1 within the same lane and segment.
-  //   * Exit waypoint from a segment to entry waypoint of another segment/zone.
-  //   * Perimeter point to another perimeter point within the same zone.
-  //   * Perimeter point to first waypoint of parking spot within the same zone.
-  //   * First waypoint of parking spot to perimeter point within the same zone.
-  //   * First waypoint of a parking spot to its second waypoint.
-  //   * Second waypoint of a parking spot to its first waypoint.
-  //   * Exit waypoint of a zone to an entry waypoint of another segment/zone.
-
-  // Add all waypoints within segments as vertexes.
-  for (auto const &segment : _rndf.Segments())
-    for (auto const &lane : segment.Lanes())
+  return this->dataPtr->options;
+}
+
+//////////////////////////////////////////////////
+bool RoadNetwork::ShortestPath(const rndf::UniqueId &_src,
+  const rndf::UniqueId &_dst, std::vector<rndf::UniqueId> &_path,
+  double &_cost) const
+{
+  std::vector<unsigned int> ends;
+  if (!this->dataPtr->Indexes({_src, _dst}, ends))
+    return false;
+
+  std::vector<unsigned int> route;
+  if (!this->dataPtr->Route(ends[0], ends[1], route, _cost))
+    return false;
+
+  _path.clear();
+  for (auto const &v : route)
+  {
+    // Skip the zone hubs.
+    if (this->dataPtr->ids[v].Valid())
+      _path.push_back(this->dataPtr->ids[v]);
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+/// \brief Run a batch of shortest path queries.
+/// \param[in] _d The routing graph.
+/// \param[in] _queries Origin and destination of each query.
+/// \param[out] _costs Cost of each route.
+/// \param[out] _paths Route of each query or null to skip the
+/// reconstruction of the routes.
+/// \param[in] _threads Number of worker threads.
+/// \return True if all the waypoints are part of the graph.
+static bool batchRoutes(RoadNetworkPrivate &_d,
+  const std::vector<std::pair<rndf::UniqueId, rndf::UniqueId>> &_queries,
+  std::vector<double> &_costs,
+  std::vector<std::vector<rndf::UniqueId>> *_paths,
+  const unsigned int _threads)
+{
+  std::vector<rndf::UniqueId> ids;
+  ids.reserve(2 * _queries.size());
+  for (auto const &query : _queries)
+  {
+    ids.push_back(query.first);
+    ids.push_back(query.second);
+  }
+
+  std::vector<unsigned int> ends;
+  if (!_d.Indexes(ids, ends))
+    return false;
+
+  _costs.assign(_queries.size(), std::numeric_limits<double>::infinity());
+  if (_paths)
+    _paths->assign(_queries.size(), {});
+
+  _d.SyncComponents();
+  _d.SyncLandmarks();
+  auto workers = workerCount(_threads, _queries.size());
+  std::vector<SearchWorkspace> workspaces(workers);
+  std::vector<std::vector<unsigned int>> routes(workers);
+
+  parallelFor(_queries.size(), workers,
+    [&](const size_t _i, const unsigned int _worker)
     {
-      std::shared_ptr<ignition::math::Vertex<std::string>> tailPtr = nullptr;
-      for (auto const &waypoint : lane.Waypoints())
+      // Each task writes its own results, so no synchronization is needed.
+      auto &route = routes[_worker];
+      if (!_d.Route(ends[2 * _i], ends[2 * _i + 1], workspaces[_worker],
+            route, _costs[_i]) || !_paths)
       {
-        rndf::UniqueId id(segment.Id(), lane.Id(), waypoint.Id());
-        std::string name = id.String();
-        auto headPtr = this->dataPtr->network.AddVertex(id.String(), name);
-
-        if (tailPtr)
-        {
-          // Connect all waypoints within a segment.
-          this->dataPtr->network.AddEdge(tailPtr, headPtr, 0);
-        }
+        return;
+      }
 
-        tailPtr = headPtr;
+      auto &path = (*_paths)[_i];
+      for (auto const &v : route)
+      {
+        // Skip the zone hubs.
+        if (_d.ids[v].Valid())
+          path.push_back(_d.ids[v]);
       }
-    }
+    });
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool RoadNetwork::ShortestPaths(
+  const std::vector<std::pair<rndf::UniqueId, rndf::UniqueId>> &_queries,
+  std::vector<double> &_costs,
+  std::vector<std::vector<rndf::UniqueId>> &_paths,
+  const unsigned int _threads) const
+{
+  return batchRoutes(*this->dataPtr, _queries, _costs, &_paths, _threads);
+}
+
+//////////////////////////////////////////////////
+bool RoadNetwork::ShortestPaths(
+  const std::vector<std::pair<rndf::UniqueId, rndf::UniqueId>> &_queries,
+  std::vector<double> &_costs, const unsigned int _threads) const
+{
+  return batchRoutes(*this->dataPtr, _queries, _costs, nullptr, _threads);
+}
+
+//////////////////////////////////////////////////
+bool RoadNetwork::AlternativePaths(const rndf::UniqueId &_src,
+  const rndf::UniqueId &_dst, const unsigned int _k,
+  std::vector<std::vector<rndf::UniqueId>> &_paths,
+  std::vector<double> &_costs, const double _maxOverlap) const
+{
+  _paths.clear();
+  _costs.clear();
+  std::vector<unsigned int> ends;
+  if (!this->dataPtr->Indexes({_src, _dst}, ends))
+    return false;
 
-  for (auto const &zone : _rndf.Zones())
+  this->dataPtr->SyncComponents();
+  this->dataPtr->SyncLandmarks();
+  std::vector<std::vector<unsigned int>> routes;
+  this->dataPtr->AlternativeRoutes(ends[0], ends[1], _k,
+    std::max(0.0, std::min(1.0, _maxOverlap)), routes, _costs);
+
+  _paths.resize(routes.size());
+  for (size_t i = 0; i < routes.size(); ++i)
   {
-    std::vector<std::shared_ptr<ignition::math::Vertex<std::string>>> pointsV;
-    // Add all waypoints delimiting the perimeter of zones as vertexes.
-    for (auto const &waypoint : zone.Perimeter().Points())
+    for (auto const &v : routes[i])
     {
-      rndf::UniqueId id(zone.Id(), 0, waypoint.Id());
-      std::string name = id.String();
-      auto vPtr = this->dataPtr->network.AddVertex(id.String(), name);
-      pointsV.push_back(vPtr);
+      // Skip the zone hubs.
+      if (this->dataPtr->ids[v].Valid())
+        _paths[i].push_back(this->dataPtr->ids[v]);
     }
+  }
+  return !_paths.empty();
+}
 
-    // Add also the two waypoints of a parking spot as vertexes.
-    for (auto const &spot : zone.Spots())
-    {
-      assert(spot.Waypoints().size() == 2);
-      auto wpId = spot.Waypoints().front().Id();
-      rndf::UniqueId wpt1(zone.Id(), spot.Id(), wpId);
-      std::string name = wpt1.String();
-      auto wpt1Ptr = this->dataPtr->network.AddVertex(wpt1.String(), name);
-      pointsV.push_back(wpt1Ptr);
-
-      // Add the second waypoint.
-      wpId = spot.Waypoints().at(1).Id();
-      rndf::UniqueId wpt2(zone.Id(), spot.Id(), wpId);
-      name = wpt2.String();
-      auto wpt2Ptr = this->dataPtr->network.AddVertex(wpt2.String(), name);
-
-      // You can always go from wpt1->wpt2 and from wpt2->wpt1.
-      this->dataPtr->network.AddEdge(wpt1Ptr, wpt2Ptr, 0);
-      this->dataPtr->network.AddEdge(wpt2Ptr, wpt1Ptr, 0);
-    }
+//////////////////////////////////////////////////
+bool RoadNetwork::WithinCost(const rndf::UniqueId &_src, const double _budget,
+  std::vector<std::pair<rndf::UniqueId, double>> &_reached) const
+{
+  _reached.clear();
+  unsigned int src;
+  if (!(_budget >= 0.0) || !this->dataPtr->Index(_src, src))
+    return false;
+
+  // One workspace per thread, reused by all the queries run on it.
+  static thread_local SearchWorkspace ws;
+  static thread_local RadixHeap queue;
+  static thread_local std::vector<unsigned int> settled;
+  this->dataPtr->SearchWithin(src, _budget, ws, queue, settled);
 
-    // From a perimeter point you can go to any other perimeter point or
-    // to the first waypoint of a parking spot.
-    for (auto const &tailPtr : pointsV)
+  for (auto const &v : settled)
+  {
+    // Skip the zone hubs.
+    if (this->dataPtr->ids[v].Valid())
+      _reached.push_back(std::make_pair(this->dataPtr->ids[v], ws.costs[v]));
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool RoadNetwork::CostMatrix(const std::vector<rndf::UniqueId> &_sources,
+  const std::vector<rndf::UniqueId> &_targets, std::vector<double> &_costs,
+  const unsigned int _threads) const
+{
+  std::vector<unsigned int> sources;
+  std::vector<unsigned int> targets;
+  if (!this->dataPtr->Indexes(_sources, sources) ||
+      !this->dataPtr->Indexes(_targets, targets))
+  {
+    return false;
+  }
+
+  const size_t cols = targets.size();
+  _costs.assign(sources.size() * cols,
+    std::numeric_limits<double>::infinity());
+  if (_costs.empty())
+    return true;
+
+  // Positions of each target vertex in the row. The same vertex might be
+  // requested more than once.
+  std::unordered_map<unsigned int, std::vector<size_t>> columns;
+  for (size_t j = 0; j < cols; ++j)
+    columns[targets[j]].push_back(j);
+
+  this->dataPtr->SyncComponents();
+  auto workers = workerCount(_threads, sources.size());
+  std::vector<SearchWorkspace> workspaces(workers);
+
+  parallelFor(sources.size(), workers,
+    [&](const size_t _row, const unsigned int _worker)
     {
-      for (auto const &headPtr : pointsV)
+      // Each task writes its own row, so no synchronization is needed.
+      double *row = &_costs[_row * cols];
+
+      // The unreachable targets will never be settled.
+      size_t pending = 0;
+      for (auto const &column : columns)
       {
-        if (tailPtr != headPtr)
-          this->dataPtr->network.AddEdge(tailPtr, headPtr, 0);
+        if (this->dataPtr->Reachable(sources[_row], column.first))
+          ++pending;
       }
+      if (pending == 0)
+        return;
+
+      this->dataPtr->Search(sources[_row], workspaces[_worker],
+        [&](const unsigned int _v)
+        {
+          auto it = columns.find(_v);
+          if (it == columns.end())
+            return false;
+
+          for (auto const &j : it->second)
+            row[j] = workspaces[_worker].costs[_v];
+
+          // Stop as soon as all the targets have been settled.
+          return --pending == 0;
+        });
+    });
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool RoadNetwork::Predecessors(const rndf::UniqueId &_id,
+  std::vector<rndf::UniqueId> &_predecessors) const
+{
+  _predecessors.clear();
+  unsigned int v;
+  if (!this->dataPtr->Index(_id, v))
+    return false;
+
+  auto const &d = *this->dataPtr;
+  for (auto const &in : d.inbound[v])
+  {
+    const unsigned int u = in.tail;
+    if (d.ids[u].Valid())
+    {
+      _predecessors.push_back(d.ids[u]);
+      continue;
     }
 
-    // Connect all exit waypoints of this zone with other entry waypoints.
-    for (auto const &exit : zone.Perimeter().Exits())
+    // A zone hub: the predecessors are the zone points leading to it.
+    for (auto const &hubIn : d.inbound[u])
+    {
+      if (hubIn.tail != v && d.ids[hubIn.tail].Valid())
+        _predecessors.push_back(d.ids[hubIn.tail]);
+    }
+  }
+
+  std::sort(_predecessors.begin(), _predecessors.end(),
+    [](const rndf::UniqueId &_a, const rndf::UniqueId &_b)
     {
-      auto nameExitWpt = exit.ExitId().String();
-      auto vertexes = this->dataPtr->network.Vertexes(nameExitWpt);
-      assert(vertexes.size() == 1);
-      auto tailPtr = vertexes.front();
+      return std::make_tuple(_a.X(), _a.Y(), _a.Z()) <
+        std::make_tuple(_b.X(), _b.Y(), _b.Z());
+    });
+  _predecessors.erase(std::unique(_predecessors.begin(),
+    _predecessors.end()), _predecessors.end());
+  return true;
+}
 
-      auto nameEntryWpt = exit.EntryId().String();
-      vertexes = this->dataPtr->network.Vertexes(nameEntryWpt);
-      assert(vertexes.size() == 1);
-      auto headPtr = vertexes.front();
+//////////////////////////////////////////////////
+bool RoadNetwork::Reachable(const rndf::UniqueId &_src,
+  const rndf::UniqueId &_dst) const
+{
+  unsigned int src;
+  unsigned int dst;
+  if (!this->dataPtr->Index(_src, src) || !this->dataPtr->Index(_dst, dst))
+    return false;
 
-      this->dataPtr->network.AddEdge(tailPtr, headPtr, 0);
-    }
+  this->dataPtr->SyncComponents();
+  return this->dataPtr->Reachable(src, dst);
+}
+
+//////////////////////////////////////////////////
+unsigned int RoadNetwork::NumComponents() const
+{
+  this->dataPtr->SyncComponents();
+  return this->dataPtr->numComponents;
+}
+
+//////////////////////////////////////////////////
+bool RoadNetwork::Component(const rndf::UniqueId &_id,
+  unsigned int &_component) const
+{
+  unsigned int v;
+  if (!this->dataPtr->Index(_id, v))
+    return false;
+
+  this->dataPtr->SyncComponents();
+  _component = this->dataPtr->components[v];
+  return true;
+}
+
+//////////////////////////////////////////////////
+void RoadNetwork::ConnectivityReport(std::vector<rndf::UniqueId> &_deadEnds,
+  std::vector<rndf::UniqueId> &_unreachable) const
+{
+  _deadEnds.clear();
+  _unreachable.clear();
+  this->dataPtr->SyncComponents();
+  auto const &d = *this->dataPtr;
+  if (d.numComponents == 0)
+    return;
+
+  // The main component is the one with more waypoints.
+  std::vector<size_t> sizes(d.numComponents, 0);
+  for (unsigned int v = 0; v < d.ids.size(); ++v)
+  {
+    if (d.ids[v].Valid())
+      ++sizes[d.components[v]];
   }
+  auto main = static_cast<unsigned int>(
+    std::max_element(sizes.begin(), sizes.end()) - sizes.begin());
 
-  // Connect all waypoints from one segment to another or from one segment to
-  // a zone.
-  for (auto const &segment : _rndf.Segments())
-    for (auto const &lane : segment.Lanes())
-      for (auto const &exit : lane.Exits())
-      {
-        auto nameExitWpt = exit.ExitId().String();
-        auto vertexes = this->dataPtr->network.Vertexes(nameExitWpt);
-        assert(vertexes.size() == 1);
-        auto tailPtr = vertexes.front();
+  for (unsigned int v = 0; v < d.ids.size(); ++v)
+  {
+    if (!d.ids[v].Valid())
+      continue;
+
+    if (!d.ComponentReachable(d.components[v], main))
+      _deadEnds.push_back(d.ids[v]);
+    if (!d.ComponentReachable(main, d.components[v]))
+      _unreachable.push_back(d.ids[v]);
+  }
+}
 
-        auto nameEntryWpt = exit.EntryId().String();
-        vertexes = this->dataPtr->network.Vertexes(nameEntryWpt);
-        assert(vertexes.size() == 1);
-        auto headPtr = vertexes.front();
+//////////////////////////////////////////////////
+unsigned int RoadNetwork::NumIntersections() const
+{
+  this->dataPtr->SyncIntersections();
+  return this->dataPtr->numIntersections;
+}
 
-        this->dataPtr->network.AddEdge(tailPtr, headPtr, 0);
-      }
+//////////////////////////////////////////////////
+bool RoadNetwork::Turn(const rndf::UniqueId &_exit,
+  const rndf::UniqueId &_entry, double &_angle, bool &_stop,
+  unsigned int &_intersection) const
+{
+  unsigned int tail;
+  unsigned int head;
+  if (!this->dataPtr->Index(_exit, tail) ||
+      !this->dataPtr->Index(_entry, head))
+  {
+    return false;
+  }
 
-  this->dataPtr->type = "rndf";
+  this->dataPtr->SyncIntersections();
+  auto it = this->dataPtr->turns.find(
+    (static_cast<uint64_t>(tail) << 32) | head);
+  if (it == this->dataPtr->turns.end())
+    return false;
+
+  _angle = it->second.angle;
+  _stop = it->second.stop;
+  _intersection = it->second.intersection;
+  return true;
 }
 
 //////////////////////////////////////////////////
-RoadNetwork::~RoadNetwork()
+bool RoadNetwork::AddSegment(const rndf::Segment &_segment)
 {
+  if (this->dataPtr->segments.find(_segment.Id()) !=
+      this->dataPtr->segments.end())
+  {
+    std::cerr << "RoadNetwork::AddSegment(): Segment [" << _segment.Id()
+              << "] already exists" << std::endl;
+    return false;
+  }
+
+  this->dataPtr->AddLanes(_segment);
+  this->dataPtr->AddLaneChanges(_segment);
+  this->dataPtr->AddLaneExits(_segment);
+  this->dataPtr->ResolveExits();
+  ++this->dataPtr->revision;
+  return true;
 }
 
 //////////////////////////////////////////////////
-ignition::math::DirectedGraph<std::string, int> &RoadNetwork::Graph()
+bool RoadNetwork::RemoveSegment(const int _segmentId)
 {
-  return this->dataPtr->network;
+  auto it = this->dataPtr->segments.find(_segmentId);
+  if (it == this->dataPtr->segments.end())
+    return false;
+
+  this->dataPtr->RemoveVertexes(it->second, _segmentId);
+  this->dataPtr->segments.erase(it);
+  ++this->dataPtr->revision;
+  return true;
 }
 
 //////////////////////////////////////////////////
-const ignition::math::DirectedGraph<std::string, int> &RoadNetwork::Graph()
-  const
+bool RoadNetwork::UpdateSegment(const rndf::Segment &_segment)
 {
-  return this->dataPtr->network;
+  return this->RemoveSegment(_segment.Id()) && this->AddSegment(_segment);
 }
 
 //////////////////////////////////////////////////
-std::string RoadNetwork::RoadType() const
+bool RoadNetwork::AddZone(const rndf::Zone &_zone)
 {
-  return this->dataPtr->type;
+  if (this->dataPtr->zones.find(_zone.Id()) != this->dataPtr->zones.end())
+  {
+    std::cerr << "RoadNetwork::AddZone(): Zone [" << _zone.Id()
+              << "] already exists" << std::endl;
+    return false;
+  }
+
+  this->dataPtr->AddZone(_zone);
+  this->dataPtr->ResolveExits();
+  ++this->dataPtr->revision;
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool RoadNetwork::RemoveZone(const int _zoneId)
+{
+  auto it = this->dataPtr->zones.find(_zoneId);
+  if (it == this->dataPtr->zones.end())
+    return false;
+
+  this->dataPtr->RemoveVertexes(it->second, _zoneId);
+  this->dataPtr->zones.erase(it);
+  ++this->dataPtr->revision;
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool RoadNetwork::UpdateZone(const rndf::Zone &_zone)
+{
+  return this->RemoveZone(_zone.Id()) && this->AddZone(_zone);
+}
+
+//////////////////////////////////////////////////
+bool RoadNetwork::AddExit(const rndf::Exit &_exit)
+{
+  if (!_exit.Valid())
+    return false;
+
+  this->dataPtr->AddExit(_exit);
+  ++this->dataPtr->revision;
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool RoadNetwork::RemoveExit(const rndf::Exit &_exit)
+{
+  unsigned int tail;
+  unsigned int head;
+  if (this->dataPtr->Index(_exit.ExitId(), tail) &&
+      this->dataPtr->Index(_exit.EntryId(), head))
+  {
+    if (!this->dataPtr->RemoveEdge(tail, head, true))
+      return false;
+
+    ++this->dataPtr->revision;
+    return true;
+  }
+
+  auto &dangling = this->dataPtr->danglingExits;
+  auto it = std::find(dangling.begin(), dangling.end(), _exit);
+  if (it == dangling.end())
+    return false;
+
+  dangling.erase(it);
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool RoadNetwork::CloseEdge(const rndf::UniqueId &_tail,
+  const rndf::UniqueId &_head)
+{
+  return this->dataPtr->SetPenalty(_tail, _head,
+    std::numeric_limits<double>::infinity());
+}
+
+//////////////////////////////////////////////////
+bool RoadNetwork::SetEdgePenalty(const rndf::UniqueId &_tail,
+  const rndf::UniqueId &_head, const double _penalty)
+{
+  if (!(_penalty >= 0))
+  {
+    std::cerr << "RoadNetwork::SetEdgePenalty(): Invalid penalty ["
+              << _penalty << "]" << std::endl;
+    return false;
+  }
+
+  return this->dataPtr->SetPenalty(_tail, _head, _penalty);
+}
+
+//////////////////////////////////////////////////
+bool RoadNetwork::OpenEdge(const rndf::UniqueId &_tail,
+  const rndf::UniqueId &_head)
+{
+  return this->dataPtr->SetPenalty(_tail, _head, 0.0);
+}
+
+//////////////////////////////////////////////////
+void RoadNetwork::ClearOverlay()
+{
+  auto &links = this->dataPtr->links;
+  for (unsigned int tail = 0; tail < links.size(); ++tail)
+  {
+    for (auto &link : links[tail])
+    {
+      if (link.penalty > 0)
+      {
+        link.penalty = 0;
+        this->dataPtr->edgeChanges.Push(tail, link.head);
+      }
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+bool RoadNetwork::EdgeCost(const rndf::UniqueId &_tail,
+  const rndf::UniqueId &_head, double &_cost) const
+{
+  unsigned int tail;
+  unsigned int head;
+  if (!this->dataPtr->Index(_tail, tail) || !this->dataPtr->Index(_head, head))
+    return false;
+
+  return this->dataPtr->EdgeCost(tail, head, _cost);
+}
+
+//////////////////////////////////////////////////
+bool RoadNetwork::Consistent(const rndf::RNDF &_rndf) const
+{
+  RoadNetwork rebuilt(_rndf, this->dataPtr->options);
+  auto expected = rebuilt.dataPtr->Adjacency();
+  auto actual = this->dataPtr->Adjacency();
+
+  const double kTolerance = 1e-6;
+  for (auto const &entry : expected)
+  {
+    auto it = actual.find(entry.first);
+    if (it == actual.end())
+    {
+      std::cerr << "RoadNetwork::Consistent(): Missing vertex ["
+                << entry.first << "]" << std::endl;
+      return false;
+    }
+
+    auto const &edges = it->second;
+    bool equal = edges.size() == entry.second.size();
+    for (size_t i = 0; equal && i < edges.size(); ++i)
+    {
+      equal = edges[i].first == entry.second[i].first &&
+        std::abs(edges[i].second - entry.second[i].second) <= kTolerance;
+    }
+
+    if (!equal)
+    {
+      std::cerr << "RoadNetwork::Consistent(): The edges of vertex ["
+                << entry.first << "] don't match" << std::endl;
+      return false;
+    }
+  }
+
+  for (auto const &entry : actual)
+  {
+    if (expected.find(entry.first) == expected.end())
+    {
+      std::cerr << "RoadNetwork::Consistent(): Unexpected vertex ["
+                << entry.first << "]" << std::endl;
+      return false;
+    }
+  }
+
+  if (!this->dataPtr->InboundConsistent())
+  {
+    std::cerr << "RoadNetwork::Consistent(): The incoming edges don't match "
+              << "the outgoing edges" << std::endl;
+    return false;
+  }
+
+  return true;
 }
@@ -0,0 +1,161 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <iostream>
+#include <ignition/math/Helpers.hh>
+
+#include "manifold/RoadNetworkOptions.hh"
+
+using namespace manifold;
+
+/// \brief Maximum number of landmarks.
+static const unsigned int kMaxLandmarks = 64;
+
+//////////////////////////////////////////////////
+ZoneModel RoadNetworkOptions::ZoneModel() const
+{
+  return this->zoneModel;
+}
+
+//////////////////////////////////////////////////
+void RoadNetworkOptions::SetZoneModel(const manifold::ZoneModel _model)
+{
+  this->zoneModel = _model;
+}
+
+//////////////////////////////////////////////////
+bool RoadNetworkOptions::LaneChanges() const
+{
+  return this->laneChanges;
+}
+
+//////////////////////////////////////////////////
+void RoadNetworkOptions::SetLaneChanges(const bool _enabled)
+{
+  this->laneChanges = _enabled;
+}
+
+//////////////////////////////////////////////////
+double RoadNetworkOptions::LaneChangePenalty() const
+{
+  return this->laneChangePenalty;
+}
+
+//////////////////////////////////////////////////
+bool RoadNetworkOptions::SetLaneChangePenalty(const double _penalty)
+{
+  if (!(_penalty >= 0))
+  {
+    std::cerr << "RoadNetworkOptions::SetLaneChangePenalty() Invalid penalty ["
+              << _penalty << "]" << std::endl;
+    return false;
+  }
+
+  this->laneChangePenalty = _penalty;
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool RoadNetworkOptions::TurnCosts() const
+{
+  return this->turnCosts;
+}
+
+//////////////////////////////////////////////////
+void RoadNetworkOptions::SetTurnCosts(const bool _enabled)
+{
+  this->turnCosts = _enabled;
+}
+
+//////////////////////////////////////////////////
+double RoadNetworkOptions::StopPenalty() const
+{
+  return this->stopPenalty;
+}
+
+//////////////////////////////////////////////////
+bool RoadNetworkOptions::SetStopPenalty(const double _penalty)
+{
+  if (!(_penalty >= 0))
+  {
+    std::cerr << "RoadNetworkOptions::SetStopPenalty() Invalid penalty ["
+              << _penalty << "]" << std::endl;
+    return false;
+  }
+
+  this->stopPenalty = _penalty;
+  return true;
+}
+
+//////////////////////////////////////////////////
+double RoadNetworkOptions::TurnPenalty() const
+{
+  return this->turnPenalty;
+}
+
+//////////////////////////////////////////////////
+bool RoadNetworkOptions::SetTurnPenalty(const double _penalty)
+{
+  if (!(_penalty >= 0))
+  {
+    std::cerr << "RoadNetworkOptions::SetTurnPenalty() Invalid penalty ["
+              << _penalty << "]" << std::endl;
+    return false;
+  }
+
+  this->turnPenalty = _penalty;
+  return true;
+}
+
+//////////////////////////////////////////////////
+unsigned int RoadNetworkOptions::Landmarks() const
+{
+  return this->landmarks;
+}
+
+//////////////////////////////////////////////////
+bool RoadNetworkOptions::SetLandmarks(const unsigned int _landmarks)
+{
+  if (_landmarks > kMaxLandmarks)
+  {
+    std::cerr << "RoadNetworkOptions::SetLandmarks() Invalid number of "
+              << "landmarks [" << _landmarks << "]" << std::endl;
+    return false;
+  }
+
+  this->landmarks = _landmarks;
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool RoadNetworkOptions::operator==(const RoadNetworkOptions &_other) const
+{
+  return this->ZoneModel() == _other.ZoneModel() &&
+    this->LaneChanges() == _other.LaneChanges() &&
+    ignition::math::equal(this->LaneChangePenalty(),
+      _other.LaneChangePenalty()) &&
+    this->Landmarks() == _other.Landmarks() &&
+    this->TurnCosts() == _other.TurnCosts() &&
+    ignition::math::equal(this->StopPenalty(), _other.StopPenalty()) &&
+    ignition::math::equal(this->TurnPenalty(), _other.TurnPenalty());
+}
+
+//////////////////////////////////////////////////
+bool RoadNetworkOptions::operator!=(const RoadNetworkOptions &_other) const
+{
+  return !(*this == _other);
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include "manifold/RoadNetworkOptions.hh"
+#include "gtest/gtest.h"
+
+using namespace manifold;
+
+//////////////////////////////////////////////////
+/// \brief Check accessors.
+TEST(RoadNetworkOptions, accessors)
+{
+  RoadNetworkOptions opts;
+  EXPECT_EQ(opts.ZoneModel(), ZoneModel::CLIQUE);
+
+  opts.SetZoneModel(ZoneModel::HUB);
+  EXPECT_EQ(opts.ZoneModel(), ZoneModel::HUB);
+
+  EXPECT_FALSE(opts.LaneChanges());
+  opts.SetLaneChanges(true);
+  EXPECT_TRUE(opts.LaneChanges());
+
+  EXPECT_DOUBLE_EQ(opts.LaneChangePenalty(), 10.0);
+  EXPECT_TRUE(opts.SetLaneChangePenalty(0.0));
+  EXPECT_DOUBLE_EQ(opts.LaneChangePenalty(), 0.0);
+  EXPECT_FALSE(opts.SetLaneChangePenalty(-1.0));
+  EXPECT_DOUBLE_EQ(opts.LaneChangePenalty(), 0.0);
+
+  EXPECT_EQ(opts.Landmarks(), 0u);
+  EXPECT_TRUE(opts.SetLandmarks(16));
+  EXPECT_EQ(opts.Landmarks(), 16u);
+  EXPECT_FALSE(opts.SetLandmarks(65));
+  EXPECT_EQ(opts.Landmarks(), 16u);
+
+  EXPECT_FALSE(opts.TurnCosts());
+  opts.SetTurnCosts(true);
+  EXPECT_TRUE(opts.TurnCosts());
+
+  EXPECT_DOUBLE_EQ(opts.StopPenalty(), 30.0);
+  EXPECT_TRUE(opts.SetStopPenalty(5.0));
+  EXPECT_DOUBLE_EQ(opts.StopPenalty(), 5.0);
+  EXPECT_FALSE(opts.SetStopPenalty(-1.0));
+  EXPECT_DOUBLE_EQ(opts.StopPenalty(), 5.0);
+
+  EXPECT_DOUBLE_EQ(opts.TurnPenalty(), 20.0);
+  EXPECT_TRUE(opts.SetTurnPenalty(0.0));
+  EXPECT_DOUBLE_EQ(opts.TurnPenalty(), 0.0);
+  EXPECT_FALSE(opts.SetTurnPenalty(-1.0));
+  EXPECT_DOUBLE_EQ(opts.TurnPenalty(), 0.0);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check [in]equality operators.
+TEST(RoadNetworkOptions, equality)
+{
+  RoadNetworkOptions opts1;
+  RoadNetworkOptions opts2;
+  EXPECT_TRUE(opts1 == opts2);
+  EXPECT_FALSE(opts1 != opts2);
+
+  opts2.SetZoneModel(ZoneModel::HUB);
+  EXPECT_FALSE(opts1 == opts2);
+  EXPECT_TRUE(opts1 != opts2);
+
+  opts1 = opts2;
+  EXPECT_TRUE(opts1 == opts2);
+
+  opts2.SetLaneChanges(true);
+  EXPECT_TRUE(opts1 != opts2);
+  opts1.SetLaneChanges(true);
+  EXPECT_TRUE(opts1 == opts2);
+
+  opts2.SetLaneChangePenalty(2.0);
+  EXPECT_TRUE(opts1 != opts2);
+  opts1.SetLaneChangePenalty(2.0);
+  EXPECT_TRUE(opts1 == opts2);
+
+  opts2.SetLandmarks(8);
+  EXPECT_TRUE(opts1 != opts2);
+  opts1.SetLandmarks(8);
+  EXPECT_TRUE(opts1 == opts2);
+
+  opts2.SetTurnCosts(true);
+  EXPECT_TRUE(opts1 != opts2);
+  opts1.SetTurnCosts(true);
+  EXPECT_TRUE(opts1 == opts2);
+
+  opts2.SetStopPenalty(1.0);
+  EXPECT_TRUE(opts1 != opts2);
+  opts1.SetStopPenalty(1.0);
+  EXPECT_TRUE(opts1 == opts2);
+
+  opts2.SetTurnPenalty(1.0);
+  EXPECT_TRUE(opts1 != opts2);
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
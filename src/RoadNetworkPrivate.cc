@@ -0,0 +1,769 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "manifold/rndf/Exit.hh"
+#include "manifold/rndf/Lane.hh"
+#include "manifold/rndf/ParkingSpot.hh"
+#include "manifold/rndf/Perimeter.hh"
+#include "manifold/rndf/RNDF.hh"
+#include "manifold/rndf/Segment.hh"
+#include "manifold/rndf/UniqueId.hh"
+#include "manifold/rndf/Waypoint.hh"
+#include "manifold/rndf/Zone.hh"
+#include "BinaryIO.hh"
+#include "ParallelFor.hh"
+#include "RoadNetworkPrivate.hh"
+
+using namespace manifold;
+
+namespace
+{
+  /// \internal
+  /// \brief First bytes of a road network file.
+  const char kMagic[4] = {'M', 'N', 'F', 'D'};
+
+  /// \internal
+  /// \brief Version of the file format. Increment it when the layout or
+  /// the way the graph is built changes, so older files are rebuilt.
+  const uint32_t kFormatVersion = 5;
+
+  /// \internal
+  /// \brief Written in native byte order to detect files created on a
+  /// machine with a different endianness.
+  const uint32_t kByteOrder = 0x01020304;
+
+  /// \internal
+  /// \brief Maximum number of loopless routes examined per alternative
+  /// route requested, when routes that overlap too much are skipped.
+  const size_t kRoutesExaminedPerAlternative = 16;
+
+  /// \internal
+  /// \brief Key of an edge.
+  /// \param[in] _tail Index of the tail vertex.
+  /// \param[in] _head Index of the head vertex.
+  /// \return The key.
+  uint64_t edgeKey(const unsigned int _tail, const unsigned int _head)
+  {
+    return (static_cast<uint64_t>(_tail) << 32) | _head;
+  }
+
+  /// \internal
+  /// \brief Incremental 64-bit FNV-1a hash.
+  class Hasher
+  {
+    /// \brief Add raw bytes to the hash.
+    /// \param[in] _data The bytes.
+    /// \param[in] _size Number of bytes.
+    public: void Add(const void *_data, const size_t _size)
+    {
+      auto bytes = static_cast<const unsigned char *>(_data);
+      for (size_t i = 0; i < _size; ++i)
+      {
+        this->value ^= bytes[i];
+        this->value *= 1099511628211ull;
+      }
+    }
+
+    /// \brief Add a value with a fixed size representation to the hash.
+    /// \param[in] _value The value.
+    public: template<typename T> void Add(const T &_value)
+    {
+      this->Add(&_value, sizeof(T));
+    }
+
+    /// \brief Add a waypoint to the hash.
+    /// \param[in] _waypoint The waypoint.
+    public: void Add(const rndf::Waypoint &_waypoint)
+    {
+      this->Add<int32_t>(_waypoint.Id());
+      this->Add<double>(_waypoint.Location().LatitudeReference().Radian());
+      this->Add<double>(_waypoint.Location().LongitudeReference().Radian());
+    }
+
+    /// \brief Add a unique Id to the hash.
+    /// \param[in] _id The unique Id.
+    public: void Add(const rndf::UniqueId &_id)
+    {
+      this->Add<int32_t>(_id.X());
+      this->Add<int32_t>(_id.Y());
+      this->Add<int32_t>(_id.Z());
+    }
+
+    /// \brief Add a list of exits to the hash.
+    /// \param[in] _exits The exits.
+    public: void Add(const std::vector<rndf::Exit> &_exits)
+    {
+      this->Add<uint64_t>(_exits.size());
+      for (auto const &exit : _exits)
+      {
+        this->Add(exit.ExitId());
+        this->Add(exit.EntryId());
+      }
+    }
+
+    /// \brief The hash value.
+    public: uint64_t value = 14695981039346656037ull;
+  };
+
+  /// \internal
+  /// \brief Write the vertexes of each segment or zone.
+  /// \param[in] _out Output stream.
+  /// \param[in] _groups The vertexes, keyed by segment or zone Id.
+  void writeGroups(std::ostream &_out,
+    const std::unordered_map<int, std::vector<unsigned int>> &_groups)
+  {
+    // Sorted, so the same network always produces the same file.
+    std::map<int, std::vector<unsigned int>> sorted(_groups.begin(),
+                                                    _groups.end());
+    write<uint64_t>(_out, sorted.size());
+    for (auto const &group : sorted)
+    {
+      write<int32_t>(_out, group.first);
+      write(_out, group.second);
+    }
+  }
+
+  /// \internal
+  /// \brief Read the vertexes of each segment or zone.
+  /// \param[in] _in Input stream.
+  /// \param[in] _numVertexes Number of vertexes of the graph.
+  /// \param[out] _groups The vertexes, keyed by segment or zone Id.
+  /// \return True if the groups were read.
+  bool readGroups(std::istream &_in, const size_t _numVertexes,
+    std::unordered_map<int, std::vector<unsigned int>> &_groups)
+  {
+    size_t count;
+    if (!readCount(_in, count))
+      return false;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+      int32_t id;
+      if (!read(_in, id) || !read(_in, _groups[id]))
+        return false;
+
+      for (auto const &v : _groups[id])
+      {
+        if (v >= _numVertexes)
+          return false;
+      }
+    }
+    return true;
+  }
+}
+
+//////////////////////////////////////////////////
+uint64_t manifold::contentHash(const rndf::RNDF &_rndf,
+  const RoadNetworkOptions &_options)
+{
+  Hasher hasher;
+  hasher.Add<uint32_t>(kFormatVersion);
+  hasher.Add<int32_t>(static_cast<int32_t>(_options.ZoneModel()));
+  hasher.Add<uint8_t>(_options.LaneChanges() ? 1 : 0);
+  hasher.Add<double>(_options.LaneChangePenalty());
+  hasher.Add<uint32_t>(_options.Landmarks());
+  hasher.Add<uint8_t>(_options.TurnCosts() ? 1 : 0);
+  hasher.Add<double>(_options.StopPenalty());
+  hasher.Add<double>(_options.TurnPenalty());
+
+  hasher.Add<uint64_t>(_rndf.Segments().size());
+  for (auto const &segment : _rndf.Segments())
+  {
+    hasher.Add<int32_t>(segment.Id());
+    hasher.Add<uint64_t>(segment.Lanes().size());
+    for (auto const &lane : segment.Lanes())
+    {
+      hasher.Add<int32_t>(lane.Id());
+      hasher.Add<double>(lane.Width());
+      hasher.Add<int32_t>(static_cast<int32_t>(lane.LeftBoundary()));
+      hasher.Add<int32_t>(static_cast<int32_t>(lane.RightBoundary()));
+      hasher.Add<uint64_t>(lane.Waypoints().size());
+      for (auto const &waypoint : lane.Waypoints())
+        hasher.Add(waypoint);
+      hasher.Add(lane.Exits());
+      hasher.Add<uint64_t>(lane.Stops().size());
+      for (auto const &stop : lane.Stops())
+        hasher.Add<int32_t>(stop);
+    }
+  }
+
+  hasher.Add<uint64_t>(_rndf.Zones().size());
+  for (auto const &zone : _rndf.Zones())
+  {
+    hasher.Add<int32_t>(zone.Id());
+    hasher.Add<uint64_t>(zone.Perimeter().Points().size());
+    for (auto const &waypoint : zone.Perimeter().Points())
+      hasher.Add(waypoint);
+    hasher.Add(zone.Perimeter().Exits());
+
+    hasher.Add<uint64_t>(zone.Spots().size());
+    for (auto const &spot : zone.Spots())
+    {
+      hasher.Add<int32_t>(spot.Id());
+      hasher.Add<uint64_t>(spot.Waypoints().size());
+      for (auto const &waypoint : spot.Waypoints())
+        hasher.Add(waypoint);
+    }
+  }
+
+  return hasher.value;
+}
+
+//////////////////////////////////////////////////
+void RoadNetworkPrivate::Build(const rndf::RNDF &_rndf)
+{
+  // Populate the graph.
+  // Vertexes (all waypoints):
+  //   * All waypoints in each segment.
+  //   * All perimeter points in each zone.
+  //   * All waypoints in each parking spot.
+  // Edges:
+  //   * Waypoint_i to waypoint_i_+_1 within the same lane and segment.
+  //   * Waypoint of a lane to a waypoint of an adjacent lane within the same
+  //   segment, when the options enable lane changes.
+  //   * Exit waypoint from a segment to entry waypoint of another segment/zone.
+  //   * Perimeter point to another perimeter point within the same zone.
+  //   * Perimeter point to first waypoint of parking spot within the same zone.
+  //   * First waypoint of parking spot to perimeter point within the same zone.
+  //   (The previous three are replaced by edges to and from a zone hub when
+  //   the options select ZoneModel::HUB).
+  //   * First waypoint of a parking spot to its second waypoint.
+  //   * Second waypoint of a parking spot to its first waypoint.
+  //   * Exit waypoint of a zone to an entry waypoint of another segment/zone.
+
+  // Add all waypoints within segments as vertexes.
+  for (auto const &segment : _rndf.Segments())
+  {
+    this->AddLanes(segment);
+    this->AddLaneChanges(segment);
+  }
+
+  for (auto const &zone : _rndf.Zones())
+    this->AddZone(zone);
+
+  // Connect all waypoints from one segment to another or from one segment to
+  // a zone.
+  for (auto const &segment : _rndf.Segments())
+    this->AddLaneExits(segment);
+
+  // Connect the exits of the zones to the zones added after them.
+  this->ResolveExits();
+
+  for (auto const &exit : this->danglingExits)
+  {
+    std::cerr << "RoadNetwork: Exit [" << exit.ExitId() << "] -> ["
+              << exit.EntryId() << "] references an unknown waypoint"
+              << std::endl;
+  }
+
+  this->type = "rndf";
+  this->edgeChanges.Clear();
+  this->SyncComponents();
+  this->SyncIntersections();
+  this->SyncLandmarks();
+}
+
+//////////////////////////////////////////////////
+void RoadNetworkPrivate::Write(std::ostream &_out, const uint64_t _hash)
+{
+  this->SyncComponents();
+  this->SyncLandmarks();
+
+  _out.write(kMagic, sizeof(kMagic));
+  write(_out, kFormatVersion);
+  write(_out, kByteOrder);
+  write(_out, _hash);
+  write(_out, this->type);
+
+  // Vertexes.
+  const size_t n = this->ids.size();
+  write<uint64_t>(_out, n);
+  for (size_t v = 0; v < n; ++v)
+  {
+    write(_out, this->names[v]);
+    write(_out, this->ids[v]);
+  }
+  write(_out, this->latitudes);
+  write(_out, this->longitudes);
+  write(_out, this->stops);
+
+  // Edges, without closures and penalties.
+  for (size_t v = 0; v < n; ++v)
+  {
+    write<uint64_t>(_out, this->links[v].size());
+    for (auto const &link : this->links[v])
+    {
+      write<uint32_t>(_out, link.head);
+      write<double>(_out, link.cost);
+      write<uint8_t>(_out, link.exit ? 1 : 0);
+    }
+  }
+
+  writeGroups(_out, this->segments);
+  writeGroups(_out, this->zones);
+
+  write<uint64_t>(_out, this->danglingExits.size());
+  for (auto const &exit : this->danglingExits)
+  {
+    write(_out, exit.ExitId());
+    write(_out, exit.EntryId());
+  }
+
+  // Strongly connected components.
+  write<uint32_t>(_out, this->numComponents);
+  write(_out, this->components);
+  for (auto const &heads : this->dag)
+    write(_out, heads);
+  write(_out, this->closure);
+
+  // Landmarks.
+  write(_out, this->landmarks);
+  write(_out, this->landmarkCosts);
+}
+
+//////////////////////////////////////////////////
+bool RoadNetworkPrivate::Read(std::istream &_in, const uint64_t _hash)
+{
+  char magic[sizeof(kMagic)];
+  uint32_t version;
+  uint32_t byteOrder;
+  uint64_t hash;
+  if (!_in.read(magic, sizeof(magic)) ||
+      std::memcmp(magic, kMagic, sizeof(kMagic)) != 0 ||
+      !read(_in, version) || version != kFormatVersion ||
+      !read(_in, byteOrder) || byteOrder != kByteOrder ||
+      !read(_in, hash) || hash != _hash ||
+      !read(_in, this->type))
+  {
+    return false;
+  }
+
+  // Vertexes.
+  size_t n;
+  if (!readCount(_in, n))
+    return false;
+
+  this->names.resize(n);
+  this->ids.resize(n);
+  for (size_t v = 0; v < n; ++v)
+  {
+    if (!read(_in, this->names[v]) || !read(_in, this->ids[v]))
+      return false;
+
+    if (!this->names[v].empty() && this->ids[v].Valid())
+      this->indexes[this->names[v]] = static_cast<unsigned int>(v);
+    else if (this->names[v].empty())
+      this->freeVertexes.push_back(static_cast<unsigned int>(v));
+  }
+
+  if (!read(_in, this->latitudes) || this->latitudes.size() != n ||
+      !read(_in, this->longitudes) || this->longitudes.size() != n ||
+      !read(_in, this->stops) || this->stops.size() != n)
+  {
+    return false;
+  }
+
+  // Edges.
+  this->links.assign(n, {});
+  this->inbound.assign(n, {});
+  for (size_t v = 0; v < n; ++v)
+  {
+    size_t count;
+    if (!readCount(_in, count))
+      return false;
+
+    auto &vLinks = this->links[v];
+    vLinks.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+      uint32_t head;
+      double cost;
+      uint8_t exit;
+      if (!read(_in, head) || !read(_in, cost) || !read(_in, exit) ||
+          head >= n)
+      {
+        return false;
+      }
+
+      vLinks.push_back({head, cost, 0.0, exit != 0});
+      this->inbound[head].push_back({static_cast<unsigned int>(v),
+        static_cast<unsigned int>(vLinks.size() - 1)});
+    }
+  }
+
+  if (!readGroups(_in, n, this->segments) || !readGroups(_in, n, this->zones))
+    return false;
+
+  size_t count;
+  if (!readCount(_in, count))
+    return false;
+  for (size_t i = 0; i < count; ++i)
+  {
+    rndf::UniqueId exitId;
+    rndf::UniqueId entryId;
+    if (!read(_in, exitId) || !read(_in, entryId))
+      return false;
+    this->danglingExits.push_back(rndf::Exit(exitId, entryId));
+  }
+
+  // Strongly connected components.
+  if (!read(_in, this->numComponents) || !read(_in, this->components) ||
+      this->components.size() != n)
+  {
+    return false;
+  }
+
+  this->dag.resize(this->numComponents);
+  for (auto &heads : this->dag)
+  {
+    if (!read(_in, heads))
+      return false;
+  }
+
+  this->closureWords = (this->numComponents + 63) / 64;
+  if (!read(_in, this->closure) ||
+      (!this->closure.empty() && this->closure.size() !=
+       this->numComponents * this->closureWords))
+  {
+    return false;
+  }
+
+  for (size_t v = 0; v < n; ++v)
+  {
+    auto c = this->components[v];
+    if ((this->Alive(static_cast<unsigned int>(v)) &&
+         c >= this->numComponents) ||
+        (!this->Alive(static_cast<unsigned int>(v)) && c != kNoVertex))
+    {
+      return false;
+    }
+  }
+  for (auto const &heads : this->dag)
+  {
+    for (auto const &c : heads)
+    {
+      if (c >= this->numComponents)
+        return false;
+    }
+  }
+
+  if (!read(_in, this->landmarks) || this->landmarks.size() > 64 ||
+      !read(_in, this->landmarkCosts) ||
+      this->landmarkCosts.size() != n * 2 * this->landmarks.size())
+  {
+    return false;
+  }
+  for (auto const &v : this->landmarks)
+  {
+    if (v >= n || !this->Alive(v))
+      return false;
+  }
+
+  this->graphDirty = true;
+  this->componentsRevision = this->revision;
+  this->landmarksRevision = this->revision;
+  return true;
+}
+
+//////////////////////////////////////////////////
+void RoadNetworkPrivate::ComputeLandmarks()
+{
+  this->landmarks.clear();
+  this->landmarkCosts.clear();
+  const unsigned int numLandmarks = this->options.Landmarks();
+  if (numLandmarks == 0)
+    return;
+
+  // Center of the waypoints.
+  const size_t n = this->ids.size();
+  double lat0 = 0.0;
+  double lon0 = 0.0;
+  size_t count = 0;
+  for (size_t v = 0; v < n; ++v)
+  {
+    if (this->Alive(static_cast<unsigned int>(v)) && this->ids[v].Valid())
+    {
+      lat0 += this->latitudes[v];
+      lon0 += this->longitudes[v];
+      ++count;
+    }
+  }
+  if (count == 0)
+    return;
+  lat0 /= count;
+  lon0 /= count;
+
+  // The waypoint farthest from the center in each angular sector, on an
+  // equirectangular projection.
+  const double kTwoPi = 2.0 * std::acos(-1.0);
+  const double cosLat0 = std::cos(lat0);
+  std::vector<std::pair<double, unsigned int>> farthest(numLandmarks,
+    std::make_pair(-1.0, kNoVertex));
+  for (unsigned int v = 0; v < n; ++v)
+  {
+    if (!this->Alive(v) || !this->ids[v].Valid())
+      continue;
+
+    double x = (this->longitudes[v] - lon0) * cosLat0;
+    double y = this->latitudes[v] - lat0;
+    double angle = std::atan2(y, x) + kTwoPi / 2.0;
+    auto sector = static_cast<size_t>(angle / kTwoPi * numLandmarks) %
+      numLandmarks;
+    double distance = x * x + y * y;
+    if (distance > farthest[sector].first)
+      farthest[sector] = std::make_pair(distance, v);
+  }
+  for (auto const &candidate : farthest)
+  {
+    if (candidate.second != kNoVertex)
+      this->landmarks.push_back(candidate.second);
+  }
+
+  // One search per landmark and direction, on the base costs.
+  const size_t stride = 2 * this->landmarks.size();
+  this->landmarkCosts.assign(n * stride,
+    std::numeric_limits<double>::infinity());
+  auto workers = workerCount(0, stride);
+  std::vector<SearchWorkspace> workspaces(workers);
+  parallelFor(stride, workers,
+    [&](const size_t _task, const unsigned int _worker)
+    {
+      auto &ws = workspaces[_worker];
+      const bool forward = _task % 2 == 0;
+      ws.Reset(n);
+      ws.Relax(this->landmarks[_task / 2], 0.0, this->landmarks[_task / 2]);
+
+      unsigned int v;
+      while (ws.Pop(v))
+      {
+        double cost = ws.costs[v];
+        this->landmarkCosts[v * stride + _task] = cost;
+        if (forward)
+        {
+          for (auto const &link : this->links[v])
+            ws.Relax(link.head, cost + link.cost, v);
+        }
+        else
+        {
+          for (auto const &in : this->inbound[v])
+            ws.Relax(in.tail, cost + this->links[in.tail][in.link].cost, v);
+        }
+      }
+    });
+}
+
+//////////////////////////////////////////////////
+void RoadNetworkPrivate::AlternativeRoutes(const unsigned int _src,
+  const unsigned int _dst, const unsigned int _k, const double _maxOverlap,
+  std::vector<std::vector<unsigned int>> &_routes,
+  std::vector<double> &_costs) const
+{
+  _routes.clear();
+  _costs.clear();
+  if (_k == 0 || !this->Reachable(_src, _dst))
+    return;
+
+  static thread_local SearchWorkspace toGo;
+  if (_k == 1)
+  {
+    // No need for the cost to go from every vertex.
+    _routes.resize(1);
+    _costs.resize(1);
+    if (!this->Route(_src, _dst, toGo, _routes[0], _costs[0]))
+    {
+      _routes.clear();
+      _costs.clear();
+    }
+    return;
+  }
+
+  // Backward search: cost to go from every vertex that can reach the
+  // destination and next vertex along its shortest route.
+  toGo.Reset(this->ids.size());
+  toGo.Relax(_dst, 0.0, _dst);
+  unsigned int v;
+  while (toGo.Pop(v))
+  {
+    for (auto const &in : this->inbound[v])
+    {
+      double cost = this->links[in.tail][in.link].Cost();
+      if (!std::isinf(cost))
+        toGo.Relax(in.tail, toGo.costs[v] + cost, v);
+    }
+  }
+  if (!toGo.Reached(_src))
+    return;
+
+  auto routeCost = [this](const std::vector<unsigned int> &_route)
+  {
+    double total = 0.0;
+    for (size_t i = 1; i < _route.size(); ++i)
+    {
+      double cost;
+      this->EdgeCost(_route[i - 1], _route[i], cost);
+      total += cost;
+    }
+    return total;
+  };
+
+  // Candidates sorted by cost, with the index of the vertex where each one
+  // deviates from the route it was derived from.
+  std::map<std::pair<double, std::vector<unsigned int>>, size_t> candidates;
+  std::vector<unsigned int> shortest;
+  for (v = _src; v != _dst; v = toGo.parents[v])
+    shortest.push_back(v);
+  shortest.push_back(_dst);
+  candidates[std::make_pair(routeCost(shortest), shortest)] = 0;
+
+  // Routes taken from the candidates, whether they were returned or not.
+  std::vector<std::vector<unsigned int>> examined;
+
+  // Edges of each route returned.
+  std::vector<std::unordered_set<uint64_t>> returnedEdges;
+
+  const bool filter = _maxOverlap < 1.0;
+  const size_t maxExamined = filter ?
+    kRoutesExaminedPerAlternative * _k : _k;
+
+  static thread_local SearchWorkspace spur;
+  std::vector<char> blocked(this->ids.size(), 0);
+  std::vector<unsigned int> blockedHeads;
+  std::vector<unsigned int> spurRoute;
+  while (!candidates.empty())
+  {
+    auto best = candidates.begin();
+    examined.push_back(best->first.second);
+    double cost = best->first.first;
+    size_t deviation = best->second;
+    candidates.erase(best);
+    auto const &route = examined.back();
+
+    // Skip the routes that share too much with a cheaper one.
+    bool diverse = true;
+    for (size_t r = 0; filter && diverse && r < returnedEdges.size(); ++r)
+    {
+      double shared = 0.0;
+      for (size_t i = 1; i < route.size(); ++i)
+      {
+        if (returnedEdges[r].count(edgeKey(route[i - 1], route[i])))
+        {
+          double edgeCost;
+          this->EdgeCost(route[i - 1], route[i], edgeCost);
+          shared += edgeCost;
+        }
+      }
+      diverse = shared <= _maxOverlap * cost;
+    }
+    if (diverse)
+    {
+      _routes.push_back(route);
+      _costs.push_back(cost);
+      if (filter)
+      {
+        returnedEdges.push_back(std::unordered_set<uint64_t>());
+        for (size_t i = 1; i < route.size(); ++i)
+          returnedEdges.back().insert(edgeKey(route[i - 1], route[i]));
+      }
+    }
+    if (_routes.size() == _k || examined.size() == maxExamined)
+      break;
+
+    // Deviate from each vertex of the route. The vertexes before its own
+    // deviation were already handled with the route it derives from
+    // (Lawler's refinement). The root of the route up to the spur vertex is
+    // blocked, so the new routes are loopless.
+    for (size_t i = 0; i < deviation; ++i)
+      blocked[route[i]] = 1;
+
+    for (size_t j = deviation; j + 1 < route.size(); ++j)
+    {
+      // Don't repeat the next edge of any examined route with the same root.
+      auto spurVertex = route[j];
+      blockedHeads.clear();
+      for (auto const &other : examined)
+      {
+        if (other.size() > j + 1 &&
+            std::equal(route.begin(), route.begin() + j + 1, other.begin()))
+        {
+          blockedHeads.push_back(other[j + 1]);
+        }
+      }
+
+      // Dijkstra on the costs reduced by the cost to go, which are never
+      // negative and are zero along the shortest routes, so the search
+      // goes straight to the destination unless a blocked edge is in the
+      // way. Vertexes that can't reach the destination are skipped.
+      spur.Reset(this->ids.size());
+      spur.Relax(spurVertex, 0.0, spurVertex);
+      bool reached = false;
+      while (spur.Pop(v))
+      {
+        if (v == _dst)
+        {
+          reached = true;
+          break;
+        }
+
+        for (auto const &link : this->links[v])
+        {
+          auto w = link.head;
+          if (std::isinf(link.penalty) || blocked[w] || !toGo.Reached(w) ||
+              (v == spurVertex && std::find(blockedHeads.begin(),
+                 blockedHeads.end(), w) != blockedHeads.end()))
+          {
+            continue;
+          }
+
+          double reduced = std::max(0.0,
+            link.Cost() + toGo.costs[w] - toGo.costs[v]);
+          spur.Relax(w, spur.costs[v] + reduced, v);
+        }
+      }
+
+      if (reached)
+      {
+        spurRoute.clear();
+        for (v = _dst; v != spurVertex; v = spur.parents[v])
+          spurRoute.push_back(v);
+        std::vector<unsigned int> candidate(route.begin(),
+                                            route.begin() + j + 1);
+        candidate.insert(candidate.end(), spurRoute.rbegin(),
+                         spurRoute.rend());
+        auto key = std::make_pair(routeCost(candidate), candidate);
+        if (candidates.find(key) == candidates.end())
+          candidates[key] = j;
+      }
+
+      blocked[spurVertex] = 1;
+    }
+
+    for (auto const &u : route)
+      blocked[u] = 0;
+  }
+}
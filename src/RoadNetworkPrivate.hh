@@ -0,0 +1,1761 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef MANIFOLD_ROADNETWORKPRIVATE_HH_
+#define MANIFOLD_ROADNETWORKPRIVATE_HH_
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <ignition/math/Graph.hh>
+#include <ignition/math/SphericalCoordinates.hh>
+
+#include "manifold/rndf/Exit.hh"
+#include "manifold/rndf/Lane.hh"
+#include "manifold/rndf/Perimeter.hh"
+#include "manifold/rndf/ParkingSpot.hh"
+#include "manifold/rndf/Segment.hh"
+#include "manifold/rndf/UniqueId.hh"
+#include "manifold/rndf/Waypoint.hh"
+#include "manifold/rndf/Zone.hh"
+#include "manifold/RoadNetworkOptions.hh"
+#include "LaneChanges.hh"
+#include "RadixHeap.hh"
+
+namespace manifold
+{
+  namespace rndf
+  {
+    class RNDF;
+  }
+
+  /// \internal
+  /// \brief Compute a hash of the content of an RNDF that affects the
+  /// routing graph built from it, together with the options used.
+  /// \param[in] _rndf The RNDF.
+  /// \param[in] _options Options used to build the graph.
+  /// \return The 64-bit hash.
+  uint64_t contentHash(const rndf::RNDF &_rndf,
+                       const RoadNetworkOptions &_options);
+
+  /// \internal
+  /// \brief An outgoing edge of the routing graph.
+  class Link
+  {
+    /// \brief Index of the head vertex.
+    public: unsigned int head;
+
+    /// \brief Cost of traversing the edge (meters).
+    public: double cost;
+
+    /// \brief Extra cost set at runtime on top of the base cost (meters).
+    /// Infinity if the edge is closed.
+    public: double penalty;
+
+    /// \brief Whether the edge is an exit of the RNDF.
+    public: bool exit;
+
+    /// \brief Cost of traversing the edge including its penalty.
+    /// \return The cost or infinity if the edge is closed.
+    public: double Cost() const
+    {
+      return this->cost + this->penalty;
+    }
+  };
+
+  /// \internal
+  /// \brief An incoming edge of the routing graph: the position of the edge
+  /// in the links of its tail, so backward searches read its cost directly.
+  class InLink
+  {
+    /// \brief Index of the tail vertex.
+    public: unsigned int tail;
+
+    /// \brief Index of the edge in the links of the tail.
+    public: unsigned int link;
+  };
+
+  /// \internal
+  /// \brief The turn made by an exit.
+  class Turn
+  {
+    /// \brief Heading change from the lane left to the lane entered
+    /// (radians, in [-pi, pi]). Positive to the left.
+    public: double angle;
+
+    /// \brief Whether the exit leaves from a stop waypoint.
+    public: bool stop;
+
+    /// \brief Intersection of the exit.
+    public: unsigned int intersection;
+  };
+
+  /// \internal
+  /// \brief Log of the edges (tail, head) added, removed or whose penalty
+  /// has changed, in order. The incremental replanners and the route caches
+  /// read it through a cursor to find the affected routes. Changes are only
+  /// recorded while there are cursors open, and they are discarded once all
+  /// the cursors have read them. A reader that falls more than kMaxChanges
+  /// changes behind misses the oldest ones.
+  class EdgeChangeLog
+  {
+    /// \brief Maximum number of changes kept.
+    public: static const size_t kMaxChanges = 1 << 16;
+
+    /// \brief Open a cursor at the end of the log.
+    /// \return Identifier of the cursor.
+    public: size_t Open()
+    {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      auto cursor = this->nextCursor++;
+      this->cursors[cursor] = this->end;
+      return cursor;
+    }
+
+    /// \brief Close a cursor.
+    /// \param[in] _cursor Identifier of the cursor.
+    public: void Close(const size_t _cursor)
+    {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      this->cursors.erase(_cursor);
+      this->Trim();
+    }
+
+    /// \brief Record a change.
+    /// \param[in] _tail Index of the tail vertex.
+    /// \param[in] _head Index of the head vertex.
+    public: void Push(const unsigned int _tail, const unsigned int _head)
+    {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      if (this->cursors.empty())
+        return;
+
+      this->changes.push_back(std::make_pair(_tail, _head));
+      ++this->end;
+      if (this->changes.size() > kMaxChanges)
+        this->changes.pop_front();
+    }
+
+    /// \brief Discard all the changes, as if the cursors had missed them.
+    public: void Clear()
+    {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      this->changes.clear();
+    }
+
+    /// \brief Move a cursor to the end of the log without reading.
+    /// \param[in] _cursor Identifier of the cursor.
+    public: void Skip(const size_t _cursor)
+    {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      this->cursors[_cursor] = this->end;
+      this->Trim();
+    }
+
+    /// \brief Read the changes after a cursor and move it to the end of the
+    /// log.
+    /// \param[in] _cursor Identifier of the cursor.
+    /// \param[in] _f Function called with the tail and head of each change.
+    /// \return False if some of the changes were discarded before the
+    /// cursor read them. Then _f isn't called and the reader must assume
+    /// that any edge might have changed.
+    public: template<typename F>
+    bool Read(const size_t _cursor, F _f)
+    {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      auto &position = this->cursors[_cursor];
+      uint64_t begin = this->end - this->changes.size();
+      bool complete = position >= begin;
+      if (complete)
+      {
+        for (auto i = position - begin; i < this->changes.size(); ++i)
+          _f(this->changes[i].first, this->changes[i].second);
+      }
+      position = this->end;
+      this->Trim();
+      return complete;
+    }
+
+    /// \brief Get the number of changes kept.
+    /// \return The number of changes.
+    public: size_t Size() const
+    {
+      std::lock_guard<std::mutex> lock(this->mutex);
+      return this->changes.size();
+    }
+
+    /// \brief Discard the changes read by all the cursors. Requires the
+    /// lock.
+    private: void Trim()
+    {
+      uint64_t first = this->end;
+      for (auto const &cursor : this->cursors)
+        first = std::min(first, cursor.second);
+      uint64_t begin = this->end - this->changes.size();
+      for (; begin < first && !this->changes.empty(); ++begin)
+        this->changes.pop_front();
+    }
+
+    /// \brief Changes not read by some cursor yet, oldest first.
+    private: std::deque<std::pair<unsigned int, unsigned int>> changes;
+
+    /// \brief Number of changes recorded since the log was created.
+    private: uint64_t end = 0;
+
+    /// \brief Position of each cursor: the number of changes recorded
+    /// before the first one that it hasn't read.
+    private: std::map<size_t, uint64_t> cursors;
+
+    /// \brief Identifier of the next cursor.
+    private: size_t nextCursor = 0;
+
+    /// \brief Protects the log from readers in different threads.
+    private: mutable std::mutex mutex;
+  };
+
+  /// \internal
+  /// \brief Reusable state of a shortest path search. The per-vertex arrays
+  /// are stamped with a generation counter, so starting a new search doesn't
+  /// need to clear them and only the vertexes touched by a search are
+  /// written.
+  class SearchWorkspace
+  {
+    /// \brief Prepare the workspace for a new search.
+    /// \param[in] _size Number of vertexes in the graph.
+    public: void Reset(const size_t _size)
+    {
+      if (this->stamps.size() != _size || this->generation ==
+          std::numeric_limits<unsigned int>::max())
+      {
+        this->stamps.assign(_size, 0);
+        this->costs.resize(_size);
+        this->parents.resize(_size);
+        this->potentials.resize(_size);
+        this->generation = 0;
+      }
+      ++this->generation;
+      this->heap.clear();
+    }
+
+    /// \brief Whether a vertex has been reached by the current search.
+    /// \param[in] _v Vertex index.
+    /// \return True if the vertex has a tentative or final cost.
+    public: bool Reached(const unsigned int _v) const
+    {
+      return this->stamps[_v] == this->generation;
+    }
+
+    /// \brief Cost of the best route to a vertex found so far.
+    /// \param[in] _v Vertex index.
+    /// \return The cost or infinity if the vertex hasn't been reached.
+    public: double Cost(const unsigned int _v) const
+    {
+      if (!this->Reached(_v))
+        return std::numeric_limits<double>::infinity();
+      return this->costs[_v];
+    }
+
+    /// \brief Offer a route to a vertex.
+    /// \param[in] _v Vertex index.
+    /// \param[in] _cost Cost of the route.
+    /// \param[in] _parent Previous vertex in the route.
+    public: void Relax(const unsigned int _v, const double _cost,
+                       const unsigned int _parent)
+    {
+      if (this->Reached(_v) && this->costs[_v] <= _cost)
+        return;
+
+      this->stamps[_v] = this->generation;
+      this->costs[_v] = _cost;
+      this->parents[_v] = _parent;
+      this->heap.push_back(std::make_pair(_cost, _v));
+      std::push_heap(this->heap.begin(), this->heap.end(),
+        std::greater<std::pair<double, unsigned int>>());
+    }
+
+    /// \brief Extract the vertex with the lowest tentative cost, skipping
+    /// outdated heap entries.
+    /// \param[out] _v Vertex index.
+    /// \return True if a vertex was extracted or false if the heap is empty.
+    public: bool Pop(unsigned int &_v)
+    {
+      while (!this->heap.empty())
+      {
+        std::pop_heap(this->heap.begin(), this->heap.end(),
+          std::greater<std::pair<double, unsigned int>>());
+        auto top = this->heap.back();
+        this->heap.pop_back();
+        if (top.first <= this->costs[top.second])
+        {
+          _v = top.second;
+          return true;
+        }
+      }
+      return false;
+    }
+
+    /// \brief Generation of the current search.
+    public: unsigned int generation = 0;
+
+    /// \brief Generation in which each vertex was last reached.
+    public: std::vector<unsigned int> stamps;
+
+    /// \brief Tentative cost of each vertex.
+    public: std::vector<double> costs;
+
+    /// \brief Previous vertex in the best route found to each vertex.
+    public: std::vector<unsigned int> parents;
+
+    /// \brief Lower bound of the cost from each vertex reached to the
+    /// destination. Only used by the searches guided by landmarks.
+    public: std::vector<double> potentials;
+
+    /// \brief Binary heap of (cost, vertex) pairs.
+    public: std::vector<std::pair<double, unsigned int>> heap;
+  };
+
+  /// \internal
+  /// \brief Index used to represent the absence of a vertex.
+  static const unsigned int kNoVertex =
+    std::numeric_limits<unsigned int>::max();
+
+  /// \internal
+  /// \brief Maximum number of components for which the transitive closure is
+  /// stored (32 MiB). Larger graphs answer reachability queries searching
+  /// the condensed DAG.
+  static const unsigned int kMaxClosureComponents = 16384;
+
+  /// \internal
+  /// \brief Number of landmarks used by each search: the ones that give the
+  /// best lower bound between its origin and its destination.
+  static const unsigned int kActiveLandmarks = 4;
+
+  /// \internal
+  /// \brief Private data for RoadNetwork class.
+  class RoadNetworkPrivate
+  {
+    /// \brief Constructor.
+    public: RoadNetworkPrivate() = default;
+
+    /// \brief Destructor.
+    public: virtual ~RoadNetworkPrivate() = default;
+
+    /// \brief Populate the routing graph from an RNDF.
+    /// \param[in] _rndf The RNDF.
+    public: void Build(const rndf::RNDF &_rndf);
+
+    /// \brief Write the routing graph and its strongly connected components
+    /// in binary form. Closures and penalties aren't written.
+    /// \param[out] _out Output stream.
+    /// \param[in] _hash Hash of the source RNDF (see contentHash()).
+    public: void Write(std::ostream &_out, const uint64_t _hash);
+
+    /// \brief Read a routing graph written with Write(). Requires an empty
+    /// graph.
+    /// \param[in] _in Input stream.
+    /// \param[in] _hash Expected hash of the source RNDF.
+    /// \return True if the graph was read or false if the stream is
+    /// corrupted, has a different format version or was built from another
+    /// RNDF or with other options.
+    public: bool Read(std::istream &_in, const uint64_t _hash);
+
+    /// \brief Add a waypoint to the routing graph.
+    /// \param[in] _id Unique Id of the waypoint.
+    /// \param[in] _waypoint The waypoint.
+    /// \return Index of the new vertex.
+    public: unsigned int AddVertex(const rndf::UniqueId &_id,
+                                   const rndf::Waypoint &_waypoint)
+    {
+      std::string name = _id.String();
+      auto index = this->AddVertex(name, _id,
+        _waypoint.Location().LatitudeReference().Radian(),
+        _waypoint.Location().LongitudeReference().Radian());
+      this->indexes[name] = index;
+      return index;
+    }
+
+    /// \brief Add a vertex to the routing graph.
+    /// \param[in] _name Name of the vertex.
+    /// \param[in] _id Unique Id of the waypoint or an invalid Id for vertexes
+    /// that aren't waypoints (e.g.: zone hubs).
+    /// \param[in] _latitude Latitude (radians).
+    /// \param[in] _longitude Longitude (radians).
+    /// \return Index of the new vertex. The index of a removed vertex is
+    /// reused if there's any.
+    public: unsigned int AddVertex(const std::string &_name,
+                                   const rndf::UniqueId &_id,
+                                   const double _latitude,
+                                   const double _longitude)
+    {
+      this->graphDirty = true;
+      if (!this->freeVertexes.empty())
+      {
+        auto index = this->freeVertexes.back();
+        this->freeVertexes.pop_back();
+        this->names[index] = _name;
+        this->ids[index] = _id;
+        this->latitudes[index] = _latitude;
+        this->longitudes[index] = _longitude;
+        this->stops[index] = 0;
+        return index;
+      }
+
+      auto index = static_cast<unsigned int>(this->ids.size());
+      this->names.push_back(_name);
+      this->ids.push_back(_id);
+      this->latitudes.push_back(_latitude);
+      this->longitudes.push_back(_longitude);
+      this->links.push_back({});
+      this->inbound.push_back({});
+      this->stops.push_back(0);
+      return index;
+    }
+
+    /// \brief Whether a vertex is part of the graph (it hasn't been
+    /// removed).
+    /// \param[in] _v Vertex index.
+    /// \return True if the vertex exists.
+    public: bool Alive(const unsigned int _v) const
+    {
+      return !this->names[_v].empty();
+    }
+
+    /// \brief Add the waypoints of all the lanes of a segment and connect
+    /// the consecutive waypoints of each lane.
+    /// \param[in] _segment The segment.
+    public: void AddLanes(const rndf::Segment &_segment)
+    {
+      auto &members = this->segments[_segment.Id()];
+      for (auto const &lane : _segment.Lanes())
+      {
+        bool first = true;
+        unsigned int tail = 0;
+        for (auto const &waypoint : lane.Waypoints())
+        {
+          rndf::UniqueId id(_segment.Id(), lane.Id(), waypoint.Id());
+          auto head = this->AddVertex(id, waypoint);
+          members.push_back(head);
+          if (std::find(lane.Stops().begin(), lane.Stops().end(),
+                waypoint.Id()) != lane.Stops().end())
+          {
+            this->stops[head] = 1;
+          }
+
+          // Connect all waypoints within a segment.
+          if (!first)
+            this->AddEdge(tail, head);
+
+          first = false;
+          tail = head;
+        }
+      }
+    }
+
+    /// \brief Add the lane changes between the parallel lanes of a segment,
+    /// if enabled in the options.
+    /// \param[in] _segment The segment.
+    public: void AddLaneChanges(const rndf::Segment &_segment)
+    {
+      if (!this->options.LaneChanges())
+        return;
+
+      std::vector<LaneChange> changes;
+      laneChanges(_segment, changes);
+      for (auto const &change : changes)
+      {
+        unsigned int tail;
+        unsigned int head;
+        if (this->Index(change.tail, tail) && this->Index(change.head, head))
+          this->AddEdge(tail, head, this->options.LaneChangePenalty());
+      }
+    }
+
+    /// \brief Add the exits of all the lanes of a segment.
+    /// \param[in] _segment The segment.
+    public: void AddLaneExits(const rndf::Segment &_segment)
+    {
+      for (auto const &lane : _segment.Lanes())
+        for (auto const &exit : lane.Exits())
+          this->AddExit(exit);
+    }
+
+    /// \brief Add a zone: its perimeter points, the waypoints of its parking
+    /// spots, the edges within the zone and the exits of its perimeter.
+    /// \param[in] _zone The zone.
+    public: void AddZone(const rndf::Zone &_zone)
+    {
+      auto &members = this->zones[_zone.Id()];
+      std::vector<unsigned int> pointsV;
+      // Add all waypoints delimiting the perimeter of zones as vertexes.
+      for (auto const &waypoint : _zone.Perimeter().Points())
+      {
+        rndf::UniqueId id(_zone.Id(), 0, waypoint.Id());
+        pointsV.push_back(this->AddVertex(id, waypoint));
+      }
+
+      // Add also the two waypoints of a parking spot as vertexes.
+      for (auto const &spot : _zone.Spots())
+      {
+        assert(spot.Waypoints().size() == 2);
+        auto const &waypoint1 = spot.Waypoints().front();
+        rndf::UniqueId wpt1(_zone.Id(), spot.Id(), waypoint1.Id());
+        auto wpt1Index = this->AddVertex(wpt1, waypoint1);
+        pointsV.push_back(wpt1Index);
+
+        // Add the second waypoint.
+        auto const &waypoint2 = spot.Waypoints().at(1);
+        rndf::UniqueId wpt2(_zone.Id(), spot.Id(), waypoint2.Id());
+        auto wpt2Index = this->AddVertex(wpt2, waypoint2);
+        members.push_back(wpt2Index);
+
+        // You can always go from wpt1->wpt2 and from wpt2->wpt1.
+        this->AddEdge(wpt1Index, wpt2Index);
+        this->AddEdge(wpt2Index, wpt1Index);
+      }
+      members.insert(members.end(), pointsV.begin(), pointsV.end());
+
+      // Allow the free traversal between the zone points.
+      auto hub = this->ConnectZone(_zone.Id(), pointsV);
+      if (hub != kNoVertex)
+        members.push_back(hub);
+
+      // Connect all exit waypoints of this zone with other entry waypoints.
+      for (auto const &exit : _zone.Perimeter().Exits())
+        this->AddExit(exit);
+    }
+
+    /// \brief Encode the free traversal between a set of zone vertexes.
+    /// \param[in] _zoneId Id of the zone.
+    /// \param[in] _points Indexes of the perimeter points and parking spot
+    /// entries of the zone.
+    /// \return Index of the hub created or kNoVertex if no hub was needed.
+    public: unsigned int ConnectZone(const int _zoneId,
+                                     const std::vector<unsigned int> &_points)
+    {
+      if (this->options.ZoneModel() == ZoneModel::CLIQUE)
+      {
+        // From a perimeter point you can go to any other perimeter point or
+        // to the first waypoint of a parking spot.
+        for (auto const &tail : _points)
+        {
+          for (auto const &head : _points)
+          {
+            if (tail != head)
+              this->AddEdge(tail, head);
+          }
+        }
+        return kNoVertex;
+      }
+
+      if (_points.empty())
+        return kNoVertex;
+
+      // A hub at the centroid of the zone points, connected to and from
+      // each of them.
+      double latitude = 0;
+      double longitude = 0;
+      for (auto const &point : _points)
+      {
+        latitude += this->latitudes[point];
+        longitude += this->longitudes[point];
+      }
+      latitude /= _points.size();
+      longitude /= _points.size();
+
+      std::string name = std::to_string(_zoneId) + ".0.0";
+      auto hub = this->AddVertex(name, rndf::UniqueId(), latitude, longitude);
+      for (auto const &point : _points)
+      {
+        this->AddEdge(point, hub);
+        this->AddEdge(hub, point);
+      }
+      return hub;
+    }
+
+    /// \brief Heading of a vertex along its lane, from the previous waypoint
+    /// of the lane or to the next one. The waypoints of a lane have
+    /// consecutive Ids, but their vertexes might not have consecutive
+    /// indexes once removed indexes are reused.
+    /// \param[in] _v Index of the vertex.
+    /// \param[in] _forward True to use the next waypoint or false to use the
+    /// previous one.
+    /// \param[out] _heading Heading (radians, counterclockwise from east).
+    /// \return True if the lane has a waypoint there.
+    public: bool LaneHeading(const unsigned int _v, const bool _forward,
+                             double &_heading) const
+    {
+      auto const &id = this->ids[_v];
+      unsigned int w;
+      if (id.Y() == 0 || (!_forward && id.Z() <= 1) ||
+          !this->Index(rndf::UniqueId(id.X(), id.Y(),
+            _forward ? id.Z() + 1 : id.Z() - 1), w))
+      {
+        return false;
+      }
+
+      return _forward ? this->Heading(_v, w, _heading) :
+        this->Heading(w, _v, _heading);
+    }
+
+    /// \brief Heading from a vertex to another one on a local plane.
+    /// \param[in] _from Index of the first vertex.
+    /// \param[in] _to Index of the second vertex.
+    /// \param[out] _heading Heading (radians, counterclockwise from east).
+    /// \return False if both vertexes are at the same location.
+    public: bool Heading(const unsigned int _from, const unsigned int _to,
+                         double &_heading) const
+    {
+      double dx = (this->longitudes[_to] - this->longitudes[_from]) *
+        std::cos(this->latitudes[_from]);
+      double dy = this->latitudes[_to] - this->latitudes[_from];
+      if (std::abs(dx) < 1e-12 && std::abs(dy) < 1e-12)
+        return false;
+
+      _heading = std::atan2(dy, dx);
+      return true;
+    }
+
+    /// \brief Heading change of an exit, from the direction of the lane
+    /// left at the exit waypoint to the direction of the lane entered at
+    /// the entry waypoint. When a waypoint isn't part of a lane with more
+    /// waypoints (e.g.: perimeter points), the direction from the exit to
+    /// the entry is used instead.
+    /// \param[in] _tail Index of the exit waypoint.
+    /// \param[in] _head Index of the entry waypoint.
+    /// \return The angle (radians, in [-pi, pi]). Positive to the left.
+    public: double TurnAngle(const unsigned int _tail,
+                             const unsigned int _head) const
+    {
+      double across = 0.0;
+      bool hasAcross = this->Heading(_tail, _head, across);
+      double in = across;
+      double out = across;
+      bool hasIn = this->LaneHeading(_tail, false, in) || hasAcross;
+      bool hasOut = this->LaneHeading(_head, true, out) || hasAcross;
+      if (!hasIn || !hasOut)
+        return 0.0;
+
+      const double kPi = std::acos(-1.0);
+      double angle = std::fmod(out - in, 2.0 * kPi);
+      if (angle > kPi)
+        angle -= 2.0 * kPi;
+      else if (angle < -kPi)
+        angle += 2.0 * kPi;
+      return angle;
+    }
+
+    /// \brief Extra cost of an exit: the stop and turn penalties of the
+    /// options.
+    /// \param[in] _tail Index of the exit waypoint.
+    /// \param[in] _head Index of the entry waypoint.
+    /// \return The cost (meters) or 0 if turn costs are disabled.
+    public: double TurnCost(const unsigned int _tail,
+                            const unsigned int _head) const
+    {
+      if (!this->options.TurnCosts())
+        return 0.0;
+
+      const double kHalfPi = std::acos(0.0);
+      return (this->stops[_tail] ? this->options.StopPenalty() : 0.0) +
+        this->options.TurnPenalty() *
+        std::abs(this->TurnAngle(_tail, _head)) / kHalfPi;
+    }
+
+    /// \brief Connect two vertexes in the routing graph.
+    /// \param[in] _tail Index of the tail vertex.
+    /// \param[in] _head Index of the head vertex.
+    /// \param[in] _extra Cost added to the distance between the vertexes.
+    /// \param[in] _exit Whether the edge is an exit of the RNDF.
+    public: void AddEdge(const unsigned int _tail, const unsigned int _head,
+                         const double _extra = 0, const bool _exit = false)
+    {
+      double cost = _extra + ignition::math::SphericalCoordinates::Distance(
+        this->latitudes[_tail], this->longitudes[_tail],
+        this->latitudes[_head], this->longitudes[_head]);
+      auto &tailLinks = this->links[_tail];
+      tailLinks.push_back({_head, cost, 0.0, _exit});
+      this->inbound[_head].push_back(
+        {_tail, static_cast<unsigned int>(tailLinks.size() - 1)});
+      this->edgeChanges.Push(_tail, _head);
+      this->graphDirty = true;
+    }
+
+    /// \brief Remove an edge from the incoming edges of its head.
+    /// \param[in] _tail Index of the tail vertex.
+    /// \param[in] _link Index of the edge in the links of the tail.
+    public: void UnlinkInbound(const unsigned int _tail,
+                               const unsigned int _link)
+    {
+      auto &headInbound = this->inbound[this->links[_tail][_link].head];
+      headInbound.erase(std::find_if(headInbound.begin(), headInbound.end(),
+        [_tail, _link](const InLink &_in)
+        {
+          return _in.tail == _tail && _in.link == _link;
+        }));
+    }
+
+    /// \brief Update the incoming edge of the head of an edge that moved
+    /// within the links of its tail.
+    /// \param[in] _tail Index of the tail vertex.
+    /// \param[in] _from Previous index of the edge in the links of the tail.
+    /// \param[in] _to Current index of the edge in the links of the tail.
+    public: void RelinkInbound(const unsigned int _tail,
+                               const unsigned int _from,
+                               const unsigned int _to)
+    {
+      for (auto &in : this->inbound[this->links[_tail][_to].head])
+      {
+        if (in.tail == _tail && in.link == _from)
+        {
+          in.link = _to;
+          return;
+        }
+      }
+    }
+
+    /// \brief Remove one edge from the routing graph.
+    /// \param[in] _tail Index of the tail vertex.
+    /// \param[in] _head Index of the head vertex.
+    /// \param[in] _exit True to remove only an exit of the RNDF, e.g. when a
+    /// lane change joins the same waypoints.
+    /// \return True if the edge existed.
+    public: bool RemoveEdge(const unsigned int _tail, const unsigned int _head,
+                            const bool _exit = false)
+    {
+      auto &tailLinks = this->links[_tail];
+      auto it = std::find_if(tailLinks.begin(), tailLinks.end(),
+        [_head, _exit](const Link &_link)
+        {
+          return _link.head == _head && (_link.exit || !_exit);
+        });
+      if (it == tailLinks.end())
+        return false;
+
+      auto index = static_cast<unsigned int>(it - tailLinks.begin());
+      this->UnlinkInbound(_tail, index);
+      tailLinks.erase(it);
+
+      // The next links of the tail are shifted by one.
+      for (auto i = index; i < tailLinks.size(); ++i)
+        this->RelinkInbound(_tail, i + 1, i);
+      this->edgeChanges.Push(_tail, _head);
+      this->graphDirty = true;
+      return true;
+    }
+
+    /// \brief Set the penalty of all the edges between two vertexes.
+    /// \param[in] _tail Unique Id of the tail waypoint.
+    /// \param[in] _head Unique Id of the head waypoint.
+    /// \param[in] _penalty The penalty (infinity closes the edge).
+    /// \return True if the edge exists.
+    public: bool SetPenalty(const rndf::UniqueId &_tail,
+                            const rndf::UniqueId &_head,
+                            const double _penalty)
+    {
+      unsigned int tail;
+      unsigned int head;
+      if (!this->Index(_tail, tail) || !this->Index(_head, head))
+        return false;
+
+      bool found = false;
+      for (auto &link : this->links[tail])
+      {
+        if (link.head == head)
+        {
+          link.penalty = _penalty;
+          found = true;
+        }
+      }
+
+      if (found)
+        this->edgeChanges.Push(tail, head);
+      return found;
+    }
+
+    /// \brief Connect an exit waypoint with an entry waypoint. If any of the
+    /// waypoints isn't part of the graph the exit is kept as dangling and
+    /// it will be connected when the missing waypoint is added.
+    /// \param[in] _exit The exit.
+    public: void AddExit(const rndf::Exit &_exit)
+    {
+      unsigned int tail;
+      unsigned int head;
+      if (this->Index(_exit.ExitId(), tail) &&
+          this->Index(_exit.EntryId(), head))
+      {
+        this->AddEdge(tail, head, this->TurnCost(tail, head), true);
+      }
+      else
+        this->danglingExits.push_back(_exit);
+    }
+
+    /// \brief Connect the dangling exits whose waypoints are now part of the
+    /// graph.
+    public: void ResolveExits()
+    {
+      std::vector<rndf::Exit> pending;
+      pending.swap(this->danglingExits);
+      for (auto const &exit : pending)
+        this->AddExit(exit);
+    }
+
+    /// \brief Remove a set of vertexes and all their edges. The exits from
+    /// the rest of the graph to the removed vertexes are kept as dangling.
+    /// The indexes of the vertexes are reused by the next vertexes added,
+    /// so a change (v, v) is logged for each one: the readers of the log
+    /// must forget any state about them.
+    /// \param[in] _members Indexes of the vertexes to remove.
+    /// \param[in] _groupId Id of the segment or zone removed. The dangling
+    /// exits leaving it are discarded.
+    public: void RemoveVertexes(const std::vector<unsigned int> &_members,
+                                const int _groupId)
+    {
+      std::vector<bool> removed(this->ids.size(), false);
+      for (auto const &v : _members)
+        removed[v] = true;
+
+      // The incoming edges from the rest of the graph are found through the
+      // inbound index, so only the edges of the removed vertexes are
+      // visited.
+      std::vector<unsigned int> tails;
+      for (auto const &v : _members)
+      {
+        for (auto const &in : this->inbound[v])
+        {
+          const unsigned int u = in.tail;
+          if (removed[u])
+            continue;
+
+          if (this->ids[u].Valid())
+          {
+            this->danglingExits.push_back(
+              rndf::Exit(this->ids[u], this->ids[v]));
+          }
+          tails.push_back(u);
+          this->edgeChanges.Push(u, v);
+        }
+
+        for (auto const &link : this->links[v])
+        {
+          this->edgeChanges.Push(v, link.head);
+          if (removed[link.head])
+            continue;
+
+          auto &headInbound = this->inbound[link.head];
+          headInbound.erase(std::remove_if(headInbound.begin(),
+            headInbound.end(), [v](const InLink &_in)
+            {
+              return _in.tail == v;
+            }), headInbound.end());
+        }
+      }
+
+      std::sort(tails.begin(), tails.end());
+      tails.erase(std::unique(tails.begin(), tails.end()), tails.end());
+      for (auto const &u : tails)
+      {
+        // Compact the links, moving the incoming edges of the heads kept.
+        auto &uLinks = this->links[u];
+        unsigned int kept = 0;
+        for (unsigned int i = 0; i < uLinks.size(); ++i)
+        {
+          if (removed[uLinks[i].head])
+            continue;
+
+          if (kept != i)
+          {
+            uLinks[kept] = uLinks[i];
+            this->RelinkInbound(u, i, kept);
+          }
+          ++kept;
+        }
+        uLinks.resize(kept);
+      }
+
+      for (auto const &v : _members)
+      {
+        this->indexes.erase(this->names[v]);
+        this->names[v].clear();
+        this->ids[v] = rndf::UniqueId();
+        this->links[v].clear();
+        this->links[v].shrink_to_fit();
+        this->inbound[v].clear();
+        this->inbound[v].shrink_to_fit();
+        this->freeVertexes.push_back(v);
+        this->edgeChanges.Push(v, v);
+      }
+
+      this->danglingExits.erase(std::remove_if(this->danglingExits.begin(),
+        this->danglingExits.end(), [_groupId](const rndf::Exit &_exit)
+        {
+          return _exit.ExitId().X() == _groupId;
+        }), this->danglingExits.end());
+
+      this->graphDirty = true;
+    }
+
+    /// \brief Compute the strongly connected components, the condensed DAG
+    /// and the reachability between components if the routing graph has
+    /// changed since the last call. Closures and penalties are ignored.
+    public: void SyncComponents()
+    {
+      if (this->componentsRevision == this->revision)
+        return;
+
+      std::lock_guard<std::mutex> lock(this->componentsMutex);
+      if (this->componentsRevision == this->revision)
+        return;
+
+      this->FindComponents();
+      this->CondenseComponents();
+      this->componentsRevision = this->revision;
+    }
+
+    /// \brief Group the exits into intersections and compute their turns
+    /// if the graph has changed since the last time.
+    public: void SyncIntersections()
+    {
+      if (this->intersectionsRevision == this->revision)
+        return;
+
+      std::lock_guard<std::mutex> lock(this->intersectionsMutex);
+      if (this->intersectionsRevision == this->revision)
+        return;
+
+      this->FindIntersections();
+      this->intersectionsRevision = this->revision;
+    }
+
+    /// \brief Group the exits into intersections: two exits belong to the
+    /// same intersection if they leave from the same waypoint (e.g.: a stop)
+    /// or enter the same waypoint, directly or through other exits. Fills
+    /// the turn of each exit.
+    public: void FindIntersections()
+    {
+      // Union-find over the vertexes connected by exits.
+      std::vector<unsigned int> parents(this->ids.size());
+      for (unsigned int v = 0; v < parents.size(); ++v)
+        parents[v] = v;
+      auto find = [&parents](unsigned int _v)
+        {
+          while (parents[_v] != _v)
+          {
+            parents[_v] = parents[parents[_v]];
+            _v = parents[_v];
+          }
+          return _v;
+        };
+
+      for (unsigned int v = 0; v < this->links.size(); ++v)
+      {
+        for (auto const &link : this->links[v])
+        {
+          if (link.exit)
+            parents[find(v)] = find(link.head);
+        }
+      }
+
+      this->turns.clear();
+      std::unordered_map<unsigned int, unsigned int> numbers;
+      for (unsigned int v = 0; v < this->links.size(); ++v)
+      {
+        for (auto const &link : this->links[v])
+        {
+          if (!link.exit)
+            continue;
+
+          auto root = find(v);
+          auto number = numbers.insert(std::make_pair(root,
+            static_cast<unsigned int>(numbers.size()))).first->second;
+          Turn turn;
+          turn.angle = this->TurnAngle(v, link.head);
+          turn.stop = this->stops[v] != 0;
+          turn.intersection = number;
+          this->turns[(static_cast<uint64_t>(v) << 32) | link.head] = turn;
+        }
+      }
+      this->numIntersections = static_cast<unsigned int>(numbers.size());
+    }
+
+    /// \brief Select the landmarks and compute their costs if the graph
+    /// has changed since the last time.
+    public: void SyncLandmarks()
+    {
+      if (this->landmarksRevision == this->revision)
+        return;
+
+      std::lock_guard<std::mutex> lock(this->landmarksMutex);
+      if (this->landmarksRevision == this->revision)
+        return;
+
+      this->ComputeLandmarks();
+      this->landmarksRevision = this->revision;
+    }
+
+    /// \brief Select the landmarks among the waypoints farthest from the
+    /// center of the network, one per angular sector, and compute the cost
+    /// from and to each one of them with one search per landmark and
+    /// direction, run in parallel. The costs ignore closures and penalties,
+    /// so they give lower bounds whatever the overlay is.
+    public: void ComputeLandmarks();
+
+    /// \brief Whether the landmark costs are up to date and can guide the
+    /// searches.
+    /// \return True if the landmarks can be used.
+    public: bool LandmarksReady() const
+    {
+      return !this->landmarks.empty() &&
+        this->landmarksRevision == this->revision;
+    }
+
+    /// \brief Tarjan's algorithm, with an explicit stack so deep graphs
+    /// don't overflow the call stack. Components are numbered in reverse
+    /// topological order: edges between components always go from a
+    /// higher number to a lower one.
+    public: void FindComponents()
+    {
+      const unsigned int n = static_cast<unsigned int>(this->ids.size());
+      std::vector<unsigned int> order(n, kNoVertex);
+      std::vector<unsigned int> low(n, 0);
+      std::vector<bool> onStack(n, false);
+      std::vector<unsigned int> stack;
+      // Vertex and position of the next link to explore.
+      std::vector<std::pair<unsigned int, size_t>> calls;
+      unsigned int counter = 0;
+
+      this->components.assign(n, kNoVertex);
+      this->numComponents = 0;
+      for (unsigned int root = 0; root < n; ++root)
+      {
+        if (!this->Alive(root) || order[root] != kNoVertex)
+          continue;
+
+        calls.push_back(std::make_pair(root, 0));
+        while (!calls.empty())
+        {
+          unsigned int v = calls.back().first;
+          size_t &next = calls.back().second;
+          if (next == 0 && order[v] == kNoVertex)
+          {
+            order[v] = low[v] = counter++;
+            stack.push_back(v);
+            onStack[v] = true;
+          }
+
+          auto const &vLinks = this->links[v];
+          if (next < vLinks.size())
+          {
+            unsigned int w = vLinks[next++].head;
+            if (order[w] == kNoVertex)
+              calls.push_back(std::make_pair(w, 0));
+            else if (onStack[w])
+              low[v] = std::min(low[v], order[w]);
+            continue;
+          }
+
+          // All the links of v have been explored.
+          calls.pop_back();
+          if (!calls.empty())
+          {
+            unsigned int parent = calls.back().first;
+            low[parent] = std::min(low[parent], low[v]);
+          }
+
+          if (low[v] == order[v])
+          {
+            unsigned int w;
+            do
+            {
+              w = stack.back();
+              stack.pop_back();
+              onStack[w] = false;
+              this->components[w] = this->numComponents;
+            } while (w != v);
+            ++this->numComponents;
+          }
+        }
+      }
+    }
+
+    /// \brief Build the condensed DAG and the transitive closure of the
+    /// components. Requires FindComponents().
+    public: void CondenseComponents()
+    {
+      const unsigned int c = this->numComponents;
+      this->dag.assign(c, {});
+      for (unsigned int v = 0; v < this->links.size(); ++v)
+      {
+        for (auto const &link : this->links[v])
+        {
+          auto from = this->components[v];
+          auto to = this->components[link.head];
+          if (from != to)
+            this->dag[from].push_back(to);
+        }
+      }
+
+      for (auto &heads : this->dag)
+      {
+        std::sort(heads.begin(), heads.end());
+        heads.erase(std::unique(heads.begin(), heads.end()), heads.end());
+      }
+
+      // One bit per pair of components. Successors have lower numbers, so
+      // they are complete when a component is processed.
+      this->closure.clear();
+      this->closureWords = (c + 63) / 64;
+      if (c > kMaxClosureComponents)
+        return;
+
+      this->closure.assign(static_cast<size_t>(c) * this->closureWords, 0);
+      for (unsigned int i = 0; i < c; ++i)
+      {
+        uint64_t *row = &this->closure[i * this->closureWords];
+        row[i / 64] |= uint64_t(1) << (i % 64);
+        for (auto const &j : this->dag[i])
+        {
+          const uint64_t *other = &this->closure[j * this->closureWords];
+          for (size_t k = 0; k < this->closureWords; ++k)
+            row[k] |= other[k];
+        }
+      }
+    }
+
+    /// \brief Whether a component can be reached from another one.
+    /// Requires SyncComponents().
+    /// \param[in] _from Origin component.
+    /// \param[in] _to Destination component.
+    /// \return True if _to is reachable from _from.
+    public: bool ComponentReachable(const unsigned int _from,
+                                    const unsigned int _to) const
+    {
+      if (_from == _to)
+        return true;
+
+      // Reachable components always have a lower number.
+      if (_to > _from)
+        return false;
+
+      if (!this->closure.empty())
+      {
+        return (this->closure[_from * this->closureWords + _to / 64] >>
+          (_to % 64)) & 1u;
+      }
+
+      // The closure is too large: search the condensed DAG.
+      std::vector<bool> visited(this->numComponents, false);
+      std::vector<unsigned int> pending = {_from};
+      visited[_from] = true;
+      while (!pending.empty())
+      {
+        auto i = pending.back();
+        pending.pop_back();
+        for (auto const &j : this->dag[i])
+        {
+          if (j == _to)
+            return true;
+          if (j > _to && !visited[j])
+          {
+            visited[j] = true;
+            pending.push_back(j);
+          }
+        }
+      }
+      return false;
+    }
+
+    /// \brief Whether a vertex can be reached from another one, ignoring
+    /// closures. Requires SyncComponents().
+    /// \param[in] _from Index of the origin vertex.
+    /// \param[in] _to Index of the destination vertex.
+    /// \return True if _to is reachable from _from.
+    public: bool Reachable(const unsigned int _from,
+                           const unsigned int _to) const
+    {
+      return this->ComponentReachable(this->components[_from],
+                                      this->components[_to]);
+    }
+
+    /// \brief Rebuild the graph of segments from the routing graph if the
+    /// routing graph has changed since the last call.
+    public: void SyncGraph()
+    {
+      std::lock_guard<std::mutex> lock(this->graphMutex);
+      if (!this->graphDirty)
+        return;
+
+      this->network = ignition::math::DirectedGraph<std::string, int>();
+      std::vector<ignition::math::VertexPtr<std::string>> vertexes(
+        this->ids.size());
+      for (unsigned int v = 0; v < this->ids.size(); ++v)
+      {
+        if (this->Alive(v))
+          vertexes[v] = this->network.AddVertex(this->names[v], this->names[v]);
+      }
+
+      for (unsigned int v = 0; v < this->ids.size(); ++v)
+        for (auto const &link : this->links[v])
+          this->network.AddEdge(vertexes[v], vertexes[link.head], 0);
+
+      this->graphDirty = false;
+    }
+
+    /// \brief Get a description of the routing graph that doesn't depend on
+    /// the vertex indexes: the outgoing edges (head name and cost) of each
+    /// vertex, keyed by vertex name.
+    /// \return The adjacency of each vertex, sorted by head name.
+    public: std::map<std::string, std::vector<std::pair<std::string, double>>>
+      Adjacency() const
+    {
+      std::map<std::string, std::vector<std::pair<std::string, double>>> adj;
+      for (unsigned int v = 0; v < this->ids.size(); ++v)
+      {
+        if (!this->Alive(v))
+          continue;
+
+        auto &edges = adj[this->names[v]];
+        for (auto const &link : this->links[v])
+          edges.push_back(std::make_pair(this->names[link.head], link.cost));
+        std::sort(edges.begin(), edges.end());
+      }
+      return adj;
+    }
+
+    /// \brief Check that the inbound index mirrors the outgoing edges.
+    /// \return True if every edge appears once in the inbound list of its
+    /// head, with its index in the links of its tail.
+    public: bool InboundConsistent() const
+    {
+      using Entry = std::pair<unsigned int, unsigned int>;
+      std::vector<std::vector<Entry>> expected(this->ids.size());
+      for (unsigned int v = 0; v < this->links.size(); ++v)
+      {
+        for (unsigned int i = 0; i < this->links[v].size(); ++i)
+          expected[this->links[v][i].head].push_back(Entry(v, i));
+      }
+
+      for (unsigned int v = 0; v < this->inbound.size(); ++v)
+      {
+        std::vector<Entry> actual;
+        for (auto const &in : this->inbound[v])
+          actual.push_back(Entry(in.tail, in.link));
+        std::sort(actual.begin(), actual.end());
+        std::sort(expected[v].begin(), expected[v].end());
+        if (actual != expected[v])
+          return false;
+      }
+      return true;
+    }
+
+    /// \brief Get the index of a vertex in the routing graph.
+    /// \param[in] _id Unique Id of the waypoint.
+    /// \param[out] _index Index of the vertex.
+    /// \return True if the waypoint is part of the graph.
+    public: bool Index(const rndf::UniqueId &_id, unsigned int &_index) const
+    {
+      auto it = this->indexes.find(_id.String());
+      if (it == this->indexes.end())
+        return false;
+
+      _index = it->second;
+      return true;
+    }
+
+    /// \brief Get the indexes of a set of waypoints.
+    /// \param[in] _ids Unique Ids of the waypoints.
+    /// \param[out] _indexes Index of each vertex.
+    /// \return True if all the waypoints are part of the graph.
+    public: bool Indexes(const std::vector<rndf::UniqueId> &_ids,
+                         std::vector<unsigned int> &_indexes) const
+    {
+      _indexes.resize(_ids.size());
+      for (size_t i = 0; i < _ids.size(); ++i)
+      {
+        if (!this->Index(_ids[i], _indexes[i]))
+        {
+          std::cerr << "RoadNetwork: Unknown waypoint [" << _ids[i] << "]"
+                    << std::endl;
+          return false;
+        }
+      }
+      return true;
+    }
+
+    /// \brief Approximate memory used by the graph, from the capacity of
+    /// its containers. The strings are counted by their capacity and the
+    /// hash maps by their buckets and nodes.
+    /// \return The size (bytes).
+    public: size_t Bytes() const
+    {
+      const size_t kNode = 2 * sizeof(void *);
+      size_t bytes = this->ids.capacity() * sizeof(rndf::UniqueId) +
+        this->names.capacity() * sizeof(std::string) +
+        this->freeVertexes.capacity() * sizeof(unsigned int) +
+        this->latitudes.capacity() * sizeof(double) +
+        this->longitudes.capacity() * sizeof(double) +
+        this->stops.capacity() * sizeof(char) +
+        this->links.capacity() * sizeof(std::vector<Link>) +
+        this->inbound.capacity() * sizeof(std::vector<InLink>) +
+        this->danglingExits.capacity() * sizeof(rndf::Exit) +
+        this->edgeChanges.Size() *
+          sizeof(std::pair<unsigned int, unsigned int>) +
+        this->components.capacity() * sizeof(unsigned int) +
+        this->dag.capacity() * sizeof(std::vector<unsigned int>) +
+        this->closure.capacity() * sizeof(uint64_t) +
+        this->landmarks.capacity() * sizeof(unsigned int) +
+        this->landmarkCosts.capacity() * sizeof(double);
+      for (auto const &name : this->names)
+        bytes += name.capacity();
+      for (auto const &edges : this->links)
+        bytes += edges.capacity() * sizeof(Link);
+      for (auto const &tails : this->inbound)
+        bytes += tails.capacity() * sizeof(InLink);
+      for (auto const &heads : this->dag)
+        bytes += heads.capacity() * sizeof(unsigned int);
+
+      bytes += this->indexes.bucket_count() * sizeof(void *);
+      for (auto const &index : this->indexes)
+        bytes += kNode + sizeof(index) + index.first.capacity();
+      for (auto const *groups : {&this->segments, &this->zones})
+      {
+        bytes += groups->bucket_count() * sizeof(void *);
+        for (auto const &group : *groups)
+        {
+          bytes += kNode + sizeof(group) +
+            group.second.capacity() * sizeof(unsigned int);
+        }
+      }
+      bytes += this->turns.bucket_count() * sizeof(void *) +
+        this->turns.size() * (kNode + sizeof(std::pair<uint64_t, Turn>));
+      return bytes;
+    }
+
+    /// \brief Run Dijkstra's algorithm from a vertex.
+    /// \param[in] _src Index of the origin vertex.
+    /// \param[in, out] _ws Workspace storing the search state.
+    /// \param[in] _settled Function called each time that a vertex gets its
+    /// final cost. The search stops when it returns true.
+    public: void Search(const unsigned int _src, SearchWorkspace &_ws,
+                        const std::function<bool(const unsigned int)> &_settled)
+      const
+    {
+      _ws.Reset(this->ids.size());
+      _ws.Relax(_src, 0.0, _src);
+
+      unsigned int v;
+      while (_ws.Pop(v))
+      {
+        if (_settled(v))
+          return;
+
+        double cost = _ws.costs[v];
+        for (auto const &link : this->links[v])
+        {
+          if (!std::isinf(link.penalty))
+            _ws.Relax(link.head, cost + link.Cost(), v);
+        }
+      }
+    }
+
+    /// \brief Run Dijkstra's algorithm from a vertex up to a cost budget,
+    /// with a radix heap as priority queue.
+    /// \param[in] _src Index of the origin vertex.
+    /// \param[in] _budget Maximum cost.
+    /// \param[in, out] _ws Workspace storing the search state. Its binary
+    /// heap isn't used.
+    /// \param[in, out] _queue Priority queue.
+    /// \param[out] _settled Vertexes reached within the budget, in
+    /// increasing order of cost. Their costs are stored in _ws.
+    public: void SearchWithin(const unsigned int _src, const double _budget,
+                              SearchWorkspace &_ws, RadixHeap &_queue,
+                              std::vector<unsigned int> &_settled) const
+    {
+      _settled.clear();
+      _ws.Reset(this->ids.size());
+      _queue.Clear();
+      _ws.stamps[_src] = _ws.generation;
+      _ws.costs[_src] = 0.0;
+      _ws.parents[_src] = _src;
+      _queue.Push(0.0, _src);
+
+      double cost;
+      unsigned int v;
+      while (_queue.Pop(cost, v))
+      {
+        // Skip outdated entries.
+        if (cost > _ws.costs[v])
+          continue;
+
+        _settled.push_back(v);
+        for (auto const &link : this->links[v])
+        {
+          if (std::isinf(link.penalty))
+            continue;
+
+          auto w = link.head;
+          double reached = cost + link.Cost();
+          if (reached <= _budget && (!_ws.Reached(w) || reached < _ws.costs[w]))
+          {
+            _ws.stamps[w] = _ws.generation;
+            _ws.costs[w] = reached;
+            _ws.parents[w] = v;
+            _queue.Push(reached, w);
+          }
+        }
+      }
+    }
+
+    /// \brief Run A* from a vertex to another one, with the lower bounds
+    /// given by the landmarks (triangle inequality). It's Dijkstra's
+    /// algorithm on the costs reduced by the lower bounds, so the costs
+    /// stored in the workspace are reduced costs. Requires
+    /// SyncLandmarks().
+    /// \param[in] _src Index of the origin vertex.
+    /// \param[in] _dst Index of the destination vertex.
+    /// \param[in, out] _ws Workspace storing the search state.
+    public: void SearchWithLandmarks(const unsigned int _src,
+                                     const unsigned int _dst,
+                                     SearchWorkspace &_ws) const
+    {
+      _ws.Reset(this->ids.size());
+
+      // d(v, t) >= d(l, t) - d(l, v) and d(v, t) >= d(v, l) - d(t, l). An
+      // infinite bound means that v can't reach t. NaN bounds (infinity
+      // minus infinity) are ignored by the comparisons.
+      const size_t stride = 2 * this->landmarks.size();
+      const double *dst = &this->landmarkCosts[_dst * stride];
+      auto bound = [&](const unsigned int _v, const size_t _l)
+      {
+        const double *v = &this->landmarkCosts[_v * stride];
+        double h = 0.0;
+        double fromLandmark = dst[_l] - v[_l];
+        double toLandmark = v[_l + 1] - dst[_l + 1];
+        if (fromLandmark > h)
+          h = fromLandmark;
+        if (toLandmark > h)
+          h = toLandmark;
+        return h;
+      };
+
+      // Keep the landmarks with the best bounds from the origin.
+      size_t active[kActiveLandmarks];
+      double activeBounds[kActiveLandmarks];
+      size_t numActive = 0;
+      for (size_t l = 0; l < stride; l += 2)
+      {
+        double h = bound(_src, l);
+        if (numActive == kActiveLandmarks && h <= activeBounds[numActive - 1])
+          continue;
+
+        // Insertion sort, by decreasing bound.
+        size_t i = numActive < kActiveLandmarks ? numActive++ : numActive - 1;
+        for (; i > 0 && activeBounds[i - 1] < h; --i)
+        {
+          active[i] = active[i - 1];
+          activeBounds[i] = activeBounds[i - 1];
+        }
+        active[i] = l;
+        activeBounds[i] = h;
+      }
+
+      auto potential = [&](const unsigned int _v)
+      {
+        double h = 0.0;
+        for (size_t i = 0; i < numActive; ++i)
+          h = std::max(h, bound(_v, active[i]));
+        return h;
+      };
+
+      double h = potential(_src);
+      if (std::isinf(h))
+        return;
+
+      _ws.Relax(_src, 0.0, _src);
+      _ws.potentials[_src] = h;
+      unsigned int v;
+      while (_ws.Pop(v))
+      {
+        if (v == _dst)
+          return;
+
+        double cost = _ws.costs[v];
+        double hv = _ws.potentials[v];
+        for (auto const &link : this->links[v])
+        {
+          if (std::isinf(link.penalty))
+            continue;
+
+          auto w = link.head;
+          double hw = _ws.Reached(w) ? _ws.potentials[w] : potential(w);
+          if (std::isinf(hw))
+            continue;
+
+          _ws.Relax(w, cost + std::max(0.0, link.Cost() + hw - hv), v);
+          _ws.potentials[w] = hw;
+        }
+      }
+    }
+
+    /// \brief Compute the shortest route between two vertexes.
+    /// \param[in] _src Index of the origin vertex.
+    /// \param[in] _dst Index of the destination vertex.
+    /// \param[out] _route Indexes of the vertexes along the route, from _src
+    /// to _dst (both included), zone hubs included.
+    /// \param[out] _cost Cost of the route.
+    /// \return True if a route was found.
+    public: bool Route(const unsigned int _src, const unsigned int _dst,
+                       std::vector<unsigned int> &_route, double &_cost)
+    {
+      this->SyncComponents();
+      this->SyncLandmarks();
+
+      // One workspace per thread, reused by all the queries run on it.
+      static thread_local SearchWorkspace ws;
+      return this->Route(_src, _dst, ws, _route, _cost);
+    }
+
+    /// \brief Compute the shortest route between two vertexes using a given
+    /// workspace. Requires SyncComponents(). The search is guided by the
+    /// landmarks if SyncLandmarks() was called too.
+    /// \param[in] _src Index of the origin vertex.
+    /// \param[in] _dst Index of the destination vertex.
+    /// \param[in, out] _ws Workspace storing the search state.
+    /// \param[out] _route Indexes of the vertexes along the route, from _src
+    /// to _dst (both included), zone hubs included.
+    /// \param[out] _cost Cost of the route.
+    /// \return True if a route was found.
+    public: bool Route(const unsigned int _src, const unsigned int _dst,
+                       SearchWorkspace &_ws, std::vector<unsigned int> &_route,
+                       double &_cost) const
+    {
+      // Don't waste a search on a destination that can't be reached.
+      if (!this->Reachable(_src, _dst))
+        return false;
+
+      bool guided = this->LandmarksReady();
+      if (guided)
+        this->SearchWithLandmarks(_src, _dst, _ws);
+      else
+      {
+        this->Search(_src, _ws, [_dst](const unsigned int _v)
+          {
+            return _v == _dst;
+          });
+      }
+
+      if (!_ws.Reached(_dst))
+        return false;
+
+      _route.clear();
+      for (unsigned int v = _dst; v != _src; v = _ws.parents[v])
+        _route.push_back(v);
+      _route.push_back(_src);
+      std::reverse(_route.begin(), _route.end());
+
+      _cost = _ws.costs[_dst];
+      if (guided)
+      {
+        // The workspace has reduced costs. Add the edges in the same order
+        // as Dijkstra's algorithm, so both give the same cost.
+        _cost = 0.0;
+        for (size_t i = 1; i < _route.size(); ++i)
+        {
+          double edgeCost;
+          this->EdgeCost(_route[i - 1], _route[i], edgeCost);
+          _cost += edgeCost;
+        }
+      }
+      return true;
+    }
+
+    /// \brief Get the current cost of the cheapest edge between two
+    /// vertexes.
+    /// \param[in] _tail Index of the tail vertex.
+    /// \param[in] _head Index of the head vertex.
+    /// \param[out] _cost The cost, penalty included, or infinity if the edge
+    /// is closed.
+    /// \return True if the edge exists.
+    public: bool EdgeCost(const unsigned int _tail, const unsigned int _head,
+                          double &_cost) const
+    {
+      bool found = false;
+      _cost = std::numeric_limits<double>::infinity();
+      for (auto const &link : this->links[_tail])
+      {
+        if (link.head == _head)
+        {
+          _cost = std::min(_cost, link.Cost());
+          found = true;
+        }
+      }
+      return found;
+    }
+
+    /// \brief Compute up to _k loopless routes between two vertexes in
+    /// increasing order of cost, with Yen's algorithm. A backward search
+    /// from _dst gives the exact cost to go from every vertex, which is used
+    /// as the potential of the spur searches: each one only explores around
+    /// the edges removed. Requires SyncComponents().
+    /// \param[in] _src Index of the origin vertex.
+    /// \param[in] _dst Index of the destination vertex.
+    /// \param[in] _k Maximum number of routes.
+    /// \param[in] _maxOverlap Maximum fraction of the cost of a route that
+    /// can be shared with a cheaper route returned. Routes that overlap
+    /// more are skipped.
+    /// \param[out] _routes Indexes of the vertexes along each route, zone
+    /// hubs included.
+    /// \param[out] _costs Cost of each route.
+    public: void AlternativeRoutes(const unsigned int _src,
+      const unsigned int _dst, const unsigned int _k,
+      const double _maxOverlap,
+      std::vector<std::vector<unsigned int>> &_routes,
+      std::vector<double> &_costs) const;
+
+    /// \brief Graph of segments.
+    /// The vertex contains a string (waypoint Id) and the edge an
+    /// integer (unused). It's rebuilt from the routing graph on demand.
+    public: ignition::math::DirectedGraph<std::string, int> network;
+
+    /// \brief Whether the graph of segments is out of date.
+    public: bool graphDirty = true;
+
+    /// \brief Protects the lazy rebuild of the graph of segments.
+    public: std::mutex graphMutex;
+
+    /// \brief Type of road file loaded into the graph.
+    public: std::string type = "";
+
+    /// \brief Options used to build the graph.
+    public: RoadNetworkOptions options;
+
+    /// \brief Unique Id of each vertex of the routing graph. The routing graph
+    /// mirrors the graph of segments using consecutive integer indexes.
+    /// Vertexes that aren't waypoints (zone hubs) have an invalid Id.
+    public: std::vector<rndf::UniqueId> ids;
+
+    /// \brief Index of each vertex, keyed by the string representation of its
+    /// unique Id.
+    public: std::unordered_map<std::string, unsigned int> indexes;
+
+    /// \brief Name of each vertex. Removed vertexes have an empty name.
+    public: std::vector<std::string> names;
+
+    /// \brief Indexes of the removed vertexes, reused by AddVertex().
+    public: std::vector<unsigned int> freeVertexes;
+
+    /// \brief Vertexes of each segment, keyed by segment Id.
+    public: std::unordered_map<int, std::vector<unsigned int>> segments;
+
+    /// \brief Vertexes of each zone (hub included), keyed by zone Id.
+    public: std::unordered_map<int, std::vector<unsigned int>> zones;
+
+    /// \brief Exits that can't be connected yet because one of their
+    /// waypoints isn't part of the graph.
+    public: std::vector<rndf::Exit> danglingExits;
+
+    /// \brief Latitude of each vertex (radians).
+    public: std::vector<double> latitudes;
+
+    /// \brief Longitude of each vertex (radians).
+    public: std::vector<double> longitudes;
+
+    /// \brief Outgoing edges of each vertex.
+    public: std::vector<std::vector<Link>> links;
+
+    /// \brief Incoming edges of each vertex: the tail of each edge whose
+    /// head is the vertex and the index of the edge in the links of the
+    /// tail. It's updated together with the links, so backward searches
+    /// don't need to scan all the edges.
+    public: std::vector<std::vector<InLink>> inbound;
+
+    /// \brief Edges added, removed or whose penalty has changed since the
+    /// network was built, for the incremental replanners and the route
+    /// caches.
+    public: EdgeChangeLog edgeChanges;
+
+    /// \brief Incremented each time that vertexes or edges are added or
+    /// removed. Searches based on older revisions must start from scratch.
+    public: unsigned int revision = 0;
+
+    /// \brief Revision of the graph used to compute the components.
+    public: std::atomic<unsigned int> componentsRevision{kNoVertex};
+
+    /// \brief Protects the lazy computation of the components.
+    public: std::mutex componentsMutex;
+
+    /// \brief Strongly connected component of each vertex (kNoVertex for
+    /// removed vertexes).
+    public: std::vector<unsigned int> components;
+
+    /// \brief Number of strongly connected components.
+    public: unsigned int numComponents = 0;
+
+    /// \brief Condensed DAG: the components reached by the edges leaving
+    /// each component.
+    public: std::vector<std::vector<unsigned int>> dag;
+
+    /// \brief Transitive closure of the condensed DAG: row i has the bit j
+    /// set if component j is reachable from component i.
+    public: std::vector<uint64_t> closure;
+
+    /// \brief Number of 64 bit words of each row of the closure.
+    public: size_t closureWords = 0;
+
+    /// \brief Whether each vertex is a stop waypoint.
+    public: std::vector<char> stops;
+
+    /// \brief Revision of the graph used to find the intersections.
+    public: std::atomic<unsigned int> intersectionsRevision{kNoVertex};
+
+    /// \brief Protects the lazy computation of the intersections.
+    public: std::mutex intersectionsMutex;
+
+    /// \brief Turn of each exit, keyed by tail and head.
+    public: std::unordered_map<uint64_t, Turn> turns;
+
+    /// \brief Number of intersections.
+    public: unsigned int numIntersections = 0;
+
+    /// \brief Revision of the graph used to compute the landmark costs.
+    public: std::atomic<unsigned int> landmarksRevision{kNoVertex};
+
+    /// \brief Protects the lazy computation of the landmark costs.
+    public: std::mutex landmarksMutex;
+
+    /// \brief Index of the vertex of each landmark.
+    public: std::vector<unsigned int> landmarks;
+
+    /// \brief Costs between the landmarks and every vertex, ignoring closures
+    /// and penalties, or infinity if there's no route. The entry
+    /// v * 2L + 2l has the cost from landmark l to vertex v and the next one
+    /// the cost from v to l, so the bounds of a vertex are contiguous.
+    public: std::vector<double> landmarkCosts;
+  };
+}
+#endif
@@ -16,9 +16,29 @@
 */
 
 #include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <map>
 #include <string>
+#include <utility>
+#include <vector>
+#include <ignition/math/Angle.hh>
+#include <ignition/math/Helpers.hh>
+#include <ignition/math/SphericalCoordinates.hh>
 
+#include "manifold/rndf/Checkpoint.hh"
+#include "manifold/rndf/Exit.hh"
+#include "manifold/rndf/Lane.hh"
+#include "manifold/rndf/Perimeter.hh"
 #include "manifold/rndf/RNDF.hh"
+#include "manifold/rndf/RNDFNode.hh"
+#include "manifold/rndf/Segment.hh"
+#include "manifold/rndf/UniqueId.hh"
+#include "manifold/rndf/Waypoint.hh"
+#include "manifold/rndf/Zone.hh"
 #include "manifold/RoadNetwork.hh"
 #include "manifold/test_config.h"
 #include "gtest/gtest.h"
@@ -130,6 +150,1344 @@ TEST(RoadNetwork, Constructor)
   EXPECT_EQ(neighbors.at(0)->Name(), "14.3.1");
 }
 
+//////////////////////////////////////////////////
+/// \brief Check the zone hub model.
+TEST(RoadNetwork, ZoneHub)
+{
+  std::string dirPath(std::string(PROJECT_SOURCE_PATH));
+
+  rndf::RNDF rndf(dirPath + "/test/rndf/sample1.rndf");
+  EXPECT_TRUE(rndf.Valid());
+
+  RoadNetworkOptions options;
+  options.SetZoneModel(ZoneModel::HUB);
+  RoadNetwork roadNetwork(rndf, options);
+  EXPECT_EQ(roadNetwork.Options(), options);
+
+  auto &graph = roadNetwork.Graph();
+
+  // The 164 waypoints plus the hub of the only zone.
+  EXPECT_EQ(graph.Vertexes().size(), 165u);
+
+  // The 132 edges among the 12 points of the zone are replaced by 24 edges
+  // to and from the hub.
+  EXPECT_EQ(graph.Edges().size(), 318u - 132u + 24u);
+
+  ASSERT_EQ(graph.Vertexes("14.0.0").size(), 1u);
+  auto hub = graph.Vertexes("14.0.0").front();
+  EXPECT_EQ(graph.Adjacents(hub).size(), 12u);
+
+  // A perimeter point is linked to the hub and to its exit.
+  ASSERT_EQ(graph.Vertexes("14.0.5").size(), 1u);
+  auto v = graph.Vertexes("14.0.5").front();
+  auto neighbors = graph.Adjacents(v);
+  ASSERT_EQ(neighbors.size(), 2u);
+  EXPECT_EQ(neighbors.at(0)->Name(), "14.0.0");
+  EXPECT_EQ(neighbors.at(1)->Name(), "11.1.1");
+
+  // The second waypoint of a parking spot is only linked with its first
+  // waypoint.
+  ASSERT_EQ(graph.Vertexes("14.3.2").size(), 1u);
+  v = graph.Vertexes("14.3.2").front();
+  neighbors = graph.Adjacents(v);
+  ASSERT_EQ(neighbors.size(), 1u);
+  EXPECT_EQ(neighbors.at(0)->Name(), "14.3.1");
+
+  // Routes don't include the hub.
+  std::vector<rndf::UniqueId> path;
+  double cost;
+  ASSERT_TRUE(roadNetwork.ShortestPath(rndf::UniqueId(14, 0, 5),
+    rndf::UniqueId(14, 3, 2), path, cost));
+  ASSERT_EQ(path.size(), 3u);
+  EXPECT_EQ(path.at(0), rndf::UniqueId(14, 0, 5));
+  EXPECT_EQ(path.at(1), rndf::UniqueId(14, 3, 1));
+  EXPECT_EQ(path.at(2), rndf::UniqueId(14, 3, 2));
+
+  // The reachability between waypoints is the same as with the clique model.
+  RoadNetwork cliqueNetwork(rndf);
+  EXPECT_EQ(cliqueNetwork.Options().ZoneModel(), ZoneModel::CLIQUE);
+
+  std::vector<rndf::UniqueId> ids;
+  for (auto const &vertex : cliqueNetwork.Graph().Vertexes())
+    ids.push_back(rndf::UniqueId(vertex->Name()));
+
+  std::vector<double> hubCosts;
+  std::vector<double> cliqueCosts;
+  ASSERT_TRUE(roadNetwork.CostMatrix(ids, ids, hubCosts));
+  ASSERT_TRUE(cliqueNetwork.CostMatrix(ids, ids, cliqueCosts));
+  ASSERT_EQ(hubCosts.size(), cliqueCosts.size());
+  for (size_t i = 0; i < hubCosts.size(); ++i)
+  {
+    EXPECT_EQ(std::isinf(hubCosts[i]), std::isinf(cliqueCosts[i]));
+    // Crossing the zone through the hub is never shorter.
+    if (!std::isinf(cliqueCosts[i]))
+    {
+      EXPECT_GE(hubCosts[i] + 1e-6, cliqueCosts[i]);
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Check point to point routing.
+TEST(RoadNetwork, ShortestPath)
+{
+  std::string dirPath(std::string(PROJECT_SOURCE_PATH));
+
+  rndf::RNDF rndf(dirPath + "/test/rndf/sample1.rndf");
+  EXPECT_TRUE(rndf.Valid());
+
+  RoadNetwork roadNetwork(rndf);
+
+  std::vector<rndf::UniqueId> path;
+  double cost;
+
+  // Unknown waypoints.
+  EXPECT_FALSE(roadNetwork.ShortestPath(rndf::UniqueId(99, 1, 1),
+    rndf::UniqueId(1, 1, 1), path, cost));
+  EXPECT_FALSE(roadNetwork.ShortestPath(rndf::UniqueId(1, 1, 1),
+    rndf::UniqueId(99, 1, 1), path, cost));
+
+  // Lane 1.1 doesn't have exits.
+  EXPECT_FALSE(roadNetwork.ShortestPath(rndf::UniqueId(1, 1, 4),
+    rndf::UniqueId(1, 1, 1), path, cost));
+
+  // A route to itself.
+  ASSERT_TRUE(roadNetwork.ShortestPath(rndf::UniqueId(1, 1, 1),
+    rndf::UniqueId(1, 1, 1), path, cost));
+  ASSERT_EQ(path.size(), 1u);
+  EXPECT_EQ(path.front(), rndf::UniqueId(1, 1, 1));
+  EXPECT_DOUBLE_EQ(cost, 0.0);
+
+  // The cost of a route along a lane is the length of the lane.
+  ASSERT_TRUE(roadNetwork.ShortestPath(rndf::UniqueId(1, 1, 1),
+    rndf::UniqueId(1, 1, 4), path, cost));
+  ASSERT_EQ(path.size(), 4u);
+  double expectedCost = 0;
+  for (auto i = 1; i < 4; ++i)
+  {
+    EXPECT_EQ(path.at(i - 1), rndf::UniqueId(1, 1, i));
+    auto wp1 = rndf.Info(rndf::UniqueId(1, 1, i))->Waypoint();
+    auto wp2 = rndf.Info(rndf::UniqueId(1, 1, i + 1))->Waypoint();
+    expectedCost += ignition::math::SphericalCoordinates::Distance(
+      wp1->Location().LatitudeReference(),
+      wp1->Location().LongitudeReference(),
+      wp2->Location().LatitudeReference(),
+      wp2->Location().LongitudeReference());
+  }
+  EXPECT_NEAR(cost, expectedCost, 1e-6);
+  EXPECT_GT(cost, 0.0);
+
+  // A route using an exit.
+  ASSERT_TRUE(roadNetwork.ShortestPath(rndf::UniqueId(1, 2, 1),
+    rndf::UniqueId(3, 1, 1), path, cost));
+  ASSERT_EQ(path.size(), 5u);
+  EXPECT_EQ(path.at(3), rndf::UniqueId(1, 2, 4));
+  EXPECT_EQ(path.at(4), rndf::UniqueId(3, 1, 1));
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the waypoints reachable within a cost budget.
+TEST(RoadNetwork, WithinCost)
+{
+  std::string dirPath(std::string(PROJECT_SOURCE_PATH));
+
+  rndf::RNDF rndf(dirPath + "/test/rndf/sample1.rndf");
+  EXPECT_TRUE(rndf.Valid());
+
+  RoadNetwork roadNetwork(rndf);
+
+  std::vector<std::pair<rndf::UniqueId, double>> reached;
+  EXPECT_FALSE(roadNetwork.WithinCost(rndf::UniqueId(99, 1, 1), 100.0,
+    reached));
+  EXPECT_FALSE(roadNetwork.WithinCost(rndf::UniqueId(12, 1, 1), -1.0,
+    reached));
+
+  // Only the origin is reached with a budget of 0.
+  ASSERT_TRUE(roadNetwork.WithinCost(rndf::UniqueId(12, 1, 1), 0.0,
+    reached));
+  ASSERT_EQ(reached.size(), 1u);
+  EXPECT_EQ(reached[0].first, rndf::UniqueId(12, 1, 1));
+  EXPECT_DOUBLE_EQ(reached[0].second, 0.0);
+
+  // The waypoints reached are the ones whose shortest route is within the
+  // budget, parking spots included.
+  for (double budget : {50.0, 150.0, 400.0})
+  {
+    rndf::UniqueId src(12, 1, 1);
+    ASSERT_TRUE(roadNetwork.WithinCost(src, budget, reached));
+    for (size_t i = 1; i < reached.size(); ++i)
+      EXPECT_LE(reached[i - 1].second, reached[i].second);
+
+    std::map<std::string, double> costs;
+    for (auto const &entry : reached)
+      costs[entry.first.String()] = entry.second;
+    EXPECT_EQ(costs.size(), reached.size());
+
+    size_t expected = 0;
+    for (auto const &vertex : roadNetwork.Graph().Vertexes())
+    {
+      std::vector<rndf::UniqueId> path;
+      double cost;
+      // Skip the zone hub.
+      rndf::UniqueId dst(vertex->Name());
+      if (!dst.Valid())
+        continue;
+
+      if (!roadNetwork.ShortestPath(src, dst, path, cost) || cost > budget)
+      {
+        EXPECT_EQ(costs.count(dst.String()), 0u);
+        continue;
+      }
+
+      ++expected;
+      ASSERT_EQ(costs.count(dst.String()), 1u);
+      EXPECT_NEAR(costs[dst.String()], cost, 1e-6);
+    }
+    EXPECT_EQ(reached.size(), expected);
+
+    if (budget > 300.0)
+    {
+      EXPECT_EQ(costs.count(rndf::UniqueId(14, 1, 1).String()), 1u);
+    }
+  }
+
+  // Closed edges aren't used.
+  ASSERT_TRUE(roadNetwork.CloseEdge(rndf::UniqueId(12, 1, 1),
+    rndf::UniqueId(12, 1, 2)));
+  ASSERT_TRUE(roadNetwork.WithinCost(rndf::UniqueId(12, 1, 1), 400.0,
+    reached));
+  EXPECT_EQ(reached.size(), 1u);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the many-to-many cost matrix.
+TEST(RoadNetwork, CostMatrix)
+{
+  std::string dirPath(std::string(PROJECT_SOURCE_PATH));
+
+  rndf::RNDF rndf(dirPath + "/test/rndf/sample1.rndf");
+  EXPECT_TRUE(rndf.Valid());
+
+  RoadNetwork roadNetwork(rndf);
+
+  // Use all the checkpoints of the lanes.
+  std::vector<rndf::UniqueId> checkpoints;
+  for (auto const &segment : rndf.Segments())
+    for (auto const &lane : segment.Lanes())
+      for (auto const &cp : lane.Checkpoints())
+      {
+        checkpoints.push_back(
+          rndf::UniqueId(segment.Id(), lane.Id(), cp.WaypointId()));
+      }
+  // Add a waypoint that can't reach anything.
+  checkpoints.push_back(rndf::UniqueId(1, 1, 4));
+  ASSERT_GT(checkpoints.size(), 2u);
+
+  std::vector<double> costs;
+  EXPECT_FALSE(roadNetwork.CostMatrix(checkpoints,
+    {rndf::UniqueId(99, 1, 1)}, costs));
+
+  ASSERT_TRUE(roadNetwork.CostMatrix(checkpoints, checkpoints, costs, 1));
+  auto n = checkpoints.size();
+  ASSERT_EQ(costs.size(), n * n);
+
+  // The results are independent of the number of threads.
+  std::vector<double> costs4;
+  ASSERT_TRUE(roadNetwork.CostMatrix(checkpoints, checkpoints, costs4, 4));
+  ASSERT_EQ(costs4.size(), costs.size());
+  for (size_t i = 0; i < costs.size(); ++i)
+    EXPECT_DOUBLE_EQ(costs[i], costs4[i]);
+
+  for (size_t i = 0; i < n; ++i)
+  {
+    EXPECT_DOUBLE_EQ(costs[i * n + i], 0.0);
+    for (size_t j = 0; j < n; ++j)
+    {
+      // Each element matches a point to point query.
+      std::vector<rndf::UniqueId> path;
+      double cost;
+      if (roadNetwork.ShortestPath(checkpoints[i], checkpoints[j], path, cost))
+      {
+        EXPECT_NEAR(costs[i * n + j], cost, 1e-6);
+      }
+      else
+        EXPECT_TRUE(std::isinf(costs[i * n + j]));
+    }
+  }
+
+  // The last waypoint doesn't reach any other checkpoint.
+  for (size_t j = 0; j + 1 < n; ++j)
+    EXPECT_TRUE(std::isinf(costs[(n - 1) * n + j]));
+
+  // Empty requests.
+  EXPECT_TRUE(roadNetwork.CostMatrix({}, checkpoints, costs));
+  EXPECT_TRUE(costs.empty());
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the batched route queries.
+TEST(RoadNetwork, ShortestPaths)
+{
+  std::string dirPath(std::string(PROJECT_SOURCE_PATH));
+
+  rndf::RNDF rndf(dirPath + "/test/rndf/sample1.rndf");
+  EXPECT_TRUE(rndf.Valid());
+
+  RoadNetwork roadNetwork(rndf);
+
+  // All the pairs of waypoints of a few lanes and the zone.
+  std::vector<rndf::UniqueId> ids;
+  for (auto const &vertex : roadNetwork.Graph().Vertexes())
+  {
+    auto const &name = vertex->Name();
+    if (name.find("1.") == 0 || name.find("3.") == 0 ||
+        (name.find("14.") == 0 && name != "14.0.0"))
+    {
+      ids.push_back(rndf::UniqueId(name));
+    }
+  }
+
+  std::vector<std::pair<rndf::UniqueId, rndf::UniqueId>> queries;
+  for (auto const &src : ids)
+    for (auto const &dst : ids)
+      queries.push_back(std::make_pair(src, dst));
+
+  std::vector<double> costs;
+  std::vector<std::vector<rndf::UniqueId>> paths;
+  ASSERT_TRUE(roadNetwork.ShortestPaths(queries, costs, paths, 1));
+  ASSERT_EQ(costs.size(), queries.size());
+  ASSERT_EQ(paths.size(), queries.size());
+
+  // The results are independent of the number of threads.
+  std::vector<double> costs4;
+  std::vector<std::vector<rndf::UniqueId>> paths4;
+  ASSERT_TRUE(roadNetwork.ShortestPaths(queries, costs4, paths4, 4));
+  std::vector<double> costsOnly;
+  ASSERT_TRUE(roadNetwork.ShortestPaths(queries, costsOnly, 3));
+
+  for (size_t i = 0; i < queries.size(); ++i)
+  {
+    EXPECT_DOUBLE_EQ(costs[i], costs4[i]);
+    EXPECT_DOUBLE_EQ(costs[i], costsOnly[i]);
+    EXPECT_EQ(paths[i], paths4[i]);
+
+    // Each result matches a point to point query.
+    std::vector<rndf::UniqueId> path;
+    double cost;
+    if (roadNetwork.ShortestPath(queries[i].first, queries[i].second, path,
+          cost))
+    {
+      EXPECT_NEAR(costs[i], cost, 1e-6);
+      EXPECT_EQ(paths[i], path);
+    }
+    else
+    {
+      EXPECT_TRUE(std::isinf(costs[i]));
+      EXPECT_TRUE(paths[i].empty());
+    }
+  }
+
+  // Closed edges are skipped.
+  rndf::UniqueId src(1, 2, 1);
+  rndf::UniqueId dst(3, 1, 1);
+  ASSERT_TRUE(roadNetwork.CloseEdge(rndf::UniqueId(1, 2, 4), dst));
+  ASSERT_TRUE(roadNetwork.ShortestPaths({std::make_pair(src, dst)}, costs));
+  ASSERT_EQ(costs.size(), 1u);
+  EXPECT_TRUE(std::isinf(costs[0]));
+
+  // Unknown waypoints and empty requests.
+  EXPECT_FALSE(roadNetwork.ShortestPaths(
+    {std::make_pair(src, rndf::UniqueId(99, 1, 1))}, costs));
+  EXPECT_TRUE(roadNetwork.ShortestPaths({}, costs, paths));
+  EXPECT_TRUE(costs.empty());
+  EXPECT_TRUE(paths.empty());
+}
+
+//////////////////////////////////////////////////
+/// \brief Build an RNDF with a small grid of one-way blocks. Each block
+/// between two adjacent intersections has one segment per direction, with
+/// exits to every block leaving the next intersection but the U-turn.
+/// \param[in] _size Number of rows and columns of intersections.
+/// \param[out] _rndf The RNDF.
+void smallGridRNDF(const int _size, rndf::RNDF &_rndf)
+{
+  auto location = [](const double _row, const double _col)
+  {
+    return ignition::math::SphericalCoordinates(
+      ignition::math::SphericalCoordinates::EARTH_WGS84,
+      ignition::math::Angle(IGN_DTOR(37.0 + _row * 1e-3)),
+      ignition::math::Angle(IGN_DTOR(-122.0 + _col * 1e-3)),
+      0.0, ignition::math::Angle::Zero);
+  };
+
+  typedef std::pair<int, int> Node;
+  std::map<std::pair<Node, Node>, int> blocks;
+  const int kDr[] = {0, 0, 1, -1};
+  const int kDc[] = {1, -1, 0, 0};
+  for (int r = 0; r < _size; ++r)
+  {
+    for (int c = 0; c < _size; ++c)
+    {
+      for (int k = 0; k < 4; ++k)
+      {
+        Node to(r + kDr[k], c + kDc[k]);
+        if (to.first >= 0 && to.first < _size && to.second >= 0 &&
+            to.second < _size)
+        {
+          auto id = static_cast<int>(blocks.size()) + 1;
+          blocks[std::make_pair(Node(r, c), to)] = id;
+        }
+      }
+    }
+  }
+
+  for (auto const &block : blocks)
+  {
+    auto const &from = block.first.first;
+    auto const &to = block.first.second;
+    rndf::Lane lane(1);
+    for (int w = 0; w < 2; ++w)
+    {
+      double t = 0.1 + 0.8 * w;
+      lane.AddWaypoint(rndf::Waypoint(w + 1,
+        location(from.first + t * (to.first - from.first),
+                 from.second + t * (to.second - from.second))));
+    }
+    for (int k = 0; k < 4; ++k)
+    {
+      Node next(to.first + kDr[k], to.second + kDc[k]);
+      auto it = blocks.find(std::make_pair(to, next));
+      if (it != blocks.end() && next != from)
+      {
+        lane.AddExit(rndf::Exit(rndf::UniqueId(block.second, 1, 2),
+                                rndf::UniqueId(it->second, 1, 1)));
+      }
+    }
+    rndf::Segment segment(block.second);
+    segment.AddLane(lane);
+    _rndf.AddSegment(segment);
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Get the cost of every loopless route between two waypoints with
+/// a depth-first search, sorted.
+/// \param[in] _network The road network.
+/// \param[in] _src Name of the origin waypoint.
+/// \param[in] _dst Name of the destination waypoint.
+/// \return The costs.
+std::vector<double> allRouteCosts(const RoadNetwork &_network,
+  const std::string &_src, const std::string &_dst)
+{
+  std::map<std::string, std::vector<std::string>> heads;
+  for (auto const &edge : _network.Graph().Edges())
+    heads[edge->Tail()->Name()].push_back(edge->Head()->Name());
+
+  std::vector<double> costs;
+  std::map<std::string, bool> visited;
+  std::function<void(const std::string &, double)> visit =
+    [&](const std::string &_v, const double _cost)
+    {
+      if (_v == _dst)
+      {
+        costs.push_back(_cost);
+        return;
+      }
+      visited[_v] = true;
+      for (auto const &w : heads[_v])
+      {
+        double cost;
+        if (!visited[w] && _network.EdgeCost(rndf::UniqueId(_v),
+              rndf::UniqueId(w), cost) && !std::isinf(cost))
+        {
+          visit(w, _cost + cost);
+        }
+      }
+      visited[_v] = false;
+    };
+  visit(_src, 0.0);
+  std::sort(costs.begin(), costs.end());
+  return costs;
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the alternative routes.
+TEST(RoadNetwork, AlternativePaths)
+{
+  rndf::RNDF rndf;
+  smallGridRNDF(3, rndf);
+  RoadNetwork roadNetwork(rndf);
+
+  std::vector<std::vector<rndf::UniqueId>> paths;
+  std::vector<double> costs;
+
+  // Unknown waypoints and no routes requested.
+  rndf::UniqueId src(1, 1, 1);
+  rndf::UniqueId dst(rndf.NumSegments(), 1, 2);
+  EXPECT_FALSE(roadNetwork.AlternativePaths(rndf::UniqueId(99, 1, 1), dst,
+    3, paths, costs));
+  EXPECT_FALSE(roadNetwork.AlternativePaths(src, dst, 0, paths, costs));
+  EXPECT_TRUE(paths.empty());
+
+  // The first route is the shortest one.
+  std::vector<rndf::UniqueId> shortest;
+  double shortestCost;
+  ASSERT_TRUE(roadNetwork.ShortestPath(src, dst, shortest, shortestCost));
+  ASSERT_TRUE(roadNetwork.AlternativePaths(src, dst, 1, paths, costs));
+  ASSERT_EQ(paths.size(), 1u);
+  EXPECT_EQ(paths[0], shortest);
+  EXPECT_DOUBLE_EQ(costs[0], shortestCost);
+
+  // The k shortest loopless routes match an exhaustive search.
+  const unsigned int kRoutes = 25;
+  auto expected = allRouteCosts(roadNetwork, src.String(), dst.String());
+  ASSERT_GT(expected.size(), kRoutes);
+  ASSERT_TRUE(roadNetwork.AlternativePaths(src, dst, kRoutes, paths, costs));
+  ASSERT_EQ(paths.size(), kRoutes);
+  ASSERT_EQ(costs.size(), kRoutes);
+  for (size_t i = 0; i < kRoutes; ++i)
+  {
+    EXPECT_NEAR(costs[i], expected[i], 1e-6);
+    EXPECT_EQ(paths[i].front(), src);
+    EXPECT_EQ(paths[i].back(), dst);
+
+    double cost = 0.0;
+    for (size_t j = 1; j < paths[i].size(); ++j)
+    {
+      double edgeCost;
+      EXPECT_TRUE(roadNetwork.EdgeCost(paths[i][j - 1], paths[i][j],
+        edgeCost));
+      cost += edgeCost;
+    }
+    EXPECT_NEAR(cost, costs[i], 1e-6);
+
+    auto sorted = paths[i];
+    std::sort(sorted.begin(), sorted.end(),
+      [](const rndf::UniqueId &_a, const rndf::UniqueId &_b)
+      {
+        return _a.String() < _b.String();
+      });
+    EXPECT_TRUE(std::adjacent_find(sorted.begin(), sorted.end()) ==
+      sorted.end());
+    for (size_t j = 0; j < i; ++j)
+      EXPECT_NE(paths[i], paths[j]);
+  }
+
+  // Asking for more routes than there are returns all of them.
+  std::vector<std::vector<rndf::UniqueId>> all;
+  ASSERT_TRUE(roadNetwork.AlternativePaths(src, dst,
+    static_cast<unsigned int>(expected.size() + 10), all, costs));
+  EXPECT_EQ(all.size(), expected.size());
+
+  // Routes that share too much with a cheaper one are skipped.
+  const double kMaxOverlap = 0.5;
+  ASSERT_TRUE(roadNetwork.AlternativePaths(src, dst, 4, paths, costs,
+    kMaxOverlap));
+  ASSERT_FALSE(paths.empty());
+  EXPECT_EQ(paths[0], shortest);
+  for (size_t i = 0; i < paths.size(); ++i)
+  {
+    for (size_t j = 0; j < i; ++j)
+    {
+      double shared = 0.0;
+      for (size_t a = 1; a < paths[i].size(); ++a)
+      {
+        for (size_t b = 1; b < paths[j].size(); ++b)
+        {
+          if (paths[i][a - 1] == paths[j][b - 1] &&
+              paths[i][a] == paths[j][b])
+          {
+            double edgeCost;
+            roadNetwork.EdgeCost(paths[i][a - 1], paths[i][a], edgeCost);
+            shared += edgeCost;
+          }
+        }
+      }
+      EXPECT_LE(shared, kMaxOverlap * costs[i] + 1e-6);
+    }
+  }
+
+  // Closed edges are avoided.
+  ASSERT_TRUE(roadNetwork.CloseEdge(shortest[0], shortest[1]));
+  ASSERT_FALSE(roadNetwork.AlternativePaths(src, dst, 3, paths, costs));
+  ASSERT_TRUE(roadNetwork.OpenEdge(shortest[0], shortest[1]));
+  ASSERT_TRUE(roadNetwork.CloseEdge(shortest[1], shortest[2]));
+  ASSERT_TRUE(roadNetwork.AlternativePaths(src, dst, 3, paths, costs));
+  for (auto const &path : paths)
+    EXPECT_NE(path[2], shortest[2]);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that two networks give routes with the same cost between
+/// many pairs of waypoints.
+/// \param[in] _expected Network searched with Dijkstra's algorithm.
+/// \param[in] _actual Network searched with landmarks.
+void expectSameCosts(RoadNetwork &_expected, RoadNetwork &_actual)
+{
+  std::vector<rndf::UniqueId> ids;
+  for (auto const &vertex : _expected.Graph().Vertexes())
+  {
+    rndf::UniqueId id(vertex->Name());
+    if (id.Valid())
+      ids.push_back(id);
+  }
+  std::sort(ids.begin(), ids.end(),
+    [](const rndf::UniqueId &_a, const rndf::UniqueId &_b)
+    {
+      return _a.String() < _b.String();
+    });
+
+  size_t found = 0;
+  for (size_t i = 0; i < ids.size(); i += 7)
+  {
+    for (size_t j = 0; j < ids.size(); j += 3)
+    {
+      std::vector<rndf::UniqueId> path1;
+      std::vector<rndf::UniqueId> path2;
+      double cost1;
+      double cost2;
+      bool found1 = _expected.ShortestPath(ids[i], ids[j], path1, cost1);
+      bool found2 = _actual.ShortestPath(ids[i], ids[j], path2, cost2);
+      ASSERT_EQ(found1, found2);
+      if (found1)
+      {
+        EXPECT_NEAR(cost1, cost2, 1e-6);
+        EXPECT_EQ(path1.front(), path2.front());
+        EXPECT_EQ(path1.back(), path2.back());
+        ++found;
+      }
+    }
+  }
+  EXPECT_GT(found, 0u);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the routes guided by landmarks.
+TEST(RoadNetwork, Landmarks)
+{
+  std::string dirPath(std::string(PROJECT_SOURCE_PATH));
+
+  rndf::RNDF rndf(dirPath + "/test/rndf/sample1.rndf");
+  EXPECT_TRUE(rndf.Valid());
+
+  RoadNetworkOptions options;
+  ASSERT_TRUE(options.SetLandmarks(8));
+  RoadNetwork plain(rndf);
+  RoadNetwork guided(rndf, options);
+  EXPECT_TRUE(guided.Consistent(rndf));
+  expectSameCosts(plain, guided);
+
+  // The bounds ignore the overlay, so they hold with closures and
+  // penalties.
+  for (auto network : {&plain, &guided})
+  {
+    EXPECT_TRUE(network->CloseEdge(rndf::UniqueId(1, 2, 4),
+      rndf::UniqueId(3, 1, 1)));
+    EXPECT_TRUE(network->SetEdgePenalty(rndf::UniqueId(3, 1, 3),
+      rndf::UniqueId(3, 1, 4), 500.0));
+  }
+  expectSameCosts(plain, guided);
+
+  // The landmarks follow the changes in the network.
+  for (auto network : {&plain, &guided})
+  {
+    network->ClearOverlay();
+    EXPECT_TRUE(network->RemoveSegment(13));
+  }
+  expectSameCosts(plain, guided);
+  rndf::Segment segment(13);
+  ASSERT_TRUE(rndf.Segment(13, segment));
+  for (auto network : {&plain, &guided})
+    EXPECT_TRUE(network->AddSegment(segment));
+  expectSameCosts(plain, guided);
+
+  // The landmarks are saved with the network.
+  std::string path = testing::getRandomNumber() + ".network";
+  EXPECT_TRUE(guided.Save(path, rndf));
+  EXPECT_FALSE(RoadNetwork::UpToDate(path, rndf));
+  EXPECT_TRUE(RoadNetwork::UpToDate(path, rndf, options));
+  RoadNetwork loaded(rndf, path, options);
+  expectSameCosts(plain, loaded);
+  std::remove(path.c_str());
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the intersections and the turn costs of the exits.
+TEST(RoadNetwork, Turns)
+{
+  std::string dirPath(std::string(PROJECT_SOURCE_PATH));
+
+  rndf::RNDF rndf(dirPath + "/test/rndf/sample1.rndf");
+  EXPECT_TRUE(rndf.Valid());
+
+  RoadNetworkOptions options;
+  options.SetTurnCosts(true);
+  RoadNetwork plain(rndf);
+  RoadNetwork turns(rndf, options);
+  EXPECT_TRUE(turns.Consistent(rndf));
+
+  // The turns are available with or without turn costs.
+  EXPECT_GT(plain.NumIntersections(), 0u);
+  EXPECT_EQ(plain.NumIntersections(), turns.NumIntersections());
+
+  double angle;
+  bool stop;
+  unsigned int intersection;
+  EXPECT_FALSE(turns.Turn(rndf::UniqueId(1, 1, 1), rndf::UniqueId(1, 1, 2),
+    angle, stop, intersection));
+
+  // Exits leaving from the same stop belong to the same intersection.
+  ASSERT_TRUE(turns.Turn(rndf::UniqueId(3, 1, 3), rndf::UniqueId(13, 1, 10),
+    angle, stop, intersection));
+  EXPECT_TRUE(stop);
+  double angle2;
+  bool stop2;
+  unsigned int intersection2;
+  ASSERT_TRUE(turns.Turn(rndf::UniqueId(3, 1, 3), rndf::UniqueId(13, 2, 1),
+    angle2, stop2, intersection2));
+  EXPECT_TRUE(stop2);
+  EXPECT_EQ(intersection, intersection2);
+  EXPECT_LT(intersection, turns.NumIntersections());
+  EXPECT_LE(std::abs(angle), IGN_PI);
+
+  // The lanes of segment 13 run in opposite directions, so one exit turns
+  // left and the other one turns right.
+  EXPECT_LT(angle * angle2, 0.0);
+
+  // The penalties are part of the cost of the exits.
+  for (auto const &exit : {std::make_pair(rndf::UniqueId(3, 1, 3),
+                                          rndf::UniqueId(13, 1, 10)),
+                           std::make_pair(rndf::UniqueId(1, 2, 4),
+                                          rndf::UniqueId(3, 1, 1))})
+  {
+    double base;
+    double cost;
+    ASSERT_TRUE(plain.EdgeCost(exit.first, exit.second, base));
+    ASSERT_TRUE(turns.EdgeCost(exit.first, exit.second, cost));
+    ASSERT_TRUE(turns.Turn(exit.first, exit.second, angle, stop,
+      intersection));
+    double expected = base + (stop ? options.StopPenalty() : 0.0) +
+      options.TurnPenalty() * std::abs(angle) / (IGN_PI / 2.0);
+    EXPECT_NEAR(cost, expected, 1e-6);
+  }
+
+  // Edges that aren't exits don't change.
+  double base;
+  double cost;
+  ASSERT_TRUE(plain.EdgeCost(rndf::UniqueId(3, 1, 3),
+    rndf::UniqueId(3, 1, 4), base));
+  ASSERT_TRUE(turns.EdgeCost(rndf::UniqueId(3, 1, 3),
+    rndf::UniqueId(3, 1, 4), cost));
+  EXPECT_DOUBLE_EQ(base, cost);
+
+  // The incremental updates compute the same turns.
+  auto numIntersections = turns.NumIntersections();
+  rndf::Segment segment(13);
+  ASSERT_TRUE(rndf.Segment(13, segment));
+  EXPECT_TRUE(turns.RemoveSegment(13));
+  EXPECT_LT(turns.NumIntersections(), numIntersections);
+  EXPECT_FALSE(turns.Turn(rndf::UniqueId(3, 1, 3),
+    rndf::UniqueId(13, 1, 10), angle, stop, intersection));
+  EXPECT_TRUE(turns.AddSegment(segment));
+  EXPECT_TRUE(turns.Consistent(rndf));
+  EXPECT_EQ(turns.NumIntersections(), numIntersections);
+  ASSERT_TRUE(turns.Turn(rndf::UniqueId(3, 1, 3),
+    rndf::UniqueId(13, 2, 1), angle, stop, intersection));
+  EXPECT_DOUBLE_EQ(angle, angle2);
+
+  // The stops and the exits are saved with the network.
+  std::string path = testing::getRandomNumber() + ".network";
+  EXPECT_TRUE(turns.Save(path, rndf));
+  RoadNetwork loaded(rndf, path, options);
+  EXPECT_TRUE(loaded.Consistent(rndf));
+  EXPECT_EQ(loaded.NumIntersections(), numIntersections);
+  ASSERT_TRUE(loaded.Turn(rndf::UniqueId(3, 1, 3),
+    rndf::UniqueId(13, 2, 1), angle, stop, intersection));
+  EXPECT_DOUBLE_EQ(angle, angle2);
+  EXPECT_TRUE(stop);
+  std::remove(path.c_str());
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the incremental updates of the network.
+TEST(RoadNetwork, IncrementalUpdates)
+{
+  std::string dirPath(std::string(PROJECT_SOURCE_PATH));
+
+  rndf::RNDF rndf(dirPath + "/test/rndf/sample1.rndf");
+  EXPECT_TRUE(rndf.Valid());
+
+  RoadNetwork roadNetwork(rndf);
+  EXPECT_TRUE(roadNetwork.Consistent(rndf));
+  auto numVertexes = roadNetwork.Graph().Vertexes().size();
+  auto numEdges = roadNetwork.Graph().Edges().size();
+
+  std::vector<rndf::UniqueId> path;
+  double cost;
+  rndf::UniqueId src(1, 2, 1);
+  rndf::UniqueId dst(3, 1, 1);
+  ASSERT_TRUE(roadNetwork.ShortestPath(src, dst, path, cost));
+  double originalCost = cost;
+
+  // Remove a segment.
+  rndf::Segment segment(3);
+  ASSERT_TRUE(rndf.Segment(3, segment));
+  EXPECT_FALSE(roadNetwork.RemoveSegment(99));
+  EXPECT_TRUE(roadNetwork.RemoveSegment(3));
+  EXPECT_FALSE(roadNetwork.RemoveSegment(3));
+  EXPECT_FALSE(roadNetwork.ShortestPath(src, dst, path, cost));
+  EXPECT_LT(roadNetwork.Graph().Vertexes().size(), numVertexes);
+
+  // The network no longer matches the RNDF until the RNDF is edited too.
+  EXPECT_FALSE(roadNetwork.Consistent(rndf));
+  ASSERT_TRUE(rndf.RemoveSegment(3));
+  EXPECT_TRUE(roadNetwork.Consistent(rndf));
+
+  // Add it back: the exits into the segment are restored.
+  EXPECT_TRUE(roadNetwork.AddSegment(segment));
+  EXPECT_FALSE(roadNetwork.AddSegment(segment));
+  ASSERT_TRUE(rndf.AddSegment(segment));
+  EXPECT_TRUE(roadNetwork.Consistent(rndf));
+  ASSERT_TRUE(roadNetwork.ShortestPath(src, dst, path, cost));
+  EXPECT_NEAR(cost, originalCost, 1e-6);
+  EXPECT_EQ(roadNetwork.Graph().Vertexes().size(), numVertexes);
+  EXPECT_EQ(roadNetwork.Graph().Edges().size(), numEdges);
+
+  // Update a segment.
+  EXPECT_TRUE(roadNetwork.UpdateSegment(segment));
+  EXPECT_TRUE(roadNetwork.Consistent(rndf));
+
+  // Remove and add a zone.
+  rndf::Zone zone(14);
+  ASSERT_TRUE(rndf.Zone(14, zone));
+  EXPECT_FALSE(roadNetwork.RemoveZone(3));
+  EXPECT_TRUE(roadNetwork.RemoveZone(14));
+  ASSERT_TRUE(rndf.RemoveZone(14));
+  EXPECT_TRUE(roadNetwork.Consistent(rndf));
+  EXPECT_TRUE(roadNetwork.AddZone(zone));
+  ASSERT_TRUE(rndf.AddZone(zone));
+  EXPECT_TRUE(roadNetwork.Consistent(rndf));
+  EXPECT_TRUE(roadNetwork.UpdateZone(zone));
+  EXPECT_TRUE(roadNetwork.Consistent(rndf));
+  EXPECT_EQ(roadNetwork.Graph().Vertexes().size(), numVertexes);
+  EXPECT_EQ(roadNetwork.Graph().Edges().size(), numEdges);
+
+  // Add and remove an exit. Lane 1.1 doesn't have exits.
+  rndf::Exit exit(rndf::UniqueId(1, 1, 4), rndf::UniqueId(1, 2, 1));
+  EXPECT_FALSE(roadNetwork.ShortestPath(rndf::UniqueId(1, 1, 4),
+    rndf::UniqueId(1, 2, 1), path, cost));
+  EXPECT_FALSE(roadNetwork.AddExit(rndf::Exit()));
+  EXPECT_TRUE(roadNetwork.AddExit(exit));
+  EXPECT_TRUE(roadNetwork.ShortestPath(rndf::UniqueId(1, 1, 4),
+    rndf::UniqueId(1, 2, 1), path, cost));
+  EXPECT_FALSE(roadNetwork.Consistent(rndf));
+  ASSERT_TRUE(rndf.Segments().front().Lanes().front().AddExit(exit));
+  EXPECT_TRUE(roadNetwork.Consistent(rndf));
+
+  EXPECT_TRUE(roadNetwork.RemoveExit(exit));
+  EXPECT_FALSE(roadNetwork.RemoveExit(exit));
+  ASSERT_TRUE(rndf.Segments().front().Lanes().front().RemoveExit(exit));
+  EXPECT_TRUE(roadNetwork.Consistent(rndf));
+
+  // An exit to a segment that doesn't exist yet is connected once the
+  // segment is added.
+  ASSERT_TRUE(roadNetwork.RemoveSegment(3));
+  rndf::Exit pending(rndf::UniqueId(1, 1, 4), rndf::UniqueId(3, 1, 1));
+  EXPECT_TRUE(roadNetwork.AddExit(pending));
+  EXPECT_TRUE(roadNetwork.AddSegment(segment));
+  EXPECT_TRUE(roadNetwork.ShortestPath(rndf::UniqueId(1, 1, 4),
+    rndf::UniqueId(3, 1, 1), path, cost));
+  EXPECT_EQ(path.size(), 2u);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the closures and penalties.
+TEST(RoadNetwork, Overlay)
+{
+  std::string dirPath(std::string(PROJECT_SOURCE_PATH));
+
+  rndf::RNDF rndf(dirPath + "/test/rndf/sample1.rndf");
+  EXPECT_TRUE(rndf.Valid());
+
+  RoadNetwork roadNetwork(rndf);
+  rndf::UniqueId tail(1, 2, 4);
+  rndf::UniqueId head(3, 1, 1);
+
+  double baseCost;
+  EXPECT_FALSE(roadNetwork.EdgeCost(head, tail, baseCost));
+  ASSERT_TRUE(roadNetwork.EdgeCost(tail, head, baseCost));
+  EXPECT_GT(baseCost, 0.0);
+
+  std::vector<rndf::UniqueId> path;
+  double cost;
+  ASSERT_TRUE(roadNetwork.ShortestPath(rndf::UniqueId(1, 2, 1), head, path,
+    cost));
+  double routeCost = cost;
+
+  // Penalties.
+  EXPECT_FALSE(roadNetwork.SetEdgePenalty(tail, head, -1));
+  EXPECT_FALSE(roadNetwork.SetEdgePenalty(head, tail, 1));
+  EXPECT_TRUE(roadNetwork.SetEdgePenalty(tail, head, 100));
+  ASSERT_TRUE(roadNetwork.EdgeCost(tail, head, cost));
+  EXPECT_NEAR(cost, baseCost + 100, 1e-6);
+  ASSERT_TRUE(roadNetwork.ShortestPath(rndf::UniqueId(1, 2, 1), head, path,
+    cost));
+  EXPECT_NEAR(cost, routeCost + 100, 1e-6);
+
+  // Closures.
+  EXPECT_TRUE(roadNetwork.CloseEdge(tail, head));
+  ASSERT_TRUE(roadNetwork.EdgeCost(tail, head, cost));
+  EXPECT_TRUE(std::isinf(cost));
+  EXPECT_FALSE(roadNetwork.ShortestPath(rndf::UniqueId(1, 2, 1), head, path,
+    cost));
+
+  // The overlay doesn't modify the base graph.
+  EXPECT_TRUE(roadNetwork.Consistent(rndf));
+  EXPECT_EQ(roadNetwork.Graph().Adjacents(
+    roadNetwork.Graph().Vertexes("1.2.4").front()).size(), 2u);
+
+  EXPECT_TRUE(roadNetwork.OpenEdge(tail, head));
+  ASSERT_TRUE(roadNetwork.EdgeCost(tail, head, cost));
+  EXPECT_NEAR(cost, baseCost, 1e-6);
+
+  EXPECT_TRUE(roadNetwork.CloseEdge(tail, head));
+  roadNetwork.ClearOverlay();
+  ASSERT_TRUE(roadNetwork.ShortestPath(rndf::UniqueId(1, 2, 1), head, path,
+    cost));
+  EXPECT_NEAR(cost, routeCost, 1e-6);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check saving and loading the network.
+TEST(RoadNetwork, Persistence)
+{
+  std::string dirPath(std::string(PROJECT_SOURCE_PATH));
+
+  rndf::RNDF rndf(dirPath + "/test/rndf/sample1.rndf");
+  EXPECT_TRUE(rndf.Valid());
+
+  std::string path = testing::getRandomNumber() + ".network";
+  EXPECT_FALSE(RoadNetwork::UpToDate(path, rndf));
+
+  // The first time the network is built and saved.
+  RoadNetwork built(rndf, path);
+  EXPECT_TRUE(RoadNetwork::UpToDate(path, rndf));
+  RoadNetworkOptions options;
+  options.SetZoneModel(ZoneModel::HUB);
+  EXPECT_FALSE(RoadNetwork::UpToDate(path, rndf, options));
+
+  // The second time it's loaded.
+  RoadNetwork loaded(rndf, path);
+  EXPECT_TRUE(loaded.Consistent(rndf));
+  EXPECT_EQ(loaded.RoadType(), "rndf");
+  EXPECT_EQ(loaded.Graph().Vertexes().size(),
+            built.Graph().Vertexes().size());
+  EXPECT_EQ(loaded.Graph().Edges().size(), built.Graph().Edges().size());
+  EXPECT_EQ(loaded.NumComponents(), built.NumComponents());
+
+  std::vector<rndf::UniqueId> deadEnds;
+  std::vector<rndf::UniqueId> unreachable;
+  std::vector<rndf::UniqueId> loadedDeadEnds;
+  std::vector<rndf::UniqueId> loadedUnreachable;
+  built.ConnectivityReport(deadEnds, unreachable);
+  loaded.ConnectivityReport(loadedDeadEnds, loadedUnreachable);
+  EXPECT_EQ(loadedDeadEnds, deadEnds);
+  EXPECT_EQ(loadedUnreachable, unreachable);
+
+  std::vector<rndf::UniqueId> path1;
+  std::vector<rndf::UniqueId> path2;
+  double cost1;
+  double cost2;
+  rndf::UniqueId src(1, 2, 1);
+  rndf::UniqueId dst(14, 3, 2);
+  ASSERT_TRUE(built.ShortestPath(src, dst, path1, cost1));
+  ASSERT_TRUE(loaded.ShortestPath(src, dst, path2, cost2));
+  EXPECT_EQ(path1, path2);
+  EXPECT_DOUBLE_EQ(cost1, cost2);
+
+  // A loaded network can be edited.
+  EXPECT_TRUE(loaded.RemoveSegment(3));
+  ASSERT_TRUE(rndf.RemoveSegment(3));
+  EXPECT_TRUE(loaded.Consistent(rndf));
+
+  // The file is stale after editing the RNDF: the network is rebuilt and
+  // saved again.
+  EXPECT_FALSE(RoadNetwork::UpToDate(path, rndf));
+  RoadNetwork rebuilt(rndf, path);
+  EXPECT_TRUE(rebuilt.Consistent(rndf));
+  EXPECT_TRUE(RoadNetwork::UpToDate(path, rndf));
+  EXPECT_TRUE(loaded.Save(path, rndf));
+  EXPECT_TRUE(RoadNetwork::UpToDate(path, rndf));
+
+  // Stops change the cost of the exits, so adding one makes the file stale.
+  auto &lane = rndf.Segments().front().Lanes().front();
+  lane.Stops().push_back(lane.Waypoints().back().Id());
+  EXPECT_FALSE(RoadNetwork::UpToDate(path, rndf));
+  RoadNetwork stopped(rndf, path);
+  EXPECT_TRUE(stopped.Consistent(rndf));
+  EXPECT_TRUE(RoadNetwork::UpToDate(path, rndf));
+
+  // A truncated file is rebuilt too.
+  {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out << "MNFD";
+  }
+  EXPECT_FALSE(RoadNetwork::UpToDate(path, rndf));
+  RoadNetwork repaired(rndf, path);
+  EXPECT_TRUE(repaired.Consistent(rndf));
+  EXPECT_TRUE(RoadNetwork::UpToDate(path, rndf));
+
+  std::remove(path.c_str());
+}
+
+//////////////////////////////////////////////////
+/// \brief Get the predecessors of every waypoint scanning all the edges.
+/// \param[in] _network The road network.
+/// \return The sorted names of the predecessors, keyed by waypoint name.
+std::map<std::string, std::vector<std::string>> scanPredecessors(
+  const RoadNetwork &_network)
+{
+  std::map<std::string, std::vector<std::string>> predecessors;
+  for (auto const &vertex : _network.Graph().Vertexes())
+    predecessors[vertex->Name()];
+  for (auto const &edge : _network.Graph().Edges())
+    predecessors[edge->Head()->Name()].push_back(edge->Tail()->Name());
+  for (auto &entry : predecessors)
+    std::sort(entry.second.begin(), entry.second.end());
+  return predecessors;
+}
+
+//////////////////////////////////////////////////
+/// \brief Get the predecessors of a set of waypoints with
+/// RoadNetwork::Predecessors().
+/// \param[in] _network The road network.
+/// \param[in] _ids The waypoints.
+/// \return The sorted names of the predecessors, keyed by waypoint name.
+std::map<std::string, std::vector<std::string>> predecessorNames(
+  const RoadNetwork &_network, const std::vector<rndf::UniqueId> &_ids)
+{
+  std::map<std::string, std::vector<std::string>> predecessors;
+  for (auto const &id : _ids)
+  {
+    std::vector<rndf::UniqueId> ids;
+    EXPECT_TRUE(_network.Predecessors(id, ids));
+    auto &names = predecessors[id.String()];
+    for (auto const &pred : ids)
+      names.push_back(pred.String());
+    std::sort(names.begin(), names.end());
+  }
+  return predecessors;
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the incoming edges.
+TEST(RoadNetwork, Predecessors)
+{
+  std::string dirPath(std::string(PROJECT_SOURCE_PATH));
+
+  rndf::RNDF rndf(dirPath + "/test/rndf/sample1.rndf");
+  EXPECT_TRUE(rndf.Valid());
+
+  RoadNetwork cliqueNetwork(rndf);
+  RoadNetworkOptions options;
+  options.SetZoneModel(ZoneModel::HUB);
+  RoadNetwork roadNetwork(rndf, options);
+
+  std::vector<rndf::UniqueId> ids;
+  for (auto const &vertex : cliqueNetwork.Graph().Vertexes())
+    ids.push_back(rndf::UniqueId(vertex->Name()));
+
+  // The predecessors match the edges of the graph. The zone hub is
+  // transparent.
+  auto expected = scanPredecessors(cliqueNetwork);
+  EXPECT_EQ(predecessorNames(cliqueNetwork, ids), expected);
+  EXPECT_EQ(predecessorNames(roadNetwork, ids), expected);
+
+  std::vector<rndf::UniqueId> predecessors;
+  EXPECT_FALSE(roadNetwork.Predecessors(rndf::UniqueId(99, 1, 1),
+    predecessors));
+  EXPECT_TRUE(predecessors.empty());
+
+  ASSERT_TRUE(roadNetwork.Predecessors(rndf::UniqueId(14, 3, 2),
+    predecessors));
+  ASSERT_EQ(predecessors.size(), 1u);
+  EXPECT_EQ(predecessors.front(), rndf::UniqueId(14, 3, 1));
+
+  // The index follows the changes in the network.
+  rndf::Segment segment;
+  ASSERT_TRUE(rndf.Segment(3, segment));
+  ASSERT_TRUE(cliqueNetwork.RemoveSegment(3));
+  ASSERT_TRUE(rndf.RemoveSegment(3));
+  EXPECT_TRUE(cliqueNetwork.Consistent(rndf));
+  EXPECT_FALSE(cliqueNetwork.Predecessors(rndf::UniqueId(3, 1, 1),
+    predecessors));
+
+  std::vector<rndf::UniqueId> remaining;
+  for (auto const &vertex : cliqueNetwork.Graph().Vertexes())
+    remaining.push_back(rndf::UniqueId(vertex->Name()));
+  EXPECT_EQ(predecessorNames(cliqueNetwork, remaining),
+            scanPredecessors(cliqueNetwork));
+
+  ASSERT_TRUE(cliqueNetwork.AddSegment(segment));
+  ASSERT_TRUE(rndf.AddSegment(segment));
+  EXPECT_TRUE(cliqueNetwork.Consistent(rndf));
+  EXPECT_EQ(predecessorNames(cliqueNetwork, ids), expected);
+
+  rndf::Exit exit(rndf::UniqueId(1, 1, 4), rndf::UniqueId(1, 2, 1));
+  ASSERT_TRUE(roadNetwork.Predecessors(rndf::UniqueId(1, 2, 1),
+    predecessors));
+  auto numPredecessors = predecessors.size();
+  ASSERT_TRUE(roadNetwork.AddExit(exit));
+  ASSERT_TRUE(roadNetwork.Predecessors(rndf::UniqueId(1, 2, 1),
+    predecessors));
+  EXPECT_EQ(predecessors.size(), numPredecessors + 1);
+  EXPECT_NE(std::find(predecessors.begin(), predecessors.end(),
+    rndf::UniqueId(1, 1, 4)), predecessors.end());
+  ASSERT_TRUE(roadNetwork.RemoveExit(exit));
+  ASSERT_TRUE(roadNetwork.Predecessors(rndf::UniqueId(1, 2, 1),
+    predecessors));
+  EXPECT_EQ(predecessors.size(), numPredecessors);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the strongly connected components and the reachability
+/// queries.
+TEST(RoadNetwork, Reachability)
+{
+  std::string dirPath(std::string(PROJECT_SOURCE_PATH));
+
+  rndf::RNDF rndf(dirPath + "/test/rndf/sample1.rndf");
+  EXPECT_TRUE(rndf.Valid());
+
+  RoadNetwork roadNetwork(rndf);
+  EXPECT_EQ(roadNetwork.NumComponents(), 8u);
+
+  EXPECT_FALSE(roadNetwork.Reachable(rndf::UniqueId(99, 1, 1),
+    rndf::UniqueId(1, 1, 1)));
+  EXPECT_TRUE(roadNetwork.Reachable(rndf::UniqueId(1, 1, 1),
+    rndf::UniqueId(1, 1, 1)));
+  EXPECT_TRUE(roadNetwork.Reachable(rndf::UniqueId(1, 2, 1),
+    rndf::UniqueId(3, 1, 1)));
+  EXPECT_TRUE(roadNetwork.Reachable(rndf::UniqueId(1, 1, 1),
+    rndf::UniqueId(1, 1, 4)));
+  EXPECT_FALSE(roadNetwork.Reachable(rndf::UniqueId(1, 1, 4),
+    rndf::UniqueId(1, 1, 1)));
+
+  // Components of a lane without exits.
+  unsigned int c1;
+  unsigned int c2;
+  EXPECT_FALSE(roadNetwork.Component(rndf::UniqueId(99, 1, 1), c1));
+  ASSERT_TRUE(roadNetwork.Component(rndf::UniqueId(1, 1, 1), c1));
+  ASSERT_TRUE(roadNetwork.Component(rndf::UniqueId(1, 1, 4), c2));
+  EXPECT_NE(c1, c2);
+  EXPECT_LT(c2, c1);
+
+  // The reachability matches the result of the searches.
+  std::vector<rndf::UniqueId> ids;
+  for (auto const &vertex : roadNetwork.Graph().Vertexes())
+  {
+    rndf::UniqueId id(vertex->Name());
+    if (id.Valid())
+      ids.push_back(id);
+  }
+  std::vector<double> costs;
+  ASSERT_TRUE(roadNetwork.CostMatrix(ids, ids, costs));
+  for (size_t i = 0; i < ids.size(); ++i)
+  {
+    for (size_t j = 0; j < ids.size(); ++j)
+    {
+      EXPECT_EQ(roadNetwork.Reachable(ids[i], ids[j]),
+        !std::isinf(costs[i * ids.size() + j]));
+    }
+  }
+
+  // Lane 1.1 can't be reached and doesn't lead anywhere.
+  std::vector<rndf::UniqueId> deadEnds;
+  std::vector<rndf::UniqueId> unreachable;
+  roadNetwork.ConnectivityReport(deadEnds, unreachable);
+  std::vector<rndf::UniqueId> expectedDeadEnds =
+  {
+    rndf::UniqueId(1, 1, 1), rndf::UniqueId(1, 1, 2), rndf::UniqueId(1, 1, 3),
+    rndf::UniqueId(1, 1, 4), rndf::UniqueId(4, 2, 5), rndf::UniqueId(4, 2, 6),
+    rndf::UniqueId(4, 2, 7)
+  };
+  std::vector<rndf::UniqueId> expectedUnreachable =
+  {
+    rndf::UniqueId(1, 1, 1), rndf::UniqueId(1, 1, 2), rndf::UniqueId(1, 1, 3),
+    rndf::UniqueId(1, 1, 4)
+  };
+  EXPECT_EQ(deadEnds, expectedDeadEnds);
+  EXPECT_EQ(unreachable, expectedUnreachable);
+
+  // The components are updated after editing the network.
+  rndf::Exit exit(rndf::UniqueId(1, 1, 4), rndf::UniqueId(1, 2, 1));
+  EXPECT_TRUE(roadNetwork.AddExit(exit));
+  EXPECT_TRUE(roadNetwork.Reachable(rndf::UniqueId(1, 1, 4),
+    rndf::UniqueId(3, 1, 1)));
+  roadNetwork.ConnectivityReport(deadEnds, unreachable);
+  EXPECT_EQ(deadEnds.size(), 3u);
+  EXPECT_EQ(unreachable.size(), 4u);
+}
+
+//////////////////////////////////////////////////
+/// \brief The components of a very long cycle are computed without
+/// recursion.
+TEST(RoadNetwork, ReachabilityLongCycle)
+{
+  const int kWaypoints = 200000;
+  rndf::Lane lane(1);
+  ignition::math::SphericalCoordinates::SurfaceType st =
+    ignition::math::SphericalCoordinates::EARTH_WGS84;
+  for (int i = 1; i <= kWaypoints; ++i)
+  {
+    ignition::math::Angle lat(IGN_DTOR(37.0 + i * 1e-6));
+    ignition::math::Angle lon(IGN_DTOR(-122.0));
+    ignition::math::SphericalCoordinates sc(st, lat, lon, 0.0,
+      ignition::math::Angle::Zero);
+    lane.Waypoints().push_back(rndf::Waypoint(i, sc));
+  }
+  lane.AddExit(rndf::Exit(rndf::UniqueId(1, 1, kWaypoints),
+    rndf::UniqueId(1, 1, 1)));
+
+  rndf::Segment segment(1);
+  ASSERT_TRUE(segment.AddLane(lane));
+  rndf::RNDF rndf;
+  ASSERT_TRUE(rndf.AddSegment(segment));
+
+  RoadNetwork roadNetwork(rndf);
+  EXPECT_EQ(roadNetwork.NumComponents(), 1u);
+  EXPECT_TRUE(roadNetwork.Reachable(rndf::UniqueId(1, 1, kWaypoints),
+    rndf::UniqueId(1, 1, 2)));
+  std::vector<rndf::UniqueId> deadEnds;
+  std::vector<rndf::UniqueId> unreachable;
+  roadNetwork.ConnectivityReport(deadEnds, unreachable);
+  EXPECT_TRUE(deadEnds.empty());
+  EXPECT_TRUE(unreachable.empty());
+}
+
+//////////////////////////////////////////////////
+/// \brief An exit from a zone into a zone listed after it is connected by
+/// the constructor, as it is by the incremental updates.
+TEST(RoadNetwork, ZoneToZoneExit)
+{
+  std::string dirPath(std::string(PROJECT_SOURCE_PATH));
+
+  rndf::RNDF rndf(dirPath + "/test/rndf/sample1.rndf");
+  EXPECT_TRUE(rndf.Valid());
+
+  // A new zone next to zone 14, entered from its first perimeter point.
+  rndf::Zone zone14;
+  ASSERT_TRUE(rndf.Zone(14, zone14));
+  rndf::Zone zone15(15);
+  for (auto const &point : zone14.Perimeter().Points())
+    zone15.Perimeter().AddPoint(rndf::Waypoint(point.Id(), point.Location()));
+  ASSERT_TRUE(rndf.AddZone(zone15));
+  rndf::UniqueId exitId(14, 0, 1);
+  rndf::UniqueId entryId(15, 0, 1);
+  ASSERT_TRUE(zone14.Perimeter().AddExit(rndf::Exit(exitId, entryId)));
+  ASSERT_TRUE(rndf.UpdateZone(zone14));
+
+  RoadNetwork roadNetwork(rndf);
+  double cost;
+  EXPECT_TRUE(roadNetwork.EdgeCost(exitId, entryId, cost));
+  EXPECT_TRUE(roadNetwork.Consistent(rndf));
+
+  // The network edited stays consistent with a network built from scratch.
+  EXPECT_TRUE(roadNetwork.UpdateZone(zone15));
+  EXPECT_TRUE(roadNetwork.EdgeCost(exitId, entryId, cost));
+  EXPECT_TRUE(roadNetwork.Consistent(rndf));
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the lane change edges.
+TEST(RoadNetwork, LaneChanges)
+{
+  std::string dirPath(std::string(PROJECT_SOURCE_PATH));
+
+  rndf::RNDF rndf(dirPath + "/test/rndf/sample1.rndf");
+  EXPECT_TRUE(rndf.Valid());
+
+  RoadNetworkOptions options;
+  options.SetLaneChanges(true);
+  RoadNetwork roadNetwork(rndf, options);
+  RoadNetwork baseNetwork(rndf);
+
+  // Lanes 1.1 and 1.2 and lanes 6.1 and 6.2 run in the same direction
+  // separated by a broken white line.
+  EXPECT_EQ(roadNetwork.Graph().Vertexes().size(),
+            baseNetwork.Graph().Vertexes().size());
+  EXPECT_EQ(roadNetwork.Graph().Edges().size(),
+            baseNetwork.Graph().Edges().size() + 30u);
+
+  auto const &graph = roadNetwork.Graph();
+  auto v = graph.Vertexes("1.1.1").front();
+  auto adjacents = graph.Adjacents(v);
+  ASSERT_EQ(adjacents.size(), 2u);
+  std::vector<std::string> names;
+  for (auto const &adj : adjacents)
+    names.push_back(adj->Name());
+  std::sort(names.begin(), names.end());
+  EXPECT_EQ(names, std::vector<std::string>({"1.1.2", "1.2.2"}));
+
+  // The lane change costs its length plus the penalty.
+  double cost;
+  ASSERT_TRUE(roadNetwork.EdgeCost(rndf::UniqueId(1, 1, 1),
+    rndf::UniqueId(1, 2, 2), cost));
+  auto wp1 = rndf.Info(rndf::UniqueId(1, 1, 1))->Waypoint();
+  auto wp2 = rndf.Info(rndf::UniqueId(1, 2, 2))->Waypoint();
+  double length = ignition::math::SphericalCoordinates::Distance(
+    wp1->Location().LatitudeReference(),
+    wp1->Location().LongitudeReference(),
+    wp2->Location().LatitudeReference(),
+    wp2->Location().LongitudeReference());
+  EXPECT_NEAR(cost, length + options.LaneChangePenalty(), 1e-6);
+
+  // Removing an exit between the same waypoints keeps the lane change.
+  auto numEdges = roadNetwork.Graph().Edges().size();
+  rndf::Exit exit(rndf::UniqueId(1, 1, 1), rndf::UniqueId(1, 2, 2));
+  ASSERT_TRUE(roadNetwork.AddExit(exit));
+  EXPECT_EQ(roadNetwork.Graph().Edges().size(), numEdges + 1);
+  EXPECT_TRUE(roadNetwork.RemoveExit(exit));
+  EXPECT_FALSE(roadNetwork.RemoveExit(exit));
+  EXPECT_EQ(roadNetwork.Graph().Edges().size(), numEdges);
+  EXPECT_TRUE(roadNetwork.Consistent(rndf));
+  ASSERT_TRUE(roadNetwork.EdgeCost(rndf::UniqueId(1, 1, 1),
+    rndf::UniqueId(1, 2, 2), cost));
+  EXPECT_NEAR(cost, length + options.LaneChangePenalty(), 1e-6);
+
+  // Lane 1.1 is no longer isolated.
+  EXPECT_FALSE(baseNetwork.Reachable(rndf::UniqueId(1, 2, 1),
+    rndf::UniqueId(1, 1, 4)));
+  EXPECT_TRUE(roadNetwork.Reachable(rndf::UniqueId(1, 2, 1),
+    rndf::UniqueId(1, 1, 4)));
+  EXPECT_TRUE(roadNetwork.Reachable(rndf::UniqueId(1, 1, 1),
+    rndf::UniqueId(3, 1, 1)));
+
+  // No lane changes between lanes in opposite directions.
+  EXPECT_FALSE(roadNetwork.EdgeCost(rndf::UniqueId(3, 1, 2),
+    rndf::UniqueId(3, 2, 2), cost));
+  EXPECT_FALSE(roadNetwork.EdgeCost(rndf::UniqueId(3, 2, 2),
+    rndf::UniqueId(3, 1, 3), cost));
+
+  // The lane changes are rebuilt with the segment.
+  rndf::Segment segment;
+  ASSERT_TRUE(rndf.Segment(1, segment));
+  EXPECT_TRUE(roadNetwork.UpdateSegment(segment));
+  EXPECT_TRUE(roadNetwork.Consistent(rndf));
+  EXPECT_TRUE(roadNetwork.EdgeCost(rndf::UniqueId(1, 1, 1),
+    rndf::UniqueId(1, 2, 2), cost));
+
+  // Solid lines can't be crossed.
+  segment.Lanes()[0].SetRightBoundary(rndf::Marking::SOLID_WHITE);
+  ASSERT_TRUE(rndf.UpdateSegment(segment));
+  EXPECT_TRUE(roadNetwork.UpdateSegment(segment));
+  EXPECT_TRUE(roadNetwork.Consistent(rndf));
+  EXPECT_FALSE(roadNetwork.EdgeCost(rndf::UniqueId(1, 1, 1),
+    rndf::UniqueId(1, 2, 2), cost));
+  EXPECT_FALSE(roadNetwork.EdgeCost(rndf::UniqueId(1, 2, 2),
+    rndf::UniqueId(1, 1, 2), cost));
+}
+
 //////////////////////////////////////////////////
 int main(int argc, char **argv)
 {
@@ -0,0 +1,549 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <ignition/math/SphericalCoordinates.hh>
+
+#include "manifold/rndf/UniqueId.hh"
+#include "manifold/RoadNetwork.hh"
+#include "manifold/RouteCache.hh"
+#include "Common.hh"
+#include "RoadNetworkPrivate.hh"
+
+using namespace manifold;
+
+namespace
+{
+  /// \internal
+  /// \brief Side of the cells of the finest level of the origin index
+  /// (meters). Each level doubles it.
+  const double kCellSize = 100.0;
+
+  /// \internal
+  /// \brief Number of levels of the origin index. The cells of the last
+  /// one are larger than the diameter of the Earth.
+  const size_t kLevels = 18;
+}
+
+namespace manifold
+{
+  /// \internal
+  /// \brief A cached route.
+  class CachedRoute
+  {
+    /// \brief Indexes of the vertexes along the route, zone hubs included.
+    public: std::vector<unsigned int> route;
+
+    /// \brief Unique Ids of the waypoints along the route.
+    public: std::vector<rndf::UniqueId> path;
+
+    /// \brief Cost of the route or infinity if there's no route.
+    public: double cost = std::numeric_limits<double>::infinity();
+
+    /// \brief Whether a route was found.
+    public: bool found = false;
+
+    /// \brief Serial number assigned when the route was stored.
+    public: uint64_t serial = 0;
+
+    /// \brief Position in the recency list.
+    public: std::list<uint64_t>::iterator position;
+  };
+
+  /// \internal
+  /// \brief Private data for RouteCache class.
+  class RouteCachePrivate
+  {
+    /// \brief Constructor.
+    /// \param[in] _graph The routing graph.
+    /// \param[in] _capacity Maximum number of routes stored.
+    public: RouteCachePrivate(RoadNetworkPrivate &_graph,
+                              const size_t _capacity)
+      : graph(_graph),
+        capacity(_capacity),
+        cursor(_graph.edgeChanges.Open()),
+        origins(kLevels)
+    {
+    }
+
+    /// \brief Destructor.
+    public: virtual ~RouteCachePrivate()
+    {
+      this->graph.edgeChanges.Close(this->cursor);
+    }
+
+    /// \brief Key of a pair of vertexes.
+    /// \param[in] _first Index of the first vertex.
+    /// \param[in] _second Index of the second vertex.
+    /// \return The key.
+    public: static uint64_t Key(const unsigned int _first,
+                                const unsigned int _second)
+    {
+      return (static_cast<uint64_t>(_first) << 32) | _second;
+    }
+
+    /// \brief Great-circle distance between two vertexes, a lower bound of
+    /// the cost of any route between them.
+    /// \param[in] _v Index of the first vertex.
+    /// \param[in] _w Index of the second vertex.
+    /// \return The distance (meters).
+    public: double Distance(const unsigned int _v, const unsigned int _w) const
+    {
+      return ignition::math::SphericalCoordinates::Distance(
+        this->graph.latitudes[_v], this->graph.longitudes[_v],
+        this->graph.latitudes[_w], this->graph.longitudes[_w]);
+    }
+
+    /// \brief Discard the routes affected by the changes in the network
+    /// since the last call. Requires the lock.
+    public: void Sync()
+    {
+      if (!this->graph.edgeChanges.Read(this->cursor,
+            [this](const unsigned int _tail, const unsigned int _head)
+            {
+              this->Invalidate(_tail, _head);
+            }))
+      {
+        // Some changes were missed, so any route might be affected.
+        this->invalidations += this->entries.size();
+        this->entries.clear();
+        this->order.clear();
+        this->Compact();
+      }
+    }
+
+    /// \brief Key of the cell of the origin index that contains a vertex.
+    /// Cells are cubes in Earth-centered coordinates, so two points closer
+    /// than the side of a cell along the surface are in the same or in
+    /// adjacent cells.
+    /// \param[in] _v Index of the vertex.
+    /// \param[in] _level Level of the index.
+    /// \param[in] _di Offset of the cell along x.
+    /// \param[in] _dj Offset of the cell along y.
+    /// \param[in] _dk Offset of the cell along z.
+    /// \return The key.
+    public: uint64_t Cell(const unsigned int _v, const size_t _level,
+                          const int _di = 0, const int _dj = 0,
+                          const int _dk = 0) const
+    {
+      double lat = this->graph.latitudes[_v];
+      double lon = this->graph.longitudes[_v];
+      double size = kCellSize * static_cast<double>(1u << _level);
+      auto coordinate = [size](const double _value, const int _offset)
+      {
+        // 21 bits per axis are enough for the finest cells.
+        return static_cast<uint64_t>(static_cast<int64_t>(
+          std::floor(kEarthRadius * _value / size)) + _offset + (1 << 20)) &
+          0x1fffff;
+      };
+      return (coordinate(std::cos(lat) * std::cos(lon), _di) << 42) |
+        (coordinate(std::cos(lat) * std::sin(lon), _dj) << 21) |
+        coordinate(std::sin(lat), _dk);
+    }
+
+    /// \brief Level of the origin index where a route is stored: the first
+    /// one whose cells are larger than its cost.
+    /// \param[in] _cost Cost of the route.
+    /// \return The level.
+    public: static size_t Level(const double _cost)
+    {
+      size_t level = 0;
+      while (level + 1 < kLevels &&
+             kCellSize * static_cast<double>(1u << level) < _cost)
+      {
+        ++level;
+      }
+      return level;
+    }
+
+    /// \brief Discard the routes affected by a change in an edge. Requires
+    /// the lock.
+    /// \param[in] _tail Index of the tail vertex.
+    /// \param[in] _head Index of the head vertex. A change with the same
+    /// tail and head means that the vertex was removed.
+    public: void Invalidate(const unsigned int _tail, const unsigned int _head)
+    {
+      // The index of a removed vertex will be reused. The routes with edges
+      // to or from it are discarded by the changes of those edges, so only
+      // the route from the vertex to itself is left.
+      if (_tail == _head)
+      {
+        auto entry = this->entries.find(Key(_tail, _tail));
+        if (entry != this->entries.end())
+        {
+          this->Erase(entry);
+          ++this->invalidations;
+        }
+        return;
+      }
+
+      // The edge might be closed, removed or more expensive: discard the
+      // routes that traverse it.
+      auto it = this->edgeIndex.find(Key(_tail, _head));
+      if (it != this->edgeIndex.end())
+      {
+        for (auto const &ref : it->second)
+        {
+          auto entry = this->entries.find(ref.first);
+          if (entry != this->entries.end() &&
+              entry->second.serial == ref.second)
+          {
+            this->Erase(entry);
+            ++this->invalidations;
+          }
+        }
+        this->indexSize -= it->second.size();
+        this->edgeIndex.erase(it);
+      }
+
+      // The edge might be new or cheaper: discard the routes that could get
+      // shorter through it. Their origin is closer to the tail than their
+      // cost, so only the routes without a path and the routes stored in
+      // the cells around the tail are checked.
+      double cost;
+      if (!this->graph.EdgeCost(_tail, _head, cost) || std::isinf(cost))
+        return;
+
+      this->Shorten(this->unreachable, _tail, _head, cost);
+      for (size_t level = 0; level < kLevels; ++level)
+      {
+        if (this->origins[level].empty())
+          continue;
+
+        for (int di = -1; di <= 1; ++di)
+          for (int dj = -1; dj <= 1; ++dj)
+            for (int dk = -1; dk <= 1; ++dk)
+            {
+              auto cell = this->origins[level].find(
+                this->Cell(_tail, level, di, dj, dk));
+              if (cell != this->origins[level].end())
+                this->Shorten(cell->second, _tail, _head, cost);
+            }
+      }
+    }
+
+    /// \brief Discard the routes of a list that could get shorter through
+    /// an edge. Requires the lock.
+    /// \param[in] _refs Routes (key and serial number).
+    /// \param[in] _tail Index of the tail vertex of the edge.
+    /// \param[in] _head Index of the head vertex of the edge.
+    /// \param[in] _cost Cost of the edge.
+    public: void Shorten(
+      const std::vector<std::pair<uint64_t, uint64_t>> &_refs,
+      const unsigned int _tail, const unsigned int _head, const double _cost)
+    {
+      for (auto const &ref : _refs)
+      {
+        auto entry = this->entries.find(ref.first);
+        if (entry == this->entries.end() ||
+            entry->second.serial != ref.second)
+        {
+          continue;
+        }
+
+        auto src = static_cast<unsigned int>(ref.first >> 32);
+        auto dst = static_cast<unsigned int>(ref.first & 0xffffffffu);
+        double bound = this->Distance(src, _tail) + _cost +
+          this->Distance(_head, dst);
+        if (bound < entry->second.cost)
+        {
+          this->Erase(entry);
+          ++this->invalidations;
+        }
+      }
+    }
+
+    /// \brief Store a route, evicting the least recently used ones if
+    /// needed. Requires the lock.
+    /// \param[in] _key Key of the origin and destination.
+    /// \param[in] _route The route.
+    public: void Insert(const uint64_t _key, CachedRoute &&_route)
+    {
+      if (this->capacity == 0 ||
+          this->entries.find(_key) != this->entries.end())
+      {
+        return;
+      }
+
+      while (this->entries.size() >= this->capacity)
+      {
+        this->Erase(this->entries.find(this->order.back()));
+        ++this->evictions;
+      }
+
+      this->order.push_front(_key);
+      _route.position = this->order.begin();
+      _route.serial = ++this->serial;
+      auto &entry = this->entries[_key] = std::move(_route);
+      this->Index(_key, entry);
+
+      // Discarded routes leave their references behind in the indexes.
+      if (this->indexSize > 2 * this->liveRefs + this->capacity)
+        this->Compact();
+    }
+
+    /// \brief Number of references to a route in the indexes: one per
+    /// edge plus one in the origin index or in the unreachable list.
+    /// \param[in] _route The route.
+    /// \return The number of references.
+    public: static size_t Refs(const CachedRoute &_route)
+    {
+      return (_route.route.empty() ? 0 : _route.route.size() - 1) + 1;
+    }
+
+    /// \brief Add a route to the edge index, and to the origin index or to
+    /// the unreachable list. Requires the lock.
+    /// \param[in] _key Key of the route.
+    /// \param[in] _route The route.
+    public: void Index(const uint64_t _key, const CachedRoute &_route)
+    {
+      auto ref = std::make_pair(_key, _route.serial);
+      for (size_t i = 1; i < _route.route.size(); ++i)
+      {
+        this->edgeIndex[Key(_route.route[i - 1], _route.route[i])].push_back(
+          ref);
+      }
+
+      if (_route.found)
+      {
+        auto src = static_cast<unsigned int>(_key >> 32);
+        auto level = Level(_route.cost);
+        this->origins[level][this->Cell(src, level)].push_back(ref);
+      }
+      else
+        this->unreachable.push_back(ref);
+
+      this->indexSize += Refs(_route);
+      this->liveRefs += Refs(_route);
+    }
+
+    /// \brief Remove a route. Requires the lock.
+    /// \param[in] _entry Iterator to the route.
+    /// \return Iterator to the next route.
+    public: std::unordered_map<uint64_t, CachedRoute>::iterator Erase(
+      std::unordered_map<uint64_t, CachedRoute>::iterator _entry)
+    {
+      this->liveRefs -= Refs(_entry->second);
+      this->order.erase(_entry->second.position);
+      return this->entries.erase(_entry);
+    }
+
+    /// \brief Rebuild the indexes from the routes stored. Requires the
+    /// lock.
+    public: void Compact()
+    {
+      this->edgeIndex.clear();
+      for (auto &level : this->origins)
+        level.clear();
+      this->unreachable.clear();
+      this->indexSize = 0;
+      this->liveRefs = 0;
+      for (auto const &entry : this->entries)
+        this->Index(entry.first, entry.second);
+    }
+
+    /// \brief The routing graph.
+    public: RoadNetworkPrivate &graph;
+
+    /// \brief Maximum number of routes stored.
+    public: size_t capacity;
+
+    /// \brief Cursor in the log of changes of the network.
+    public: size_t cursor;
+
+    /// \brief Protects all the members below.
+    public: std::mutex mutex;
+
+    /// \brief Routes stored, keyed by origin and destination.
+    public: std::unordered_map<uint64_t, CachedRoute> entries;
+
+    /// \brief Keys of the routes stored, most recently used first.
+    public: std::list<uint64_t> order;
+
+    /// \brief Routes (key and serial number) traversing each edge, keyed by
+    /// tail and head. References to discarded routes are removed lazily.
+    public: std::unordered_map<uint64_t,
+      std::vector<std::pair<uint64_t, uint64_t>>> edgeIndex;
+
+    /// \brief Routes (key and serial number) stored in each cell of each
+    /// level of the origin index, keyed by cell. A route is stored in the
+    /// cell of its origin, in the first level whose cells are larger than
+    /// its cost. References to discarded routes are removed lazily.
+    public: std::vector<std::unordered_map<uint64_t,
+      std::vector<std::pair<uint64_t, uint64_t>>>> origins;
+
+    /// \brief Routes (key and serial number) without a path.
+    public: std::vector<std::pair<uint64_t, uint64_t>> unreachable;
+
+    /// \brief Number of references in the indexes.
+    public: size_t indexSize = 0;
+
+    /// \brief Number of references in the indexes to routes stored.
+    public: size_t liveRefs = 0;
+
+    /// \brief Last serial number assigned.
+    public: uint64_t serial = 0;
+
+    /// \brief Number of queries answered from the cache.
+    public: size_t hits = 0;
+
+    /// \brief Number of queries that required a search.
+    public: size_t misses = 0;
+
+    /// \brief Number of routes evicted.
+    public: size_t evictions = 0;
+
+    /// \brief Number of routes discarded because of changes in the network.
+    public: size_t invalidations = 0;
+  };
+}
+
+//////////////////////////////////////////////////
+RouteCache::RouteCache(const RoadNetwork &_network, const size_t _capacity)
+  : dataPtr(new RouteCachePrivate(*_network.dataPtr, _capacity))
+{
+}
+
+//////////////////////////////////////////////////
+RouteCache::~RouteCache()
+{
+}
+
+//////////////////////////////////////////////////
+bool RouteCache::ShortestPath(const rndf::UniqueId &_src,
+  const rndf::UniqueId &_dst, std::vector<rndf::UniqueId> &_path,
+  double &_cost)
+{
+  auto &d = *this->dataPtr;
+  std::vector<unsigned int> ends;
+  if (!d.graph.Indexes({_src, _dst}, ends))
+    return false;
+
+  auto key = RouteCachePrivate::Key(ends[0], ends[1]);
+  {
+    std::lock_guard<std::mutex> lock(d.mutex);
+    d.Sync();
+    auto it = d.entries.find(key);
+    if (it != d.entries.end())
+    {
+      ++d.hits;
+      d.order.splice(d.order.begin(), d.order, it->second.position);
+      if (!it->second.found)
+        return false;
+
+      _path = it->second.path;
+      _cost = it->second.cost;
+      return true;
+    }
+    ++d.misses;
+  }
+
+  // Search without holding the lock.
+  CachedRoute entry;
+  entry.found = d.graph.Route(ends[0], ends[1], entry.route, entry.cost);
+  if (entry.found)
+  {
+    for (auto const &v : entry.route)
+    {
+      // Skip the zone hubs.
+      if (d.graph.ids[v].Valid())
+        entry.path.push_back(d.graph.ids[v]);
+    }
+    _path = entry.path;
+    _cost = entry.cost;
+  }
+  else
+  {
+    entry.route.clear();
+    entry.cost = std::numeric_limits<double>::infinity();
+  }
+
+  bool found = entry.found;
+  std::lock_guard<std::mutex> lock(d.mutex);
+  d.Sync();
+  d.Insert(key, std::move(entry));
+  return found;
+}
+
+//////////////////////////////////////////////////
+size_t RouteCache::Capacity() const
+{
+  return this->dataPtr->capacity;
+}
+
+//////////////////////////////////////////////////
+size_t RouteCache::Size() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  this->dataPtr->Sync();
+  return this->dataPtr->entries.size();
+}
+
+//////////////////////////////////////////////////
+void RouteCache::Clear()
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  this->dataPtr->Sync();
+  this->dataPtr->entries.clear();
+  this->dataPtr->order.clear();
+  this->dataPtr->Compact();
+}
+
+//////////////////////////////////////////////////
+size_t RouteCache::Hits() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  return this->dataPtr->hits;
+}
+
+//////////////////////////////////////////////////
+size_t RouteCache::Misses() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  return this->dataPtr->misses;
+}
+
+//////////////////////////////////////////////////
+size_t RouteCache::Evictions() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  return this->dataPtr->evictions;
+}
+
+//////////////////////////////////////////////////
+size_t RouteCache::Invalidations() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  return this->dataPtr->invalidations;
+}
+
+//////////////////////////////////////////////////
+void RouteCache::ResetCounters()
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->mutex);
+  this->dataPtr->hits = 0;
+  this->dataPtr->misses = 0;
+  this->dataPtr->evictions = 0;
+  this->dataPtr->invalidations = 0;
+}
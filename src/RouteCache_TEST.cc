@@ -0,0 +1,367 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <cmath>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "manifold/rndf/RNDF.hh"
+#include "manifold/rndf/Segment.hh"
+#include "manifold/rndf/UniqueId.hh"
+#include "manifold/RoadNetwork.hh"
+#include "manifold/RouteCache.hh"
+#include "manifold/test_config.h"
+#include "gtest/gtest.h"
+
+using namespace manifold;
+
+//////////////////////////////////////////////////
+/// \brief Check hits, misses and evictions.
+TEST(RouteCache, Counters)
+{
+  std::string dirPath(std::string(PROJECT_SOURCE_PATH));
+
+  rndf::RNDF rndf(dirPath + "/test/rndf/sample1.rndf");
+  EXPECT_TRUE(rndf.Valid());
+
+  RoadNetwork roadNetwork(rndf);
+  RouteCache cache(roadNetwork, 2);
+  EXPECT_EQ(cache.Capacity(), 2u);
+  EXPECT_EQ(cache.Size(), 0u);
+
+  std::vector<rndf::UniqueId> path;
+  double cost;
+  EXPECT_FALSE(cache.ShortestPath(rndf::UniqueId(99, 1, 1),
+    rndf::UniqueId(3, 1, 1), path, cost));
+  EXPECT_EQ(cache.Misses(), 0u);
+
+  rndf::UniqueId a(1, 2, 1);
+  rndf::UniqueId b(3, 1, 1);
+  rndf::UniqueId c(14, 0, 5);
+  std::vector<rndf::UniqueId> expectedPath;
+  double expectedCost;
+  ASSERT_TRUE(roadNetwork.ShortestPath(a, b, expectedPath, expectedCost));
+
+  ASSERT_TRUE(cache.ShortestPath(a, b, path, cost));
+  EXPECT_EQ(path, expectedPath);
+  EXPECT_DOUBLE_EQ(cost, expectedCost);
+  EXPECT_EQ(cache.Hits(), 0u);
+  EXPECT_EQ(cache.Misses(), 1u);
+
+  path.clear();
+  ASSERT_TRUE(cache.ShortestPath(a, b, path, cost));
+  EXPECT_EQ(path, expectedPath);
+  EXPECT_DOUBLE_EQ(cost, expectedCost);
+  EXPECT_EQ(cache.Hits(), 1u);
+  EXPECT_EQ(cache.Misses(), 1u);
+
+  // Lane 1.1 can't be reached. The failure is cached too.
+  EXPECT_FALSE(cache.ShortestPath(a, rndf::UniqueId(1, 1, 1), path, cost));
+  EXPECT_FALSE(cache.ShortestPath(a, rndf::UniqueId(1, 1, 1), path, cost));
+  EXPECT_EQ(cache.Hits(), 2u);
+  EXPECT_EQ(cache.Misses(), 2u);
+  EXPECT_EQ(cache.Size(), 2u);
+
+  // The least recently used route is evicted.
+  EXPECT_TRUE(cache.ShortestPath(a, b, path, cost));
+  EXPECT_TRUE(cache.ShortestPath(a, c, path, cost));
+  EXPECT_EQ(cache.Size(), 2u);
+  EXPECT_EQ(cache.Evictions(), 1u);
+  EXPECT_TRUE(cache.ShortestPath(a, b, path, cost));
+  EXPECT_EQ(cache.Hits(), 4u);
+  EXPECT_EQ(cache.Misses(), 3u);
+
+  cache.Clear();
+  EXPECT_EQ(cache.Size(), 0u);
+  EXPECT_EQ(cache.Hits(), 4u);
+  cache.ResetCounters();
+  EXPECT_EQ(cache.Hits(), 0u);
+  EXPECT_EQ(cache.Misses(), 0u);
+  EXPECT_EQ(cache.Evictions(), 0u);
+  EXPECT_EQ(cache.Invalidations(), 0u);
+
+  // A cache without capacity doesn't store anything.
+  RouteCache disabled(roadNetwork, 0);
+  EXPECT_TRUE(disabled.ShortestPath(a, b, path, cost));
+  EXPECT_TRUE(disabled.ShortestPath(a, b, path, cost));
+  EXPECT_EQ(disabled.Size(), 0u);
+  EXPECT_EQ(disabled.Hits(), 0u);
+  EXPECT_EQ(disabled.Misses(), 2u);
+}
+
+//////////////////////////////////////////////////
+/// \brief Only the routes affected by a change are discarded.
+TEST(RouteCache, Invalidation)
+{
+  std::string dirPath(std::string(PROJECT_SOURCE_PATH));
+
+  rndf::RNDF rndf(dirPath + "/test/rndf/sample1.rndf");
+  EXPECT_TRUE(rndf.Valid());
+
+  RoadNetwork roadNetwork(rndf);
+  RouteCache cache(roadNetwork);
+
+  rndf::UniqueId start(1, 2, 1);
+  rndf::UniqueId goal(3, 1, 1);
+  std::vector<rndf::UniqueId> path;
+  double cost;
+  ASSERT_TRUE(cache.ShortestPath(start, goal, path, cost));
+  double originalCost = cost;
+
+  // A closure away from the route.
+  EXPECT_TRUE(roadNetwork.CloseEdge(rndf::UniqueId(14, 3, 1),
+    rndf::UniqueId(14, 3, 2)));
+  ASSERT_TRUE(cache.ShortestPath(start, goal, path, cost));
+  EXPECT_EQ(cache.Hits(), 1u);
+  EXPECT_EQ(cache.Invalidations(), 0u);
+
+  // Reopening it can't make the route shorter.
+  EXPECT_TRUE(roadNetwork.OpenEdge(rndf::UniqueId(14, 3, 1),
+    rndf::UniqueId(14, 3, 2)));
+  ASSERT_TRUE(cache.ShortestPath(start, goal, path, cost));
+  EXPECT_EQ(cache.Hits(), 2u);
+  EXPECT_EQ(cache.Invalidations(), 0u);
+
+  // Close the exit used by the route.
+  EXPECT_TRUE(roadNetwork.CloseEdge(rndf::UniqueId(1, 2, 4), goal));
+  EXPECT_FALSE(cache.ShortestPath(start, goal, path, cost));
+  EXPECT_EQ(cache.Invalidations(), 1u);
+  EXPECT_EQ(cache.Misses(), 2u);
+
+  // Reopen it: the cached failure is discarded.
+  EXPECT_TRUE(roadNetwork.OpenEdge(rndf::UniqueId(1, 2, 4), goal));
+  ASSERT_TRUE(cache.ShortestPath(start, goal, path, cost));
+  EXPECT_DOUBLE_EQ(cost, originalCost);
+  EXPECT_EQ(cache.Invalidations(), 2u);
+  EXPECT_EQ(cache.Misses(), 3u);
+
+  // Edits of the RNDF.
+  ASSERT_TRUE(roadNetwork.RemoveSegment(3));
+  EXPECT_EQ(cache.Size(), 0u);
+  EXPECT_EQ(cache.Invalidations(), 3u);
+  EXPECT_FALSE(cache.ShortestPath(start, goal, path, cost));
+
+  rndf::Segment segment;
+  ASSERT_TRUE(rndf.Segment(3, segment));
+  ASSERT_TRUE(roadNetwork.AddSegment(segment));
+  ASSERT_TRUE(cache.ShortestPath(start, goal, path, cost));
+  EXPECT_DOUBLE_EQ(cost, originalCost);
+  ASSERT_TRUE(cache.ShortestPath(start, goal, path, cost));
+  EXPECT_EQ(cache.Hits(), 3u);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check a burst of penalty updates between queries that is longer
+/// than the changes kept for the cache.
+TEST(RouteCache, LongBurst)
+{
+  std::string dirPath(std::string(PROJECT_SOURCE_PATH));
+
+  rndf::RNDF rndf(dirPath + "/test/rndf/sample1.rndf");
+  EXPECT_TRUE(rndf.Valid());
+
+  RoadNetwork roadNetwork(rndf);
+  RouteCache cache(roadNetwork);
+
+  rndf::UniqueId start(1, 2, 1);
+  rndf::UniqueId goal(3, 1, 1);
+  std::vector<rndf::UniqueId> path;
+  double cost;
+  ASSERT_TRUE(cache.ShortestPath(start, goal, path, cost));
+
+  // A short burst away from the route doesn't affect it.
+  rndf::UniqueId tail(14, 3, 1);
+  rndf::UniqueId head(14, 3, 2);
+  for (int i = 0; i < 1000; ++i)
+    EXPECT_TRUE(roadNetwork.SetEdgePenalty(tail, head, i % 100));
+  EXPECT_EQ(cache.Size(), 1u);
+  EXPECT_EQ(cache.Invalidations(), 0u);
+
+  // After a long one the cache can't tell, so the route is discarded.
+  for (int i = 0; i < 100000; ++i)
+    EXPECT_TRUE(roadNetwork.SetEdgePenalty(tail, head, i % 100));
+  EXPECT_EQ(cache.Size(), 0u);
+  EXPECT_EQ(cache.Invalidations(), 1u);
+
+  std::vector<rndf::UniqueId> expectedPath;
+  double expectedCost;
+  ASSERT_TRUE(roadNetwork.ShortestPath(start, goal, expectedPath,
+    expectedCost));
+  ASSERT_TRUE(cache.ShortestPath(start, goal, path, cost));
+  EXPECT_EQ(path, expectedPath);
+  EXPECT_DOUBLE_EQ(cost, expectedCost);
+}
+
+//////////////////////////////////////////////////
+/// \brief The cached routes match a search from scratch after each change.
+TEST(RouteCache, RandomChanges)
+{
+  std::string dirPath(std::string(PROJECT_SOURCE_PATH));
+
+  rndf::RNDF rndf(dirPath + "/test/rndf/sample1.rndf");
+  EXPECT_TRUE(rndf.Valid());
+
+  RoadNetwork roadNetwork(rndf);
+  RouteCache cache(roadNetwork, 16);
+
+  std::vector<rndf::UniqueId> ids;
+  for (auto const &vertex : roadNetwork.Graph().Vertexes())
+  {
+    rndf::UniqueId id(vertex->Name());
+    if (id.Valid())
+      ids.push_back(id);
+  }
+
+  std::mt19937 generator(42);
+  std::uniform_int_distribution<size_t> pick(0, ids.size() - 1);
+  std::vector<std::pair<rndf::UniqueId, rndf::UniqueId>> queries;
+  for (int i = 0; i < 24; ++i)
+  {
+    queries.push_back(std::make_pair(ids[pick(generator)],
+                                     ids[pick(generator)]));
+  }
+
+  rndf::Segment segment;
+  ASSERT_TRUE(rndf.Segment(3, segment));
+  std::uniform_int_distribution<int> action(0, 4);
+  std::uniform_int_distribution<size_t> query(0, queries.size() - 1);
+  for (int i = 0; i < 300; ++i)
+  {
+    auto const &q = queries[query(generator)];
+    std::vector<rndf::UniqueId> path;
+    double cost;
+    std::vector<rndf::UniqueId> expectedPath;
+    double expectedCost;
+    bool expected = roadNetwork.ShortestPath(q.first, q.second, expectedPath,
+      expectedCost);
+    ASSERT_EQ(cache.ShortestPath(q.first, q.second, path, cost), expected);
+    if (expected)
+    {
+      EXPECT_NEAR(cost, expectedCost, 1e-6);
+      ASSERT_FALSE(path.empty());
+      EXPECT_EQ(path.front(), q.first);
+      EXPECT_EQ(path.back(), q.second);
+    }
+
+    // Change an edge of the route, if any.
+    if (i % 3 != 0 || path.size() < 2)
+      continue;
+
+    std::uniform_int_distribution<size_t> d(0, path.size() - 2);
+    size_t k = d(generator);
+    switch (action(generator))
+    {
+      case 0:
+        roadNetwork.CloseEdge(path[k], path[k + 1]);
+        break;
+      case 1:
+        roadNetwork.SetEdgePenalty(path[k], path[k + 1], 25.0);
+        break;
+      case 2:
+        roadNetwork.ClearOverlay();
+        break;
+      case 3:
+        if (!roadNetwork.RemoveSegment(3))
+          roadNetwork.AddSegment(segment);
+        break;
+      default:
+        roadNetwork.OpenEdge(path[k], path[k + 1]);
+        break;
+    }
+  }
+  EXPECT_GT(cache.Hits(), 0u);
+  EXPECT_GT(cache.Invalidations(), 0u);
+}
+
+//////////////////////////////////////////////////
+/// \brief Concurrent queries.
+TEST(RouteCache, Threads)
+{
+  std::string dirPath(std::string(PROJECT_SOURCE_PATH));
+
+  rndf::RNDF rndf(dirPath + "/test/rndf/sample2.rndf");
+  EXPECT_TRUE(rndf.Valid());
+
+  RoadNetwork roadNetwork(rndf);
+  RouteCache cache(roadNetwork, 64);
+
+  std::vector<rndf::UniqueId> ids;
+  for (auto const &vertex : roadNetwork.Graph().Vertexes())
+  {
+    rndf::UniqueId id(vertex->Name());
+    if (id.Valid())
+      ids.push_back(id);
+  }
+
+  // 100 queries, each one asked by every thread.
+  std::mt19937 generator(7);
+  std::uniform_int_distribution<size_t> pick(0, ids.size() - 1);
+  std::vector<std::pair<rndf::UniqueId, rndf::UniqueId>> queries;
+  std::vector<double> expected;
+  for (int i = 0; i < 100; ++i)
+  {
+    queries.push_back(std::make_pair(ids[pick(generator)],
+                                     ids[pick(generator)]));
+    std::vector<rndf::UniqueId> path;
+    double cost;
+    if (!roadNetwork.ShortestPath(queries.back().first,
+          queries.back().second, path, cost))
+    {
+      cost = -1;
+    }
+    expected.push_back(cost);
+  }
+
+  const unsigned int kThreads = 8;
+  std::vector<int> errors(kThreads, 0);
+  std::vector<std::thread> threads;
+  for (unsigned int t = 0; t < kThreads; ++t)
+  {
+    threads.push_back(std::thread([&, t]()
+      {
+        for (size_t i = 0; i < queries.size(); ++i)
+        {
+          size_t k = (i + t * 13) % queries.size();
+          std::vector<rndf::UniqueId> path;
+          double cost = -1;
+          if (!cache.ShortestPath(queries[k].first, queries[k].second, path,
+                cost))
+          {
+            cost = -1;
+          }
+          if (std::abs(cost - expected[k]) > 1e-6)
+            ++errors[t];
+        }
+      }));
+  }
+  for (auto &thread : threads)
+    thread.join();
+
+  for (auto const &e : errors)
+    EXPECT_EQ(e, 0);
+  EXPECT_EQ(cache.Hits() + cache.Misses(), kThreads * queries.size());
+  EXPECT_LE(cache.Size(), 64u);
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef MANIFOLD_SPATIALGRID_HH_
+#define MANIFOLD_SPATIALGRID_HH_
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace manifold
+{
+  /// \internal
+  /// \brief A uniform grid that hashes items by the cells overlapped by their
+  /// bounding box, so the items near a location can be found without
+  /// testing all of them. Coordinates are planar (e.g.: meters in a local
+  /// tangent plane).
+  class SpatialGrid
+  {
+    /// \brief Constructor.
+    /// \param[in] _cellSize Length of the side of a cell. Works best when
+    /// it's similar to the size of the items and the query radius.
+    public: explicit SpatialGrid(const double _cellSize)
+      : cellSize(_cellSize)
+    {
+    }
+
+    /// \brief Add an item.
+    /// \param[in] _item Identifier of the item.
+    /// \param[in] _minX Minimum x of the bounding box of the item.
+    /// \param[in] _minY Minimum y of the bounding box of the item.
+    /// \param[in] _maxX Maximum x of the bounding box of the item.
+    /// \param[in] _maxY Maximum y of the bounding box of the item.
+    public: void Insert(const size_t _item,
+                        const double _minX, const double _minY,
+                        const double _maxX, const double _maxY)
+    {
+      for (int64_t i = this->Cell(_minX); i <= this->Cell(_maxX); ++i)
+        for (int64_t j = this->Cell(_minY); j <= this->Cell(_maxY); ++j)
+          this->cells[this->Key(i, j)].push_back(_item);
+    }
+
+    /// \brief Find the items whose cells overlap a box.
+    /// \param[in] _minX Minimum x of the box.
+    /// \param[in] _minY Minimum y of the box.
+    /// \param[in] _maxX Maximum x of the box.
+    /// \param[in] _maxY Maximum y of the box.
+    /// \param[out] _items The candidate items, without duplicates. They
+    /// might be outside of the box, so the caller must check them.
+    public: void Query(const double _minX, const double _minY,
+                       const double _maxX, const double _maxY,
+                       std::vector<size_t> &_items) const
+    {
+      _items.clear();
+      for (int64_t i = this->Cell(_minX); i <= this->Cell(_maxX); ++i)
+      {
+        for (int64_t j = this->Cell(_minY); j <= this->Cell(_maxY); ++j)
+        {
+          auto it = this->cells.find(this->Key(i, j));
+          if (it != this->cells.end())
+            _items.insert(_items.end(), it->second.begin(), it->second.end());
+        }
+      }
+      std::sort(_items.begin(), _items.end());
+      _items.erase(std::unique(_items.begin(), _items.end()), _items.end());
+    }
+
+    /// \brief Get the cell index of a coordinate.
+    /// \param[in] _value The coordinate.
+    /// \return The cell index.
+    private: int64_t Cell(const double _value) const
+    {
+      return static_cast<int64_t>(std::floor(_value / this->cellSize));
+    }
+
+    /// \brief Get the hash key of a cell.
+    /// \param[in] _i Cell index along x.
+    /// \param[in] _j Cell index along y.
+    /// \return The key.
+    private: static uint64_t Key(const int64_t _i, const int64_t _j)
+    {
+      return (static_cast<uint64_t>(_i) << 32) ^
+        (static_cast<uint64_t>(_j) & 0xffffffffu);
+    }
+
+    /// \brief Length of the side of a cell.
+    private: double cellSize;
+
+    /// \brief Items of each non-empty cell.
+    private: std::unordered_map<uint64_t, std::vector<size_t>> cells;
+  };
+}
+#endif
@@ -0,0 +1,1029 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+#include <ignition/math/Angle.hh>
+#include <ignition/math/SphericalCoordinates.hh>
+
+#include "manifold/rndf/Checkpoint.hh"
+#include "manifold/rndf/Exit.hh"
+#include "manifold/rndf/Lane.hh"
+#include "manifold/rndf/ParkingSpot.hh"
+#include "manifold/rndf/Perimeter.hh"
+#include "manifold/rndf/RNDF.hh"
+#include "manifold/rndf/Segment.hh"
+#include "manifold/rndf/UniqueId.hh"
+#include "manifold/rndf/Waypoint.hh"
+#include "manifold/rndf/Zone.hh"
+#include "manifold/RoadNetwork.hh"
+#include "manifold/TiledMap.hh"
+#include "BinaryIO.hh"
+#include "RoadNetworkPrivate.hh"
+#include "SpatialGrid.hh"
+
+using namespace manifold;
+
+namespace
+{
+  /// \internal
+  /// \brief First bytes of a manifest.
+  const char kManifestMagic[4] = {'M', 'N', 'F', 'M'};
+
+  /// \internal
+  /// \brief First bytes of a tile.
+  const char kTileMagic[4] = {'M', 'N', 'F', 'T'};
+
+  /// \internal
+  /// \brief Version of the file format of the manifest and the tiles.
+  const uint32_t kFormatVersion = 1;
+
+  /// \internal
+  /// \brief Written in native byte order to detect files created on a
+  /// machine with a different endianness.
+  const uint32_t kByteOrder = 0x01020304;
+
+  /// \internal
+  /// \brief Approximate length of a degree of latitude (meters).
+  const double kMetersPerDegree = 111320.0;
+
+  /// \internal
+  /// \brief Tiles farther than this times the radius are unloaded.
+  const double kUnloadFactor = 2.0;
+
+  /// \internal
+  /// \brief A bounding box in degrees.
+  class Bounds
+  {
+    /// \brief Grow the box to include a waypoint.
+    /// \param[in] _waypoint The waypoint.
+    public: void Add(const rndf::Waypoint &_waypoint)
+    {
+      double lat = _waypoint.Location().LatitudeReference().Degree();
+      double lon = _waypoint.Location().LongitudeReference().Degree();
+      this->minLat = std::min(this->minLat, lat);
+      this->minLon = std::min(this->minLon, lon);
+      this->maxLat = std::max(this->maxLat, lat);
+      this->maxLon = std::max(this->maxLon, lon);
+    }
+
+    /// \brief Grow the box to include another one.
+    /// \param[in] _other The other box.
+    public: void Merge(const Bounds &_other)
+    {
+      this->minLat = std::min(this->minLat, _other.minLat);
+      this->minLon = std::min(this->minLon, _other.minLon);
+      this->maxLat = std::max(this->maxLat, _other.maxLat);
+      this->maxLon = std::max(this->maxLon, _other.maxLon);
+    }
+
+    /// \brief Whether the box is empty.
+    /// \return True if nothing was added.
+    public: bool Empty() const
+    {
+      return this->minLat > this->maxLat;
+    }
+
+    /// \brief Whether the box overlaps another one.
+    /// \param[in] _other The other box.
+    /// \return True if they overlap.
+    public: bool Overlaps(const Bounds &_other) const
+    {
+      return this->minLat <= _other.maxLat && _other.minLat <= this->maxLat &&
+        this->minLon <= _other.maxLon && _other.minLon <= this->maxLon;
+    }
+
+    /// \brief Minimum latitude.
+    public: double minLat = std::numeric_limits<double>::infinity();
+
+    /// \brief Minimum longitude.
+    public: double minLon = std::numeric_limits<double>::infinity();
+
+    /// \brief Maximum latitude.
+    public: double maxLat = -std::numeric_limits<double>::infinity();
+
+    /// \brief Maximum longitude.
+    public: double maxLon = -std::numeric_limits<double>::infinity();
+  };
+
+  /// \internal
+  /// \brief Bounding box of a segment.
+  /// \param[in] _segment The segment.
+  /// \return The box.
+  Bounds bounds(const rndf::Segment &_segment)
+  {
+    Bounds box;
+    for (auto const &lane : _segment.Lanes())
+    {
+      for (auto const &waypoint : lane.Waypoints())
+        box.Add(waypoint);
+    }
+    return box;
+  }
+
+  /// \internal
+  /// \brief Bounding box of a zone.
+  /// \param[in] _zone The zone.
+  /// \return The box.
+  Bounds bounds(const rndf::Zone &_zone)
+  {
+    Bounds box;
+    for (auto const &point : _zone.Perimeter().Points())
+      box.Add(point);
+    for (auto const &spot : _zone.Spots())
+    {
+      for (auto const &waypoint : spot.Waypoints())
+        box.Add(waypoint);
+    }
+    return box;
+  }
+
+  /// \internal
+  /// \brief Write the header of a file.
+  /// \param[in] _out Output stream.
+  /// \param[in] _magic The first bytes.
+  void writeHeader(std::ostream &_out, const char *_magic)
+  {
+    _out.write(_magic, 4);
+    write(_out, kFormatVersion);
+    write(_out, kByteOrder);
+  }
+
+  /// \internal
+  /// \brief Read and check the header of a file.
+  /// \param[in] _in Input stream.
+  /// \param[in] _magic The expected first bytes.
+  /// \return True if the header matches.
+  bool readHeader(std::istream &_in, const char *_magic)
+  {
+    char magic[4];
+    uint32_t version;
+    uint32_t byteOrder;
+    return _in.read(magic, sizeof(magic)) &&
+      std::equal(magic, magic + sizeof(magic), _magic) &&
+      read(_in, version) && version == kFormatVersion &&
+      read(_in, byteOrder) && byteOrder == kByteOrder;
+  }
+
+  /// \internal
+  /// \brief Write a list of waypoints.
+  /// \param[in] _out Output stream.
+  /// \param[in] _waypoints The waypoints.
+  void writeWaypoints(std::ostream &_out,
+    const std::vector<rndf::Waypoint> &_waypoints)
+  {
+    write<uint64_t>(_out, _waypoints.size());
+    for (auto const &waypoint : _waypoints)
+    {
+      write<int32_t>(_out, waypoint.Id());
+      write<double>(_out, waypoint.Location().LatitudeReference().Radian());
+      write<double>(_out, waypoint.Location().LongitudeReference().Radian());
+      write<double>(_out, waypoint.Location().ElevationReference());
+    }
+  }
+
+  /// \internal
+  /// \brief Read a list of waypoints.
+  /// \param[in] _in Input stream.
+  /// \param[out] _waypoints The waypoints.
+  /// \return True if the waypoints were read.
+  bool readWaypoints(std::istream &_in,
+    std::vector<rndf::Waypoint> &_waypoints)
+  {
+    size_t count;
+    if (!readCount(_in, count))
+      return false;
+
+    _waypoints.clear();
+    for (size_t i = 0; i < count; ++i)
+    {
+      int32_t id;
+      double lat;
+      double lon;
+      double elevation;
+      if (!read(_in, id) || !read(_in, lat) || !read(_in, lon) ||
+          !read(_in, elevation))
+      {
+        return false;
+      }
+      _waypoints.push_back(rndf::Waypoint(id,
+        ignition::math::SphericalCoordinates(
+          ignition::math::SphericalCoordinates::EARTH_WGS84,
+          ignition::math::Angle(lat), ignition::math::Angle(lon),
+          elevation, ignition::math::Angle::Zero)));
+    }
+    return true;
+  }
+
+  /// \internal
+  /// \brief Write a list of exits.
+  /// \param[in] _out Output stream.
+  /// \param[in] _exits The exits.
+  void writeExits(std::ostream &_out,
+    const std::vector<rndf::Exit> &_exits)
+  {
+    write<uint64_t>(_out, _exits.size());
+    for (auto const &exit : _exits)
+    {
+      write(_out, exit.ExitId());
+      write(_out, exit.EntryId());
+    }
+  }
+
+  /// \internal
+  /// \brief Read a list of exits.
+  /// \param[in] _in Input stream.
+  /// \param[out] _exits The exits.
+  /// \return True if the exits were read.
+  bool readExits(std::istream &_in, std::vector<rndf::Exit> &_exits)
+  {
+    size_t count;
+    if (!readCount(_in, count))
+      return false;
+
+    _exits.clear();
+    for (size_t i = 0; i < count; ++i)
+    {
+      rndf::UniqueId exitId;
+      rndf::UniqueId entryId;
+      if (!read(_in, exitId) || !read(_in, entryId))
+        return false;
+      _exits.push_back(rndf::Exit(exitId, entryId));
+    }
+    return true;
+  }
+
+  /// \internal
+  /// \brief Write a checkpoint.
+  /// \param[in] _out Output stream.
+  /// \param[in] _checkpoint The checkpoint.
+  void writeCheckpoint(std::ostream &_out,
+    const rndf::Checkpoint &_checkpoint)
+  {
+    write<int32_t>(_out, _checkpoint.CheckpointId());
+    write<int32_t>(_out, _checkpoint.WaypointId());
+  }
+
+  /// \internal
+  /// \brief Read a checkpoint.
+  /// \param[in] _in Input stream.
+  /// \param[out] _checkpoint The checkpoint.
+  /// \return True if the checkpoint was read.
+  bool readCheckpoint(std::istream &_in, rndf::Checkpoint &_checkpoint)
+  {
+    int32_t checkpointId;
+    int32_t waypointId;
+    if (!read(_in, checkpointId) || !read(_in, waypointId))
+      return false;
+    _checkpoint = rndf::Checkpoint(checkpointId, waypointId);
+    return true;
+  }
+
+  /// \internal
+  /// \brief Write a segment and its lanes.
+  /// \param[in] _out Output stream.
+  /// \param[in] _segment The segment.
+  void writeSegment(std::ostream &_out, const rndf::Segment &_segment)
+  {
+    write<int32_t>(_out, _segment.Id());
+    write(_out, _segment.Name());
+    write<uint64_t>(_out, _segment.Lanes().size());
+    for (auto const &lane : _segment.Lanes())
+    {
+      write<int32_t>(_out, lane.Id());
+      write<double>(_out, lane.Width());
+      write<int32_t>(_out, static_cast<int32_t>(lane.LeftBoundary()));
+      write<int32_t>(_out, static_cast<int32_t>(lane.RightBoundary()));
+      writeWaypoints(_out, lane.Waypoints());
+      write<uint64_t>(_out, lane.Checkpoints().size());
+      for (auto const &checkpoint : lane.Checkpoints())
+        writeCheckpoint(_out, checkpoint);
+      std::vector<int32_t> stops(lane.Stops().begin(), lane.Stops().end());
+      write(_out, stops);
+      writeExits(_out, lane.Exits());
+    }
+  }
+
+  /// \internal
+  /// \brief Read a segment and its lanes.
+  /// \param[in] _in Input stream.
+  /// \param[out] _segment The segment.
+  /// \return True if the segment was read.
+  bool readSegment(std::istream &_in, rndf::Segment &_segment)
+  {
+    int32_t id;
+    std::string name;
+    size_t numLanes;
+    if (!read(_in, id) || !read(_in, name) || !readCount(_in, numLanes))
+      return false;
+
+    _segment = rndf::Segment(id);
+    _segment.SetName(name);
+    for (size_t i = 0; i < numLanes; ++i)
+    {
+      int32_t laneId;
+      double width;
+      int32_t left;
+      int32_t right;
+      std::vector<rndf::Waypoint> waypoints;
+      size_t numCheckpoints;
+      if (!read(_in, laneId) || !read(_in, width) || !read(_in, left) ||
+          !read(_in, right) || !readWaypoints(_in, waypoints) ||
+          !readCount(_in, numCheckpoints))
+      {
+        return false;
+      }
+
+      rndf::Lane lane(laneId);
+      if (width > 0)
+        lane.SetWidth(width);
+      lane.SetLeftBoundary(static_cast<rndf::Marking>(left));
+      lane.SetRightBoundary(static_cast<rndf::Marking>(right));
+      for (auto const &waypoint : waypoints)
+        lane.AddWaypoint(waypoint);
+      for (size_t j = 0; j < numCheckpoints; ++j)
+      {
+        rndf::Checkpoint checkpoint;
+        if (!readCheckpoint(_in, checkpoint))
+          return false;
+        lane.AddCheckpoint(checkpoint);
+      }
+
+      std::vector<int32_t> stops;
+      std::vector<rndf::Exit> exits;
+      if (!read(_in, stops) || !readExits(_in, exits))
+        return false;
+      for (auto const &stop : stops)
+        lane.AddStop(stop);
+      for (auto const &exit : exits)
+        lane.AddExit(exit);
+      _segment.AddLane(lane);
+    }
+    return true;
+  }
+
+  /// \internal
+  /// \brief Write a zone.
+  /// \param[in] _out Output stream.
+  /// \param[in] _zone The zone.
+  void writeZone(std::ostream &_out, const rndf::Zone &_zone)
+  {
+    write<int32_t>(_out, _zone.Id());
+    write(_out, _zone.Name());
+    writeWaypoints(_out, _zone.Perimeter().Points());
+    writeExits(_out, _zone.Perimeter().Exits());
+    write<uint64_t>(_out, _zone.Spots().size());
+    for (auto const &spot : _zone.Spots())
+    {
+      write<int32_t>(_out, spot.Id());
+      write<double>(_out, spot.Width());
+      writeCheckpoint(_out, spot.Checkpoint());
+      writeWaypoints(_out, spot.Waypoints());
+    }
+  }
+
+  /// \internal
+  /// \brief Read a zone.
+  /// \param[in] _in Input stream.
+  /// \param[out] _zone The zone.
+  /// \return True if the zone was read.
+  bool readZone(std::istream &_in, rndf::Zone &_zone)
+  {
+    int32_t id;
+    std::string name;
+    std::vector<rndf::Waypoint> points;
+    std::vector<rndf::Exit> exits;
+    size_t numSpots;
+    if (!read(_in, id) || !read(_in, name) || !readWaypoints(_in, points) ||
+        !readExits(_in, exits) || !readCount(_in, numSpots))
+    {
+      return false;
+    }
+
+    _zone = rndf::Zone(id);
+    _zone.SetName(name);
+    for (auto const &point : points)
+      _zone.Perimeter().AddPoint(point);
+    for (auto const &exit : exits)
+      _zone.Perimeter().AddExit(exit);
+    for (size_t i = 0; i < numSpots; ++i)
+    {
+      int32_t spotId;
+      double width;
+      rndf::Checkpoint checkpoint;
+      std::vector<rndf::Waypoint> waypoints;
+      if (!read(_in, spotId) || !read(_in, width) ||
+          !readCheckpoint(_in, checkpoint) || !readWaypoints(_in, waypoints))
+      {
+        return false;
+      }
+
+      rndf::ParkingSpot spot(spotId);
+      if (width > 0)
+        spot.SetWidth(width);
+      spot.Checkpoint() = checkpoint;
+      for (auto const &waypoint : waypoints)
+        spot.AddWaypoint(waypoint);
+      _zone.AddSpot(spot);
+    }
+    return true;
+  }
+}
+
+namespace manifold
+{
+  /// \internal
+  /// \brief A tile, as described by the manifest.
+  class TileInfo
+  {
+    /// \brief Bounding box of the segments and zones of the tile.
+    public: Bounds bounds;
+
+    /// \brief Size of the file (bytes).
+    public: uint64_t bytes = 0;
+
+    /// \brief Ids of the segments.
+    public: std::vector<int32_t> segments;
+
+    /// \brief Ids of the zones.
+    public: std::vector<int32_t> zones;
+
+    /// \brief Ids of the segments added to the map when the tile was loaded.
+    /// The segments that were already in the network aren't included, so
+    /// unloading the tile doesn't remove them.
+    public: std::vector<int32_t> loadedSegments;
+
+    /// \brief Ids of the zones added to the map when the tile was loaded.
+    public: std::vector<int32_t> loadedZones;
+
+    /// \brief Whether the tile is loaded.
+    public: bool resident = false;
+  };
+
+  /// \internal
+  /// \brief Private data for TiledMap class.
+  class TiledMapPrivate
+  {
+    /// \brief Constructor.
+    /// \param[in] _path Path of the manifest.
+    /// \param[in] _options Options of the road network.
+    public: TiledMapPrivate(const std::string &_path,
+                            const RoadNetworkOptions &_options)
+      : path(_path),
+        options(_options)
+    {
+    }
+
+    /// \brief Read the manifest.
+    /// \return True if the manifest was read.
+    public: bool ReadManifest()
+    {
+      std::ifstream in(this->path, std::ios::binary);
+      size_t count;
+      if (!in || !readHeader(in, kManifestMagic) || !read(in, this->name) ||
+          !read(in, this->tileSize) || !(this->tileSize > 0) ||
+          !readCount(in, count))
+      {
+        return false;
+      }
+
+      this->grid = SpatialGrid(this->tileSize / kMetersPerDegree);
+      this->tiles.resize(count);
+      for (size_t i = 0; i < count; ++i)
+      {
+        auto &tile = this->tiles[i];
+        if (!read(in, tile.bounds.minLat) || !read(in, tile.bounds.minLon) ||
+            !read(in, tile.bounds.maxLat) || !read(in, tile.bounds.maxLon) ||
+            !read(in, tile.bytes) || !read(in, tile.segments) ||
+            !read(in, tile.zones))
+        {
+          return false;
+        }
+
+        // Each segment or zone belongs to a single tile.
+        for (auto const &id : tile.segments)
+        {
+          if (!this->groups.insert(std::make_pair(id, i)).second)
+            return false;
+        }
+        for (auto const &id : tile.zones)
+        {
+          if (!this->groups.insert(std::make_pair(id, i)).second)
+            return false;
+        }
+        if (!tile.bounds.Empty())
+        {
+          this->grid.Insert(i, tile.bounds.minLon, tile.bounds.minLat,
+                            tile.bounds.maxLon, tile.bounds.maxLat);
+        }
+      }
+      return true;
+    }
+
+    /// \brief Load a tile.
+    /// \param[in] _tile Index of the tile.
+    /// \return True if all the segments and zones of the tile were loaded.
+    public: bool Load(const size_t _tile)
+    {
+      auto &tile = this->tiles[_tile];
+      if (tile.resident)
+        return true;
+
+      // Read everything before touching the map.
+      std::string tilePath = this->path + "." + std::to_string(_tile);
+      std::ifstream in(tilePath, std::ios::binary);
+      std::vector<rndf::Segment> segments(tile.segments.size());
+      std::vector<rndf::Zone> zones(tile.zones.size());
+      bool ok = in && readHeader(in, kTileMagic);
+      for (size_t i = 0; ok && i < segments.size(); ++i)
+      {
+        ok = readSegment(in, segments[i]) &&
+          segments[i].Id() == tile.segments[i];
+      }
+      for (size_t i = 0; ok && i < zones.size(); ++i)
+        ok = readZone(in, zones[i]) && zones[i].Id() == tile.zones[i];
+      if (!ok)
+      {
+        std::cerr << "TiledMap::Load(): Unable to read [" << tilePath << "]"
+                  << std::endl;
+        return false;
+      }
+
+      // The exits are resolved once for the whole tile, the exits between
+      // its own segments and zones included. A segment or zone that is
+      // already in the map is skipped, so the map and the network stay in
+      // sync, and it's left in place when the tile is unloaded.
+      tile.loadedSegments.clear();
+      tile.loadedZones.clear();
+      std::vector<const rndf::Segment *> added;
+      for (auto const &segment : segments)
+      {
+        if (this->graph->segments.find(segment.Id()) !=
+              this->graph->segments.end() ||
+            !this->rndf.AddSegment(segment))
+        {
+          std::cerr << "TiledMap::Load(): Unable to add segment ["
+                    << segment.Id() << "] of [" << tilePath << "]"
+                    << std::endl;
+          ok = false;
+          continue;
+        }
+        this->graph->AddLanes(segment);
+        this->graph->AddLaneChanges(segment);
+        added.push_back(&segment);
+        tile.loadedSegments.push_back(segment.Id());
+      }
+      for (auto const &zone : zones)
+      {
+        if (this->graph->zones.find(zone.Id()) != this->graph->zones.end() ||
+            !this->rndf.AddZone(zone))
+        {
+          std::cerr << "TiledMap::Load(): Unable to add zone [" << zone.Id()
+                    << "] of [" << tilePath << "]" << std::endl;
+          ok = false;
+          continue;
+        }
+        this->graph->AddZone(zone);
+        tile.loadedZones.push_back(zone.Id());
+      }
+      for (auto const &segment : added)
+        this->graph->AddLaneExits(*segment);
+      this->graph->ResolveExits();
+      ++this->graph->revision;
+
+      tile.resident = true;
+      this->resident.push_back(_tile);
+      this->residentBytes += tile.bytes;
+      ++this->loads;
+      return ok;
+    }
+
+    /// \brief Unload a tile.
+    /// \param[in] _tile Index of the tile.
+    public: void Unload(const size_t _tile)
+    {
+      auto &tile = this->tiles[_tile];
+      if (!tile.resident)
+        return;
+
+      for (auto const &id : tile.loadedSegments)
+        this->network->RemoveSegment(id);
+      for (auto const &id : tile.loadedZones)
+        this->network->RemoveZone(id);
+
+      // Removing them one by one would shift the rest of the map each time.
+      std::unordered_set<int> segmentIds(tile.loadedSegments.begin(),
+                                         tile.loadedSegments.end());
+      auto &mapSegments = this->rndf.Segments();
+      mapSegments.erase(std::remove_if(mapSegments.begin(),
+        mapSegments.end(), [&segmentIds](const rndf::Segment &_segment)
+        {
+          return segmentIds.count(_segment.Id()) > 0;
+        }), mapSegments.end());
+
+      std::unordered_set<int> zoneIds(tile.loadedZones.begin(),
+                                      tile.loadedZones.end());
+      auto &mapZones = this->rndf.Zones();
+      mapZones.erase(std::remove_if(mapZones.begin(), mapZones.end(),
+        [&zoneIds](const rndf::Zone &_zone)
+        {
+          return zoneIds.count(_zone.Id()) > 0;
+        }), mapZones.end());
+      tile.loadedSegments.clear();
+      tile.loadedZones.clear();
+
+      tile.resident = false;
+      this->resident.erase(std::find(this->resident.begin(),
+                                     this->resident.end(), _tile));
+      this->residentBytes -= tile.bytes;
+      ++this->unloads;
+    }
+
+    /// \brief Whether the segment or zone of a waypoint is loaded.
+    /// \param[in] _id Unique Id of the waypoint.
+    /// \return True if it's loaded.
+    public: bool Loaded(const rndf::UniqueId &_id) const
+    {
+      auto it = this->groups.find(_id.X());
+      return it != this->groups.end() && this->tiles[it->second].resident;
+    }
+
+    /// \brief Path of the manifest.
+    public: std::string path;
+
+    /// \brief Options of the road network.
+    public: RoadNetworkOptions options;
+
+    /// \brief Whether the manifest was read.
+    public: bool valid = false;
+
+    /// \brief Name of the RNDF.
+    public: std::string name;
+
+    /// \brief Length of the side of a tile (meters).
+    public: double tileSize = 0;
+
+    /// \brief The tiles.
+    public: std::vector<TileInfo> tiles;
+
+    /// \brief Tile of each segment and zone, keyed by their Id.
+    public: std::unordered_map<int, size_t> groups;
+
+    /// \brief The bounding boxes of the tiles (degrees), hashed in cells
+    /// of the size of a tile.
+    public: SpatialGrid grid{1.0};
+
+    /// \brief Indexes of the tiles loaded.
+    public: std::vector<size_t> resident;
+
+    /// \brief Size of the files of the tiles loaded (bytes).
+    public: size_t residentBytes = 0;
+
+    /// \brief Number of loads.
+    public: size_t loads = 0;
+
+    /// \brief Number of unloads.
+    public: size_t unloads = 0;
+
+    /// \brief Segments and zones of the tiles loaded.
+    public: rndf::RNDF rndf;
+
+    /// \brief Road network of the tiles loaded.
+    public: std::unique_ptr<RoadNetwork> network;
+
+    /// \brief Routing graph of the road network.
+    public: RoadNetworkPrivate *graph = nullptr;
+  };
+}
+
+//////////////////////////////////////////////////
+bool TiledMap::Build(const rndf::RNDF &_rndf, const std::string &_path,
+  const double _tileSize)
+{
+  if (!(_tileSize > 0))
+  {
+    std::cerr << "TiledMap::Build() Invalid tile size [" << _tileSize << "]"
+              << std::endl;
+    return false;
+  }
+
+  // The grid starts at the south-west corner of the map. A degree of
+  // longitude is scaled at the latitude of its center.
+  Bounds map;
+  for (auto const &segment : _rndf.Segments())
+    map.Merge(bounds(segment));
+  for (auto const &zone : _rndf.Zones())
+    map.Merge(bounds(zone));
+  if (map.Empty())
+    map.minLat = map.minLon = map.maxLat = map.maxLon = 0;
+  double latStep = _tileSize / kMetersPerDegree;
+  double lonStep = latStep /
+    std::max(std::cos(IGN_DTOR(0.5 * (map.minLat + map.maxLat))), 1e-6);
+
+  // Tiles keyed by row and column, so the files are written in order.
+  std::map<std::pair<int64_t, int64_t>, TileInfo> grid;
+  std::map<std::pair<int64_t, int64_t>, std::vector<const rndf::Segment *>>
+    segments;
+  std::map<std::pair<int64_t, int64_t>, std::vector<const rndf::Zone *>>
+    zones;
+  auto cell = [&](const Bounds &_box)
+  {
+    if (_box.Empty())
+      return std::make_pair(int64_t(0), int64_t(0));
+    return std::make_pair(
+      static_cast<int64_t>(std::floor(
+        (0.5 * (_box.minLat + _box.maxLat) - map.minLat) / latStep)),
+      static_cast<int64_t>(std::floor(
+        (0.5 * (_box.minLon + _box.maxLon) - map.minLon) / lonStep)));
+  };
+  for (auto const &segment : _rndf.Segments())
+  {
+    auto box = bounds(segment);
+    auto key = cell(box);
+    grid[key].bounds.Merge(box);
+    grid[key].segments.push_back(segment.Id());
+    segments[key].push_back(&segment);
+  }
+  for (auto const &zone : _rndf.Zones())
+  {
+    auto box = bounds(zone);
+    auto key = cell(box);
+    grid[key].bounds.Merge(box);
+    grid[key].zones.push_back(zone.Id());
+    zones[key].push_back(&zone);
+  }
+
+  size_t index = 0;
+  for (auto &entry : grid)
+  {
+    // The size of the tile is recorded in the manifest, so the tile is
+    // serialized in memory first.
+    std::ostringstream buffer;
+    writeHeader(buffer, kTileMagic);
+    for (auto const &segment : segments[entry.first])
+      writeSegment(buffer, *segment);
+    for (auto const &zone : zones[entry.first])
+      writeZone(buffer, *zone);
+    std::string data = buffer.str();
+    entry.second.bytes = data.size();
+
+    // Closing flushes the last bytes, which might fail too.
+    std::string tilePath = _path + "." + std::to_string(index++);
+    std::ofstream out(tilePath, std::ios::binary | std::ios::trunc);
+    out.write(data.data(), static_cast<std::streamsize>(data.size()));
+    out.close();
+    if (!out)
+    {
+      std::cerr << "TiledMap::Build(): Unable to write [" << tilePath << "]"
+                << std::endl;
+      return false;
+    }
+  }
+
+  std::ofstream out(_path, std::ios::binary | std::ios::trunc);
+  writeHeader(out, kManifestMagic);
+  write(out, _rndf.Name());
+  write(out, _tileSize);
+  write<uint64_t>(out, grid.size());
+  for (auto const &entry : grid)
+  {
+    auto const &tile = entry.second;
+    write(out, tile.bounds.minLat);
+    write(out, tile.bounds.minLon);
+    write(out, tile.bounds.maxLat);
+    write(out, tile.bounds.maxLon);
+    write(out, tile.bytes);
+    write(out, tile.segments);
+    write(out, tile.zones);
+  }
+  out.close();
+  if (!out)
+  {
+    std::cerr << "TiledMap::Build(): Unable to write [" << _path << "]"
+              << std::endl;
+    return false;
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+TiledMap::TiledMap(const std::string &_path,
+  const RoadNetworkOptions &_options)
+  : dataPtr(new TiledMapPrivate(_path, _options))
+{
+  auto &d = *this->dataPtr;
+  d.valid = d.ReadManifest();
+  if (!d.valid)
+  {
+    std::cerr << "TiledMap::TiledMap(): Unable to read [" << _path << "]"
+              << std::endl;
+    d.tiles.clear();
+    d.groups.clear();
+    d.grid = SpatialGrid(1.0);
+  }
+  d.rndf.SetName(d.name);
+  d.network.reset(new RoadNetwork(d.rndf, d.options));
+  d.graph = d.network->dataPtr.get();
+}
+
+//////////////////////////////////////////////////
+TiledMap::~TiledMap()
+{
+}
+
+//////////////////////////////////////////////////
+bool TiledMap::Valid() const
+{
+  return this->dataPtr->valid;
+}
+
+//////////////////////////////////////////////////
+double TiledMap::TileSize() const
+{
+  return this->dataPtr->tileSize;
+}
+
+//////////////////////////////////////////////////
+size_t TiledMap::NumTiles() const
+{
+  return this->dataPtr->tiles.size();
+}
+
+//////////////////////////////////////////////////
+size_t TiledMap::NumResident() const
+{
+  return this->dataPtr->resident.size();
+}
+
+//////////////////////////////////////////////////
+bool TiledMap::Resident(const size_t _tile) const
+{
+  auto const &tiles = this->dataPtr->tiles;
+  return _tile < tiles.size() && tiles[_tile].resident;
+}
+
+//////////////////////////////////////////////////
+size_t TiledMap::ResidentBytes() const
+{
+  return this->dataPtr->residentBytes;
+}
+
+//////////////////////////////////////////////////
+size_t TiledMap::NetworkBytes() const
+{
+  return this->dataPtr->graph->Bytes();
+}
+
+//////////////////////////////////////////////////
+size_t TiledMap::NumLoads() const
+{
+  return this->dataPtr->loads;
+}
+
+//////////////////////////////////////////////////
+size_t TiledMap::NumUnloads() const
+{
+  return this->dataPtr->unloads;
+}
+
+//////////////////////////////////////////////////
+bool TiledMap::Tile(const rndf::UniqueId &_id, size_t &_tile) const
+{
+  auto const &groups = this->dataPtr->groups;
+  auto it = groups.find(_id.X());
+  if (it == groups.end())
+    return false;
+  _tile = it->second;
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool TiledMap::Update(const ignition::math::SphericalCoordinates &_position,
+  const double _radius)
+{
+  auto &d = *this->dataPtr;
+  if (!d.valid)
+    return false;
+
+  double lat = _position.LatitudeReference().Degree();
+  double lon = _position.LongitudeReference().Degree();
+  double dLat = std::max(_radius, 0.0) / kMetersPerDegree;
+  double dLon = dLat / std::max(std::cos(IGN_DTOR(lat)), 1e-6);
+  auto around = [&](const double _scale)
+  {
+    Bounds box;
+    box.minLat = lat - _scale * dLat;
+    box.minLon = lon - _scale * dLon;
+    box.maxLat = lat + _scale * dLat;
+    box.maxLon = lon + _scale * dLon;
+    return box;
+  };
+
+  // Unload first, to keep the peak memory low.
+  auto keep = around(kUnloadFactor);
+  auto resident = d.resident;
+  for (auto const &tile : resident)
+  {
+    if (!d.tiles[tile].bounds.Overlaps(keep))
+      d.Unload(tile);
+  }
+
+  auto needed = around(1.0);
+  std::vector<size_t> candidates;
+  d.grid.Query(needed.minLon, needed.minLat, needed.maxLon, needed.maxLat,
+               candidates);
+  bool ok = true;
+  for (auto const &tile : candidates)
+  {
+    if (d.tiles[tile].bounds.Overlaps(needed))
+      ok = d.Load(tile) && ok;
+  }
+  return ok;
+}
+
+//////////////////////////////////////////////////
+bool TiledMap::Require(const rndf::UniqueId &_id)
+{
+  size_t tile;
+  if (!this->Tile(_id, tile))
+    return false;
+  return this->dataPtr->Load(tile);
+}
+
+//////////////////////////////////////////////////
+void TiledMap::PendingExits(std::vector<rndf::Exit> &_exits) const
+{
+  auto const &d = *this->dataPtr;
+  _exits.clear();
+  for (auto const &segment : d.rndf.Segments())
+  {
+    for (auto const &lane : segment.Lanes())
+    {
+      for (auto const &exit : lane.Exits())
+      {
+        if (!d.Loaded(exit.EntryId()))
+          _exits.push_back(exit);
+      }
+    }
+  }
+  for (auto const &zone : d.rndf.Zones())
+  {
+    for (auto const &exit : zone.Perimeter().Exits())
+    {
+      if (!d.Loaded(exit.EntryId()))
+        _exits.push_back(exit);
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+const rndf::RNDF &TiledMap::Map() const
+{
+  return this->dataPtr->rndf;
+}
+
+//////////////////////////////////////////////////
+RoadNetwork &TiledMap::Network()
+{
+  return *this->dataPtr->network;
+}
+
+//////////////////////////////////////////////////
+const RoadNetwork &TiledMap::Network() const
+{
+  return *this->dataPtr->network;
+}
+
+//////////////////////////////////////////////////
+void TiledMap::Compact()
+{
+  auto &d = *this->dataPtr;
+  d.network.reset(new RoadNetwork(d.rndf, d.options));
+  d.graph = d.network->dataPtr.get();
+}
@@ -0,0 +1,390 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+#include <ignition/math/Angle.hh>
+#include <ignition/math/Helpers.hh>
+#include <ignition/math/SphericalCoordinates.hh>
+
+#include "manifold/rndf/Checkpoint.hh"
+#include "manifold/rndf/Exit.hh"
+#include "manifold/rndf/Lane.hh"
+#include "manifold/rndf/ParkingSpot.hh"
+#include "manifold/rndf/Perimeter.hh"
+#include "manifold/rndf/RNDF.hh"
+#include "manifold/rndf/Segment.hh"
+#include "manifold/rndf/UniqueId.hh"
+#include "manifold/rndf/Waypoint.hh"
+#include "manifold/rndf/Zone.hh"
+#include "manifold/RoadNetwork.hh"
+#include "manifold/RouteCache.hh"
+#include "manifold/TiledMap.hh"
+#include "manifold/test_config.h"
+#include "performance/fixtures.hh"
+#include "gtest/gtest.h"
+
+using namespace manifold;
+using test::location;
+
+/// \brief Remove the files of a tiled map.
+/// \param[in] _path Path of the manifest.
+/// \param[in] _numTiles Number of tiles.
+void removeTiles(const std::string &_path, const size_t _numTiles)
+{
+  for (size_t i = 0; i < _numTiles; ++i)
+    std::remove((_path + "." + std::to_string(i)).c_str());
+  std::remove(_path.c_str());
+}
+
+/// \brief Check that two lists of waypoints are equal.
+/// \param[in] _a The first list.
+/// \param[in] _b The second list.
+void expectSameWaypoints(const std::vector<rndf::Waypoint> &_a,
+                         const std::vector<rndf::Waypoint> &_b)
+{
+  ASSERT_EQ(_a.size(), _b.size());
+  for (size_t i = 0; i < _a.size(); ++i)
+  {
+    EXPECT_EQ(_a[i].Id(), _b[i].Id());
+    EXPECT_DOUBLE_EQ(_a[i].Location().LatitudeReference().Radian(),
+                     _b[i].Location().LatitudeReference().Radian());
+    EXPECT_DOUBLE_EQ(_a[i].Location().LongitudeReference().Radian(),
+                     _b[i].Location().LongitudeReference().Radian());
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that loading all the tiles restores the RNDF and its road
+/// network.
+TEST(TiledMap, RoundTrip)
+{
+  std::string dirPath(PROJECT_SOURCE_PATH);
+  rndf::RNDF rndf(dirPath + "/test/rndf/sample1.rndf");
+  ASSERT_TRUE(rndf.Valid());
+
+  std::string path = testing::getRandomNumber() + ".tiles";
+  ASSERT_TRUE(TiledMap::Build(rndf, path, 200.0));
+  TiledMap map(path);
+  ASSERT_TRUE(map.Valid());
+  EXPECT_DOUBLE_EQ(map.TileSize(), 200.0);
+  EXPECT_GT(map.NumTiles(), 1u);
+  EXPECT_EQ(map.NumResident(), 0u);
+  EXPECT_EQ(map.Map().NumSegments(), 0u);
+  EXPECT_EQ(map.Map().Name(), rndf.Name());
+
+  for (auto const &segment : rndf.Segments())
+    EXPECT_TRUE(map.Require(rndf::UniqueId(segment.Id(), 1, 1)));
+  for (auto const &zone : rndf.Zones())
+    EXPECT_TRUE(map.Require(rndf::UniqueId(zone.Id(), 0, 1)));
+  EXPECT_EQ(map.NumResident(), map.NumTiles());
+  EXPECT_EQ(map.NumLoads(), map.NumTiles());
+  EXPECT_GT(map.ResidentBytes(), 0u);
+  EXPECT_FALSE(map.Require(rndf::UniqueId(99, 1, 1)));
+
+  ASSERT_EQ(map.Map().NumSegments(), rndf.NumSegments());
+  for (auto const &segment : rndf.Segments())
+  {
+    rndf::Segment loaded;
+    ASSERT_TRUE(map.Map().Segment(segment.Id(), loaded));
+    EXPECT_EQ(loaded.Name(), segment.Name());
+    ASSERT_EQ(loaded.NumLanes(), segment.NumLanes());
+    for (size_t i = 0; i < segment.Lanes().size(); ++i)
+    {
+      auto const &a = segment.Lanes()[i];
+      auto const &b = loaded.Lanes()[i];
+      EXPECT_EQ(a.Id(), b.Id());
+      EXPECT_DOUBLE_EQ(a.Width(), b.Width());
+      EXPECT_EQ(a.LeftBoundary(), b.LeftBoundary());
+      EXPECT_EQ(a.RightBoundary(), b.RightBoundary());
+      expectSameWaypoints(a.Waypoints(), b.Waypoints());
+      EXPECT_EQ(a.NumCheckpoints(), b.NumCheckpoints());
+      EXPECT_EQ(a.Stops(), b.Stops());
+      EXPECT_EQ(a.Exits(), b.Exits());
+    }
+  }
+
+  ASSERT_EQ(map.Map().NumZones(), rndf.NumZones());
+  for (auto const &zone : rndf.Zones())
+  {
+    rndf::Zone loaded;
+    ASSERT_TRUE(map.Map().Zone(zone.Id(), loaded));
+    expectSameWaypoints(zone.Perimeter().Points(),
+                        loaded.Perimeter().Points());
+    EXPECT_EQ(zone.Perimeter().Exits(), loaded.Perimeter().Exits());
+    ASSERT_EQ(zone.NumSpots(), loaded.NumSpots());
+    for (size_t i = 0; i < zone.Spots().size(); ++i)
+    {
+      auto const &a = zone.Spots()[i];
+      auto const &b = loaded.Spots()[i];
+      EXPECT_EQ(a.Id(), b.Id());
+      EXPECT_DOUBLE_EQ(a.Width(), b.Width());
+      EXPECT_EQ(a.Checkpoint().CheckpointId(), b.Checkpoint().CheckpointId());
+      expectSameWaypoints(a.Waypoints(), b.Waypoints());
+    }
+  }
+
+  // Same routes as the network of the whole RNDF.
+  RoadNetwork full(rndf);
+  std::vector<std::pair<rndf::UniqueId, rndf::UniqueId>> trips =
+  {
+    {rndf::UniqueId(1, 2, 1), rndf::UniqueId(3, 1, 3)},
+    {rndf::UniqueId(14, 0, 5), rndf::UniqueId(1, 2, 6)},
+    {rndf::UniqueId(3, 2, 13), rndf::UniqueId(14, 1, 2)}
+  };
+  for (auto const &trip : trips)
+  {
+    std::vector<rndf::UniqueId> expected;
+    std::vector<rndf::UniqueId> route;
+    double expectedCost;
+    double cost;
+    bool found = full.ShortestPath(trip.first, trip.second, expected,
+                                   expectedCost);
+    EXPECT_EQ(map.Network().ShortestPath(trip.first, trip.second, route,
+                                         cost), found);
+    if (found)
+    {
+      EXPECT_NEAR(cost, expectedCost, 1e-6);
+    }
+  }
+
+  std::vector<rndf::Exit> pending;
+  map.PendingExits(pending);
+  EXPECT_TRUE(pending.empty());
+  removeTiles(path, map.NumTiles());
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the paging of the tiles around a moving position and the
+/// lazy connection of the exits between tiles.
+TEST(TiledMap, Paging)
+{
+  std::string dirPath(PROJECT_SOURCE_PATH);
+  rndf::RNDF rndf(dirPath + "/test/rndf/sample1.rndf");
+  ASSERT_TRUE(rndf.Valid());
+  std::string path = testing::getRandomNumber() + ".tiles";
+  ASSERT_TRUE(TiledMap::Build(rndf, path, 200.0));
+  TiledMap map(path);
+  ASSERT_TRUE(map.Valid());
+
+  // Corners of the map.
+  double minLat = 90;
+  double minLon = 180;
+  double maxLat = -90;
+  double maxLon = -180;
+  for (auto const &segment : rndf.Segments())
+  {
+    for (auto const &lane : segment.Lanes())
+    {
+      for (auto const &waypoint : lane.Waypoints())
+      {
+        double lat = waypoint.Location().LatitudeReference().Degree();
+        double lon = waypoint.Location().LongitudeReference().Degree();
+        minLat = std::min(minLat, lat);
+        minLon = std::min(minLon, lon);
+        maxLat = std::max(maxLat, lat);
+        maxLon = std::max(maxLon, lon);
+      }
+    }
+  }
+
+  // Around the first waypoint.
+  auto start = rndf.Segments().front().Lanes().front().Waypoints().front()
+    .Location();
+  ASSERT_TRUE(map.Update(start, 100.0));
+  size_t resident = map.NumResident();
+  EXPECT_GT(resident, 0u);
+  EXPECT_LT(resident, map.NumTiles());
+  EXPECT_LT(map.Map().NumSegments(), rndf.NumSegments());
+
+  // Nothing changes without moving.
+  ASSERT_TRUE(map.Update(start, 100.0));
+  EXPECT_EQ(map.NumResident(), resident);
+  EXPECT_EQ(map.NumLoads(), resident);
+
+  // The exits leaving the tiles loaded are connected on demand.
+  std::vector<rndf::Exit> pending;
+  map.PendingExits(pending);
+  ASSERT_FALSE(pending.empty());
+  auto exit = pending.front();
+  double cost;
+  EXPECT_FALSE(map.Network().EdgeCost(exit.ExitId(), exit.EntryId(), cost));
+  size_t tile;
+  ASSERT_TRUE(map.Tile(exit.EntryId(), tile));
+  EXPECT_FALSE(map.Resident(tile));
+  ASSERT_TRUE(map.Require(exit.EntryId()));
+  EXPECT_TRUE(map.Resident(tile));
+  EXPECT_TRUE(map.Network().EdgeCost(exit.ExitId(), exit.EntryId(), cost));
+  std::vector<rndf::Exit> after;
+  map.PendingExits(after);
+  for (auto const &other : after)
+    EXPECT_FALSE(other == exit);
+
+  // Far away, everything is unloaded.
+  ASSERT_TRUE(map.Update(location(minLat - 1, minLon - 1), 150.0));
+  EXPECT_EQ(map.NumResident(), 0u);
+  EXPECT_EQ(map.NumUnloads(), map.NumLoads());
+  EXPECT_EQ(map.ResidentBytes(), 0u);
+  EXPECT_EQ(map.Map().NumSegments(), 0u);
+  EXPECT_EQ(map.Map().NumZones(), 0u);
+  EXPECT_FALSE(map.Network().EdgeCost(exit.ExitId(), exit.EntryId(), cost));
+
+  // The whole map.
+  ASSERT_TRUE(map.Update(location(0.5 * (minLat + maxLat),
+                                  0.5 * (minLon + maxLon)), 2000.0));
+  EXPECT_EQ(map.NumResident(), map.NumTiles());
+  EXPECT_EQ(map.Map().NumSegments(), rndf.NumSegments());
+  map.PendingExits(pending);
+  EXPECT_TRUE(pending.empty());
+
+  // The routes match the network of the whole RNDF, also after rebuilding
+  // the network.
+  RoadNetwork full(rndf);
+  std::vector<rndf::UniqueId> expected;
+  double expectedCost;
+  ASSERT_TRUE(full.ShortestPath(rndf::UniqueId(1, 2, 1),
+    rndf::UniqueId(3, 1, 3), expected, expectedCost));
+  for (int compact = 0; compact < 2; ++compact)
+  {
+    if (compact)
+      map.Compact();
+    std::vector<rndf::UniqueId> route;
+    ASSERT_TRUE(map.Network().ShortestPath(rndf::UniqueId(1, 2, 1),
+      rndf::UniqueId(3, 1, 3), route, cost));
+    EXPECT_NEAR(cost, expectedCost, 1e-6);
+  }
+  removeTiles(path, map.NumTiles());
+}
+
+//////////////////////////////////////////////////
+/// \brief A segment that is already in the network isn't added twice when
+/// its tile is loaded, nor removed when the tile is unloaded.
+TEST(TiledMap, Duplicates)
+{
+  std::string dirPath(PROJECT_SOURCE_PATH);
+  rndf::RNDF rndf(dirPath + "/test/rndf/sample1.rndf");
+  ASSERT_TRUE(rndf.Valid());
+  std::string path = testing::getRandomNumber() + ".tiles";
+  ASSERT_TRUE(TiledMap::Build(rndf, path, 200.0));
+  TiledMap map(path);
+  ASSERT_TRUE(map.Valid());
+
+  rndf::Segment segment;
+  ASSERT_TRUE(rndf.Segment(1, segment));
+  ASSERT_TRUE(map.Network().AddSegment(segment));
+  EXPECT_FALSE(map.Require(rndf::UniqueId(1, 1, 1)));
+  EXPECT_EQ(map.Network().Graph().Vertexes("1.1.1").size(), 1u);
+
+  size_t tile;
+  ASSERT_TRUE(map.Tile(rndf::UniqueId(1, 1, 1), tile));
+  EXPECT_TRUE(map.Resident(tile));
+  EXPECT_FALSE(map.Map().Segment(1, segment));
+
+  // Far away, the tile is unloaded but the segment stays.
+  auto start = segment.Lanes().front().Waypoints().front().Location();
+  ASSERT_TRUE(map.Update(location(start.LatitudeReference().Degree() - 1,
+    start.LongitudeReference().Degree() - 1), 150.0));
+  EXPECT_FALSE(map.Resident(tile));
+  EXPECT_EQ(map.Network().Graph().Vertexes("1.1.1").size(), 1u);
+  std::vector<rndf::UniqueId> route;
+  double cost;
+  EXPECT_TRUE(map.Network().ShortestPath(rndf::UniqueId(1, 1, 1),
+    rndf::UniqueId(1, 1, 4), route, cost));
+  removeTiles(path, map.NumTiles());
+}
+
+//////////////////////////////////////////////////
+/// \brief The memory of the network stays flat while the same tiles are
+/// loaded and unloaded over and over, with a route cache following the
+/// changes.
+TEST(TiledMap, Memory)
+{
+  std::string dirPath(PROJECT_SOURCE_PATH);
+  rndf::RNDF rndf(dirPath + "/test/rndf/sample1.rndf");
+  ASSERT_TRUE(rndf.Valid());
+  std::string path = testing::getRandomNumber() + ".tiles";
+  ASSERT_TRUE(TiledMap::Build(rndf, path, 200.0));
+  TiledMap map(path);
+  ASSERT_TRUE(map.Valid());
+  RouteCache cache(map.Network());
+
+  auto start = rndf.Segments().front().Lanes().front().Waypoints().front()
+    .Location();
+  auto far = location(
+    start.LatitudeReference().Degree() - 1,
+    start.LongitudeReference().Degree() - 1);
+  size_t loadedBytes = 0;
+  size_t unloadedBytes = 0;
+  for (int cycle = 0; cycle < 50; ++cycle)
+  {
+    ASSERT_TRUE(map.Update(start, 5000.0));
+    ASSERT_EQ(map.NumResident(), map.NumTiles());
+    std::vector<rndf::UniqueId> route;
+    double cost;
+    ASSERT_TRUE(cache.ShortestPath(rndf::UniqueId(1, 2, 1),
+      rndf::UniqueId(3, 1, 3), route, cost));
+    if (cycle == 1)
+    {
+      loadedBytes = map.NetworkBytes();
+    }
+    else if (cycle > 1)
+    {
+      EXPECT_EQ(map.NetworkBytes(), loadedBytes);
+    }
+
+    ASSERT_TRUE(map.Update(far, 5000.0));
+    ASSERT_EQ(map.NumResident(), 0u);
+    if (cycle == 1)
+    {
+      unloadedBytes = map.NetworkBytes();
+    }
+    else if (cycle > 1)
+    {
+      EXPECT_EQ(map.NetworkBytes(), unloadedBytes);
+    }
+  }
+  EXPECT_GT(loadedBytes, unloadedBytes);
+  removeTiles(path, map.NumTiles());
+}
+
+//////////////////////////////////////////////////
+/// \brief Check invalid inputs.
+TEST(TiledMap, Invalid)
+{
+  rndf::RNDF rndf;
+  EXPECT_FALSE(TiledMap::Build(rndf, "unused.tiles", 0.0));
+
+  TiledMap missing("missing.tiles");
+  EXPECT_FALSE(missing.Valid());
+  EXPECT_EQ(missing.NumTiles(), 0u);
+  EXPECT_FALSE(missing.Update(location(37.4, -122.1), 100.0));
+  EXPECT_FALSE(missing.Resident(0));
+  size_t tile;
+  EXPECT_FALSE(missing.Tile(rndf::UniqueId(1, 1, 1), tile));
+
+  // An empty RNDF has no tiles.
+  std::string path = testing::getRandomNumber() + ".tiles";
+  ASSERT_TRUE(TiledMap::Build(rndf, path));
+  TiledMap empty(path);
+  EXPECT_TRUE(empty.Valid());
+  EXPECT_EQ(empty.NumTiles(), 0u);
+  EXPECT_TRUE(empty.Update(location(37.4, -122.1), 100.0));
+  removeTiles(path, 0);
+}
@@ -0,0 +1,636 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <ignition/math/Angle.hh>
+#include <ignition/math/Helpers.hh>
+#include <ignition/math/SphericalCoordinates.hh>
+
+#include "manifold/rndf/Lane.hh"
+#include "manifold/rndf/RNDF.hh"
+#include "manifold/rndf/Segment.hh"
+#include "manifold/rndf/UniqueId.hh"
+#include "manifold/rndf/Waypoint.hh"
+#include "manifold/LaneMatcher.hh"
+#include "manifold/RoadNetwork.hh"
+#include "manifold/TraceMatcher.hh"
+#include "Common.hh"
+#include "ParallelFor.hh"
+
+using namespace manifold;
+
+namespace
+{
+  /// \internal
+  /// \brief Maximum number of candidate lanes of a fix.
+  const size_t kMaxCandidates = 8;
+
+  /// \internal
+  /// \brief Great-circle distance between two locations.
+  /// \param[in] _a First location.
+  /// \param[in] _b Second location.
+  /// \return The distance (meters).
+  double distance(const ignition::math::SphericalCoordinates &_a,
+                  const ignition::math::SphericalCoordinates &_b)
+  {
+    return ignition::math::SphericalCoordinates::Distance(
+      _a.LatitudeReference(), _a.LongitudeReference(),
+      _b.LatitudeReference(), _b.LongitudeReference());
+  }
+}
+
+namespace manifold
+{
+  /// \internal
+  /// \brief Waypoints of a lane and their arc length along it.
+  class LaneStations
+  {
+    /// \brief Ids of the waypoints.
+    public: std::vector<int> ids;
+
+    /// \brief Arc length up to each waypoint (meters).
+    public: std::vector<double> stations;
+  };
+
+  /// \internal
+  /// \brief The candidate states of a fix.
+  class ViterbiColumn
+  {
+    /// \brief Projections of the fix on the candidate lanes.
+    public: std::vector<LaneMatch> states;
+
+    /// \brief Log-probability of the most likely sequence ending in each
+    /// state, relative to the best one.
+    public: std::vector<double> scores;
+
+    /// \brief Index of the previous state of that sequence, or -1.
+    public: std::vector<int> back;
+  };
+
+  /// \internal
+  /// \brief Private data for TraceMatcher class.
+  class TraceMatcherPrivate
+  {
+    /// \brief Constructor.
+    /// \param[in] _rndf The RNDF.
+    /// \param[in] _network The road network.
+    public: TraceMatcherPrivate(const rndf::RNDF &_rndf,
+                                const RoadNetwork &_network)
+      : matcher(_rndf),
+        network(_network)
+    {
+      // Same arc lengths as the ones of LaneMatcher.
+      for (auto const &segment : _rndf.Segments())
+      {
+        for (auto const &lane : segment.Lanes())
+        {
+          auto &entry =
+            this->lanes[laneKey(rndf::UniqueId(segment.Id(), lane.Id(), 1))];
+          double station = 0;
+          auto const &waypoints = lane.Waypoints();
+          for (size_t i = 0; i < waypoints.size(); ++i)
+          {
+            if (i > 0)
+            {
+              station += distance(waypoints[i - 1].Location(),
+                                  waypoints[i].Location());
+            }
+            entry.ids.push_back(waypoints[i].Id());
+            entry.stations.push_back(station);
+          }
+        }
+      }
+    }
+
+    /// \brief Destructor.
+    public: virtual ~TraceMatcherPrivate() = default;
+
+    /// \brief Log-probability of observing a fix from a state.
+    /// \param[in] _state The state.
+    /// \return The log-probability, up to a constant.
+    public: double Emission(const LaneMatch &_state) const
+    {
+      double z = _state.distance / this->sigma;
+      return -0.5 * z * z;
+    }
+
+    /// \brief Length of the routes from a state to the states of the next
+    /// fix.
+    /// \param[in] _from The state.
+    /// \param[in] _to The states of the next fix.
+    /// \param[in] _budget Maximum length (meters).
+    /// \param[out] _routes Length of the route to each state, or infinity
+    /// if there's none within the budget.
+    /// \param[in,out] _reached Buffer for the bounded search.
+    public: void Routes(const LaneMatch &_from,
+      const std::vector<LaneMatch> &_to, const double _budget,
+      std::vector<double> &_routes,
+      std::vector<std::pair<rndf::UniqueId, double>> &_reached) const
+    {
+      const double kInf = std::numeric_limits<double>::infinity();
+      _routes.assign(_to.size(), kInf);
+      auto const &from = this->lanes.at(laneKey(_from.waypoint));
+
+      // Moves forward along the same lane, or slightly backward because of
+      // the GPS error.
+      bool search = false;
+      for (size_t j = 0; j < _to.size(); ++j)
+      {
+        if (laneKey(_to[j].waypoint) == laneKey(_from.waypoint) &&
+            _to[j].progress >= _from.progress - this->sigma)
+        {
+          _routes[j] = std::abs(_to[j].progress - _from.progress);
+        }
+        else
+          search = true;
+      }
+      if (!search)
+        return;
+
+      // Other moves leave through the end of the piece of the state.
+      double toEnd = from.stations[_from.index + 1] - _from.progress;
+      rndf::UniqueId next(_from.waypoint.X(), _from.waypoint.Y(),
+                          from.ids[_from.index + 1]);
+      if (toEnd > _budget ||
+          !this->network.WithinCost(next, _budget - toEnd, _reached))
+      {
+        return;
+      }
+
+      for (size_t j = 0; j < _to.size(); ++j)
+      {
+        auto const &to = this->lanes.at(laneKey(_to[j].waypoint));
+        double fromStart = _to[j].progress - to.stations[_to[j].index];
+        for (auto const &reached : _reached)
+        {
+          if (reached.first == _to[j].waypoint)
+          {
+            double route = toEnd + reached.second + fromStart;
+            if (route <= _budget)
+              _routes[j] = std::min(_routes[j], route);
+            break;
+          }
+        }
+      }
+    }
+
+    /// \brief Lane matcher for the candidate states.
+    public: LaneMatcher matcher;
+
+    /// \brief The road network.
+    public: const RoadNetwork &network;
+
+    /// \brief Stations of each lane, keyed by segment and lane Id.
+    public: std::unordered_map<uint64_t, LaneStations> lanes;
+
+    /// \brief Standard deviation of the GPS error (meters).
+    public: double sigma = 5.0;
+
+    /// \brief Scale of the transition probability (meters).
+    public: double beta = 10.0;
+
+    /// \brief Search radius (meters).
+    public: double radius = 25.0;
+
+    /// \brief Maximum number of fixes kept.
+    public: size_t maxLag = 64;
+  };
+
+  /// \internal
+  /// \brief The Viterbi algorithm run on a stream of fixes, with a window
+  /// of the fixes whose match is not decided yet.
+  class ViterbiStream
+  {
+    /// \brief Constructor.
+    /// \param[in] _matcher The trace matcher.
+    /// \param[in] _output Function called with the match of each fix, in
+    /// chronological order.
+    public: ViterbiStream(const TraceMatcherPrivate &_matcher,
+      const std::function<void(const LaneMatch &)> &_output)
+      : matcher(_matcher),
+        output(_output)
+    {
+    }
+
+    /// \brief Add the next fix of the trace.
+    /// \param[in] _fix The fix.
+    public: void Push(const ignition::math::SphericalCoordinates &_fix)
+    {
+      ViterbiColumn column;
+      this->matcher.matcher.Candidates(_fix, this->matcher.radius,
+                                       column.states);
+      if (column.states.size() > kMaxCandidates)
+        column.states.resize(kMaxCandidates);
+
+      if (column.states.empty())
+      {
+        this->Finish();
+        this->output(LaneMatch());
+        return;
+      }
+
+      const double kInf = std::numeric_limits<double>::infinity();
+      column.scores.assign(column.states.size(), -kInf);
+      column.back.assign(column.states.size(), -1);
+      bool linked = false;
+      if (!this->window.empty())
+      {
+        auto const &prev = this->window.back();
+        double straight = distance(this->last, _fix);
+        double budget = 2 * straight + 2 * this->matcher.radius;
+        for (size_t i = 0; i < prev.states.size(); ++i)
+        {
+          this->matcher.Routes(prev.states[i], column.states, budget,
+                               this->routes, this->reached);
+          for (size_t j = 0; j < column.states.size(); ++j)
+          {
+            if (std::isinf(this->routes[j]))
+              continue;
+
+            double score = prev.scores[i] -
+              std::abs(this->routes[j] - straight) / this->matcher.beta;
+            if (column.back[j] < 0 || score > column.scores[j])
+            {
+              column.scores[j] = score;
+              column.back[j] = static_cast<int>(i);
+            }
+          }
+        }
+
+        // Drop the states that can't be reached.
+        size_t kept = 0;
+        for (size_t j = 0; j < column.states.size(); ++j)
+        {
+          if (column.back[j] < 0)
+            continue;
+          column.states[kept] = column.states[j];
+          column.scores[kept] = column.scores[j];
+          column.back[kept] = column.back[j];
+          ++kept;
+        }
+        linked = kept > 0;
+        if (linked)
+        {
+          column.states.resize(kept);
+          column.scores.resize(kept);
+          column.back.resize(kept);
+        }
+      }
+
+      if (!linked)
+      {
+        // Start a new sequence.
+        this->Finish();
+        column.scores.assign(column.states.size(), 0.0);
+        column.back.assign(column.states.size(), -1);
+      }
+
+      double best = -kInf;
+      for (size_t j = 0; j < column.states.size(); ++j)
+      {
+        column.scores[j] += this->matcher.Emission(column.states[j]);
+        best = std::max(best, column.scores[j]);
+      }
+      for (auto &score : column.scores)
+        score -= best;
+
+      this->window.push_back(std::move(column));
+      this->last = _fix;
+      this->Converge();
+      // Force the decision of the oldest fix, following the best sequence.
+      if (this->window.size() > this->matcher.maxLag)
+      {
+        this->Output(1,
+          this->Trace(this->window.size() - 1, this->Best(), 0));
+      }
+    }
+
+    /// \brief Output the matches of all the fixes left.
+    public: void Finish()
+    {
+      if (!this->window.empty())
+        this->Output(this->window.size(), this->Best());
+    }
+
+    /// \brief Index of the best state of the last fix.
+    /// \return The index.
+    private: int Best() const
+    {
+      auto const &scores = this->window.back().scores;
+      return static_cast<int>(
+        std::max_element(scores.begin(), scores.end()) - scores.begin());
+    }
+
+    /// \brief Output the matches of the oldest fixes whose state is the
+    /// same in all the sequences kept.
+    private: void Converge()
+    {
+      // Follow all the sequences back until they merge. The states are the
+      // ones of the fix k - 1.
+      this->states.resize(this->window.back().states.size());
+      for (size_t j = 0; j < this->states.size(); ++j)
+        this->states[j] = static_cast<int>(j);
+
+      for (size_t k = this->window.size(); k > 0; --k)
+      {
+        std::sort(this->states.begin(), this->states.end());
+        this->states.erase(
+          std::unique(this->states.begin(), this->states.end()),
+          this->states.end());
+        if (this->states.size() == 1)
+        {
+          // The fixes up to k - 1 are decided.
+          this->Output(k, this->states[0]);
+          return;
+        }
+
+        if (k > 1)
+        {
+          for (auto &state : this->states)
+            state = this->window[k - 1].back[state];
+        }
+      }
+    }
+
+    /// \brief Output the matches of the oldest fixes.
+    /// \param[in] _count Number of fixes.
+    /// \param[in] _state Index of the state of the fix _count - 1 in the
+    /// sequence to output.
+    private: void Output(const size_t _count, const int _state)
+    {
+      this->path.resize(_count);
+      this->path[_count - 1] = _state;
+      for (size_t c = _count - 1; c > 0; --c)
+        this->path[c - 1] = this->window[c].back[this->path[c]];
+
+      for (size_t c = 0; c < _count; ++c)
+        this->output(this->window[c].states[this->path[c]]);
+      this->window.erase(this->window.begin(), this->window.begin() + _count);
+    }
+
+    /// \brief Follow a sequence back.
+    /// \param[in] _from Index of the fix in the window.
+    /// \param[in] _state Index of the state of that fix.
+    /// \param[in] _to Index of an older fix in the window.
+    /// \return Index of the state of the older fix.
+    private: int Trace(const size_t _from, const int _state,
+                       const size_t _to) const
+    {
+      int state = _state;
+      for (size_t c = _from; c > _to; --c)
+        state = this->window[c].back[state];
+      return state;
+    }
+
+    /// \brief The trace matcher.
+    private: const TraceMatcherPrivate &matcher;
+
+    /// \brief Function called with the match of each fix.
+    private: std::function<void(const LaneMatch &)> output;
+
+    /// \brief States of the fixes not output yet.
+    private: std::deque<ViterbiColumn> window;
+
+    /// \brief Last fix added.
+    private: ignition::math::SphericalCoordinates last;
+
+    /// \brief Buffer for the length of the routes.
+    private: std::vector<double> routes;
+
+    /// \brief Buffer for the waypoints reached by the route searches.
+    private: std::vector<std::pair<rndf::UniqueId, double>> reached;
+
+    /// \brief Buffer for the states followed back.
+    private: std::vector<int> states;
+
+    /// \brief Buffer for the states of the sequence output.
+    private: std::vector<int> path;
+  };
+}
+
+//////////////////////////////////////////////////
+TraceMatcher::TraceMatcher(const rndf::RNDF &_rndf,
+  const RoadNetwork &_network)
+  : dataPtr(new TraceMatcherPrivate(_rndf, _network))
+{
+}
+
+//////////////////////////////////////////////////
+TraceMatcher::~TraceMatcher()
+{
+}
+
+//////////////////////////////////////////////////
+double TraceMatcher::GpsNoise() const
+{
+  return this->dataPtr->sigma;
+}
+
+//////////////////////////////////////////////////
+bool TraceMatcher::SetGpsNoise(const double _sigma)
+{
+  if (!(_sigma > 0) || std::isinf(_sigma))
+  {
+    std::cerr << "TraceMatcher::SetGpsNoise() Invalid deviation ["
+              << _sigma << "]" << std::endl;
+    return false;
+  }
+
+  this->dataPtr->sigma = _sigma;
+  return true;
+}
+
+//////////////////////////////////////////////////
+double TraceMatcher::TransitionScale() const
+{
+  return this->dataPtr->beta;
+}
+
+//////////////////////////////////////////////////
+bool TraceMatcher::SetTransitionScale(const double _beta)
+{
+  if (!(_beta > 0) || std::isinf(_beta))
+  {
+    std::cerr << "TraceMatcher::SetTransitionScale() Invalid scale ["
+              << _beta << "]" << std::endl;
+    return false;
+  }
+
+  this->dataPtr->beta = _beta;
+  return true;
+}
+
+//////////////////////////////////////////////////
+double TraceMatcher::SearchRadius() const
+{
+  return this->dataPtr->radius;
+}
+
+//////////////////////////////////////////////////
+bool TraceMatcher::SetSearchRadius(const double _radius)
+{
+  if (!(_radius > 0) || std::isinf(_radius))
+  {
+    std::cerr << "TraceMatcher::SetSearchRadius() Invalid radius ["
+              << _radius << "]" << std::endl;
+    return false;
+  }
+
+  this->dataPtr->radius = _radius;
+  return true;
+}
+
+//////////////////////////////////////////////////
+size_t TraceMatcher::MaxLag() const
+{
+  return this->dataPtr->maxLag;
+}
+
+//////////////////////////////////////////////////
+bool TraceMatcher::SetMaxLag(const size_t _lag)
+{
+  if (_lag == 0)
+  {
+    std::cerr << "TraceMatcher::SetMaxLag() Invalid lag [" << _lag << "]"
+              << std::endl;
+    return false;
+  }
+
+  this->dataPtr->maxLag = _lag;
+  return true;
+}
+
+//////////////////////////////////////////////////
+size_t TraceMatcher::Match(
+  const std::vector<ignition::math::SphericalCoordinates> &_trace,
+  std::vector<LaneMatch> &_matches) const
+{
+  _matches.clear();
+  _matches.reserve(_trace.size());
+  size_t matched = 0;
+  ViterbiStream stream(*this->dataPtr, [&](const LaneMatch &_match)
+    {
+      _matches.push_back(_match);
+      matched += _match.waypoint.Valid() ? 1 : 0;
+    });
+
+  for (auto const &fix : _trace)
+    stream.Push(fix);
+  stream.Finish();
+  return matched;
+}
+
+//////////////////////////////////////////////////
+bool TraceMatcher::Match(std::istream &_in, std::ostream &_out) const
+{
+  auto flags = _out.flags();
+  auto precision = _out.precision();
+  _out << std::fixed << std::setprecision(3);
+
+  ViterbiStream stream(*this->dataPtr, [&](const LaneMatch &_match)
+    {
+      if (!_match.waypoint.Valid())
+      {
+        _out << "-\n";
+        return;
+      }
+      _out << _match.waypoint << " " << _match.index << " " << _match.offset
+           << " " << _match.distance << " " << _match.progress << "\n";
+    });
+
+  bool valid = true;
+  std::string line;
+  while (std::getline(_in, line))
+  {
+    auto first = line.find_first_not_of(" \t\r");
+    if (first == std::string::npos || line[first] == '#')
+      continue;
+
+    std::istringstream fields(line);
+    double latitude;
+    double longitude;
+    if (!(fields >> latitude >> longitude))
+    {
+      std::cerr << "TraceMatcher::Match() Unable to parse line [" << line
+                << "]" << std::endl;
+      valid = false;
+      break;
+    }
+
+    stream.Push(ignition::math::SphericalCoordinates(
+      ignition::math::SphericalCoordinates::EARTH_WGS84,
+      ignition::math::Angle(IGN_DTOR(latitude)),
+      ignition::math::Angle(IGN_DTOR(longitude)),
+      0.0, ignition::math::Angle::Zero));
+  }
+  stream.Finish();
+
+  _out.flags(flags);
+  _out.precision(precision);
+  return valid && _out.good();
+}
+
+//////////////////////////////////////////////////
+size_t TraceMatcher::Match(const std::vector<std::string> &_inputs,
+  const std::vector<std::string> &_outputs,
+  const unsigned int _threads) const
+{
+  if (_inputs.size() != _outputs.size())
+  {
+    std::cerr << "TraceMatcher::Match() The number of inputs ["
+              << _inputs.size() << "] and outputs [" << _outputs.size()
+              << "] differ" << std::endl;
+    return 0;
+  }
+
+  auto workers = workerCount(_threads, _inputs.size());
+  std::vector<size_t> counts(workers, 0);
+  parallelFor(_inputs.size(), workers,
+    [&](const size_t _i, const unsigned int _worker)
+    {
+      std::ifstream in(_inputs[_i]);
+      std::ofstream out(_outputs[_i]);
+      if (!in.is_open() || !out.is_open())
+      {
+        std::cerr << "TraceMatcher::Match() Unable to open ["
+                  << _inputs[_i] << "] or [" << _outputs[_i] << "]"
+                  << std::endl;
+        return;
+      }
+
+      if (this->Match(in, out))
+        ++counts[_worker];
+    });
+
+  size_t matched = 0;
+  for (auto const &count : counts)
+    matched += count;
+  return matched;
+}
@@ -0,0 +1,190 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <ignition/math/Angle.hh>
+#include <ignition/math/Helpers.hh>
+#include <ignition/math/SphericalCoordinates.hh>
+
+#include "manifold/rndf/Lane.hh"
+#include "manifold/rndf/RNDF.hh"
+#include "manifold/rndf/Segment.hh"
+#include "manifold/rndf/UniqueId.hh"
+#include "manifold/rndf/Waypoint.hh"
+#include "manifold/LaneMatcher.hh"
+#include "manifold/RoadNetwork.hh"
+#include "manifold/TraceMatcher.hh"
+#include "manifold/test_config.h"
+#include "performance/fixtures.hh"
+#include "gtest/gtest.h"
+
+using namespace manifold;
+using test::location;
+using test::roadRNDF;
+
+/// \brief A trace driving east on lane 1, every 10 m, with a GPS error
+/// that puts every other fix closer to lane 2.
+/// \return The trace.
+std::vector<ignition::math::SphericalCoordinates> eastTrace()
+{
+  std::vector<ignition::math::SphericalCoordinates> trace;
+  for (int i = 0; i < 24; ++i)
+  {
+    double lat = i % 2 == 0 ? 36.999995 : 37.0000234;
+    trace.push_back(location(lat, -121.9998 + i * 1.12e-4));
+  }
+  return trace;
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the parameters.
+TEST(TraceMatcher, Parameters)
+{
+  rndf::RNDF rndf;
+  roadRNDF(rndf);
+  RoadNetwork roadNetwork(rndf);
+  TraceMatcher matcher(rndf, roadNetwork);
+
+  EXPECT_DOUBLE_EQ(matcher.GpsNoise(), 5.0);
+  EXPECT_TRUE(matcher.SetGpsNoise(3.0));
+  EXPECT_DOUBLE_EQ(matcher.GpsNoise(), 3.0);
+  EXPECT_FALSE(matcher.SetGpsNoise(0.0));
+  EXPECT_DOUBLE_EQ(matcher.GpsNoise(), 3.0);
+
+  EXPECT_DOUBLE_EQ(matcher.TransitionScale(), 10.0);
+  EXPECT_TRUE(matcher.SetTransitionScale(2.0));
+  EXPECT_DOUBLE_EQ(matcher.TransitionScale(), 2.0);
+  EXPECT_FALSE(matcher.SetTransitionScale(-1.0));
+
+  EXPECT_DOUBLE_EQ(matcher.SearchRadius(), 25.0);
+  EXPECT_TRUE(matcher.SetSearchRadius(40.0));
+  EXPECT_DOUBLE_EQ(matcher.SearchRadius(), 40.0);
+  EXPECT_FALSE(matcher.SetSearchRadius(0.0));
+
+  EXPECT_EQ(matcher.MaxLag(), 64u);
+  EXPECT_TRUE(matcher.SetMaxLag(8));
+  EXPECT_EQ(matcher.MaxLag(), 8u);
+  EXPECT_FALSE(matcher.SetMaxLag(0));
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that the matcher follows the lane that can be driven
+/// rather than the closest one.
+TEST(TraceMatcher, Match)
+{
+  rndf::RNDF rndf;
+  roadRNDF(rndf);
+  RoadNetwork roadNetwork(rndf);
+  TraceMatcher matcher(rndf, roadNetwork);
+  auto trace = eastTrace();
+
+  // Matching each fix independently jumps between the lanes.
+  LaneMatcher lanes(rndf);
+  LaneMatch match;
+  ASSERT_TRUE(lanes.Match(trace[1], match));
+  EXPECT_EQ(match.waypoint.Y(), 2);
+
+  for (size_t lag : {64u, 4u, 1u})
+  {
+    ASSERT_TRUE(matcher.SetMaxLag(lag));
+    std::vector<LaneMatch> matches;
+    EXPECT_EQ(matcher.Match(trace, matches), trace.size());
+    ASSERT_EQ(matches.size(), trace.size());
+    for (size_t i = 0; i < matches.size(); ++i)
+    {
+      EXPECT_EQ(matches[i].waypoint.X(), 1);
+      EXPECT_EQ(matches[i].waypoint.Y(), 1);
+      if (i > 0)
+      {
+        EXPECT_GT(matches[i].progress, matches[i - 1].progress);
+      }
+    }
+  }
+
+  // A fix far from the road breaks the trace.
+  trace.insert(trace.begin() + 10, location(37.01, -121.998));
+  std::vector<LaneMatch> matches;
+  EXPECT_EQ(matcher.Match(trace, matches), trace.size() - 1);
+  ASSERT_EQ(matches.size(), trace.size());
+  EXPECT_FALSE(matches[10].waypoint.Valid());
+  EXPECT_EQ(matches[11].waypoint.Y(), 1);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the matching of streams and files.
+TEST(TraceMatcher, Streams)
+{
+  rndf::RNDF rndf;
+  roadRNDF(rndf);
+  RoadNetwork roadNetwork(rndf);
+  TraceMatcher matcher(rndf, roadNetwork);
+
+  std::stringstream in;
+  in.precision(10);
+  in << "# latitude longitude\n\n";
+  for (auto const &fix : eastTrace())
+  {
+    in << fix.LatitudeReference().Degree() << " "
+       << fix.LongitudeReference().Degree() << "\n";
+  }
+  in << "37.01 -121.998\n";
+
+  std::stringstream out;
+  ASSERT_TRUE(matcher.Match(in, out));
+  std::vector<std::string> lines;
+  std::string line;
+  while (std::getline(out, line))
+    lines.push_back(line);
+  ASSERT_EQ(lines.size(), eastTrace().size() + 1);
+  EXPECT_EQ(lines.front().substr(0, 6), "1.1.1 ");
+  EXPECT_EQ(lines.back(), "-");
+
+  // Malformed input.
+  std::stringstream bad("37.0 -122.0\n37.0\n");
+  std::stringstream badOut;
+  EXPECT_FALSE(matcher.Match(bad, badOut));
+
+  // Files matched in parallel give the same output.
+  std::vector<std::string> inputs;
+  std::vector<std::string> outputs;
+  for (int i = 0; i < 3; ++i)
+  {
+    inputs.push_back(testing::getRandomNumber() + ".trace");
+    outputs.push_back(testing::getRandomNumber() + ".matches");
+    std::ofstream file(inputs.back());
+    file << in.str();
+  }
+  inputs.push_back("missing.trace");
+  outputs.push_back(testing::getRandomNumber() + ".matches");
+
+  EXPECT_EQ(matcher.Match(inputs, outputs, 2), 3u);
+  for (int i = 0; i < 3; ++i)
+  {
+    std::ifstream file(outputs[i]);
+    std::stringstream content;
+    content << file.rdbuf();
+    EXPECT_EQ(content.str(), out.str());
+    std::remove(inputs[i].c_str());
+    std::remove(outputs[i].c_str());
+  }
+  std::remove(outputs.back().c_str());
+  EXPECT_EQ(matcher.Match(inputs, {}), 0u);
+}
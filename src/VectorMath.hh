@@ -0,0 +1,289 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef MANIFOLD_VECTORMATH_HH_
+#define MANIFOLD_VECTORMATH_HH_
+
+#include <cmath>
+#include <cstddef>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace manifold
+{
+  /// \internal
+  /// \brief Kernels of elementary functions over arrays of doubles, with a
+  /// SIMD (SSE2) implementation where available and a scalar one
+  /// otherwise. Both run the same sequence of correctly rounded operations,
+  /// so they return the same bits. The error is within a few ulps of the
+  /// standard library.
+  class VectorMath
+  {
+    /// \brief Whether the kernels use SIMD instructions.
+    /// \return True if they do.
+    public: static bool Vectorized()
+    {
+#if defined(__SSE2__)
+      return true;
+#else
+      return false;
+#endif
+    }
+
+    /// \brief Sine and cosine of an angle, with the scalar kernel.
+    /// \param[in] _x The angle (radians), with |_x| < 1e9.
+    /// \param[out] _sin Its sine.
+    /// \param[out] _cos Its cosine.
+    public: static void SinCos(const double _x, double &_sin, double &_cos)
+    {
+      // Reduce to r in [-pi/4, pi/4] and the quadrant q.
+      double k = std::nearbyint(_x * kTwoOverPi);
+      int q = static_cast<int>(k);
+      double r = ((_x - k * kPiOver2A) - k * kPiOver2B) - k * kPiOver2C;
+      double z = r * r;
+
+      double ps = kSin0;
+      ps = ps * z + kSin1;
+      ps = ps * z + kSin2;
+      ps = ps * z + kSin3;
+      ps = ps * z + kSin4;
+      ps = ps * z + kSin5;
+      double pc = kCos0;
+      pc = pc * z + kCos1;
+      pc = pc * z + kCos2;
+      pc = pc * z + kCos3;
+      pc = pc * z + kCos4;
+      pc = pc * z + kCos5;
+      double s = r + r * z * ps;
+      double c = (1.0 - 0.5 * z) + z * z * pc;
+
+      if (q & 1)
+      {
+        double t = s;
+        s = c;
+        c = t;
+      }
+      _sin = (q & 2) ? -s : s;
+      _cos = ((q + 1) & 2) ? -c : c;
+    }
+
+    /// \brief Sine and cosine of an array of angles.
+    /// \param[in] _x The angles (radians), with |_x[i]| < 1e9.
+    /// \param[in] _count Number of angles.
+    /// \param[out] _sin Sine of each angle.
+    /// \param[out] _cos Cosine of each angle.
+    public: static void SinCos(const double *_x, const size_t _count,
+                               double *_sin, double *_cos)
+    {
+      size_t i = 0;
+#if defined(__SSE2__)
+      const __m128d one = _mm_set1_pd(1.0);
+      const __m128d sign = _mm_set1_pd(-0.0);
+      const __m128i bit0 = _mm_set1_epi32(1);
+      const __m128i bit1 = _mm_set1_epi32(2);
+      for (; i + 2 <= _count; i += 2)
+      {
+        __m128d x = _mm_loadu_pd(_x + i);
+
+        // The conversion rounds to nearest even, like nearbyint().
+        __m128i q = _mm_cvtpd_epi32(_mm_mul_pd(x, _mm_set1_pd(kTwoOverPi)));
+        __m128d k = _mm_cvtepi32_pd(q);
+        __m128d r = _mm_sub_pd(x, _mm_mul_pd(k, _mm_set1_pd(kPiOver2A)));
+        r = _mm_sub_pd(r, _mm_mul_pd(k, _mm_set1_pd(kPiOver2B)));
+        r = _mm_sub_pd(r, _mm_mul_pd(k, _mm_set1_pd(kPiOver2C)));
+        __m128d z = _mm_mul_pd(r, r);
+
+        __m128d ps = _mm_set1_pd(kSin0);
+        ps = _mm_add_pd(_mm_mul_pd(ps, z), _mm_set1_pd(kSin1));
+        ps = _mm_add_pd(_mm_mul_pd(ps, z), _mm_set1_pd(kSin2));
+        ps = _mm_add_pd(_mm_mul_pd(ps, z), _mm_set1_pd(kSin3));
+        ps = _mm_add_pd(_mm_mul_pd(ps, z), _mm_set1_pd(kSin4));
+        ps = _mm_add_pd(_mm_mul_pd(ps, z), _mm_set1_pd(kSin5));
+        __m128d pc = _mm_set1_pd(kCos0);
+        pc = _mm_add_pd(_mm_mul_pd(pc, z), _mm_set1_pd(kCos1));
+        pc = _mm_add_pd(_mm_mul_pd(pc, z), _mm_set1_pd(kCos2));
+        pc = _mm_add_pd(_mm_mul_pd(pc, z), _mm_set1_pd(kCos3));
+        pc = _mm_add_pd(_mm_mul_pd(pc, z), _mm_set1_pd(kCos4));
+        pc = _mm_add_pd(_mm_mul_pd(pc, z), _mm_set1_pd(kCos5));
+        __m128d s = _mm_add_pd(r, _mm_mul_pd(_mm_mul_pd(r, z), ps));
+        __m128d c = _mm_add_pd(
+          _mm_sub_pd(one, _mm_mul_pd(_mm_set1_pd(0.5), z)),
+          _mm_mul_pd(_mm_mul_pd(z, z), pc));
+
+        // Masks of the quadrant bits, converted to doubles to get 64-bit
+        // lanes.
+        __m128d swap = _mm_cmpeq_pd(
+          _mm_cvtepi32_pd(_mm_and_si128(q, bit0)), one);
+        __m128d negSin = _mm_cmpeq_pd(
+          _mm_cvtepi32_pd(_mm_srli_epi32(_mm_and_si128(q, bit1), 1)), one);
+        __m128d negCos = _mm_cmpeq_pd(_mm_cvtepi32_pd(_mm_srli_epi32(
+          _mm_and_si128(_mm_add_epi32(q, bit0), bit1), 1)), one);
+
+        __m128d sq = Select(swap, c, s);
+        __m128d cq = Select(swap, s, c);
+        _mm_storeu_pd(_sin + i, _mm_xor_pd(sq, _mm_and_pd(negSin, sign)));
+        _mm_storeu_pd(_cos + i, _mm_xor_pd(cq, _mm_and_pd(negCos, sign)));
+      }
+#endif
+      for (; i < _count; ++i)
+        SinCos(_x[i], _sin[i], _cos[i]);
+    }
+
+    /// \brief Arcsine of a value, with the scalar kernel.
+    /// \param[in] _x The value, in [-1, 1].
+    /// \return Its arcsine (radians).
+    public: static double Asin(const double _x)
+    {
+      // Near 1, asin(x) = pi/2 - 2 asin(sqrt((1 - x) / 2)).
+      double ax = std::abs(_x);
+      bool big = ax >= 0.5;
+      double t = big ? (1.0 - ax) * 0.5 : ax * ax;
+      double s = big ? std::sqrt(t) : ax;
+      double r = s + s * AsinRatio(t);
+      double y = big ? kPiOver2Hi - (2.0 * r - kPiOver2Lo) : r;
+      return std::copysign(y, _x);
+    }
+
+    /// \brief Arcsine of an array of values.
+    /// \param[in] _x The values, in [-1, 1].
+    /// \param[in] _count Number of values.
+    /// \param[out] _asin Arcsine of each value (radians).
+    public: static void Asin(const double *_x, const size_t _count,
+                             double *_asin)
+    {
+      size_t i = 0;
+#if defined(__SSE2__)
+      const __m128d sign = _mm_set1_pd(-0.0);
+      const __m128d half = _mm_set1_pd(0.5);
+      const __m128d one = _mm_set1_pd(1.0);
+      const __m128d two = _mm_set1_pd(2.0);
+      for (; i + 2 <= _count; i += 2)
+      {
+        __m128d x = _mm_loadu_pd(_x + i);
+        __m128d xs = _mm_and_pd(x, sign);
+        __m128d ax = _mm_andnot_pd(sign, x);
+        __m128d big = _mm_cmpge_pd(ax, half);
+
+        __m128d t = Select(big, _mm_mul_pd(_mm_sub_pd(one, ax), half),
+                           _mm_mul_pd(ax, ax));
+        __m128d s = Select(big, _mm_sqrt_pd(t), ax);
+
+        __m128d p = _mm_set1_pd(kAsinP5);
+        p = _mm_add_pd(_mm_mul_pd(p, t), _mm_set1_pd(kAsinP4));
+        p = _mm_add_pd(_mm_mul_pd(p, t), _mm_set1_pd(kAsinP3));
+        p = _mm_add_pd(_mm_mul_pd(p, t), _mm_set1_pd(kAsinP2));
+        p = _mm_add_pd(_mm_mul_pd(p, t), _mm_set1_pd(kAsinP1));
+        p = _mm_add_pd(_mm_mul_pd(p, t), _mm_set1_pd(kAsinP0));
+        p = _mm_mul_pd(p, t);
+        __m128d q = _mm_set1_pd(kAsinQ4);
+        q = _mm_add_pd(_mm_mul_pd(q, t), _mm_set1_pd(kAsinQ3));
+        q = _mm_add_pd(_mm_mul_pd(q, t), _mm_set1_pd(kAsinQ2));
+        q = _mm_add_pd(_mm_mul_pd(q, t), _mm_set1_pd(kAsinQ1));
+        q = _mm_add_pd(_mm_mul_pd(q, t), one);
+
+        __m128d r = _mm_add_pd(s, _mm_mul_pd(s, _mm_div_pd(p, q)));
+        __m128d y = Select(big, _mm_sub_pd(_mm_set1_pd(kPiOver2Hi),
+          _mm_sub_pd(_mm_mul_pd(two, r), _mm_set1_pd(kPiOver2Lo))), r);
+        _mm_storeu_pd(_asin + i, _mm_or_pd(y, xs));
+      }
+#endif
+      for (; i < _count; ++i)
+        _asin[i] = Asin(_x[i]);
+    }
+
+    /// \brief Rational approximation of (asin(sqrt(t)) - sqrt(t)) /
+    /// sqrt(t) on [0, 1/4] (fdlibm).
+    /// \param[in] _t The argument.
+    /// \return The ratio.
+    private: static double AsinRatio(const double _t)
+    {
+      double p = kAsinP5;
+      p = p * _t + kAsinP4;
+      p = p * _t + kAsinP3;
+      p = p * _t + kAsinP2;
+      p = p * _t + kAsinP1;
+      p = p * _t + kAsinP0;
+      p = p * _t;
+      double q = kAsinQ4;
+      q = q * _t + kAsinQ3;
+      q = q * _t + kAsinQ2;
+      q = q * _t + kAsinQ1;
+      q = q * _t + 1.0;
+      return p / q;
+    }
+
+#if defined(__SSE2__)
+    /// \brief Select the lanes of two vectors.
+    /// \param[in] _mask All ones in the lanes to take from _a.
+    /// \param[in] _a First vector.
+    /// \param[in] _b Second vector.
+    /// \return The lanes of _a where the mask is set and of _b elsewhere.
+    private: static __m128d Select(const __m128d _mask, const __m128d _a,
+                                   const __m128d _b)
+    {
+      return _mm_or_pd(_mm_and_pd(_mask, _a), _mm_andnot_pd(_mask, _b));
+    }
+#endif
+
+    /// \brief 2 / pi.
+    private: static constexpr double kTwoOverPi = 0.63661977236758134308;
+
+    /// \brief pi / 2 split in three parts for the range reduction
+    /// (Cody-Waite): the first two have trailing zeros, so their products
+    /// with the quadrant are exact.
+    private: static constexpr double kPiOver2A = 1.57079625129699707031;
+    private: static constexpr double kPiOver2B = 7.54978941586159635335e-8;
+    private: static constexpr double kPiOver2C = 5.39030285815811905290e-15;
+
+    /// \brief Coefficients of the sine polynomial on [-pi/4, pi/4]
+    /// (Cephes).
+    private: static constexpr double kSin0 = 1.58962301576546568060e-10;
+    private: static constexpr double kSin1 = -2.50507477628578072866e-8;
+    private: static constexpr double kSin2 = 2.75573136213857245213e-6;
+    private: static constexpr double kSin3 = -1.98412698295895385996e-4;
+    private: static constexpr double kSin4 = 8.33333333332211858878e-3;
+    private: static constexpr double kSin5 = -1.66666666666666307295e-1;
+
+    /// \brief Coefficients of the cosine polynomial on [-pi/4, pi/4]
+    /// (Cephes).
+    private: static constexpr double kCos0 = -1.13585365213876817300e-11;
+    private: static constexpr double kCos1 = 2.08757008419747316778e-9;
+    private: static constexpr double kCos2 = -2.75573141792967388112e-7;
+    private: static constexpr double kCos3 = 2.48015872888517045348e-5;
+    private: static constexpr double kCos4 = -1.38888888888730564116e-3;
+    private: static constexpr double kCos5 = 4.16666666666665929218e-2;
+
+    /// \brief pi / 2 split in two parts for the arcsine near 1.
+    private: static constexpr double kPiOver2Hi = 1.57079632679489655800;
+    private: static constexpr double kPiOver2Lo = 6.12323399573676603587e-17;
+
+    /// \brief Coefficients of the arcsine approximation (fdlibm).
+    private: static constexpr double kAsinP0 = 1.66666666666666657415e-1;
+    private: static constexpr double kAsinP1 = -3.25565818622400915405e-1;
+    private: static constexpr double kAsinP2 = 2.01212532134862925881e-1;
+    private: static constexpr double kAsinP3 = -4.00555345006794114027e-2;
+    private: static constexpr double kAsinP4 = 7.91534994289814532176e-4;
+    private: static constexpr double kAsinP5 = 3.47933107596021167570e-5;
+    private: static constexpr double kAsinQ1 = -2.40339491173441421878;
+    private: static constexpr double kAsinQ2 = 2.02094576023350569471;
+    private: static constexpr double kAsinQ3 = -6.88283971605453293030e-1;
+    private: static constexpr double kAsinQ4 = 7.70381505559019352791e-2;
+  };
+}
+#endif
@@ -0,0 +1,279 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include <ignition/math/Helpers.hh>
+#include <ignition/math/SphericalCoordinates.hh>
+
+#include "manifold/rndf/Perimeter.hh"
+#include "manifold/rndf/RNDF.hh"
+#include "manifold/rndf/Waypoint.hh"
+#include "manifold/rndf/Zone.hh"
+#include "manifold/ZoneIndex.hh"
+#include "Common.hh"
+#include "SpatialGrid.hh"
+
+using namespace manifold;
+
+namespace
+{
+  /// \internal
+  /// \brief Side of a cell of the grid (meters along a meridian).
+  const double kCellSize = 200.0;
+}
+
+namespace manifold
+{
+  /// \internal
+  /// \brief The perimeter of a zone as a polygon of longitudes (x) and
+  /// latitudes (y), in radians. The edge i goes from (x0[i], y0[i]) to a
+  /// point with latitude y1[i].
+  class ZonePolygon
+  {
+    /// \brief Id of the zone.
+    public: int id;
+
+    /// \brief Longitude of the start of each edge.
+    public: std::vector<double> x0;
+
+    /// \brief Latitude of the start of each edge.
+    public: std::vector<double> y0;
+
+    /// \brief Latitude of the end of each edge.
+    public: std::vector<double> y1;
+
+    /// \brief Change of longitude per change of latitude along each edge,
+    /// or 0 if the edge is horizontal.
+    public: std::vector<double> slope;
+
+    /// \brief Whether a point is inside the polygon, by counting the edges
+    /// crossed by a ray going east from it.
+    /// \param[in] _x Longitude of the point.
+    /// \param[in] _y Latitude of the point.
+    /// \return True if the point is inside.
+    public: bool Contains(const double _x, const double _y) const
+    {
+      bool inside = false;
+      for (size_t e = 0; e < this->x0.size(); ++e)
+      {
+        bool straddles = (this->y0[e] > _y) != (this->y1[e] > _y);
+        double x = this->x0[e] + (_y - this->y0[e]) * this->slope[e];
+        inside ^= straddles && _x < x;
+      }
+      return inside;
+    }
+
+    /// \brief Test a batch of points. Each edge is tested against all the
+    /// points in a branch-free loop.
+    /// \param[in] _x Longitude of each point.
+    /// \param[in] _y Latitude of each point.
+    /// \param[in] _count Number of points.
+    /// \param[out] _inside 1 for the points inside, 0 for the others.
+    public: void Contains(const double *_x, const double *_y,
+      const size_t _count, uint8_t *_inside) const
+    {
+      std::fill(_inside, _inside + _count, 0);
+      for (size_t e = 0; e < this->x0.size(); ++e)
+      {
+        const double ex = this->x0[e];
+        const double ey0 = this->y0[e];
+        const double ey1 = this->y1[e];
+        const double k = this->slope[e];
+        for (size_t i = 0; i < _count; ++i)
+        {
+          uint8_t straddles = (ey0 > _y[i]) != (ey1 > _y[i]);
+          uint8_t left = _x[i] < ex + (_y[i] - ey0) * k;
+          _inside[i] ^= straddles & left;
+        }
+      }
+    }
+  };
+
+  /// \internal
+  /// \brief Private data for ZoneIndex class.
+  class ZoneIndexPrivate
+  {
+    /// \brief Constructor.
+    /// \param[in] _rndf The RNDF.
+    public: explicit ZoneIndexPrivate(const rndf::RNDF &_rndf)
+      : grid(kCellSize / kEarthRadius)
+    {
+      for (auto const &zone : _rndf.Zones())
+      {
+        auto const &points = zone.Perimeter().Points();
+        if (points.size() < 3)
+          continue;
+
+        ZonePolygon polygon;
+        polygon.id = zone.Id();
+        for (size_t i = 0; i < points.size(); ++i)
+        {
+          auto const &a = points[i].Location();
+          auto const &b = points[(i + 1) % points.size()].Location();
+          double xa = a.LongitudeReference().Radian();
+          double ya = a.LatitudeReference().Radian();
+          double xb = b.LongitudeReference().Radian();
+          double yb = b.LatitudeReference().Radian();
+          polygon.x0.push_back(xa);
+          polygon.y0.push_back(ya);
+          polygon.y1.push_back(yb);
+          polygon.slope.push_back(
+            std::abs(yb - ya) > 0 ? (xb - xa) / (yb - ya) : 0.0);
+        }
+        this->polygons.push_back(polygon);
+      }
+
+      // The lowest Ids first, so they win when zones overlap.
+      std::sort(this->polygons.begin(), this->polygons.end(),
+        [](const ZonePolygon &_a, const ZonePolygon &_b)
+        {
+          return _a.id < _b.id;
+        });
+
+      for (size_t p = 0; p < this->polygons.size(); ++p)
+      {
+        auto const &polygon = this->polygons[p];
+        auto const &xs = polygon.x0;
+        auto const &ys = polygon.y0;
+        this->grid.Insert(p, *std::min_element(xs.begin(), xs.end()),
+          *std::min_element(ys.begin(), ys.end()),
+          *std::max_element(xs.begin(), xs.end()),
+          *std::max_element(ys.begin(), ys.end()));
+      }
+    }
+
+    /// \brief Destructor.
+    public: virtual ~ZoneIndexPrivate() = default;
+
+    /// \brief Find the zone that contains a point.
+    /// \param[in] _x Longitude (radians).
+    /// \param[in] _y Latitude (radians).
+    /// \param[in,out] _nearby Buffer for the candidate zones.
+    /// \return Id of the zone or 0.
+    public: int ZoneAt(const double _x, const double _y,
+                       std::vector<size_t> &_nearby) const
+    {
+      this->grid.Query(_x, _y, _x, _y, _nearby);
+      for (auto const &p : _nearby)
+      {
+        if (this->polygons[p].Contains(_x, _y))
+          return this->polygons[p].id;
+      }
+      return 0;
+    }
+
+    /// \brief The polygons, in increasing order of zone Id.
+    public: std::vector<ZonePolygon> polygons;
+
+    /// \brief Index of the polygons by their bounding box.
+    public: SpatialGrid grid;
+  };
+}
+
+//////////////////////////////////////////////////
+ZoneIndex::ZoneIndex(const rndf::RNDF &_rndf)
+  : dataPtr(new ZoneIndexPrivate(_rndf))
+{
+}
+
+//////////////////////////////////////////////////
+ZoneIndex::~ZoneIndex()
+{
+}
+
+//////////////////////////////////////////////////
+size_t ZoneIndex::Size() const
+{
+  return this->dataPtr->polygons.size();
+}
+
+//////////////////////////////////////////////////
+int ZoneIndex::ZoneAt(const double _latitude, const double _longitude) const
+{
+  std::vector<size_t> nearby;
+  return this->dataPtr->ZoneAt(IGN_DTOR(_longitude), IGN_DTOR(_latitude),
+                               nearby);
+}
+
+//////////////////////////////////////////////////
+int ZoneIndex::ZoneAt(
+  const ignition::math::SphericalCoordinates &_location) const
+{
+  std::vector<size_t> nearby;
+  return this->dataPtr->ZoneAt(_location.LongitudeReference().Radian(),
+    _location.LatitudeReference().Radian(), nearby);
+}
+
+//////////////////////////////////////////////////
+size_t ZoneIndex::ZoneAt(
+  const std::vector<ignition::math::SphericalCoordinates> &_locations,
+  std::vector<int> &_zones) const
+{
+  auto const &d = *this->dataPtr;
+  _zones.assign(_locations.size(), 0);
+
+  // Group the locations by candidate zone.
+  std::vector<std::vector<size_t>> candidates(d.polygons.size());
+  std::vector<size_t> nearby;
+  for (size_t i = 0; i < _locations.size(); ++i)
+  {
+    double x = _locations[i].LongitudeReference().Radian();
+    double y = _locations[i].LatitudeReference().Radian();
+    d.grid.Query(x, y, x, y, nearby);
+    for (auto const &p : nearby)
+      candidates[p].push_back(i);
+  }
+
+  // Test each zone against its candidates not found in a lower zone yet.
+  size_t found = 0;
+  std::vector<size_t> indexes;
+  std::vector<double> xs;
+  std::vector<double> ys;
+  std::vector<uint8_t> inside;
+  for (size_t p = 0; p < d.polygons.size(); ++p)
+  {
+    indexes.clear();
+    xs.clear();
+    ys.clear();
+    for (auto const &i : candidates[p])
+    {
+      if (_zones[i] != 0)
+        continue;
+      indexes.push_back(i);
+      xs.push_back(_locations[i].LongitudeReference().Radian());
+      ys.push_back(_locations[i].LatitudeReference().Radian());
+    }
+    if (indexes.empty())
+      continue;
+
+    inside.resize(indexes.size());
+    d.polygons[p].Contains(xs.data(), ys.data(), indexes.size(),
+                           inside.data());
+    for (size_t j = 0; j < indexes.size(); ++j)
+    {
+      if (inside[j])
+      {
+        _zones[indexes[j]] = d.polygons[p].id;
+        ++found;
+      }
+    }
+  }
+  return found;
+}
@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include <ignition/math/Angle.hh>
+#include <ignition/math/Helpers.hh>
+#include <ignition/math/SphericalCoordinates.hh>
+
+#include "manifold/rndf/Perimeter.hh"
+#include "manifold/rndf/RNDF.hh"
+#include "manifold/rndf/Waypoint.hh"
+#include "manifold/rndf/Zone.hh"
+#include "manifold/ZoneIndex.hh"
+#include "manifold/test_config.h"
+#include "performance/fixtures.hh"
+#include "gtest/gtest.h"
+
+using namespace manifold;
+using test::location;
+
+/// \brief Add a zone to an RNDF.
+/// \param[in] _id Id of the zone.
+/// \param[in] _points Latitude and longitude (degrees) of the perimeter.
+/// \param[in,out] _rndf The RNDF.
+void addZone(const int _id,
+  const std::vector<std::pair<double, double>> &_points, rndf::RNDF &_rndf)
+{
+  rndf::Zone zone(_id);
+  for (size_t i = 0; i < _points.size(); ++i)
+  {
+    zone.Perimeter().AddPoint(rndf::Waypoint(static_cast<int>(i) + 1,
+      location(_points[i].first, _points[i].second)));
+  }
+  ASSERT_TRUE(_rndf.AddZone(zone));
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the zones of a sample RNDF.
+TEST(ZoneIndex, Sample)
+{
+  std::string dirPath(std::string(PROJECT_SOURCE_PATH));
+  rndf::RNDF rndf(dirPath + "/test/rndf/sample1.rndf");
+  ASSERT_TRUE(rndf.Valid());
+
+  ZoneIndex index(rndf);
+  EXPECT_EQ(index.Size(), rndf.NumZones());
+  EXPECT_EQ(index.ZoneAt(38.8721, -77.2028), 14);
+  EXPECT_EQ(index.ZoneAt(location(38.8721, -77.2028)), 14);
+  EXPECT_EQ(index.ZoneAt(38.8730, -77.2028), 0);
+  EXPECT_EQ(index.ZoneAt(38.8721, -77.2040), 0);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check concave and overlapping zones.
+TEST(ZoneIndex, Polygons)
+{
+  rndf::RNDF rndf;
+  ZoneIndex empty(rndf);
+  EXPECT_EQ(empty.Size(), 0u);
+  EXPECT_EQ(empty.ZoneAt(37.0, -122.0), 0);
+
+  // An L shape: the north-east quarter of the square is missing.
+  addZone(3, {{37.0, -122.0}, {37.0, -121.998}, {37.001, -121.998},
+              {37.001, -121.999}, {37.002, -121.999}, {37.002, -122.0}},
+          rndf);
+  // A square overlapping the south-east corner of the L.
+  addZone(2, {{36.9995, -121.9985}, {36.9995, -121.997},
+              {37.0005, -121.997}, {37.0005, -121.9985}}, rndf);
+  // A degenerate zone.
+  addZone(1, {{37.01, -122.0}, {37.01, -121.99}}, rndf);
+
+  ZoneIndex index(rndf);
+  EXPECT_EQ(index.Size(), 2u);
+  EXPECT_EQ(index.ZoneAt(37.0015, -121.9995), 3);
+  EXPECT_EQ(index.ZoneAt(37.0005, -121.9995), 3);
+  EXPECT_EQ(index.ZoneAt(37.0015, -121.9985), 0);
+  EXPECT_EQ(index.ZoneAt(37.0008, -121.9982), 3);
+  EXPECT_EQ(index.ZoneAt(37.0002, -121.9982), 2);
+  EXPECT_EQ(index.ZoneAt(37.0002, -121.9975), 2);
+  EXPECT_EQ(index.ZoneAt(37.01, -121.995), 0);
+
+  // The batch query gives the same results.
+  std::mt19937 generator(5);
+  std::uniform_real_distribution<double> lat(36.999, 37.003);
+  std::uniform_real_distribution<double> lon(-122.001, -121.996);
+  std::vector<ignition::math::SphericalCoordinates> locations;
+  for (int i = 0; i < 2000; ++i)
+    locations.push_back(location(lat(generator), lon(generator)));
+
+  std::vector<int> zones;
+  size_t found = index.ZoneAt(locations, zones);
+  ASSERT_EQ(zones.size(), locations.size());
+  size_t expected = 0;
+  for (size_t i = 0; i < locations.size(); ++i)
+  {
+    int zone = index.ZoneAt(locations[i]);
+    EXPECT_EQ(zones[i], zone);
+    expected += zone != 0 ? 1 : 0;
+  }
+  EXPECT_EQ(found, expected);
+  EXPECT_GT(found, 0u);
+}
@@ -186,6 +186,12 @@ ignition::math::SphericalCoordinates &Waypoint::Location()
   return this->dataPtr->location;
 }
 
+//////////////////////////////////////////////////
+const ignition::math::SphericalCoordinates &Waypoint::Location() const
+{
+  return this->dataPtr->location;
+}
+
 //////////////////////////////////////////////////
 bool Waypoint::Valid() const
 {
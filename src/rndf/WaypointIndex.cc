@@ -0,0 +1,360 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <queue>
+#include <utility>
+#include <vector>
+#include <ignition/math/Angle.hh>
+#include <ignition/math/SphericalCoordinates.hh>
+
+#include "manifold/rndf/Lane.hh"
+#include "manifold/rndf/ParkingSpot.hh"
+#include "manifold/rndf/Perimeter.hh"
+#include "manifold/rndf/RNDF.hh"
+#include "manifold/rndf/Segment.hh"
+#include "manifold/rndf/UniqueId.hh"
+#include "manifold/rndf/Waypoint.hh"
+#include "manifold/rndf/WaypointIndex.hh"
+#include "manifold/rndf/Zone.hh"
+#include "../Common.hh"
+
+using namespace manifold;
+using namespace rndf;
+
+namespace
+{
+  /// \brief Relative slack of the chord bound of the radius queries, so
+  /// rounding can't drop a waypoint right at the radius.
+  const double kSlack = 1e-9;
+}
+
+namespace manifold
+{
+  namespace rndf
+  {
+    /// \internal
+    /// \brief A waypoint of the index.
+    class IndexedWaypoint
+    {
+      /// \brief Position on the sphere (meters).
+      public: double point[3];
+
+      /// \brief Latitude.
+      public: ignition::math::Angle latitude;
+
+      /// \brief Longitude.
+      public: ignition::math::Angle longitude;
+
+      /// \brief Unique Id of the waypoint.
+      public: UniqueId id;
+    };
+
+    /// \internal
+    /// \brief Private data for WaypointIndex class.
+    class WaypointIndexPrivate
+    {
+      /// \brief Constructor.
+      /// \param[in] _rndf The RNDF.
+      public: explicit WaypointIndexPrivate(const RNDF &_rndf)
+      {
+        for (auto const &segment : _rndf.Segments())
+        {
+          for (auto const &lane : segment.Lanes())
+          {
+            for (auto const &wp : lane.Waypoints())
+            {
+              this->Add(UniqueId(segment.Id(), lane.Id(), wp.Id()),
+                        wp.Location());
+            }
+          }
+        }
+
+        for (auto const &zone : _rndf.Zones())
+        {
+          for (auto const &wp : zone.Perimeter().Points())
+            this->Add(UniqueId(zone.Id(), 0, wp.Id()), wp.Location());
+
+          for (auto const &spot : zone.Spots())
+          {
+            for (auto const &wp : spot.Waypoints())
+            {
+              this->Add(UniqueId(zone.Id(), spot.Id(), wp.Id()),
+                        wp.Location());
+            }
+          }
+        }
+
+        this->Build(0, this->waypoints.size(), 0);
+      }
+
+      /// \brief Destructor.
+      public: virtual ~WaypointIndexPrivate() = default;
+
+      /// \brief Position of a location on the sphere. The length of the
+      /// chord between two positions grows with their great-circle
+      /// distance, so both have the same nearest neighbors.
+      /// \param[in] _latitude Latitude.
+      /// \param[in] _longitude Longitude.
+      /// \param[out] _point The position (meters).
+      public: static void Position(const ignition::math::Angle &_latitude,
+        const ignition::math::Angle &_longitude, double _point[3])
+      {
+        double lat = _latitude.Radian();
+        double lon = _longitude.Radian();
+        _point[0] = kEarthRadius * std::cos(lat) * std::cos(lon);
+        _point[1] = kEarthRadius * std::cos(lat) * std::sin(lon);
+        _point[2] = kEarthRadius * std::sin(lat);
+      }
+
+      /// \brief Squared length of the chord between two positions.
+      /// \param[in] _a First position.
+      /// \param[in] _b Second position.
+      /// \return The squared length (square meters).
+      public: static double Chord2(const double _a[3], const double _b[3])
+      {
+        double dx = _a[0] - _b[0];
+        double dy = _a[1] - _b[1];
+        double dz = _a[2] - _b[2];
+        return dx * dx + dy * dy + dz * dz;
+      }
+
+      /// \brief Add a waypoint.
+      /// \param[in] _id Unique Id of the waypoint.
+      /// \param[in] _location Location of the waypoint.
+      public: void Add(const UniqueId &_id,
+        const ignition::math::SphericalCoordinates &_location)
+      {
+        IndexedWaypoint wp;
+        wp.latitude = _location.LatitudeReference();
+        wp.longitude = _location.LongitudeReference();
+        Position(wp.latitude, wp.longitude, wp.point);
+        wp.id = _id;
+        this->waypoints.push_back(wp);
+      }
+
+      /// \brief Arrange a range of waypoints as a k-d tree: the median along
+      /// the splitting axis goes in the middle, the waypoints below it on
+      /// its left and the ones above it on its right.
+      /// \param[in] _begin First waypoint of the range.
+      /// \param[in] _end One past the last waypoint of the range.
+      /// \param[in] _axis Splitting axis.
+      public: void Build(const size_t _begin, const size_t _end,
+                         const size_t _axis)
+      {
+        if (_end - _begin < 2)
+          return;
+
+        size_t mid = _begin + (_end - _begin) / 2;
+        std::nth_element(this->waypoints.begin() + _begin,
+          this->waypoints.begin() + mid, this->waypoints.begin() + _end,
+          [_axis](const IndexedWaypoint &_a, const IndexedWaypoint &_b)
+          {
+            return _a.point[_axis] < _b.point[_axis];
+          });
+
+        this->Build(_begin, mid, (_axis + 1) % 3);
+        this->Build(mid + 1, _end, (_axis + 1) % 3);
+      }
+
+      /// \brief Find the k waypoints closest to a position in a range of
+      /// the tree.
+      /// \param[in] _point The position.
+      /// \param[in] _k Number of waypoints.
+      /// \param[in] _begin First waypoint of the range.
+      /// \param[in] _end One past the last waypoint of the range.
+      /// \param[in] _axis Splitting axis.
+      /// \param[in,out] _best Max-heap of the closest waypoints found, as
+      /// (squared chord, index) pairs.
+      public: void Nearest(const double _point[3], const size_t _k,
+        const size_t _begin, const size_t _end, const size_t _axis,
+        std::priority_queue<std::pair<double, size_t>> &_best) const
+      {
+        if (_begin >= _end)
+          return;
+
+        size_t mid = _begin + (_end - _begin) / 2;
+        auto const &wp = this->waypoints[mid];
+        double d2 = Chord2(_point, wp.point);
+        if (_best.size() < _k)
+          _best.push(std::make_pair(d2, mid));
+        else if (d2 < _best.top().first)
+        {
+          _best.pop();
+          _best.push(std::make_pair(d2, mid));
+        }
+
+        // Search the side of the position first.
+        double diff = _point[_axis] - wp.point[_axis];
+        size_t next = (_axis + 1) % 3;
+        if (diff < 0)
+          this->Nearest(_point, _k, _begin, mid, next, _best);
+        else
+          this->Nearest(_point, _k, mid + 1, _end, next, _best);
+
+        if (_best.size() < _k || diff * diff < _best.top().first)
+        {
+          if (diff < 0)
+            this->Nearest(_point, _k, mid + 1, _end, next, _best);
+          else
+            this->Nearest(_point, _k, _begin, mid, next, _best);
+        }
+      }
+
+      /// \brief Find the waypoints within a chord of a position in a range
+      /// of the tree.
+      /// \param[in] _point The position.
+      /// \param[in] _chord2 Maximum squared chord (square meters).
+      /// \param[in] _begin First waypoint of the range.
+      /// \param[in] _end One past the last waypoint of the range.
+      /// \param[in] _axis Splitting axis.
+      /// \param[out] _found Indexes of the waypoints found.
+      public: void Within(const double _point[3], const double _chord2,
+        const size_t _begin, const size_t _end, const size_t _axis,
+        std::vector<size_t> &_found) const
+      {
+        if (_begin >= _end)
+          return;
+
+        size_t mid = _begin + (_end - _begin) / 2;
+        auto const &wp = this->waypoints[mid];
+        if (Chord2(_point, wp.point) <= _chord2)
+          _found.push_back(mid);
+
+        double diff = _point[_axis] - wp.point[_axis];
+        size_t next = (_axis + 1) % 3;
+        if (diff < 0 || diff * diff <= _chord2)
+          this->Within(_point, _chord2, _begin, mid, next, _found);
+        if (diff >= 0 || diff * diff <= _chord2)
+          this->Within(_point, _chord2, mid + 1, _end, next, _found);
+      }
+
+      /// \brief Great-circle distance between a location and a waypoint.
+      /// \param[in] _location The location.
+      /// \param[in] _index Index of the waypoint.
+      /// \return The distance (meters).
+      public: double Distance(
+        const ignition::math::SphericalCoordinates &_location,
+        const size_t _index) const
+      {
+        auto const &wp = this->waypoints[_index];
+        return ignition::math::SphericalCoordinates::Distance(
+          _location.LatitudeReference(), _location.LongitudeReference(),
+          wp.latitude, wp.longitude);
+      }
+
+      /// \brief The waypoints, arranged as an implicit k-d tree.
+      public: std::vector<IndexedWaypoint> waypoints;
+    };
+  }
+}
+
+//////////////////////////////////////////////////
+WaypointIndex::WaypointIndex(const RNDF &_rndf)
+  : dataPtr(new WaypointIndexPrivate(_rndf))
+{
+}
+
+//////////////////////////////////////////////////
+WaypointIndex::~WaypointIndex()
+{
+}
+
+//////////////////////////////////////////////////
+size_t WaypointIndex::Size() const
+{
+  return this->dataPtr->waypoints.size();
+}
+
+//////////////////////////////////////////////////
+bool WaypointIndex::Nearest(
+  const ignition::math::SphericalCoordinates &_location, UniqueId &_id,
+  double &_distance) const
+{
+  std::vector<std::pair<UniqueId, double>> nearest;
+  this->Nearest(_location, 1, nearest);
+  if (nearest.empty())
+    return false;
+
+  _id = nearest.front().first;
+  _distance = nearest.front().second;
+  return true;
+}
+
+//////////////////////////////////////////////////
+void WaypointIndex::Nearest(
+  const ignition::math::SphericalCoordinates &_location, const size_t _k,
+  std::vector<std::pair<UniqueId, double>> &_nearest) const
+{
+  _nearest.clear();
+  auto const &d = *this->dataPtr;
+  if (_k == 0 || d.waypoints.empty())
+    return;
+
+  double point[3];
+  WaypointIndexPrivate::Position(_location.LatitudeReference(),
+    _location.LongitudeReference(), point);
+
+  std::priority_queue<std::pair<double, size_t>> best;
+  d.Nearest(point, _k, 0, d.waypoints.size(), 0, best);
+
+  _nearest.resize(best.size());
+  for (size_t i = best.size(); i > 0; --i)
+  {
+    auto index = best.top().second;
+    _nearest[i - 1] =
+      std::make_pair(d.waypoints[index].id, d.Distance(_location, index));
+    best.pop();
+  }
+}
+
+//////////////////////////////////////////////////
+void WaypointIndex::Within(
+  const ignition::math::SphericalCoordinates &_location,
+  const double _radius,
+  std::vector<std::pair<UniqueId, double>> &_within) const
+{
+  _within.clear();
+  auto const &d = *this->dataPtr;
+  if (_radius < 0 || d.waypoints.empty())
+    return;
+
+  double point[3];
+  WaypointIndexPrivate::Position(_location.LatitudeReference(),
+    _location.LongitudeReference(), point);
+
+  // Length of the chord of an arc of the radius.
+  double angle = std::min(_radius / kEarthRadius, M_PI);
+  double chord = 2 * kEarthRadius * std::sin(angle / 2) * (1 + kSlack);
+  std::vector<size_t> found;
+  d.Within(point, chord * chord + kSlack, 0, d.waypoints.size(), 0, found);
+
+  for (auto const &index : found)
+  {
+    double distance = d.Distance(_location, index);
+    if (distance <= _radius)
+      _within.push_back(std::make_pair(d.waypoints[index].id, distance));
+  }
+
+  std::sort(_within.begin(), _within.end(),
+    [](const std::pair<UniqueId, double> &_a,
+       const std::pair<UniqueId, double> &_b)
+    {
+      return _a.second < _b.second;
+    });
+}
@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include <ignition/math/Angle.hh>
+#include <ignition/math/SphericalCoordinates.hh>
+
+#include "performance/fixtures.hh"
+#include "gtest/gtest.h"
+#include "manifold/test_config.h"
+#include "manifold/rndf/Lane.hh"
+#include "manifold/rndf/ParkingSpot.hh"
+#include "manifold/rndf/Perimeter.hh"
+#include "manifold/rndf/RNDF.hh"
+#include "manifold/rndf/Segment.hh"
+#include "manifold/rndf/UniqueId.hh"
+#include "manifold/rndf/Waypoint.hh"
+#include "manifold/rndf/WaypointIndex.hh"
+#include "manifold/rndf/Zone.hh"
+
+using namespace manifold;
+using namespace rndf;
+using test::location;
+
+/// \brief Distances from a location to all the waypoints of an RNDF, in
+/// increasing order.
+/// \param[in] _rndf The RNDF.
+/// \param[in] _location The location.
+/// \return The distances.
+std::vector<double> allDistances(const RNDF &_rndf,
+  const ignition::math::SphericalCoordinates &_location)
+{
+  std::vector<Waypoint> waypoints;
+  for (auto const &segment : _rndf.Segments())
+  {
+    for (auto const &lane : segment.Lanes())
+    {
+      waypoints.insert(waypoints.end(), lane.Waypoints().begin(),
+                       lane.Waypoints().end());
+    }
+  }
+  for (auto const &zone : _rndf.Zones())
+  {
+    waypoints.insert(waypoints.end(), zone.Perimeter().Points().begin(),
+                     zone.Perimeter().Points().end());
+    for (auto const &spot : zone.Spots())
+    {
+      waypoints.insert(waypoints.end(), spot.Waypoints().begin(),
+                       spot.Waypoints().end());
+    }
+  }
+
+  std::vector<double> distances;
+  for (auto const &wp : waypoints)
+  {
+    distances.push_back(ignition::math::SphericalCoordinates::Distance(
+      _location.LatitudeReference(), _location.LongitudeReference(),
+      wp.Location().LatitudeReference(),
+      wp.Location().LongitudeReference()));
+  }
+  std::sort(distances.begin(), distances.end());
+  return distances;
+}
+
+//////////////////////////////////////////////////
+/// \brief Check an index of an empty RNDF.
+TEST(WaypointIndex, Empty)
+{
+  RNDF rndf;
+  WaypointIndex index(rndf);
+  EXPECT_EQ(index.Size(), 0u);
+
+  UniqueId id;
+  double distance;
+  EXPECT_FALSE(index.Nearest(location(0, 0), id, distance));
+
+  std::vector<std::pair<UniqueId, double>> found;
+  index.Nearest(location(0, 0), 3, found);
+  EXPECT_TRUE(found.empty());
+  index.Within(location(0, 0), 1000.0, found);
+  EXPECT_TRUE(found.empty());
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the queries against a scan of all the waypoints.
+TEST(WaypointIndex, Queries)
+{
+  std::string dirPath(std::string(PROJECT_SOURCE_PATH));
+  RNDF rndf(dirPath + "/test/rndf/sample2.rndf");
+  ASSERT_TRUE(rndf.Valid());
+
+  WaypointIndex index(rndf);
+  auto const &zone = rndf.Zones().front();
+  auto const &wp = zone.Perimeter().Points().front();
+  auto const &origin = wp.Location();
+
+  // The waypoints of the lanes, the perimeters and the parking spots.
+  EXPECT_EQ(index.Size(), allDistances(rndf, origin).size());
+
+  // A waypoint is its own nearest neighbor.
+  UniqueId id;
+  double distance;
+  ASSERT_TRUE(index.Nearest(origin, id, distance));
+  EXPECT_EQ(id, UniqueId(zone.Id(), 0, wp.Id()));
+  EXPECT_NEAR(distance, 0.0, 1e-6);
+
+  // Random locations around the RNDF.
+  std::mt19937 generator(7);
+  std::uniform_real_distribution<double> offset(-0.01, 0.01);
+  double lat = origin.LatitudeReference().Degree();
+  double lon = origin.LongitudeReference().Degree();
+  for (int i = 0; i < 50; ++i)
+  {
+    auto query = location(lat + offset(generator), lon + offset(generator));
+    auto expected = allDistances(rndf, query);
+
+    std::vector<std::pair<UniqueId, double>> nearest;
+    index.Nearest(query, 10, nearest);
+    ASSERT_EQ(nearest.size(), 10u);
+    for (size_t j = 0; j < nearest.size(); ++j)
+      EXPECT_NEAR(nearest[j].second, expected[j], 1e-6);
+
+    const double kRadius = 250.0;
+    std::vector<std::pair<UniqueId, double>> within;
+    index.Within(query, kRadius, within);
+    auto count = std::upper_bound(expected.begin(), expected.end(),
+                                  kRadius) - expected.begin();
+    ASSERT_EQ(within.size(), static_cast<size_t>(count));
+    for (size_t j = 0; j < within.size(); ++j)
+      EXPECT_NEAR(within[j].second, expected[j], 1e-6);
+  }
+
+  // Asking for more waypoints than indexed returns all of them.
+  std::vector<std::pair<UniqueId, double>> all;
+  index.Nearest(origin, index.Size() + 5, all);
+  EXPECT_EQ(all.size(), index.Size());
+  for (size_t j = 1; j < all.size(); ++j)
+    EXPECT_LE(all[j - 1].second, all[j].second);
+}
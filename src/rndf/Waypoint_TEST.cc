@@ -86,6 +86,10 @@ TEST(Waypoint, location)
   location.SetElevationReference(newElev);
   EXPECT_TRUE(
     ignition::math::equal(waypoint.Location().ElevationReference(), newElev));
+
+  // Check the read-only accessor.
+  const Waypoint &constWaypoint = waypoint;
+  EXPECT_EQ(constWaypoint.Location(), location);
 }
 
 //////////////////////////////////////////////////
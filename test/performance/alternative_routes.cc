@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "manifold/rndf/RNDF.hh"
+#include "manifold/rndf/UniqueId.hh"
+#include "manifold/RoadNetwork.hh"
+#include "gtest/gtest.h"
+#include "performance/grid_rndf.hh"
+
+using namespace manifold;
+
+//////////////////////////////////////////////////
+/// \brief Compare the time to compute k alternative routes with the time
+/// of a single shortest path query.
+TEST(AlternativeRoutes, CostPerQuery)
+{
+  const int kSize = 20;
+  const int kWaypoints = 5;
+  rndf::RNDF rndf;
+  test::gridRNDF(kSize, kSize, kWaypoints, rndf);
+  RoadNetwork roadNetwork(rndf);
+
+  std::vector<rndf::UniqueId> ids;
+  for (auto const &vertex : roadNetwork.Graph().Vertexes())
+    ids.push_back(rndf::UniqueId(vertex->Name()));
+
+  const size_t kQueries = 100;
+  std::mt19937 generator(5);
+  std::uniform_int_distribution<size_t> pick(0, ids.size() - 1);
+  std::vector<std::pair<rndf::UniqueId, rndf::UniqueId>> queries;
+  for (size_t i = 0; i < kQueries; ++i)
+  {
+    queries.push_back(std::make_pair(ids[pick(generator)],
+                                     ids[pick(generator)]));
+  }
+
+  auto t0 = std::chrono::steady_clock::now();
+  std::vector<rndf::UniqueId> path;
+  double cost;
+  for (auto const &query : queries)
+    roadNetwork.ShortestPath(query.first, query.second, path, cost);
+  auto t1 = std::chrono::steady_clock::now();
+  double single = std::chrono::duration<double>(t1 - t0).count();
+  std::cout << "Vertexes: " << ids.size() << std::endl
+            << "Shortest path: " << 1e3 * single / kQueries << " ms"
+            << std::endl;
+
+  for (unsigned int k = 1; k <= 8; k *= 2)
+  {
+    for (double overlap : {1.0, 0.5})
+    {
+      std::vector<std::vector<rndf::UniqueId>> paths;
+      std::vector<double> costs;
+      size_t found = 0;
+      t0 = std::chrono::steady_clock::now();
+      for (auto const &query : queries)
+      {
+        if (roadNetwork.AlternativePaths(query.first, query.second, k,
+              paths, costs, overlap))
+        {
+          found += paths.size();
+          for (size_t i = 1; i < costs.size(); ++i)
+            EXPECT_LE(costs[i - 1], costs[i] + 1e-6);
+        }
+      }
+      t1 = std::chrono::steady_clock::now();
+      double seconds = std::chrono::duration<double>(t1 - t0).count();
+      std::cout << "k = " << k << ", overlap <= " << overlap << ": "
+                << 1e3 * seconds / kQueries << " ms ("
+                << seconds / single << "x), "
+                << static_cast<double>(found) / kQueries
+                << " routes per query" << std::endl;
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "manifold/rndf/RNDF.hh"
+#include "manifold/rndf/UniqueId.hh"
+#include "manifold/RoadNetwork.hh"
+#include "gtest/gtest.h"
+#include "performance/grid_rndf.hh"
+
+using namespace manifold;
+
+//////////////////////////////////////////////////
+/// \brief Measure the throughput of the batched route queries with a
+/// growing number of worker threads.
+TEST(BatchRouting, Throughput)
+{
+  const int kSize = 20;
+  const int kWaypoints = 5;
+  rndf::RNDF rndf;
+  test::gridRNDF(kSize, kSize, kWaypoints, rndf);
+  RoadNetwork roadNetwork(rndf);
+
+  // Random trips between the lanes of the grid.
+  std::vector<rndf::UniqueId> ids;
+  for (auto const &vertex : roadNetwork.Graph().Vertexes())
+    ids.push_back(rndf::UniqueId(vertex->Name()));
+
+  const size_t kQueries = 2000;
+  std::mt19937 generator(11);
+  std::uniform_int_distribution<size_t> pick(0, ids.size() - 1);
+  std::vector<std::pair<rndf::UniqueId, rndf::UniqueId>> queries;
+  for (size_t i = 0; i < kQueries; ++i)
+  {
+    queries.push_back(std::make_pair(ids[pick(generator)],
+                                     ids[pick(generator)]));
+  }
+
+  std::cout << "Vertexes: " << ids.size() << std::endl
+            << "Queries: " << kQueries << std::endl
+            << "Hardware threads: " << std::thread::hardware_concurrency()
+            << std::endl;
+
+  std::vector<double> reference;
+  for (unsigned int threads = 1; threads <= 16; threads *= 2)
+  {
+    std::vector<double> costs;
+    std::vector<std::vector<rndf::UniqueId>> paths;
+    auto t0 = std::chrono::steady_clock::now();
+    ASSERT_TRUE(roadNetwork.ShortestPaths(queries, costs, paths, threads));
+    auto t1 = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(t1 - t0).count();
+
+    if (reference.empty())
+      reference = costs;
+    ASSERT_EQ(costs.size(), reference.size());
+    for (size_t i = 0; i < costs.size(); ++i)
+      EXPECT_DOUBLE_EQ(costs[i], reference[i]);
+
+    std::cout << threads << " threads: " << kQueries / seconds
+              << " queries/s" << std::endl;
+  }
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include <ignition/math/SphericalCoordinates.hh>
+#include <ignition/math/Vector3.hh>
+
+#include "manifold/rndf/Lane.hh"
+#include "manifold/rndf/RNDF.hh"
+#include "manifold/rndf/Segment.hh"
+#include "manifold/rndf/UniqueId.hh"
+#include "manifold/rndf/Waypoint.hh"
+#include "manifold/EnuProjection.hh"
+#include "gtest/gtest.h"
+#include "performance/grid_rndf.hh"
+
+using namespace manifold;
+
+/// \brief ENU coordinates of a location, converted point by point through
+/// the earth-centered frame as the general-purpose transforms of
+/// SphericalCoordinates do.
+/// \param[in] _location The location.
+/// \param[in] _origin Origin of the frame.
+/// \return The east and north coordinates (meters).
+ignition::math::Vector3d perPoint(
+  const ignition::math::SphericalCoordinates &_location,
+  const ignition::math::SphericalCoordinates &_origin)
+{
+  const double kA = 6378137.0;
+  const double kE2 = 6.69437999014e-3;
+  auto ecef = [&](const ignition::math::SphericalCoordinates &_sc)
+  {
+    double phi = _sc.LatitudeReference().Radian();
+    double lambda = _sc.LongitudeReference().Radian();
+    double n = kA / std::sqrt(1 - kE2 * std::sin(phi) * std::sin(phi));
+    return ignition::math::Vector3d(n * std::cos(phi) * std::cos(lambda),
+      n * std::cos(phi) * std::sin(lambda), n * (1 - kE2) * std::sin(phi));
+  };
+
+  double phi0 = _origin.LatitudeReference().Radian();
+  double lambda0 = _origin.LongitudeReference().Radian();
+  auto d = ecef(_location) - ecef(_origin);
+  double east = -std::sin(lambda0) * d.X() + std::cos(lambda0) * d.Y();
+  double north = -std::sin(phi0) * std::cos(lambda0) * d.X() -
+    std::sin(phi0) * std::sin(lambda0) * d.Y() + std::cos(phi0) * d.Z();
+  return ignition::math::Vector3d(east, north, 0);
+}
+
+//////////////////////////////////////////////////
+/// \brief Measure the batch projection of a whole map against projecting
+/// its waypoints one by one.
+TEST(EnuProjection, Throughput)
+{
+  const int kSize = 40;
+  const int kWaypoints = 40;
+  rndf::RNDF rndf;
+  test::gridRNDF(kSize, kSize, kWaypoints, rndf);
+
+  std::vector<const rndf::Waypoint *> waypoints;
+  std::vector<double> lat;
+  std::vector<double> lon;
+  for (auto const &segment : rndf.Segments())
+  {
+    for (auto const &lane : segment.Lanes())
+    {
+      for (auto const &wp : lane.Waypoints())
+      {
+        waypoints.push_back(&wp);
+        lat.push_back(wp.Location().LatitudeReference().Degree());
+        lon.push_back(wp.Location().LongitudeReference().Degree());
+      }
+    }
+  }
+  const double kPoints = static_cast<double>(waypoints.size());
+  auto origin = waypoints.front()->Location();
+  EnuProjection projection(origin);
+  std::cout << "Waypoints: " << waypoints.size() << std::endl
+            << "Vectorized: " << EnuProjection::Vectorized() << std::endl;
+
+  const int kRuns = 10;
+  std::vector<ignition::math::Vector3d> reference(waypoints.size());
+  auto t0 = std::chrono::steady_clock::now();
+  for (int run = 0; run < kRuns; ++run)
+  {
+    for (size_t i = 0; i < waypoints.size(); ++i)
+      reference[i] = perPoint(waypoints[i]->Location(), origin);
+  }
+  auto t1 = std::chrono::steady_clock::now();
+  double seconds = std::chrono::duration<double>(t1 - t0).count();
+  std::cout << "Per point (earth-centered): " << kRuns * kPoints / seconds
+            << " points/s" << std::endl;
+
+  std::vector<ignition::math::Vector3d> single(waypoints.size());
+  t0 = std::chrono::steady_clock::now();
+  for (int run = 0; run < kRuns; ++run)
+  {
+    for (size_t i = 0; i < waypoints.size(); ++i)
+      single[i] = projection.Project(waypoints[i]->Location());
+  }
+  t1 = std::chrono::steady_clock::now();
+  seconds = std::chrono::duration<double>(t1 - t0).count();
+  std::cout << "Per point (Project): " << kRuns * kPoints / seconds
+            << " points/s" << std::endl;
+
+  std::vector<double> east;
+  std::vector<double> north;
+  t0 = std::chrono::steady_clock::now();
+  for (int run = 0; run < kRuns; ++run)
+    ASSERT_TRUE(projection.Project(lat, lon, east, north));
+  t1 = std::chrono::steady_clock::now();
+  seconds = std::chrono::duration<double>(t1 - t0).count();
+  std::cout << "Batch (arrays): " << kRuns * kPoints / seconds
+            << " points/s" << std::endl;
+
+  std::vector<rndf::UniqueId> ids;
+  std::vector<ignition::math::Vector3d> points;
+  t0 = std::chrono::steady_clock::now();
+  for (int run = 0; run < kRuns; ++run)
+    projection.Project(rndf, ids, points);
+  t1 = std::chrono::steady_clock::now();
+  seconds = std::chrono::duration<double>(t1 - t0).count();
+  std::cout << "Batch (RNDF): " << kRuns * kPoints / seconds
+            << " points/s" << std::endl;
+
+  double error = 0;
+  ASSERT_EQ(points.size(), waypoints.size());
+  for (size_t i = 0; i < waypoints.size(); ++i)
+  {
+    error = std::max(error, (points[i] - reference[i]).Length());
+    EXPECT_DOUBLE_EQ(points[i].X(), single[i].X());
+    EXPECT_DOUBLE_EQ(points[i].Y(), single[i].Y());
+    EXPECT_DOUBLE_EQ(east[i], single[i].X());
+    EXPECT_DOUBLE_EQ(north[i], single[i].Y());
+  }
+  std::cout << "Maximum difference: " << error << " m" << std::endl;
+  EXPECT_LT(error, 1e-6);
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef MANIFOLD_TEST_PERFORMANCE_FIXTURES_HH_
+#define MANIFOLD_TEST_PERFORMANCE_FIXTURES_HH_
+
+#include <ignition/math/Angle.hh>
+#include <ignition/math/Helpers.hh>
+#include <ignition/math/SphericalCoordinates.hh>
+
+#include "manifold/rndf/Lane.hh"
+#include "manifold/rndf/RNDF.hh"
+#include "manifold/rndf/Segment.hh"
+#include "manifold/rndf/Waypoint.hh"
+
+namespace manifold
+{
+  namespace test
+  {
+    /// \brief A location.
+    /// \param[in] _lat Latitude (degrees).
+    /// \param[in] _lon Longitude (degrees).
+    /// \return The location.
+    inline ignition::math::SphericalCoordinates location(const double _lat,
+      const double _lon)
+    {
+      return ignition::math::SphericalCoordinates(
+        ignition::math::SphericalCoordinates::EARTH_WGS84,
+        ignition::math::Angle(IGN_DTOR(_lat)),
+        ignition::math::Angle(IGN_DTOR(_lon)),
+        0.0, ignition::math::Angle::Zero);
+    }
+
+    /// \brief A road with two lanes in opposite directions, 4.4 m apart:
+    /// lane 1 runs east along latitude 37 and lane 2 runs west, north of it.
+    /// Each lane has 4 waypoints, 1e-3 degrees of longitude apart, and
+    /// there's no way to turn around.
+    /// \param[out] _rndf The RNDF.
+    inline void roadRNDF(rndf::RNDF &_rndf)
+    {
+      rndf::Segment segment(1);
+      rndf::Lane east(1);
+      rndf::Lane west(2);
+      for (int w = 0; w < 4; ++w)
+      {
+        east.AddWaypoint(
+          rndf::Waypoint(w + 1, location(37.0, -122.0 + w * 1e-3)));
+        west.AddWaypoint(
+          rndf::Waypoint(w + 1, location(37.00004, -121.997 - w * 1e-3)));
+      }
+      segment.AddLane(east);
+      segment.AddLane(west);
+      _rndf.AddSegment(segment);
+    }
+  }
+}
+#endif
@@ -0,0 +1,187 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+#include <ignition/math/Helpers.hh>
+#include <ignition/math/Vector3.hh>
+
+#include "manifold/rndf/RNDF.hh"
+#include "manifold/rndf/UniqueId.hh"
+#include "manifold/FrenetFrame.hh"
+#include "manifold/LaneGeometry.hh"
+#include "manifold/RoadNetwork.hh"
+#include "gtest/gtest.h"
+#include "performance/grid_rndf.hh"
+
+using namespace manifold;
+
+/// \brief Frenet coordinates of a point by a scan of all the pieces of a
+/// path, as done without the conversion API.
+/// \param[in] _path The path.
+/// \param[in] _p The point.
+/// \param[out] _s Arc length (meters).
+/// \param[out] _d Signed distance (meters).
+void scan(const LaneGeometry &_path, const ignition::math::Vector3d &_p,
+          double &_s, double &_d)
+{
+  double best = 1e18;
+  for (size_t j = 0; j + 1 < _path.NumPoints(); ++j)
+  {
+    auto a = _path.Point(j);
+    auto e = _path.Point(j + 1) - a;
+    auto w = _p - a;
+    double t = ignition::math::clamp(w.Dot(e) / e.Dot(e), 0.0, 1.0);
+    double distance = (e * t - w).Length();
+    if (distance < best)
+    {
+      best = distance;
+      _s = _path.Station(j) + t * e.Length();
+      _d = (e.X() * w.Y() - e.Y() * w.X()) < 0 ? -distance : distance;
+    }
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Measure the conversions of the samples of a trajectory along a
+/// long route, with and without hints.
+TEST(FrenetConversion, Throughput)
+{
+  const int kSize = 20;
+  const int kWaypoints = 20;
+  rndf::RNDF rndf;
+  test::gridRNDF(kSize, kSize, kWaypoints, rndf);
+  RoadNetwork roadNetwork(rndf);
+  LaneGeometryCache cache(rndf);
+
+  // Across the grid, along a staircase of streets.
+  std::vector<rndf::UniqueId> route;
+  double cost;
+  ASSERT_TRUE(roadNetwork.ShortestPath(rndf::UniqueId(1, 1, 1),
+    rndf::UniqueId(static_cast<int>(rndf.NumSegments()), 1, kWaypoints),
+    route, cost));
+
+  auto t0 = std::chrono::steady_clock::now();
+  FrenetFrame frame(cache, route);
+  auto t1 = std::chrono::steady_clock::now();
+  std::cout << "Route: " << frame.Path().NumPoints() << " points, "
+            << frame.Length() << " m" << std::endl
+            << "Build: "
+            << std::chrono::duration<double, std::milli>(t1 - t0).count()
+            << " ms" << std::endl;
+
+  // Samples every 0.25 m, up to 3 m from the route.
+  std::mt19937 generator(49);
+  std::uniform_real_distribution<double> lateral(-3.0, 3.0);
+  std::vector<double> s0;
+  std::vector<double> d0;
+  for (double s = 0; s < frame.Length(); s += 0.25)
+  {
+    s0.push_back(s);
+    d0.push_back(lateral(generator));
+  }
+  std::vector<ignition::math::Vector3d> samples;
+  ASSERT_TRUE(frame.ToCartesian(s0, d0, samples));
+  const size_t kSamples = samples.size();
+  std::cout << "Samples: " << kSamples << std::endl;
+
+  // The scan is slow: convert a subset.
+  const size_t kStride = 20;
+  std::vector<double> reference(kSamples, 0.0);
+  double sink = 0;
+  t0 = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < kSamples; i += kStride)
+  {
+    double d;
+    scan(frame.Path(), samples[i], reference[i], d);
+    sink += d;
+  }
+  t1 = std::chrono::steady_clock::now();
+  double seconds = std::chrono::duration<double>(t1 - t0).count();
+  std::cout << "Scan: " << (kSamples / kStride) / seconds << " points/s"
+            << std::endl;
+
+  t0 = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < kSamples; ++i)
+  {
+    double s;
+    double d;
+    frame.ToFrenet(samples[i], s, d);
+    sink += s + d;
+  }
+  t1 = std::chrono::steady_clock::now();
+  seconds = std::chrono::duration<double>(t1 - t0).count();
+  std::cout << "ToFrenet: " << kSamples / seconds << " points/s"
+            << std::endl;
+
+  size_t hint = 0;
+  t0 = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < kSamples; ++i)
+  {
+    double s;
+    double d;
+    frame.ToFrenet(samples[i], hint, s, d);
+    sink += s + d;
+  }
+  t1 = std::chrono::steady_clock::now();
+  seconds = std::chrono::duration<double>(t1 - t0).count();
+  std::cout << "ToFrenet with hints: " << kSamples / seconds << " points/s"
+            << std::endl;
+
+  std::vector<double> ss;
+  std::vector<double> ds;
+  t0 = std::chrono::steady_clock::now();
+  ASSERT_TRUE(frame.ToFrenet(samples, ss, ds));
+  t1 = std::chrono::steady_clock::now();
+  seconds = std::chrono::duration<double>(t1 - t0).count();
+  std::cout << "ToFrenet batch: " << kSamples / seconds << " points/s"
+            << std::endl;
+  for (size_t i = 0; i < kSamples; i += kStride)
+    EXPECT_NEAR(ss[i], reference[i], 1e-6);
+
+  t0 = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < kSamples; ++i)
+  {
+    ignition::math::Vector3d point;
+    frame.ToCartesian(ss[i], ds[i], point);
+    sink += point.X();
+  }
+  t1 = std::chrono::steady_clock::now();
+  seconds = std::chrono::duration<double>(t1 - t0).count();
+  std::cout << "ToCartesian: " << kSamples / seconds << " points/s"
+            << std::endl;
+
+  std::vector<ignition::math::Vector3d> points;
+  t0 = std::chrono::steady_clock::now();
+  ASSERT_TRUE(frame.ToCartesian(ss, ds, points));
+  t1 = std::chrono::steady_clock::now();
+  seconds = std::chrono::duration<double>(t1 - t0).count();
+  std::cout << "ToCartesian batch: " << kSamples / seconds << " points/s"
+            << std::endl;
+  EXPECT_FALSE(std::isnan(sink));
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
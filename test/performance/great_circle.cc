@@ -0,0 +1,147 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include <ignition/math/Angle.hh>
+#include <ignition/math/Helpers.hh>
+#include <ignition/math/SphericalCoordinates.hh>
+
+#include "manifold/GreatCircle.hh"
+#include "gtest/gtest.h"
+
+using namespace manifold;
+
+/// \brief Print the time per million pairs.
+/// \param[in] _name Name of the measurement.
+/// \param[in] _pairs Number of pairs.
+/// \param[in] _seconds Time spent.
+void report(const std::string &_name, const double _pairs,
+            const double _seconds)
+{
+  std::cout << _name << ": " << 1e9 * _seconds / _pairs
+            << " ms per million pairs" << std::endl;
+}
+
+/// \brief Maximum difference between two arrays of distances, relative to
+/// the distances, or absolute below a meter.
+/// \param[in] _distances The distances.
+/// \param[in] _reference The reference distances.
+/// \return The difference.
+double maxError(const std::vector<double> &_distances,
+                const std::vector<double> &_reference)
+{
+  double error = 0;
+  for (size_t i = 0; i < _distances.size(); ++i)
+  {
+    error = std::max(error, std::abs(_distances[i] - _reference[i]) /
+      std::max(1.0, _reference[i]));
+  }
+  return error;
+}
+
+//////////////////////////////////////////////////
+/// \brief Measure the batch distances against calling
+/// SphericalCoordinates::Distance() for each pair.
+TEST(GreatCircle, Throughput)
+{
+  // A trace of a million points with a few meters between them.
+  const size_t kPoints = 1000000;
+  std::mt19937 generator(31);
+  std::uniform_real_distribution<double> step(-5e-5, 5e-5);
+  std::vector<double> lat(kPoints);
+  std::vector<double> lon(kPoints);
+  lat[0] = 37.4;
+  lon[0] = -122.1;
+  for (size_t i = 1; i < kPoints; ++i)
+  {
+    lat[i] = lat[i - 1] + step(generator);
+    lon[i] = lon[i - 1] + step(generator);
+  }
+  std::cout << "Vectorized: " << GreatCircle::Vectorized() << std::endl;
+
+  std::vector<double> reference(kPoints - 1);
+  auto t0 = std::chrono::steady_clock::now();
+  for (size_t i = 0; i + 1 < kPoints; ++i)
+  {
+    reference[i] = ignition::math::SphericalCoordinates::Distance(
+      ignition::math::Angle(IGN_DTOR(lat[i])),
+      ignition::math::Angle(IGN_DTOR(lon[i])),
+      ignition::math::Angle(IGN_DTOR(lat[i + 1])),
+      ignition::math::Angle(IGN_DTOR(lon[i + 1])));
+  }
+  auto t1 = std::chrono::steady_clock::now();
+  report("SphericalCoordinates::Distance", kPoints - 1,
+         std::chrono::duration<double>(t1 - t0).count());
+
+  std::vector<double> distances;
+  t0 = std::chrono::steady_clock::now();
+  ASSERT_TRUE(GreatCircle::Consecutive(lat, lon, distances));
+  t1 = std::chrono::steady_clock::now();
+  report("Consecutive", kPoints - 1,
+         std::chrono::duration<double>(t1 - t0).count());
+  double error = maxError(distances, reference);
+  std::cout << "Maximum difference: " << error << std::endl;
+  EXPECT_LT(error, 1e-12);
+
+  t0 = std::chrono::steady_clock::now();
+  ASSERT_TRUE(GreatCircle::OneToMany(lat[0], lon[0], lat, lon, distances));
+  t1 = std::chrono::steady_clock::now();
+  report("OneToMany", kPoints,
+         std::chrono::duration<double>(t1 - t0).count());
+
+  // A thousand by a thousand.
+  const size_t kSide = 1000;
+  std::vector<double> latA(lat.begin(), lat.begin() + kSide);
+  std::vector<double> lonA(lon.begin(), lon.begin() + kSide);
+  std::vector<double> latB(lat.end() - kSide, lat.end());
+  std::vector<double> lonB(lon.end() - kSide, lon.end());
+  t0 = std::chrono::steady_clock::now();
+  ASSERT_TRUE(GreatCircle::ManyToMany(latA, lonA, latB, lonB, distances));
+  t1 = std::chrono::steady_clock::now();
+  report("ManyToMany", kSide * kSide,
+         std::chrono::duration<double>(t1 - t0).count());
+
+  reference.resize(kSide * kSide);
+  for (size_t i = 0; i < kSide; ++i)
+  {
+    for (size_t j = 0; j < kSide; ++j)
+    {
+      reference[i * kSide + j] =
+        ignition::math::SphericalCoordinates::Distance(
+          ignition::math::Angle(IGN_DTOR(latA[i])),
+          ignition::math::Angle(IGN_DTOR(lonA[i])),
+          ignition::math::Angle(IGN_DTOR(latB[j])),
+          ignition::math::Angle(IGN_DTOR(lonB[j])));
+    }
+  }
+  error = maxError(distances, reference);
+  std::cout << "Maximum difference: " << error << std::endl;
+  EXPECT_LT(error, 1e-12);
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef MANIFOLD_TEST_PERFORMANCE_GRID_RNDF_HH_
+#define MANIFOLD_TEST_PERFORMANCE_GRID_RNDF_HH_
+
+#include <map>
+#include <utility>
+#include <vector>
+#include <ignition/math/Angle.hh>
+#include <ignition/math/Helpers.hh>
+#include <ignition/math/SphericalCoordinates.hh>
+
+#include "manifold/rndf/Exit.hh"
+#include "manifold/rndf/Lane.hh"
+#include "manifold/rndf/RNDF.hh"
+#include "manifold/rndf/Segment.hh"
+#include "manifold/rndf/UniqueId.hh"
+#include "manifold/rndf/Waypoint.hh"
+
+namespace manifold
+{
+  namespace test
+  {
+    /// \brief Build a synthetic RNDF with a grid of streets, used to
+    /// measure the performance on maps larger than the samples.
+    /// Each block between two adjacent intersections is crossed by two
+    /// one-lane segments, one per direction. The last waypoint of every lane
+    /// has an exit to the first waypoint of every lane leaving the
+    /// intersection, except the one making a U-turn.
+    /// \param[in] _rows Number of rows of intersections.
+    /// \param[in] _cols Number of columns of intersections.
+    /// \param[in] _waypoints Number of waypoints per lane (at least 2).
+    /// \param[out] _rndf The RNDF. It should be empty.
+    /// \param[in] _spacing Distance between intersections (meters).
+    inline void gridRNDF(const int _rows, const int _cols,
+                         const int _waypoints, rndf::RNDF &_rndf,
+                         const double _spacing = 100.0)
+    {
+      const double kMetersPerDegree = 111320.0;
+      const double kLat0 = 37.4;
+      const double kLon0 = -122.1;
+      const double step = _spacing / kMetersPerDegree;
+      auto location = [&](const double _row, const double _col)
+      {
+        return ignition::math::SphericalCoordinates(
+          ignition::math::SphericalCoordinates::EARTH_WGS84,
+          ignition::math::Angle(IGN_DTOR(kLat0 + _row * step)),
+          ignition::math::Angle(IGN_DTOR(kLon0 + _col * step)),
+          0.0, ignition::math::Angle::Zero);
+      };
+
+      // Segment Id of each directed block, keyed by its intersections.
+      using Node = std::pair<int, int>;
+      std::map<std::pair<Node, Node>, int> blocks;
+      const int kDr[] = {0, 0, 1, -1};
+      const int kDc[] = {1, -1, 0, 0};
+      for (int r = 0; r < _rows; ++r)
+      {
+        for (int c = 0; c < _cols; ++c)
+        {
+          for (int k = 0; k < 4; ++k)
+          {
+            Node to(r + kDr[k], c + kDc[k]);
+            if (to.first < 0 || to.first >= _rows || to.second < 0 ||
+                to.second >= _cols)
+            {
+              continue;
+            }
+            auto id = static_cast<int>(blocks.size()) + 1;
+            blocks[std::make_pair(Node(r, c), to)] = id;
+          }
+        }
+      }
+
+      _rndf.SetName("grid");
+      for (auto const &block : blocks)
+      {
+        auto const &from = block.first.first;
+        auto const &to = block.first.second;
+        rndf::Lane lane(1);
+        for (int w = 0; w < _waypoints; ++w)
+        {
+          // Leave some room around the intersections.
+          double t = 0.1 + 0.8 * w / (_waypoints - 1);
+          double row = from.first + t * (to.first - from.first);
+          double col = from.second + t * (to.second - from.second);
+          lane.AddWaypoint(rndf::Waypoint(w + 1, location(row, col)));
+        }
+
+        for (int k = 0; k < 4; ++k)
+        {
+          Node next(to.first + kDr[k], to.second + kDc[k]);
+          auto it = blocks.find(std::make_pair(to, next));
+          if (it == blocks.end() || next == from)
+            continue;
+
+          lane.AddExit(rndf::Exit(
+            rndf::UniqueId(block.second, 1, _waypoints),
+            rndf::UniqueId(it->second, 1, 1)));
+        }
+
+        rndf::Segment segment(block.second);
+        segment.AddLane(lane);
+        _rndf.AddSegment(segment);
+      }
+    }
+  }
+}
+#endif
@@ -0,0 +1,78 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "manifold/rndf/RNDF.hh"
+#include "manifold/rndf/UniqueId.hh"
+#include "manifold/RoadNetwork.hh"
+#include "gtest/gtest.h"
+#include "performance/grid_rndf.hh"
+
+using namespace manifold;
+
+//////////////////////////////////////////////////
+/// \brief Measure the throughput of the queries of the waypoints reachable
+/// within a cost budget.
+TEST(Isochrone, Throughput)
+{
+  const int kSize = 30;
+  const int kWaypoints = 5;
+  rndf::RNDF rndf;
+  test::gridRNDF(kSize, kSize, kWaypoints, rndf);
+  RoadNetwork roadNetwork(rndf);
+
+  std::vector<rndf::UniqueId> ids;
+  for (auto const &vertex : roadNetwork.Graph().Vertexes())
+    ids.push_back(rndf::UniqueId(vertex->Name()));
+
+  const size_t kQueries = 1000;
+  std::mt19937 generator(3);
+  std::uniform_int_distribution<size_t> pick(0, ids.size() - 1);
+  std::vector<rndf::UniqueId> sources;
+  for (size_t i = 0; i < kQueries; ++i)
+    sources.push_back(ids[pick(generator)]);
+
+  std::cout << "Vertexes: " << ids.size() << std::endl;
+  std::vector<std::pair<rndf::UniqueId, double>> reached;
+  for (double budget : {250.0, 1000.0, 4000.0})
+  {
+    size_t total = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (auto const &src : sources)
+    {
+      ASSERT_TRUE(roadNetwork.WithinCost(src, budget, reached));
+      total += reached.size();
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(t1 - t0).count();
+    std::cout << "Budget " << budget << " m: " << kQueries / seconds
+              << " queries/s, " << static_cast<double>(total) / kQueries
+              << " waypoints per query" << std::endl;
+  }
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
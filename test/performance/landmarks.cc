@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "manifold/rndf/RNDF.hh"
+#include "manifold/rndf/UniqueId.hh"
+#include "manifold/RoadNetwork.hh"
+#include "manifold/RoadNetworkOptions.hh"
+#include "gtest/gtest.h"
+#include "performance/grid_rndf.hh"
+
+using namespace manifold;
+
+//////////////////////////////////////////////////
+/// \brief Compare the route queries with a growing number of landmarks.
+TEST(Landmarks, QueryTime)
+{
+  const int kSize = 30;
+  const int kWaypoints = 5;
+  rndf::RNDF rndf;
+  test::gridRNDF(kSize, kSize, kWaypoints, rndf);
+
+  const size_t kQueries = 500;
+  std::vector<std::pair<rndf::UniqueId, rndf::UniqueId>> queries;
+  std::vector<double> reference;
+  for (unsigned int landmarks : {0u, 4u, 8u, 16u})
+  {
+    RoadNetworkOptions options;
+    ASSERT_TRUE(options.SetLandmarks(landmarks));
+    auto t0 = std::chrono::steady_clock::now();
+    RoadNetwork roadNetwork(rndf, options);
+    auto t1 = std::chrono::steady_clock::now();
+
+    if (queries.empty())
+    {
+      std::vector<rndf::UniqueId> ids;
+      for (auto const &vertex : roadNetwork.Graph().Vertexes())
+        ids.push_back(rndf::UniqueId(vertex->Name()));
+      std::mt19937 generator(7);
+      std::uniform_int_distribution<size_t> pick(0, ids.size() - 1);
+      for (size_t i = 0; i < kQueries; ++i)
+      {
+        queries.push_back(std::make_pair(ids[pick(generator)],
+                                         ids[pick(generator)]));
+      }
+      std::cout << "Vertexes: " << ids.size() << std::endl;
+    }
+
+    std::vector<double> costs;
+    std::vector<rndf::UniqueId> path;
+    auto t2 = std::chrono::steady_clock::now();
+    for (auto const &query : queries)
+    {
+      double cost = -1.0;
+      roadNetwork.ShortestPath(query.first, query.second, path, cost);
+      costs.push_back(cost);
+    }
+    auto t3 = std::chrono::steady_clock::now();
+
+    if (reference.empty())
+      reference = costs;
+    for (size_t i = 0; i < costs.size(); ++i)
+      EXPECT_NEAR(costs[i], reference[i], 1e-6);
+
+    std::cout << landmarks << " landmarks: build "
+              << std::chrono::duration<double, std::milli>(t1 - t0).count()
+              << " ms, query "
+              << std::chrono::duration<double, std::milli>(t3 - t2).count() /
+                 kQueries << " ms" << std::endl;
+  }
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
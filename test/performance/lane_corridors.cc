@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+#include <ignition/math/Vector3.hh>
+
+#include "manifold/rndf/Lane.hh"
+#include "manifold/rndf/RNDF.hh"
+#include "manifold/rndf/Segment.hh"
+#include "manifold/rndf/UniqueId.hh"
+#include "manifold/LaneCorridors.hh"
+#include "gtest/gtest.h"
+#include "performance/grid_rndf.hh"
+
+using namespace manifold;
+
+/// \brief Whether a triangle contains a point, as a brute-force reference.
+/// \param[in] _v The vertexes of the triangle.
+/// \param[in] _p The point.
+/// \return True if it does.
+bool contains(const ignition::math::Vector3d *_v,
+              const ignition::math::Vector3d &_p)
+{
+  double d[3];
+  for (int k = 0; k < 3; ++k)
+  {
+    auto const &a = _v[k];
+    auto const &b = _v[(k + 1) % 3];
+    d[k] = (b.X() - a.X()) * (_p.Y() - a.Y()) -
+      (b.Y() - a.Y()) * (_p.X() - a.X());
+  }
+  bool negative = d[0] < 0 || d[1] < 0 || d[2] < 0;
+  bool positive = d[0] > 0 || d[1] > 0 || d[2] > 0;
+  return !(negative && positive);
+}
+
+//////////////////////////////////////////////////
+/// \brief Measure the point and segment queries of a planner against
+/// testing every triangle.
+TEST(LaneCorridors, Throughput)
+{
+  const int kSize = 20;
+  const int kWaypoints = 5;
+  rndf::RNDF rndf;
+  test::gridRNDF(kSize, kSize, kWaypoints, rndf);
+
+  auto t0 = std::chrono::steady_clock::now();
+  LaneCorridors corridors(rndf);
+  auto t1 = std::chrono::steady_clock::now();
+  std::cout << "Lanes: " << corridors.NumLanes() << std::endl
+            << "Triangles: " << corridors.NumTriangles() << std::endl
+            << "Build: "
+            << std::chrono::duration<double, std::milli>(t1 - t0).count()
+            << " ms" << std::endl;
+
+  // Triangles of every lane, for the brute-force reference.
+  std::vector<rndf::UniqueId> ids;
+  std::vector<std::vector<ignition::math::Vector3d>> triangles;
+  for (auto const &segment : rndf.Segments())
+  {
+    for (auto const &lane : segment.Lanes())
+    {
+      ids.push_back(rndf::UniqueId(segment.Id(), lane.Id(), 1));
+      triangles.push_back(std::vector<ignition::math::Vector3d>());
+      ASSERT_TRUE(corridors.Triangles(ids.back(), triangles.back()));
+    }
+  }
+
+  // Points near the streets of the grid (100 m blocks), and short
+  // segments from them as the motions checked by a planner.
+  const size_t kQueries = 200000;
+  std::mt19937 generator(41);
+  std::uniform_int_distribution<int> street(0, kSize - 1);
+  std::uniform_real_distribution<double> along(0.0, 100.0 * (kSize - 1));
+  std::uniform_real_distribution<double> across(-5.0, 5.0);
+  std::uniform_real_distribution<double> motion(-3.0, 3.0);
+  std::vector<ignition::math::Vector3d> starts;
+  std::vector<ignition::math::Vector3d> ends;
+  for (size_t i = 0; i < kQueries; ++i)
+  {
+    double s = along(generator);
+    double c = 100.0 * street(generator) + across(generator);
+    starts.push_back(i % 2 == 0 ? ignition::math::Vector3d(s, c, 0) :
+      ignition::math::Vector3d(c, s, 0));
+    ends.push_back(starts.back() +
+      ignition::math::Vector3d(motion(generator), motion(generator), 0));
+  }
+
+  std::vector<rndf::UniqueId> lanes;
+  size_t hits = 0;
+  t0 = std::chrono::steady_clock::now();
+  for (auto const &p : starts)
+    hits += corridors.LanesAt(p, lanes) > 0;
+  t1 = std::chrono::steady_clock::now();
+  double seconds = std::chrono::duration<double>(t1 - t0).count();
+  std::cout << "LanesAt: " << kQueries / seconds << " queries/s ("
+            << hits << " in a lane)" << std::endl;
+
+  size_t crossed = 0;
+  t0 = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < kQueries; ++i)
+    crossed += corridors.LanesCrossed(starts[i], ends[i], lanes);
+  t1 = std::chrono::steady_clock::now();
+  seconds = std::chrono::duration<double>(t1 - t0).count();
+  std::cout << "LanesCrossed: " << kQueries / seconds << " queries/s ("
+            << crossed << " lanes crossed)" << std::endl;
+
+  // Brute force on a subset, which must agree on the number of lanes.
+  const size_t kBrute = 2000;
+  t0 = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < kBrute; ++i)
+  {
+    size_t expected = 0;
+    for (auto const &vertexes : triangles)
+    {
+      for (size_t t = 0; t + 2 < vertexes.size(); t += 3)
+      {
+        if (contains(&vertexes[t], starts[i]))
+        {
+          ++expected;
+          break;
+        }
+      }
+    }
+    EXPECT_EQ(corridors.LanesAt(starts[i], lanes), expected);
+  }
+  t1 = std::chrono::steady_clock::now();
+  seconds = std::chrono::duration<double>(t1 - t0).count();
+  std::cout << "Brute force: " << kBrute / seconds << " queries/s"
+            << std::endl;
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <utility>
+#include <vector>
+#include <ignition/math/SphericalCoordinates.hh>
+#include <ignition/math/Vector3.hh>
+
+#include "manifold/rndf/Lane.hh"
+#include "manifold/rndf/RNDF.hh"
+#include "manifold/rndf/Segment.hh"
+#include "manifold/rndf/UniqueId.hh"
+#include "manifold/rndf/Waypoint.hh"
+#include "manifold/LaneGeometry.hh"
+#include "gtest/gtest.h"
+#include "performance/grid_rndf.hh"
+
+using namespace manifold;
+
+/// \brief Latitude and longitude (degrees) of the point some distance
+/// along a lane, walking its waypoints as done without the cache.
+/// \param[in] _lane The lane.
+/// \param[in] _s The distance (meters).
+/// \param[out] _lat Latitude of the point.
+/// \param[out] _lon Longitude of the point.
+void walk(const rndf::Lane &_lane, const double _s, double &_lat,
+          double &_lon)
+{
+  auto const &waypoints = _lane.Waypoints();
+  double s = _s;
+  for (size_t i = 0; i + 1 < waypoints.size(); ++i)
+  {
+    auto const &a = waypoints[i].Location();
+    auto const &b = waypoints[i + 1].Location();
+    double length = ignition::math::SphericalCoordinates::Distance(
+      a.LatitudeReference(), a.LongitudeReference(),
+      b.LatitudeReference(), b.LongitudeReference());
+    if (s <= length || i + 2 == waypoints.size())
+    {
+      double t = length > 0 ? std::min(s / length, 1.0) : 0.0;
+      _lat = (1 - t) * a.LatitudeReference().Degree() +
+        t * b.LatitudeReference().Degree();
+      _lon = (1 - t) * a.LongitudeReference().Degree() +
+        t * b.LongitudeReference().Degree();
+      return;
+    }
+    s -= length;
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Measure the station queries on the cached lane geometry against
+/// walking the waypoints of the lane.
+TEST(LaneGeometry, Throughput)
+{
+  const int kSize = 20;
+  const int kWaypoints = 20;
+  rndf::RNDF rndf;
+  test::gridRNDF(kSize, kSize, kWaypoints, rndf);
+
+  std::vector<const rndf::Lane *> lanes;
+  for (auto const &segment : rndf.Segments())
+  {
+    for (auto const &lane : segment.Lanes())
+      lanes.push_back(&lane);
+  }
+
+  LaneGeometryCache cache(rndf);
+  auto t0 = std::chrono::steady_clock::now();
+  std::vector<const LaneGeometry *> geometries;
+  for (auto const &segment : rndf.Segments())
+  {
+    for (auto const &lane : segment.Lanes())
+    {
+      geometries.push_back(
+        cache.Lane(rndf::UniqueId(segment.Id(), lane.Id(), 1)));
+    }
+  }
+  auto t1 = std::chrono::steady_clock::now();
+  std::cout << "Lanes: " << lanes.size() << std::endl
+            << "Build: "
+            << std::chrono::duration<double, std::milli>(t1 - t0).count()
+            << " ms" << std::endl;
+
+  const size_t kQueries = 200000;
+  std::mt19937 generator(21);
+  std::uniform_int_distribution<size_t> pick(0, lanes.size() - 1);
+  std::uniform_real_distribution<double> fraction(0.0, 1.0);
+  std::vector<std::pair<size_t, double>> queries;
+  for (size_t i = 0; i < kQueries; ++i)
+  {
+    size_t lane = pick(generator);
+    queries.push_back(std::make_pair(lane,
+      fraction(generator) * geometries[lane]->Length()));
+  }
+
+  double sink = 0;
+  t0 = std::chrono::steady_clock::now();
+  for (auto const &query : queries)
+  {
+    double lat = 0;
+    double lon = 0;
+    walk(*lanes[query.first], query.second, lat, lon);
+    sink += lat + lon;
+  }
+  t1 = std::chrono::steady_clock::now();
+  double seconds = std::chrono::duration<double>(t1 - t0).count();
+  std::cout << "Walk: " << kQueries / seconds << " queries/s" << std::endl;
+
+  t0 = std::chrono::steady_clock::now();
+  for (auto const &query : queries)
+  {
+    auto const &geometry = *geometries[query.first];
+    auto point = geometry.PointAt(query.second);
+    sink += point.X() + geometry.HeadingAt(query.second);
+  }
+  t1 = std::chrono::steady_clock::now();
+  seconds = std::chrono::duration<double>(t1 - t0).count();
+  std::cout << "PointAt + HeadingAt: " << kQueries / seconds
+            << " queries/s" << std::endl;
+
+  t0 = std::chrono::steady_clock::now();
+  for (auto const &query : queries)
+  {
+    auto const &geometry = *geometries[query.first];
+    auto point = geometry.PointAt(query.second) +
+      ignition::math::Vector3d(0.5, 0.5, 0);
+    double offset;
+    double s = geometry.Project(point, offset);
+    EXPECT_NEAR(s, query.second, 1.0);
+    sink += offset;
+  }
+  t1 = std::chrono::steady_clock::now();
+  seconds = std::chrono::duration<double>(t1 - t0).count();
+  std::cout << "Project: " << kQueries / seconds << " queries/s"
+            << std::endl;
+  EXPECT_FALSE(std::isnan(sink));
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
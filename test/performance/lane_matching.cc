@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+#include <ignition/math/Angle.hh>
+#include <ignition/math/Helpers.hh>
+#include <ignition/math/SphericalCoordinates.hh>
+
+#include "manifold/rndf/RNDF.hh"
+#include "manifold/LaneMatcher.hh"
+#include "gtest/gtest.h"
+#include "performance/grid_rndf.hh"
+
+using namespace manifold;
+
+//////////////////////////////////////////////////
+/// \brief Measure the throughput of the matching of locations to lanes,
+/// one at a time and in batches with a growing number of worker threads.
+TEST(LaneMatching, Throughput)
+{
+  const int kSize = 30;
+  const int kWaypoints = 5;
+  rndf::RNDF rndf;
+  test::gridRNDF(kSize, kSize, kWaypoints, rndf);
+
+  auto t0 = std::chrono::steady_clock::now();
+  LaneMatcher matcher(rndf);
+  auto t1 = std::chrono::steady_clock::now();
+  std::cout << "Pieces: " << matcher.Size() << std::endl
+            << "Build: "
+            << std::chrono::duration<double, std::milli>(t1 - t0).count()
+            << " ms" << std::endl
+            << "Hardware threads: " << std::thread::hardware_concurrency()
+            << std::endl;
+
+  // Random locations over the grid (100 m between intersections).
+  const size_t kQueries = 100000;
+  const double kExtent = kSize * 100.0 / 111320.0;
+  std::mt19937 generator(9);
+  std::uniform_real_distribution<double> offset(0.0, kExtent);
+  std::vector<ignition::math::SphericalCoordinates> locations;
+  for (size_t i = 0; i < kQueries; ++i)
+  {
+    locations.push_back(ignition::math::SphericalCoordinates(
+      ignition::math::SphericalCoordinates::EARTH_WGS84,
+      ignition::math::Angle(IGN_DTOR(37.4 + offset(generator))),
+      ignition::math::Angle(IGN_DTOR(-122.1 + offset(generator))),
+      0.0, ignition::math::Angle::Zero));
+  }
+
+  size_t single = 0;
+  t0 = std::chrono::steady_clock::now();
+  for (auto const &location : locations)
+  {
+    LaneMatch match;
+    single += matcher.Match(location, match) ? 1 : 0;
+  }
+  t1 = std::chrono::steady_clock::now();
+  double seconds = std::chrono::duration<double>(t1 - t0).count();
+  std::cout << "Single: " << kQueries / seconds << " queries/s, "
+            << single << " matched" << std::endl;
+
+  for (unsigned int threads = 1; threads <= 8; threads *= 2)
+  {
+    std::vector<LaneMatch> matches;
+    t0 = std::chrono::steady_clock::now();
+    size_t matched = matcher.Match(locations, matches, 50.0, threads);
+    t1 = std::chrono::steady_clock::now();
+    seconds = std::chrono::duration<double>(t1 - t0).count();
+    EXPECT_EQ(matched, single);
+    std::cout << "Batch, " << threads << " threads: " << kQueries / seconds
+              << " queries/s" << std::endl;
+  }
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
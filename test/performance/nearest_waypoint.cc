@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+#include <ignition/math/Angle.hh>
+#include <ignition/math/Helpers.hh>
+#include <ignition/math/SphericalCoordinates.hh>
+
+#include "manifold/rndf/Lane.hh"
+#include "manifold/rndf/RNDF.hh"
+#include "manifold/rndf/Segment.hh"
+#include "manifold/rndf/UniqueId.hh"
+#include "manifold/rndf/Waypoint.hh"
+#include "manifold/rndf/WaypointIndex.hh"
+#include "gtest/gtest.h"
+#include "performance/grid_rndf.hh"
+
+using namespace manifold;
+
+//////////////////////////////////////////////////
+/// \brief Compare the nearest waypoint queries of the index with a linear
+/// scan of all the waypoints.
+TEST(NearestWaypoint, Throughput)
+{
+  const int kSize = 30;
+  const int kWaypoints = 5;
+  rndf::RNDF rndf;
+  test::gridRNDF(kSize, kSize, kWaypoints, rndf);
+
+  auto t0 = std::chrono::steady_clock::now();
+  rndf::WaypointIndex index(rndf);
+  auto t1 = std::chrono::steady_clock::now();
+  std::cout << "Waypoints: " << index.Size() << std::endl
+            << "Build: "
+            << std::chrono::duration<double, std::milli>(t1 - t0).count()
+            << " ms" << std::endl;
+
+  std::vector<rndf::Waypoint> waypoints;
+  for (auto const &segment : rndf.Segments())
+  {
+    for (auto const &lane : segment.Lanes())
+    {
+      waypoints.insert(waypoints.end(), lane.Waypoints().begin(),
+                       lane.Waypoints().end());
+    }
+  }
+  ASSERT_EQ(waypoints.size(), index.Size());
+
+  // Random locations over the grid (100 m between intersections).
+  const size_t kQueries = 2000;
+  const double kExtent = kSize * 100.0 / 111320.0;
+  std::mt19937 generator(5);
+  std::uniform_real_distribution<double> offset(0.0, kExtent);
+  std::vector<ignition::math::SphericalCoordinates> queries;
+  for (size_t i = 0; i < kQueries; ++i)
+  {
+    queries.push_back(ignition::math::SphericalCoordinates(
+      ignition::math::SphericalCoordinates::EARTH_WGS84,
+      ignition::math::Angle(IGN_DTOR(37.4 + offset(generator))),
+      ignition::math::Angle(IGN_DTOR(-122.1 + offset(generator))),
+      0.0, ignition::math::Angle::Zero));
+  }
+
+  std::vector<double> scanned;
+  t0 = std::chrono::steady_clock::now();
+  for (auto const &query : queries)
+  {
+    double best = std::numeric_limits<double>::infinity();
+    for (auto const &wp : waypoints)
+    {
+      best = std::min(best, ignition::math::SphericalCoordinates::Distance(
+        query.LatitudeReference(), query.LongitudeReference(),
+        wp.Location().LatitudeReference(),
+        wp.Location().LongitudeReference()));
+    }
+    scanned.push_back(best);
+  }
+  t1 = std::chrono::steady_clock::now();
+  double scanSeconds = std::chrono::duration<double>(t1 - t0).count();
+
+  std::vector<double> indexed;
+  t0 = std::chrono::steady_clock::now();
+  for (auto const &query : queries)
+  {
+    rndf::UniqueId id;
+    double distance;
+    ASSERT_TRUE(index.Nearest(query, id, distance));
+    indexed.push_back(distance);
+  }
+  t1 = std::chrono::steady_clock::now();
+  double indexSeconds = std::chrono::duration<double>(t1 - t0).count();
+
+  for (size_t i = 0; i < kQueries; ++i)
+    EXPECT_NEAR(indexed[i], scanned[i], 1e-6);
+
+  std::cout << "Linear scan: " << kQueries / scanSeconds << " queries/s"
+            << std::endl
+            << "Index: " << kQueries / indexSeconds << " queries/s"
+            << std::endl;
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
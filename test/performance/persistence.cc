@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+#include "manifold/rndf/RNDF.hh"
+#include "manifold/RoadNetwork.hh"
+#include "manifold/test_config.h"
+#include "gtest/gtest.h"
+#include "performance/grid_rndf.hh"
+
+using namespace manifold;
+
+//////////////////////////////////////////////////
+/// \brief Compare the time to build a network with the time to load it
+/// from a file.
+TEST(Persistence, BuildVersusLoad)
+{
+  const int kSize = 30;
+  const int kWaypoints = 5;
+  rndf::RNDF rndf;
+  test::gridRNDF(kSize, kSize, kWaypoints, rndf);
+
+  std::string path = std::string(PROJECT_BINARY_PATH) +
+    "/test/performance/persistence.network";
+  std::remove(path.c_str());
+
+  auto t0 = std::chrono::steady_clock::now();
+  RoadNetwork built(rndf);
+  auto t1 = std::chrono::steady_clock::now();
+  ASSERT_TRUE(built.Save(path, rndf));
+  auto t2 = std::chrono::steady_clock::now();
+  ASSERT_TRUE(RoadNetwork::UpToDate(path, rndf));
+  auto t3 = std::chrono::steady_clock::now();
+  RoadNetwork loaded(rndf, path);
+  auto t4 = std::chrono::steady_clock::now();
+
+  EXPECT_EQ(loaded.Graph().Vertexes().size(),
+            built.Graph().Vertexes().size());
+  EXPECT_EQ(loaded.Graph().Edges().size(), built.Graph().Edges().size());
+  EXPECT_EQ(loaded.NumComponents(), built.NumComponents());
+
+  auto ms = [](std::chrono::steady_clock::duration _d)
+  {
+    return std::chrono::duration<double, std::milli>(_d).count();
+  };
+  std::cout << "Vertexes: " << built.Graph().Vertexes().size() << std::endl
+            << "Edges: " << built.Graph().Edges().size() << std::endl
+            << "Build: " << ms(t1 - t0) << " ms" << std::endl
+            << "Save: " << ms(t2 - t1) << " ms" << std::endl
+            << "Check: " << ms(t3 - t2) << " ms" << std::endl
+            << "Load: " << ms(t4 - t3) << " ms" << std::endl;
+
+  std::remove(path.c_str());
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
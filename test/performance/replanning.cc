@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "manifold/rndf/RNDF.hh"
+#include "manifold/rndf/UniqueId.hh"
+#include "manifold/Replanner.hh"
+#include "manifold/RoadNetwork.hh"
+#include "gtest/gtest.h"
+#include "performance/grid_rndf.hh"
+
+using namespace manifold;
+
+//////////////////////////////////////////////////
+/// \brief Compare the time needed to repair a route after a few closures
+/// with the time of a search from scratch. The vehicle drives along the
+/// route and discovers the closures a few waypoints ahead of it.
+TEST(Replanning, RepairVsRecompute)
+{
+  const int kSize = 30;
+  const int kWaypoints = 5;
+  rndf::RNDF rndf;
+  test::gridRNDF(kSize, kSize, kWaypoints, rndf);
+  RoadNetwork roadNetwork(rndf);
+  auto numVertexes = roadNetwork.Graph().Vertexes().size();
+
+  // From a corner to the opposite one.
+  rndf::UniqueId start(1, 1, 1);
+  rndf::UniqueId goal(rndf.NumSegments(), 1, kWaypoints);
+
+  Replanner replanner(roadNetwork);
+  ASSERT_TRUE(replanner.Plan(start, goal));
+
+  std::mt19937 generator(7);
+  const int kRounds = 50;
+  const int kClosuresPerRound = 3;
+  const size_t kHorizon = 10;
+  const size_t kAdvance = 3;
+  double repairTime = 0;
+  double recomputeTime = 0;
+  size_t expansions = 0;
+  int samples = 0;
+  for (int round = 0; round < kRounds; ++round)
+  {
+    auto route = replanner.Route();
+    if (route.size() <= kHorizon + kAdvance)
+      break;
+
+    // Advance and block a few edges of the route ahead of the vehicle.
+    start = route[kAdvance];
+    ASSERT_TRUE(replanner.MoveTo(start));
+    std::uniform_int_distribution<size_t> d(kAdvance, kAdvance + kHorizon);
+    for (int i = 0; i < kClosuresPerRound; ++i)
+    {
+      size_t k = d(generator);
+      roadNetwork.CloseEdge(route[k], route[k + 1]);
+    }
+
+    auto t0 = std::chrono::steady_clock::now();
+    bool repaired = replanner.Replan();
+    auto t1 = std::chrono::steady_clock::now();
+    std::vector<rndf::UniqueId> path;
+    double cost;
+    bool recomputed = roadNetwork.ShortestPath(start, goal, path, cost);
+    auto t2 = std::chrono::steady_clock::now();
+
+    ASSERT_EQ(repaired, recomputed);
+    if (!repaired)
+    {
+      // Too many closures: start again with an open network.
+      roadNetwork.ClearOverlay();
+      ASSERT_TRUE(replanner.Replan());
+      continue;
+    }
+    EXPECT_NEAR(replanner.Cost(), cost, 1e-6);
+
+    repairTime += std::chrono::duration<double, std::micro>(t1 - t0).count();
+    recomputeTime +=
+      std::chrono::duration<double, std::micro>(t2 - t1).count();
+    expansions += replanner.Expansions();
+    ++samples;
+  }
+  ASSERT_GT(samples, 0);
+
+  std::cout << "Vertexes: " << numVertexes << std::endl
+            << "Average repair time: " << repairTime / samples << " us ("
+            << expansions / samples << " expansions)" << std::endl
+            << "Average recompute time: " << recomputeTime / samples
+            << " us" << std::endl;
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
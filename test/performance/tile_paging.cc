@@ -0,0 +1,168 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <ignition/math/Angle.hh>
+#include <ignition/math/Helpers.hh>
+#include <ignition/math/SphericalCoordinates.hh>
+
+#include "manifold/rndf/RNDF.hh"
+#include "manifold/RoadNetwork.hh"
+#include "manifold/TiledMap.hh"
+#include "manifold/test_config.h"
+#include "gtest/gtest.h"
+#include "performance/grid_rndf.hh"
+
+using namespace manifold;
+
+/// \brief Resident memory of the process, if available.
+/// \return The memory (kB) or 0 if unknown.
+size_t residentKb()
+{
+  std::ifstream status("/proc/self/status");
+  std::string key;
+  while (status >> key)
+  {
+    if (key == "VmRSS:")
+    {
+      size_t kb = 0;
+      status >> kb;
+      return kb;
+    }
+  }
+  return 0;
+}
+
+//////////////////////////////////////////////////
+/// \brief Drive across a large grid with the tiles paged around the
+/// vehicle, and compare with the network of the whole map.
+TEST(TilePaging, Drive)
+{
+  const int kSize = 40;
+  const int kWaypoints = 10;
+  const double kSpacing = 100.0;
+  rndf::RNDF rndf;
+  test::gridRNDF(kSize, kSize, kWaypoints, rndf, kSpacing);
+
+  std::string path = std::string(PROJECT_BINARY_PATH) +
+    "/test/performance/tile_paging.tiles";
+  auto t0 = std::chrono::steady_clock::now();
+  ASSERT_TRUE(TiledMap::Build(rndf, path, 500.0));
+  auto t1 = std::chrono::steady_clock::now();
+
+  auto ms = [](std::chrono::steady_clock::duration _d)
+  {
+    return std::chrono::duration<double, std::milli>(_d).count();
+  };
+
+  TiledMap map(path);
+  ASSERT_TRUE(map.Valid());
+  size_t totalBytes = 0;
+  std::ifstream manifest(path, std::ios::binary | std::ios::ate);
+  for (size_t i = 0; i < map.NumTiles(); ++i)
+  {
+    std::ifstream tile(path + "." + std::to_string(i),
+                       std::ios::binary | std::ios::ate);
+    totalBytes += static_cast<size_t>(tile.tellg());
+  }
+  std::cout << "Segments: " << rndf.NumSegments() << std::endl
+            << "Tiles: " << map.NumTiles() << " ("
+            << totalBytes / 1024 << " kB, manifest "
+            << static_cast<size_t>(manifest.tellg()) / 1024 << " kB)"
+            << std::endl
+            << "Tiling: " << ms(t1 - t0) << " ms" << std::endl;
+
+  // Both networks are kept alive, so neither reuses the memory of the
+  // other.
+  size_t kb0 = residentKb();
+  t0 = std::chrono::steady_clock::now();
+  RoadNetwork full(rndf);
+  t1 = std::chrono::steady_clock::now();
+  size_t kb1 = residentKb();
+  std::cout << "Whole network: " << ms(t1 - t0) << " ms";
+  if (kb0 > 0)
+    std::cout << ", " << kb1 - std::min(kb0, kb1) << " kB";
+  std::cout << std::endl;
+
+  size_t peakKb = kb1;
+
+  // Along the diagonal, every 50 m, keeping 500 m around the vehicle.
+  const double kRadius = 500.0;
+  const double kExtent = (kSize - 1) * kSpacing / 111320.0;
+  const int kSteps = static_cast<int>((kSize - 1) * kSpacing * 1.41 / 50);
+  double worst = 0;
+  double total = 0;
+  size_t maxResident = 0;
+  size_t maxBytes = 0;
+  for (int i = 0; i <= kSteps; ++i)
+  {
+    double f = static_cast<double>(i) / kSteps;
+    ignition::math::SphericalCoordinates position(
+      ignition::math::SphericalCoordinates::EARTH_WGS84,
+      ignition::math::Angle(IGN_DTOR(37.4 + f * kExtent)),
+      ignition::math::Angle(IGN_DTOR(-122.1 + f * kExtent)),
+      0.0, ignition::math::Angle::Zero);
+
+    size_t loads = map.NumLoads();
+    auto u0 = std::chrono::steady_clock::now();
+    ASSERT_TRUE(map.Update(position, kRadius));
+    auto u1 = std::chrono::steady_clock::now();
+    if (map.NumLoads() > loads)
+    {
+      worst = std::max(worst, ms(u1 - u0) / (map.NumLoads() - loads));
+      total += ms(u1 - u0);
+    }
+    maxResident = std::max(maxResident, map.NumResident());
+    maxBytes = std::max(maxBytes, map.ResidentBytes());
+    peakKb = std::max(peakKb, residentKb());
+  }
+  std::cout << "Updates: " << kSteps + 1 << ", loads: " << map.NumLoads()
+            << ", unloads: " << map.NumUnloads() << std::endl
+            << "Update latency: " << total / map.NumLoads()
+            << " ms per tile loaded (worst " << worst << " ms)"
+            << std::endl
+            << "Resident tiles: " << maxResident << " of "
+            << map.NumTiles() << " (" << maxBytes / 1024 << " kB)"
+            << std::endl;
+  EXPECT_LT(maxResident, map.NumTiles());
+
+  auto c0 = std::chrono::steady_clock::now();
+  map.Compact();
+  auto c1 = std::chrono::steady_clock::now();
+  std::cout << "Compact: " << ms(c1 - c0) << " ms" << std::endl;
+  if (kb1 > 0)
+  {
+    std::cout << "Tiled map peak: " << peakKb - kb1 << " kB"
+              << std::endl;
+  }
+
+  for (size_t i = 0; i < map.NumTiles(); ++i)
+    std::remove((path + "." + std::to_string(i)).c_str());
+  std::remove(path.c_str());
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
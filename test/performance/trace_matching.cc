@@ -0,0 +1,167 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <ignition/math/SphericalCoordinates.hh>
+
+#include "manifold/rndf/Lane.hh"
+#include "manifold/rndf/RNDF.hh"
+#include "manifold/rndf/Segment.hh"
+#include "manifold/rndf/UniqueId.hh"
+#include "manifold/rndf/Waypoint.hh"
+#include "manifold/RoadNetwork.hh"
+#include "manifold/TraceMatcher.hh"
+#include "manifold/test_config.h"
+#include "gtest/gtest.h"
+#include "performance/grid_rndf.hh"
+
+using namespace manifold;
+
+//////////////////////////////////////////////////
+/// \brief Measure the throughput of the map-matching of trace files with a
+/// growing number of worker threads, and the fraction of the fixes matched
+/// to a lane of the route driven.
+TEST(TraceMatching, Throughput)
+{
+  const int kSize = 20;
+  const int kWaypoints = 5;
+  rndf::RNDF rndf;
+  test::gridRNDF(kSize, kSize, kWaypoints, rndf);
+  RoadNetwork roadNetwork(rndf);
+  TraceMatcher matcher(rndf, roadNetwork);
+
+  std::vector<rndf::UniqueId> ids;
+  for (auto const &vertex : roadNetwork.Graph().Vertexes())
+    ids.push_back(rndf::UniqueId(vertex->Name()));
+
+  // Location of each waypoint.
+  std::map<std::string, ignition::math::SphericalCoordinates> locations;
+  for (auto const &segment : rndf.Segments())
+  {
+    for (auto const &lane : segment.Lanes())
+    {
+      for (auto const &wp : lane.Waypoints())
+      {
+        rndf::UniqueId id(segment.Id(), lane.Id(), wp.Id());
+        locations[id.String()] = wp.Location();
+      }
+    }
+  }
+
+  // Random routes sampled every 10 m with a GPS error of 3 m.
+  const size_t kTraces = 16;
+  const double kStep = 10.0;
+  std::mt19937 generator(13);
+  std::uniform_int_distribution<size_t> pick(0, ids.size() - 1);
+  std::normal_distribution<double> noise(0.0, 3.0 / 111320.0);
+  std::vector<std::string> inputs;
+  std::vector<std::string> outputs;
+  std::vector<std::set<std::pair<int, int>>> driven;
+  size_t fixes = 0;
+  while (inputs.size() < kTraces)
+  {
+    std::vector<rndf::UniqueId> path;
+    double cost;
+    if (!roadNetwork.ShortestPath(ids[pick(generator)], ids[pick(generator)],
+                                  path, cost) || cost < 1000.0)
+    {
+      continue;
+    }
+
+    inputs.push_back(testing::getRandomNumber() + ".trace");
+    outputs.push_back(testing::getRandomNumber() + ".matches");
+    driven.push_back(std::set<std::pair<int, int>>());
+    std::ofstream file(inputs.back());
+    file << std::setprecision(10);
+    for (size_t i = 1; i < path.size(); ++i)
+    {
+      driven.back().insert(std::make_pair(path[i].X(), path[i].Y()));
+      auto const &a = locations[path[i - 1].String()];
+      auto const &b = locations[path[i].String()];
+      double length = ignition::math::SphericalCoordinates::Distance(
+        a.LatitudeReference(), a.LongitudeReference(),
+        b.LatitudeReference(), b.LongitudeReference());
+      for (double s = 0; s < length; s += kStep)
+      {
+        double t = s / length;
+        double lat = (1 - t) * a.LatitudeReference().Degree() +
+          t * b.LatitudeReference().Degree();
+        double lon = (1 - t) * a.LongitudeReference().Degree() +
+          t * b.LongitudeReference().Degree();
+        file << lat + noise(generator) << " " << lon + noise(generator)
+             << "\n";
+        ++fixes;
+      }
+    }
+  }
+
+  std::cout << "Traces: " << kTraces << std::endl
+            << "Fixes: " << fixes << std::endl
+            << "Hardware threads: " << std::thread::hardware_concurrency()
+            << std::endl;
+
+  for (unsigned int threads = 1; threads <= 8; threads *= 2)
+  {
+    auto t0 = std::chrono::steady_clock::now();
+    EXPECT_EQ(matcher.Match(inputs, outputs, threads), kTraces);
+    auto t1 = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(t1 - t0).count();
+    std::cout << threads << " threads: " << fixes / seconds << " fixes/s"
+              << std::endl;
+  }
+
+  // Fixes matched to a lane of their route.
+  size_t correct = 0;
+  for (size_t i = 0; i < kTraces; ++i)
+  {
+    std::ifstream file(outputs[i]);
+    std::string id;
+    std::string rest;
+    while (file >> id && std::getline(file, rest))
+    {
+      if (id == "-")
+        continue;
+      rndf::UniqueId waypoint(id);
+      if (driven[i].count(std::make_pair(waypoint.X(), waypoint.Y())))
+        ++correct;
+    }
+    std::remove(inputs[i].c_str());
+    std::remove(outputs[i].c_str());
+  }
+  double accuracy = static_cast<double>(correct) / fixes;
+  std::cout << "Fixes on the route: " << 100 * accuracy << " %"
+            << std::endl;
+  EXPECT_GT(accuracy, 0.9);
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
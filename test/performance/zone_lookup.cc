@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2016 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+#include <ignition/math/Angle.hh>
+#include <ignition/math/Helpers.hh>
+#include <ignition/math/SphericalCoordinates.hh>
+
+#include "manifold/rndf/Perimeter.hh"
+#include "manifold/rndf/RNDF.hh"
+#include "manifold/rndf/Waypoint.hh"
+#include "manifold/rndf/Zone.hh"
+#include "manifold/ZoneIndex.hh"
+#include "performance/fixtures.hh"
+#include "gtest/gtest.h"
+
+using namespace manifold;
+using test::location;
+
+/// \brief Whether a location is inside a zone, testing its perimeter as
+/// is.
+/// \param[in] _zone The zone.
+/// \param[in] _location The location.
+/// \return True if it's inside.
+bool inside(const rndf::Zone &_zone,
+            const ignition::math::SphericalCoordinates &_location)
+{
+  double x = _location.LongitudeReference().Degree();
+  double y = _location.LatitudeReference().Degree();
+  auto const &points = _zone.Perimeter().Points();
+  bool result = false;
+  for (size_t i = 0, j = points.size() - 1; i < points.size(); j = i++)
+  {
+    double xi = points[i].Location().LongitudeReference().Degree();
+    double yi = points[i].Location().LatitudeReference().Degree();
+    double xj = points[j].Location().LongitudeReference().Degree();
+    double yj = points[j].Location().LatitudeReference().Degree();
+    if ((yi > y) != (yj > y) && x < xi + (y - yi) * (xj - xi) / (yj - yi))
+      result = !result;
+  }
+  return result;
+}
+
+//////////////////////////////////////////////////
+/// \brief Compare the zone queries of the index with a test of every zone.
+TEST(ZoneLookup, Throughput)
+{
+  // A grid of octagonal zones (80 m of radius, 200 m apart).
+  const int kSize = 40;
+  const double kStep = 200.0 / 111320.0;
+  const double kRadius = 80.0 / 111320.0;
+  rndf::RNDF rndf;
+  for (int r = 0; r < kSize; ++r)
+  {
+    for (int c = 0; c < kSize; ++c)
+    {
+      rndf::Zone zone(r * kSize + c + 1);
+      for (int k = 0; k < 8; ++k)
+      {
+        double angle = k * IGN_PI / 4;
+        zone.Perimeter().AddPoint(rndf::Waypoint(k + 1,
+          location(37.4 + r * kStep + kRadius * std::sin(angle),
+                   -122.1 + c * kStep + kRadius * std::cos(angle))));
+      }
+      ASSERT_TRUE(rndf.AddZone(zone));
+    }
+  }
+
+  auto t0 = std::chrono::steady_clock::now();
+  ZoneIndex index(rndf);
+  auto t1 = std::chrono::steady_clock::now();
+  std::cout << "Zones: " << index.Size() << std::endl
+            << "Build: "
+            << std::chrono::duration<double, std::milli>(t1 - t0).count()
+            << " ms" << std::endl;
+
+  const size_t kQueries = 200000;
+  std::mt19937 generator(17);
+  std::uniform_real_distribution<double> offset(-kStep, kSize * kStep);
+  std::vector<ignition::math::SphericalCoordinates> locations;
+  for (size_t i = 0; i < kQueries; ++i)
+  {
+    locations.push_back(location(37.4 + offset(generator),
+                                 -122.1 + offset(generator)));
+  }
+
+  // Every zone, on a tenth of the locations.
+  const size_t kScanned = kQueries / 10;
+  std::vector<int> scanned(kScanned, 0);
+  t0 = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < kScanned; ++i)
+  {
+    for (auto const &zone : rndf.Zones())
+    {
+      if (inside(zone, locations[i]))
+      {
+        scanned[i] = zone.Id();
+        break;
+      }
+    }
+  }
+  t1 = std::chrono::steady_clock::now();
+  double seconds = std::chrono::duration<double>(t1 - t0).count();
+  std::cout << "Scan: " << kScanned / seconds << " queries/s" << std::endl;
+
+  std::vector<int> single(kQueries);
+  t0 = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < kQueries; ++i)
+    single[i] = index.ZoneAt(locations[i]);
+  t1 = std::chrono::steady_clock::now();
+  seconds = std::chrono::duration<double>(t1 - t0).count();
+  std::cout << "Index: " << kQueries / seconds << " queries/s" << std::endl;
+
+  std::vector<int> batch;
+  t0 = std::chrono::steady_clock::now();
+  size_t found = index.ZoneAt(locations, batch);
+  t1 = std::chrono::steady_clock::now();
+  seconds = std::chrono::duration<double>(t1 - t0).count();
+  std::cout << "Batch: " << kQueries / seconds << " queries/s, "
+            << found << " in a zone" << std::endl;
+
+  for (size_t i = 0; i < kScanned; ++i)
+    EXPECT_EQ(single[i], scanned[i]);
+  EXPECT_EQ(batch, single);
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}